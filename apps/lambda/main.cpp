@@ -0,0 +1,7 @@
+#include "georoute/lambda_handler.hpp"
+
+// Bootstrap of the Lambda custom runtime: configured entirely through the
+// environment (see LambdaOptions).
+int main() {
+    return georoute::lambda_entry_point();
+}
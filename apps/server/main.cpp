@@ -1,3 +1,5 @@
+#include <charconv>
+#include <chrono>
 #include <cstdint>
 #include <iostream>
 #include <optional>
@@ -9,7 +11,23 @@
 namespace {
 
 void print_usage(const char* binary) {
-    std::cout << "Usage: " << binary << " --graph <path> [--host <host>] [--port <port>]" << '\n';
+    std::cout << "Usage: " << binary << " --graph <path> [--host <host>] [--port <port>] [--coalesce-window-us <us>]"
+              << " [--feed unix:<path>|tcp:[<host>:]<port>|file:<path>]... [--feed-format ndjson|binary]"
+              << " [--state-dir <dir>] [--snapshot-interval-s <s>]"
+              << " [--route-timeout-ms <ms>] [--max-settled-nodes <n>] [--max-batch-size <n>]"
+              << " [--binary-port <port>] [--http-threads <n>] [--http-max-queued <n>]"
+              << " [--keep-alive-max <n>] [--keep-alive-timeout-s <s>] [--read-timeout-ms <ms>]"
+              << " [--write-timeout-ms <ms>] [--no-route-coalescing]" << '\n';
+}
+
+// Rejects values that do not fit instead of wrapping them.
+std::optional<std::uint32_t> parse_uint32(std::string_view text) {
+    std::uint32_t value{0};
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
 }
 
 std::optional<georoute::AppConfig> parse_arguments(int argc, char** argv) {
@@ -23,6 +41,43 @@ std::optional<georoute::AppConfig> parse_arguments(int argc, char** argv) {
             config.host = argv[++i];
         } else if (arg == "--port" && i + 1 < argc) {
             config.port = static_cast<std::uint16_t>(std::stoi(argv[++i]));
+        } else if (arg == "--feed" && i + 1 < argc) {
+            config.congestion_feeds.emplace_back(argv[++i]);
+        } else if (arg == "--feed-format" && i + 1 < argc) {
+            config.congestion_feed_format = argv[++i];
+        } else if (arg == "--state-dir" && i + 1 < argc) {
+            config.state_dir = argv[++i];
+        } else if (arg == "--snapshot-interval-s" && i + 1 < argc) {
+            config.snapshot_interval = std::chrono::seconds{std::stoll(argv[++i])};
+        } else if (arg == "--route-timeout-ms" && i + 1 < argc) {
+            config.route_timeout = std::chrono::milliseconds{std::stoll(argv[++i])};
+        } else if (arg == "--max-settled-nodes" && i + 1 < argc) {
+            const auto max_settled_nodes = parse_uint32(argv[++i]);
+            if (!max_settled_nodes) {
+                std::cerr << "--max-settled-nodes must be an integer from 0 to 4294967295\n";
+                return std::nullopt;
+            }
+            config.max_settled_nodes = *max_settled_nodes;
+        } else if (arg == "--max-batch-size" && i + 1 < argc) {
+            config.max_route_batch_size = std::stoul(argv[++i]);
+        } else if (arg == "--binary-port" && i + 1 < argc) {
+            config.binary_port = static_cast<std::uint16_t>(std::stoi(argv[++i]));
+        } else if (arg == "--http-threads" && i + 1 < argc) {
+            config.http_worker_threads = std::stoul(argv[++i]);
+        } else if (arg == "--http-max-queued" && i + 1 < argc) {
+            config.http_max_queued_connections = std::stoul(argv[++i]);
+        } else if (arg == "--keep-alive-max" && i + 1 < argc) {
+            config.keep_alive_max_count = std::stoul(argv[++i]);
+        } else if (arg == "--keep-alive-timeout-s" && i + 1 < argc) {
+            config.keep_alive_timeout = std::chrono::seconds{std::stoll(argv[++i])};
+        } else if (arg == "--read-timeout-ms" && i + 1 < argc) {
+            config.read_timeout = std::chrono::milliseconds{std::stoll(argv[++i])};
+        } else if (arg == "--write-timeout-ms" && i + 1 < argc) {
+            config.write_timeout = std::chrono::milliseconds{std::stoll(argv[++i])};
+        } else if (arg == "--no-route-coalescing") {
+            config.route_coalescing = false;
+        } else if (arg == "--coalesce-window-us" && i + 1 < argc) {
+            config.congestion_coalesce_window = std::chrono::microseconds{std::stoll(argv[++i])};
         } else {
             return std::nullopt;
         }
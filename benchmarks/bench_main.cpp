@@ -1,15 +1,102 @@
 #include <algorithm>
+#include <atomic>
+#include <barrier>
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <random>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
 #include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+
+#include <fcntl.h>
+#include <malloc.h>
+#include <unistd.h>
+
+#include "georoute/binary_client.hpp"
+#include "georoute/binary_server.hpp"
+#include "georoute/congestion_index.hpp"
+#include "georoute/congestion_journal.hpp"
+#include "georoute/congestion_writer.hpp"
+#include "georoute/dijkstra.hpp"
+#include "georoute/dimacs.hpp"
+#include "georoute/engine.hpp"
 #include "georoute/graph.hpp"
+#include "georoute/graph_generator.hpp"
+#include "georoute/graph_reloader.hpp"
+#include "georoute/graph_snapshot.hpp"
+#include "georoute/http_server.hpp"
+#include "georoute/json_writer.hpp"
+#include "georoute/lambda_handler.hpp"
+#include "georoute/path_encoding.hpp"
+#include "georoute/request_arena.hpp"
+#include "georoute/response_json.hpp"
+#include "georoute/route_request.hpp"
 #include "georoute/router.hpp"
 #include "georoute/segment_tree.hpp"
+#include "georoute/sqrt_decomposition.hpp"
+
+namespace {
+
+// Counted by the replacement operator new below (--mode alloc).
+std::atomic<std::uint64_t> heap_allocations{0};
+std::atomic<std::uint64_t> heap_bytes{0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    heap_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size > 0 ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+// std::pmr::new_delete_resource() allocates through the aligned overloads.
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    heap_bytes.fetch_add(size, std::memory_order_relaxed);
+    const auto align = static_cast<std::size_t>(alignment);
+    if (void* pointer = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align)) {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
 
 namespace {
 
@@ -19,35 +106,22 @@ struct BenchmarkContext {
     std::size_t edge_count;
 };
 
-BenchmarkContext build_grid_router(std::size_t rows, std::size_t cols) {
-    georoute::Graph graph{rows * cols};
+// Set from --graph-type and --seed before any mode runs; every mode builds
+// its graph through build_bench_graph.
+georoute::GraphType bench_graph_type = georoute::GraphType::grid;
+std::uint64_t bench_graph_seed = 1;
 
-    const auto index = [cols](std::size_t r, std::size_t c) {
-        return static_cast<georoute::node_id>(r * cols + c);
-    };
-
-    for (std::size_t r = 0; r < rows; ++r) {
-        for (std::size_t c = 0; c < cols; ++c) {
-            const auto current = index(r, c);
-            if (c + 1 < cols) {
-                const auto right = index(r, c + 1);
-                const float base = 1.0F + static_cast<float>((r + c) % 7) * 0.1F;
-                graph.add_edge(current, right, base);
-                graph.add_edge(right, current, base);
-            }
-            if (r + 1 < rows) {
-                const auto down = index(r + 1, c);
-                const float base = 1.0F + static_cast<float>((r + c) % 5) * 0.15F;
-                graph.add_edge(current, down, base);
-                graph.add_edge(down, current, base);
-            }
-        }
-    }
+georoute::Graph build_bench_graph(std::size_t grid_size) {
+    return georoute::generate_graph(bench_graph_type, grid_size, bench_graph_seed);
+}
 
+BenchmarkContext build_bench_router(std::size_t grid_size, const std::string& congestion_index) {
+    auto graph = build_bench_graph(grid_size);
+    const auto node_count = graph.node_count();
     const auto edge_count = graph.edge_count();
-    georoute::SegmentTree tree{edge_count};
+    auto congestion = georoute::CongestionIndex::make(congestion_index, edge_count);
 
-    return BenchmarkContext{georoute::Router{std::move(graph), std::move(tree)}, rows * cols, edge_count};
+    return BenchmarkContext{georoute::Router{std::move(graph), std::move(congestion)}, node_count, edge_count};
 }
 
 double percentile(const std::vector<double>& sorted, double p) {
@@ -62,6 +136,7 @@ struct PercentileStats {
     double p50{0.0};
     double p95{0.0};
     double p99{0.0};
+    double p999{0.0};
     double max{0.0};
     double min{0.0};
     double mean{0.0};
@@ -80,6 +155,7 @@ struct PercentileStats {
         stats.p50 = percentile(values, 0.50);
         stats.p95 = percentile(values, 0.95);
         stats.p99 = percentile(values, 0.99);
+        stats.p999 = percentile(values, 0.999);
         
         double sum = 0.0;
         for (const auto v : values) {
@@ -97,19 +173,2036 @@ void print_percentile_stats(const std::string& label, const PercentileStats& sta
     std::cout << "  p50_us=" << stats.p50 << "\n";
     std::cout << "  p95_us=" << stats.p95 << "\n";
     std::cout << "  p99_us=" << stats.p99 << "\n";
+    std::cout << "  p999_us=" << stats.p999 << "\n";
     std::cout << "  max_us=" << stats.max << "\n";
     std::cout << "  min_us=" << stats.min << "\n";
     std::cout << "  mean_us=" << stats.mean << "\n";
 }
 
+struct UpdateRange {
+    std::size_t start;
+    std::size_t end;
+    float factor;
+};
+
+UpdateRange random_update(std::mt19937& rng, std::size_t edge_count, std::size_t max_span) {
+    std::uniform_int_distribution<std::size_t> edge_dist(0, edge_count - 1);
+    std::uniform_int_distribution<std::size_t> span_dist(0, max_span);
+    std::uniform_real_distribution<float> factor_dist(0.8F, 1.3F);
+    const auto start_idx = edge_dist(rng);
+    const auto span = std::min(span_dist(rng), edge_count - start_idx - 1);
+    return UpdateRange{start_idx, start_idx + span, factor_dist(rng)};
+}
+
+// Compares per-relaxation segment tree walks against the Router's materialized
+// edge cost table on identical queries and updates.
+void run_cost_table_comparison(std::size_t grid_size, std::size_t queries, std::size_t updates, std::mt19937& rng) {
+    const auto graph = build_bench_graph(grid_size);
+    const auto node_count = graph.node_count();
+    const auto edge_count = graph.edge_count();
+    std::cout << "Graph: " << node_count << " nodes, " << edge_count << " edges\n\n";
+    if (edge_count == 0) {
+        return;
+    }
+
+    georoute::SegmentTree tree{edge_count};
+    georoute::Router router{graph, georoute::SegmentTree{edge_count}};
+
+    std::uniform_int_distribution<std::size_t> node_dist(0, node_count - 1);
+    const std::size_t max_span = std::min<std::size_t>(750, edge_count - 1);
+    const auto update_interval = updates > 0 ? std::max<std::size_t>(1, queries / updates) : 0;
+
+    std::vector<double> tree_walk_times;
+    std::vector<double> cost_table_times;
+    std::vector<double> tree_update_times;
+    std::vector<double> router_update_times;
+    std::size_t mismatches = 0;
+
+    for (std::size_t i = 0; i < queries; ++i) {
+        if (update_interval > 0 && i % update_interval == 0) {
+            const auto update = random_update(rng, edge_count, max_span);
+
+            const auto tree_begin = std::chrono::high_resolution_clock::now();
+            tree.range_multiply(update.start, update.end, update.factor);
+            const auto tree_end = std::chrono::high_resolution_clock::now();
+            router.apply_congestion_update(update.start, update.end, update.factor);
+            const auto router_end = std::chrono::high_resolution_clock::now();
+
+            tree_update_times.push_back(std::chrono::duration<double, std::micro>(tree_end - tree_begin).count());
+            router_update_times.push_back(std::chrono::duration<double, std::micro>(router_end - tree_end).count());
+        }
+
+        const auto source = static_cast<georoute::node_id>(node_dist(rng));
+        auto target = static_cast<georoute::node_id>(node_dist(rng));
+        if (source == target) {
+            target = static_cast<georoute::node_id>((target + 1) % node_count);
+        }
+
+        const auto walk_begin = std::chrono::high_resolution_clock::now();
+        const auto walked = georoute::DijkstraRouter{graph, tree}.shortest_path(source, target);
+        const auto walk_end = std::chrono::high_resolution_clock::now();
+        const auto tabled = router.compute_route(source, target);
+        const auto table_end = std::chrono::high_resolution_clock::now();
+
+        tree_walk_times.push_back(std::chrono::duration<double, std::micro>(walk_end - walk_begin).count());
+        cost_table_times.push_back(std::chrono::duration<double, std::micro>(table_end - walk_end).count());
+
+        const auto delta = std::abs(walked.result.total_travel_time - tabled.result.total_travel_time);
+        if (walked.result.reachable != tabled.result.reachable ||
+            delta > 1e-3F * std::max(1.0F, walked.result.total_travel_time)) {
+            ++mismatches;
+        }
+    }
+
+    const auto walk_stats = PercentileStats::compute(tree_walk_times);
+    const auto table_stats = PercentileStats::compute(cost_table_times);
+    std::cout << "ROUTE_BENCH\n";
+    print_percentile_stats("route_tree_walk", walk_stats);
+    print_percentile_stats("route_cost_table", table_stats);
+    std::cout << "  speedup_mean=" << (table_stats.mean > 0 ? walk_stats.mean / table_stats.mean : 0.0) << "\n";
+    std::cout << "  cost_mismatches=" << mismatches << "\n\n";
+
+    if (!tree_update_times.empty()) {
+        const auto tree_stats = PercentileStats::compute(tree_update_times);
+        const auto router_stats = PercentileStats::compute(router_update_times);
+        std::cout << "UPDATE_BENCH\n";
+        print_percentile_stats("update_tree_only", tree_stats);
+        print_percentile_stats("update_tree_and_cost_table", router_stats);
+        std::cout << "  added_mean_us=" << router_stats.mean - tree_stats.mean << "\n\n";
+    }
+}
+
+// Raw range_multiply and point_query throughput of one congestion backend on a
+// fixed update sequence.
+template <typename Structure>
+void run_structure_benchmark(const std::string& label,
+                             std::size_t edge_count,
+                             const std::vector<UpdateRange>& updates) {
+    Structure structure{edge_count};
+
+    std::vector<double> update_times;
+    update_times.reserve(updates.size());
+    for (const auto& update : updates) {
+        const auto begin = std::chrono::high_resolution_clock::now();
+        structure.range_multiply(update.start, update.end, update.factor);
+        const auto end = std::chrono::high_resolution_clock::now();
+        update_times.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+    }
+
+    float checksum = 0.0F;
+    const auto query_begin = std::chrono::high_resolution_clock::now();
+    for (std::size_t i = 0; i < edge_count; ++i) {
+        checksum += structure.point_query(i);
+    }
+    const auto query_end = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double, std::nano> query_duration = query_end - query_begin;
+
+    const auto stats = PercentileStats::compute(update_times);
+    print_percentile_stats(label, stats);
+    std::cout << "  throughput_updates_per_sec=" << (stats.mean > 0 ? 1000000.0 / stats.mean : 0.0) << "\n";
+    std::cout << "  point_query_ns=" << query_duration.count() / static_cast<double>(edge_count) << "\n";
+    std::cout << "  checksum=" << checksum << "\n";
+}
+
+// Builds each generated graph type at grid_size and reports its shape and
+// how the same number of random queries behaves on it.
+void run_graph_type_comparison(std::size_t grid_size, std::size_t queries, std::mt19937& rng) {
+    std::cout << "GRAPH_BENCH\n";
+    for (const auto type : {georoute::GraphType::grid, georoute::GraphType::geometric, georoute::GraphType::highway,
+                            georoute::GraphType::city}) {
+        const auto build_begin = std::chrono::steady_clock::now();
+        auto graph = georoute::generate_graph(type, grid_size, bench_graph_seed);
+        const std::chrono::duration<double, std::milli> build_time = std::chrono::steady_clock::now() - build_begin;
+        const auto node_count = graph.node_count();
+        const auto edge_count = graph.edge_count();
+
+        std::size_t max_degree = 0;
+        std::size_t dead_ends = 0;
+        std::size_t one_way = 0;
+        for (georoute::node_id u = 0; u < node_count; ++u) {
+            const auto& edges = graph.neighbors(u);
+            max_degree = std::max(max_degree, edges.size());
+            dead_ends += edges.size() == 1 ? 1 : 0;
+            for (const auto& edge : edges) {
+                const auto& back = graph.neighbors(edge.to);
+                one_way += std::none_of(back.begin(), back.end(), [u](const auto& e) { return e.to == u; }) ? 1 : 0;
+            }
+        }
+
+        std::cout << georoute::graph_type_name(type) << "\n";
+        std::cout << "  build_ms=" << build_time.count() << "\n";
+        std::cout << "  nodes=" << node_count << "\n";
+        std::cout << "  edges=" << edge_count << "\n";
+        if (node_count == 0) {
+            continue;
+        }
+        std::cout << "  mean_out_degree=" << static_cast<double>(edge_count) / static_cast<double>(node_count) << "\n";
+        std::cout << "  max_out_degree=" << max_degree << "\n";
+        std::cout << "  dead_end_share=" << static_cast<double>(dead_ends) / static_cast<double>(node_count) << "\n";
+        std::cout << "  one_way_edge_share="
+                  << (edge_count > 0 ? static_cast<double>(one_way) / static_cast<double>(edge_count) : 0.0) << "\n";
+
+        georoute::Router router{std::move(graph), georoute::CongestionIndex::make("segment_tree", edge_count)};
+        std::uniform_int_distribution<georoute::node_id> node_dist(0, static_cast<georoute::node_id>(node_count - 1));
+        std::vector<double> times;
+        times.reserve(queries);
+        std::size_t unreachable = 0;
+        std::size_t hops = 0;
+        std::size_t expanded = 0;
+        for (std::size_t i = 0; i < queries; ++i) {
+            const auto source = node_dist(rng);
+            const auto target = node_dist(rng);
+            const auto begin = std::chrono::steady_clock::now();
+            const auto computation = router.compute_route(source, target);
+            const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - begin;
+            times.push_back(elapsed.count());
+            expanded += computation.stats.expanded_nodes;
+            if (!computation.result.reachable) {
+                ++unreachable;
+            } else {
+                hops += computation.result.nodes.size() - 1;
+            }
+        }
+        const auto reachable = queries - unreachable;
+        const auto stats = PercentileStats::compute(std::move(times));
+        std::cout << "  unreachable_share=" << (queries > 0 ? static_cast<double>(unreachable) / queries : 0.0) << "\n";
+        std::cout << "  mean_hops=" << (reachable > 0 ? static_cast<double>(hops) / reachable : 0.0) << "\n";
+        std::cout << "  mean_expanded_nodes=" << (queries > 0 ? static_cast<double>(expanded) / queries : 0.0) << "\n";
+        std::cout << "  p50_us=" << stats.p50 << "\n";
+        std::cout << "  p99_us=" << stats.p99 << "\n";
+    }
+    std::cout << "\n";
+}
+
+void run_congestion_index_comparison(std::size_t grid_size, std::size_t updates, std::mt19937& rng) {
+    const auto edge_count = build_bench_graph(grid_size).edge_count();
+    std::cout << "Edges: " << edge_count << "\n\n";
+    if (edge_count == 0) {
+        return;
+    }
+
+    const std::size_t max_span = std::min<std::size_t>(750, edge_count - 1);
+    std::vector<UpdateRange> sequence;
+    sequence.reserve(updates);
+    for (std::size_t i = 0; i < updates; ++i) {
+        sequence.push_back(random_update(rng, edge_count, max_span));
+    }
+
+    std::cout << "UPDATE_BENCH\n";
+    run_structure_benchmark<georoute::SegmentTree>("segment_tree", edge_count, sequence);
+    run_structure_benchmark<georoute::SqrtDecomposition>("blocked", edge_count, sequence);
+    std::cout << "  simd=" << (georoute::SqrtDecomposition::uses_avx2() ? "avx2" : "scalar") << "\n";
+    std::cout << "\n";
+}
+
+// Applies ticks of batch_size random updates either one call at a time or as a
+// single merged batch, reporting time per tick for each.
+void run_batch_comparison(std::size_t grid_size,
+                          std::size_t ticks,
+                          std::size_t batch_size,
+                          const std::string& congestion_index,
+                          std::mt19937& rng) {
+    auto individual = build_bench_router(grid_size, congestion_index);
+    auto batched = build_bench_router(grid_size, congestion_index);
+    const auto edge_count = individual.edge_count;
+    std::cout << "Graph: " << individual.node_count << " nodes, " << edge_count << " edges\n";
+    std::cout << "Batch size: " << batch_size << "\n\n";
+    if (edge_count == 0 || batch_size == 0) {
+        return;
+    }
+
+    const std::size_t max_span = std::min<std::size_t>(750, edge_count - 1);
+    std::vector<double> individual_times;
+    std::vector<double> batch_times;
+    std::vector<double> merge_times;
+    std::size_t merged_ranges = 0;
+
+    for (std::size_t tick = 0; tick < ticks; ++tick) {
+        std::vector<georoute::CongestionUpdate> tick_updates;
+        tick_updates.reserve(batch_size);
+        for (std::size_t i = 0; i < batch_size; ++i) {
+            const auto update = random_update(rng, edge_count, max_span);
+            tick_updates.push_back(georoute::CongestionUpdate{update.start, update.end, update.factor});
+        }
+
+        const auto individual_begin = std::chrono::high_resolution_clock::now();
+        for (const auto& update : tick_updates) {
+            individual.router.apply_congestion_update(update.edge_start, update.edge_end, update.factor);
+        }
+        const auto individual_end = std::chrono::high_resolution_clock::now();
+        batched.router.apply_congestion_updates(tick_updates);
+        const auto batch_end = std::chrono::high_resolution_clock::now();
+
+        individual_times.push_back(
+            std::chrono::duration<double, std::micro>(individual_end - individual_begin).count());
+        batch_times.push_back(std::chrono::duration<double, std::micro>(batch_end - individual_end).count());
+
+        // Merging runs before the router takes its lock; time it on its own.
+        const auto merge_begin = std::chrono::high_resolution_clock::now();
+        const auto merged = georoute::merge_congestion_updates(tick_updates);
+        const auto merge_end = std::chrono::high_resolution_clock::now();
+        merge_times.push_back(std::chrono::duration<double, std::micro>(merge_end - merge_begin).count());
+        merged_ranges += merged.size();
+    }
+
+    const auto individual_stats = PercentileStats::compute(individual_times);
+    const auto batch_stats = PercentileStats::compute(batch_times);
+    std::cout << "UPDATE_BENCH\n";
+    print_percentile_stats("tick_individual", individual_stats);
+    print_percentile_stats("tick_batched", batch_stats);
+    const auto merge_stats = PercentileStats::compute(merge_times);
+    std::cout << "  merge_mean_us=" << merge_stats.mean << "\n";
+    std::cout << "  locked_mean_us=" << batch_stats.mean - merge_stats.mean << "\n";
+    std::cout << "  lock_acquisitions_per_tick_individual=" << batch_size << "\n";
+    std::cout << "  lock_acquisitions_per_tick_batched=1\n";
+    std::cout << "  merged_ranges_per_tick=" << static_cast<double>(merged_ranges) / static_cast<double>(ticks) << "\n";
+    std::cout << "  speedup_mean=" << (batch_stats.mean > 0 ? individual_stats.mean / batch_stats.mean : 0.0) << "\n\n";
+}
+
+// Ticks of scattered single-edge updates applied as one range call per edge,
+// as a batch of single-edge ranges, and through the sparse overlay.
+void run_sparse_comparison(std::size_t grid_size,
+                           std::size_t ticks,
+                           std::size_t edges_per_tick,
+                           const std::string& congestion_index,
+                           std::mt19937& rng) {
+    auto per_edge = build_bench_router(grid_size, congestion_index);
+    auto ranged = build_bench_router(grid_size, congestion_index);
+    auto sparse = build_bench_router(grid_size, congestion_index);
+    const auto edge_count = per_edge.edge_count;
+    std::cout << "Graph: " << per_edge.node_count << " nodes, " << edge_count << " edges\n";
+    std::cout << "Edges per tick: " << edges_per_tick << "\n\n";
+    if (edge_count == 0 || edges_per_tick == 0) {
+        return;
+    }
+
+    std::uniform_int_distribution<georoute::edge_id> edge_dist(0, static_cast<georoute::edge_id>(edge_count - 1));
+    std::uniform_real_distribution<float> factor_dist(0.8F, 1.3F);
+
+    std::vector<double> per_edge_times;
+    std::vector<double> ranged_times;
+    std::vector<double> sparse_times;
+    std::size_t flushes = 0;
+
+    for (std::size_t tick = 0; tick < ticks; ++tick) {
+        std::vector<georoute::EdgeFactorUpdate> edges;
+        std::vector<georoute::CongestionUpdate> ranges;
+        edges.reserve(edges_per_tick);
+        ranges.reserve(edges_per_tick);
+        for (std::size_t i = 0; i < edges_per_tick; ++i) {
+            const auto edge = edge_dist(rng);
+            const auto factor = factor_dist(rng);
+            edges.push_back(georoute::EdgeFactorUpdate{edge, factor});
+            ranges.push_back(georoute::CongestionUpdate{edge, edge, factor});
+        }
+
+        const auto per_edge_begin = std::chrono::high_resolution_clock::now();
+        for (const auto& range : ranges) {
+            per_edge.router.apply_congestion_update(range.edge_start, range.edge_end, range.factor);
+        }
+        const auto ranged_begin = std::chrono::high_resolution_clock::now();
+        ranged.router.apply_congestion_updates(ranges);
+        const auto sparse_begin = std::chrono::high_resolution_clock::now();
+        flushes += sparse.router.apply_edge_updates(edges).ranges_written > 0 ? 1 : 0;
+        const auto sparse_end = std::chrono::high_resolution_clock::now();
+
+        per_edge_times.push_back(std::chrono::duration<double, std::micro>(ranged_begin - per_edge_begin).count());
+        ranged_times.push_back(std::chrono::duration<double, std::micro>(sparse_begin - ranged_begin).count());
+        sparse_times.push_back(std::chrono::duration<double, std::micro>(sparse_end - sparse_begin).count());
+    }
+
+    const auto per_edge_stats = PercentileStats::compute(per_edge_times);
+    const auto ranged_stats = PercentileStats::compute(ranged_times);
+    const auto sparse_stats = PercentileStats::compute(sparse_times);
+    std::cout << "UPDATE_BENCH\n";
+    print_percentile_stats("tick_range_per_edge", per_edge_stats);
+    print_percentile_stats("tick_range_batch", ranged_stats);
+    print_percentile_stats("tick_sparse_overlay", sparse_stats);
+    std::cout << "  overlay_flushes=" << flushes << "\n";
+    std::cout << "  sparse_edges_per_sec="
+              << (sparse_stats.mean > 0 ? static_cast<double>(edges_per_tick) * 1000000.0 / sparse_stats.mean : 0.0)
+              << "\n\n";
+}
+
+// Reader threads route continuously while one writer publishes congestion
+// updates at a fixed rate; reports reader latency for each writer rate.
+void run_contention_benchmark(std::size_t grid_size,
+                              std::size_t readers,
+                              std::size_t duration_ms,
+                              const std::string& congestion_index,
+                              std::mt19937& rng) {
+    auto context = build_bench_router(grid_size, congestion_index);
+    std::cout << "Graph: " << context.node_count << " nodes, " << context.edge_count << " edges\n";
+    std::cout << "Readers: " << readers << ", duration_ms=" << duration_ms << "\n\n";
+    if (context.node_count == 0 || context.edge_count == 0 || readers == 0) {
+        return;
+    }
+
+    const std::size_t max_span = std::min<std::size_t>(750, context.edge_count - 1);
+    const std::vector<std::size_t> writer_rates{0, 1000, 10000, 100000};
+    std::cout << "CONTENTION_BENCH\n";
+    for (const auto rate : writer_rates) {
+        std::atomic<bool> stop{false};
+        std::vector<std::vector<double>> reader_times(readers);
+        std::vector<std::thread> threads;
+        threads.reserve(readers);
+        for (std::size_t r = 0; r < readers; ++r) {
+            threads.emplace_back([&, r, reader_seed = rng()] {
+                std::mt19937 local_rng{reader_seed};
+                std::uniform_int_distribution<std::size_t> node_dist(0, context.node_count - 1);
+                while (!stop.load(std::memory_order_relaxed)) {
+                    const auto source = static_cast<georoute::node_id>(node_dist(local_rng));
+                    const auto target = static_cast<georoute::node_id>(node_dist(local_rng));
+                    const auto begin = std::chrono::high_resolution_clock::now();
+                    const auto result = context.router.compute_route(source, target);
+                    const auto end = std::chrono::high_resolution_clock::now();
+                    (void)result;
+                    reader_times[r].push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+                }
+            });
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto deadline = start + std::chrono::milliseconds(duration_ms);
+        std::size_t written = 0;
+        if (rate > 0) {
+            const auto interval = std::chrono::nanoseconds(1000000000 / rate);
+            auto next_write = start;
+            while (std::chrono::steady_clock::now() < deadline) {
+                const auto update = random_update(rng, context.edge_count, max_span);
+                context.router.apply_congestion_update(update.start, update.end, update.factor);
+                ++written;
+                next_write += interval;
+                std::this_thread::sleep_until(next_write);
+            }
+        } else {
+            std::this_thread::sleep_until(deadline);
+        }
+        stop.store(true, std::memory_order_relaxed);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::vector<double> all_times;
+        for (const auto& times : reader_times) {
+            all_times.insert(all_times.end(), times.begin(), times.end());
+        }
+        const auto stats = PercentileStats::compute(all_times);
+        print_percentile_stats("writer_rate_" + std::to_string(rate), stats);
+        std::cout << "  routes_per_sec=" << static_cast<double>(stats.count) / elapsed.count() << "\n";
+        std::cout << "  updates_per_sec=" << static_cast<double>(written) / elapsed.count() << "\n";
+    }
+    std::cout << "\n";
+}
+
+// Upper bound of the bucket holding the p-th quantile, in microseconds; the
+// last bound when the quantile lies above every bound.
+double histogram_percentile_us(const georoute::MetricHistogramSnapshot& histogram, double p) {
+    if (histogram.total_count == 0 || histogram.upper_bounds.empty()) {
+        return 0.0;
+    }
+    const auto rank = static_cast<std::uint64_t>(std::ceil(p * static_cast<double>(histogram.total_count)));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < histogram.upper_bounds.size(); ++i) {
+        seen += histogram.counts[i];
+        if (seen >= rank) {
+            return static_cast<double>(histogram.upper_bounds[i]) / 1000.0;
+        }
+    }
+    return static_cast<double>(histogram.upper_bounds.back()) / 1000.0;
+}
+
+// --readers threads route random pairs through one GeoRouteEngine while
+// --writers threads apply random congestion updates through it, together
+// aiming at update_rate updates/sec (0: back to back). Unlike --mode mixed,
+// queries and updates run at the same time, so this measures the engine's
+// update lock, stats recorder, coalescer and snapshot publication under
+// contention. Reports each thread's throughput and latency, the aggregate
+// p50/p99/p999 of both operations, how far writers fell behind their
+// schedule, and the time they spent waiting for the update lock.
+void run_concurrent_benchmark(std::size_t grid_size,
+                              std::size_t readers,
+                              std::size_t writers,
+                              std::size_t update_rate,
+                              std::size_t duration_ms,
+                              const std::string& congestion_index,
+                              std::mt19937& rng) {
+    auto context = build_bench_router(grid_size, congestion_index);
+    std::cout << "Graph: " << context.node_count << " nodes, " << context.edge_count << " edges\n";
+    std::cout << "Readers: " << readers << ", writers: " << writers << ", target_updates_per_sec=" << update_rate
+              << ", duration_ms=" << duration_ms << "\n\n";
+    if (context.node_count == 0 || context.edge_count == 0 || readers + writers == 0) {
+        return;
+    }
+
+    const auto node_count = context.node_count;
+    const auto edge_count = context.edge_count;
+    const std::size_t max_span = std::min<std::size_t>(750, edge_count - 1);
+    georoute::GeoRouteEngine engine{std::move(context.router)};
+
+    struct ThreadResult {
+        std::vector<double> times;
+        // Writers only: worst delay between an update's scheduled and actual start.
+        double max_schedule_lag_us{0.0};
+    };
+    std::vector<ThreadResult> reader_results(readers);
+    std::vector<ThreadResult> writer_results(writers);
+    std::atomic<bool> stop{false};
+    // Paced writers sleep on this so the stop wakes them instead of their next slot.
+    std::mutex stop_mutex;
+    std::condition_variable stop_cv;
+    std::barrier start_line{static_cast<std::ptrdiff_t>(readers + writers + 1)};
+    std::vector<std::thread> threads;
+    threads.reserve(readers + writers);
+
+    for (std::size_t r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r, reader_seed = rng()] {
+            std::mt19937 local_rng{reader_seed};
+            std::uniform_int_distribution<std::size_t> node_dist(0, node_count - 1);
+            auto& times = reader_results[r].times;
+            times.reserve(1 << 16);
+            start_line.arrive_and_wait();
+            while (!stop.load(std::memory_order_relaxed)) {
+                const auto source = static_cast<georoute::node_id>(node_dist(local_rng));
+                const auto target = static_cast<georoute::node_id>(node_dist(local_rng));
+                const auto begin = std::chrono::high_resolution_clock::now();
+                const auto response = engine.route(source, target);
+                const auto end = std::chrono::high_resolution_clock::now();
+                (void)response;
+                times.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+            }
+        });
+    }
+
+    // Each writer takes an equal share of the rate, offset so their updates interleave.
+    const auto interval = update_rate > 0 ? std::chrono::nanoseconds(1'000'000'000ULL * writers / update_rate)
+                                          : std::chrono::nanoseconds{0};
+    for (std::size_t w = 0; w < writers; ++w) {
+        threads.emplace_back([&, w, writer_seed = rng()] {
+            std::mt19937 local_rng{writer_seed};
+            auto& result = writer_results[w];
+            result.times.reserve(1 << 16);
+            start_line.arrive_and_wait();
+            auto next_write = std::chrono::steady_clock::now() + interval * w / writers;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (interval.count() > 0) {
+                    std::unique_lock lock{stop_mutex};
+                    if (stop_cv.wait_until(lock, next_write, [&stop] { return stop.load(std::memory_order_relaxed); })) {
+                        break;
+                    }
+                    lock.unlock();
+                    const std::chrono::duration<double, std::micro> lag = std::chrono::steady_clock::now() - next_write;
+                    result.max_schedule_lag_us = std::max(result.max_schedule_lag_us, lag.count());
+                    next_write += interval;
+                }
+                const auto update = random_update(local_rng, edge_count, max_span);
+                const auto begin = std::chrono::high_resolution_clock::now();
+                engine.apply_congestion_update(update.start, update.end, update.factor);
+                const auto end = std::chrono::high_resolution_clock::now();
+                result.times.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+            }
+        });
+    }
+
+    start_line.arrive_and_wait();
+    const auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_until(start + std::chrono::milliseconds(duration_ms));
+    {
+        std::lock_guard lock{stop_mutex};
+        stop.store(true, std::memory_order_relaxed);
+    }
+    stop_cv.notify_all();
+    // Taken before the joins: a reader finishing a long route must not
+    // stretch the window the throughput is divided by.
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const auto report_threads = [&elapsed](const std::string& label,
+                                           const std::string& unit,
+                                           const std::vector<ThreadResult>& results) {
+        std::vector<double> all_times;
+        std::cout << "per_" << label << "\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto stats = PercentileStats::compute(results[i].times);
+            std::cout << "  " << label << "_" << i << " " << unit << "=" << stats.count << " " << unit
+                      << "_per_sec=" << static_cast<double>(stats.count) / elapsed.count() << " p50_us=" << stats.p50
+                      << " p99_us=" << stats.p99 << " p999_us=" << stats.p999;
+            if (label == "writer") {
+                std::cout << " max_schedule_lag_us=" << results[i].max_schedule_lag_us;
+            }
+            std::cout << "\n";
+            all_times.insert(all_times.end(), results[i].times.begin(), results[i].times.end());
+        }
+        const auto stats = PercentileStats::compute(std::move(all_times));
+        print_percentile_stats(unit, stats);
+        std::cout << "  " << unit << "_per_sec=" << static_cast<double>(stats.count) / elapsed.count() << "\n";
+        return stats;
+    };
+
+    std::cout << "CONCURRENT_BENCH\n";
+    report_threads("reader", "routes", reader_results);
+    const auto update_stats = report_threads("writer", "updates", writer_results);
+
+    // Measured inside the engine, from the call to acquiring its update lock.
+    const auto lock_wait = engine.update_lock_wait_histogram();
+    const auto waited = lock_wait.total_count - (lock_wait.counts.empty() ? 0 : lock_wait.counts.front());
+    const auto total_wait_us = static_cast<double>(lock_wait.sum) / 1000.0;
+    const auto total_update_us = update_stats.mean * static_cast<double>(update_stats.count);
+    std::cout << "writer_lock_wait\n";
+    std::cout << "  calls=" << lock_wait.total_count << "\n";
+    std::cout << "  waited_over_1us=" << waited << "\n";
+    std::cout << "  total_ms=" << total_wait_us / 1000.0 << "\n";
+    std::cout << "  mean_us="
+              << (lock_wait.total_count > 0 ? total_wait_us / static_cast<double>(lock_wait.total_count) : 0.0)
+              << "\n";
+    // Bucket upper bounds: "at most" this long.
+    std::cout << "  p50_le_us=" << histogram_percentile_us(lock_wait, 0.50) << "\n";
+    std::cout << "  p99_le_us=" << histogram_percentile_us(lock_wait, 0.99) << "\n";
+    std::cout << "  p999_le_us=" << histogram_percentile_us(lock_wait, 0.999) << "\n";
+    std::cout << "  share_of_update_time=" << (total_update_us > 0.0 ? total_wait_us / total_update_us : 0.0)
+              << "\n\n";
+}
+
+// Producer threads issue the same random updates either directly through
+// GeoRouteEngine::apply_congestion_update or through the CongestionWriter
+// queue; reports producer-side call latency and end-to-end throughput.
+void run_writer_comparison(std::size_t grid_size,
+                           std::size_t producers,
+                           std::size_t updates,
+                           std::chrono::microseconds coalesce_window,
+                           const std::string& congestion_index,
+                           std::mt19937& rng) {
+    auto direct_context = build_bench_router(grid_size, congestion_index);
+    auto queued_context = build_bench_router(grid_size, congestion_index);
+    const auto edge_count = direct_context.edge_count;
+    std::cout << "Graph: " << direct_context.node_count << " nodes, " << edge_count << " edges\n";
+    std::cout << "Producers: " << producers << ", coalesce_window_us=" << coalesce_window.count() << "\n\n";
+    if (edge_count == 0 || producers == 0) {
+        return;
+    }
+
+    const std::size_t max_span = std::min<std::size_t>(750, edge_count - 1);
+    const std::size_t per_producer = updates / producers;
+    std::vector<std::vector<UpdateRange>> workloads(producers);
+    for (auto& workload : workloads) {
+        workload.reserve(per_producer);
+        for (std::size_t i = 0; i < per_producer; ++i) {
+            workload.push_back(random_update(rng, edge_count, max_span));
+        }
+    }
+
+    georoute::GeoRouteEngine direct{std::move(direct_context.router)};
+    georoute::GeoRouteEngine queued{std::move(queued_context.router)};
+
+    const auto run_producers = [&](auto&& submit, std::vector<double>& call_times) {
+        std::vector<std::vector<double>> per_thread(producers);
+        std::vector<std::thread> threads;
+        threads.reserve(producers);
+        for (std::size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                per_thread[p].reserve(per_producer);
+                for (const auto& update : workloads[p]) {
+                    const auto begin = std::chrono::high_resolution_clock::now();
+                    submit(update);
+                    const auto end = std::chrono::high_resolution_clock::now();
+                    per_thread[p].push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (const auto& times : per_thread) {
+            call_times.insert(call_times.end(), times.begin(), times.end());
+        }
+    };
+
+    std::vector<double> direct_times;
+    const auto direct_begin = std::chrono::steady_clock::now();
+    run_producers([&](const UpdateRange& update) { direct.apply_congestion_update(update.start, update.end, update.factor); },
+                  direct_times);
+    const std::chrono::duration<double> direct_elapsed = std::chrono::steady_clock::now() - direct_begin;
+
+    std::vector<double> queued_times;
+    georoute::CongestionWriterStats writer_stats;
+    std::chrono::duration<double> queued_elapsed{};
+    {
+        georoute::CongestionWriter writer{queued, georoute::CongestionWriterOptions{coalesce_window}};
+        const auto queued_begin = std::chrono::steady_clock::now();
+        run_producers(
+            [&](const UpdateRange& update) {
+                writer.enqueue(georoute::CongestionUpdate{update.start, update.end, update.factor});
+            },
+            queued_times);
+        writer.wait_for(per_producer * producers, std::chrono::minutes{5});
+        queued_elapsed = std::chrono::steady_clock::now() - queued_begin;
+        writer_stats = writer.stats();
+    }
+
+    const auto total = static_cast<double>(per_producer * producers);
+    std::cout << "WRITER_BENCH\n";
+    print_percentile_stats("direct_apply_call", PercentileStats::compute(direct_times));
+    std::cout << "  updates_per_sec=" << total / direct_elapsed.count() << "\n";
+    print_percentile_stats("queued_enqueue_call", PercentileStats::compute(queued_times));
+    std::cout << "  updates_per_sec=" << total / queued_elapsed.count() << "\n";
+    std::cout << "  writer_batches=" << writer_stats.batches << "\n";
+    std::cout << "  apply_lag_avg_us=" << writer_stats.mean_apply_lag_us << "\n";
+    std::cout << "  apply_lag_max_us=" << writer_stats.max_apply_lag_us << "\n\n";
+}
+
+// Applies updates through an engine with a CongestionJournal attached, then
+// compares restart-to-ready from the journal (snapshot load + one batch of
+// factor runs) against rebuilding the same state by replaying every update.
+void run_persistence_benchmark(std::size_t grid_size,
+                               std::size_t updates,
+                               const std::string& congestion_index,
+                               std::mt19937& rng) {
+    auto context = build_bench_router(grid_size, congestion_index);
+    const auto edge_count = context.edge_count;
+    std::cout << "Graph: " << context.node_count << " nodes, " << edge_count << " edges\n\n";
+    if (edge_count == 0) {
+        return;
+    }
+
+    const auto directory = (std::filesystem::temp_directory_path() /
+                            ("georoute_persistence_" + std::to_string(::getpid())))
+                               .string();
+    std::filesystem::remove_all(directory);
+
+    const std::size_t max_span = std::min<std::size_t>(750, edge_count - 1);
+    std::vector<georoute::CongestionUpdate> workload;
+    workload.reserve(updates);
+    for (std::size_t i = 0; i < updates; ++i) {
+        const auto update = random_update(rng, edge_count, max_span);
+        workload.push_back(georoute::CongestionUpdate{update.start, update.end, update.factor});
+    }
+
+    georoute::GeoRouteEngine engine{std::move(context.router)};
+    auto journal = std::make_unique<georoute::CongestionJournal>(
+        georoute::CongestionJournalOptions{directory, std::chrono::hours{1}, true},
+        georoute::CongestionJournal::recover(directory, edge_count));
+    engine.set_congestion_journal(journal.get());
+    const auto apply_begin = std::chrono::steady_clock::now();
+    for (const auto& update : workload) {
+        engine.apply_congestion_update(update.edge_start, update.edge_end, update.factor);
+    }
+    journal->flush();
+    const std::chrono::duration<double> apply_elapsed = std::chrono::steady_clock::now() - apply_begin;
+    engine.set_congestion_journal(nullptr);
+    const auto log_bytes = journal->stats().log_bytes;
+
+    // Shutdown writes the final snapshot and truncates the log.
+    const auto shutdown_begin = std::chrono::steady_clock::now();
+    journal.reset();
+    const std::chrono::duration<double, std::milli> snapshot_elapsed = std::chrono::steady_clock::now() - shutdown_begin;
+    const auto snapshot_bytes =
+        std::filesystem::file_size(std::filesystem::path{directory} / georoute::CongestionJournal::snapshot_file);
+
+    auto fresh_context = build_bench_router(grid_size, congestion_index);
+    georoute::GeoRouteEngine restored{std::move(fresh_context.router)};
+    const auto restore_begin = std::chrono::steady_clock::now();
+    const auto recovered = georoute::CongestionJournal::recover(directory, edge_count);
+    const auto runs = georoute::factor_runs(recovered.factors);
+    restored.apply_congestion_updates(runs);
+    const std::chrono::duration<double, std::milli> restore_elapsed = std::chrono::steady_clock::now() - restore_begin;
+
+    auto replay_context = build_bench_router(grid_size, congestion_index);
+    georoute::GeoRouteEngine replayed{std::move(replay_context.router)};
+    const auto replay_begin = std::chrono::steady_clock::now();
+    for (const auto& update : workload) {
+        replayed.apply_congestion_update(update.edge_start, update.edge_end, update.factor);
+    }
+    const std::chrono::duration<double, std::milli> replay_elapsed = std::chrono::steady_clock::now() - replay_begin;
+
+    std::cout << "PERSISTENCE_BENCH\n";
+    std::cout << "  updates=" << workload.size() << "\n";
+    std::cout << "  journaled_updates_per_sec=" << static_cast<double>(workload.size()) / apply_elapsed.count() << "\n";
+    std::cout << "  log_bytes_before_snapshot=" << log_bytes << "\n";
+    std::cout << "  snapshot_bytes=" << snapshot_bytes << "\n";
+    std::cout << "  snapshot_write_ms=" << snapshot_elapsed.count() << "\n";
+    std::cout << "  restore_runs=" << runs.size() << "\n";
+    std::cout << "  restore_to_ready_ms=" << restore_elapsed.count() << "\n";
+    std::cout << "  replay_to_ready_ms=" << replay_elapsed.count() << "\n\n";
+
+    std::filesystem::remove_all(directory);
+}
+
+// Per-query stats bookkeeping from concurrent threads: the former single
+// mutex-guarded EngineStats block vs. the sharded EngineStatsRecorder.
+void run_stats_benchmark(std::size_t threads, std::size_t records) {
+    std::cout << "Threads: " << threads << ", records per thread: " << records << "\n\n";
+    if (threads == 0) {
+        return;
+    }
+
+    const auto run_threads = [&](auto&& record) {
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        const auto begin = std::chrono::steady_clock::now();
+        for (std::size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                for (std::size_t i = 0; i < records; ++i) {
+                    record(static_cast<std::uint64_t>(1000 + (i * 37 + t) % 50000));
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - begin;
+        return elapsed.count() / static_cast<double>(threads * records);
+    };
+
+    georoute::EngineStats locked_stats;
+    std::mutex stats_mutex;
+    const auto mutex_ns = run_threads([&](std::uint64_t ns) {
+        std::lock_guard<std::mutex> lock{stats_mutex};
+        locked_stats.total_queries++;
+        locked_stats.total_compute_time_us += static_cast<double>(ns) / 1000.0;
+        locked_stats.max_compute_time_us = std::max(locked_stats.max_compute_time_us, static_cast<double>(ns) / 1000.0);
+    });
+
+    georoute::EngineStatsRecorder recorder;
+    const auto sharded_ns = run_threads([&](std::uint64_t ns) { recorder.record_route(ns, 100, 400); });
+
+    const auto read_begin = std::chrono::steady_clock::now();
+    const auto stats = recorder.aggregate();
+    const std::chrono::duration<double, std::micro> read_elapsed = std::chrono::steady_clock::now() - read_begin;
+
+    std::cout << "STATS_BENCH\n";
+    std::cout << "  mutex_ns_per_record=" << mutex_ns << "\n";
+    std::cout << "  sharded_ns_per_record=" << sharded_ns << "\n";
+    std::cout << "  aggregate_read_us=" << read_elapsed.count() << "\n";
+    std::cout << "  queries=" << stats.total_queries << "\n";
+    std::cout << "  p50_us=" << stats.p50_compute_time_us << "\n";
+    std::cout << "  p99_us=" << stats.p99_compute_time_us << "\n\n";
+}
+
+// Bursts of identical queries: in each burst every reader thread routes the
+// same random pair at once, as clients leaving one venue would. Runs the
+// bursts with route coalescing off, then on, and reports searches actually
+// run, process CPU time and per-query latency.
+void run_burst_benchmark(std::size_t grid_size,
+                         std::size_t bursts,
+                         std::size_t readers,
+                         const std::string& congestion_index,
+                         std::mt19937& rng) {
+    auto probe = build_bench_router(grid_size, congestion_index);
+    std::cout << "Graph: " << probe.node_count << " nodes, " << probe.edge_count << " edges\n";
+    std::cout << "Bursts: " << bursts << " x " << readers << " identical queries\n\n";
+    if (probe.node_count == 0 || readers == 0) {
+        return;
+    }
+
+    std::uniform_int_distribution<georoute::node_id> node_dist(0, static_cast<georoute::node_id>(probe.node_count - 1));
+    std::vector<georoute::RouteQuery> pairs(bursts);
+    for (auto& pair : pairs) {
+        pair = georoute::RouteQuery{node_dist(rng), node_dist(rng)};
+    }
+
+    std::cout << "BURST_BENCH\n";
+    for (const bool coalescing : {false, true}) {
+        auto context = build_bench_router(grid_size, congestion_index);
+        georoute::GeoRouteEngine engine{std::move(context.router)};
+        engine.set_route_coalescing(coalescing);
+        engine.reset_stats();
+
+        std::vector<std::vector<double>> latencies(readers);
+        std::barrier start_burst{static_cast<std::ptrdiff_t>(readers)};
+        const auto cpu_begin = std::clock();
+        const auto wall_begin = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < readers; ++t) {
+            threads.emplace_back([&, t] {
+                for (const auto& pair : pairs) {
+                    start_burst.arrive_and_wait();
+                    const auto begin = std::chrono::steady_clock::now();
+                    const auto response = engine.route(pair.source, pair.target);
+                    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - begin;
+                    latencies[t].push_back(elapsed.count());
+                    if (!response.result.reachable) {
+                        std::cerr << "unreachable pair in burst benchmark\n";
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        const std::chrono::duration<double, std::milli> wall = std::chrono::steady_clock::now() - wall_begin;
+        const auto cpu_ms = 1000.0 * static_cast<double>(std::clock() - cpu_begin) / CLOCKS_PER_SEC;
+
+        std::vector<double> all;
+        for (const auto& thread_latencies : latencies) {
+            all.insert(all.end(), thread_latencies.begin(), thread_latencies.end());
+        }
+        const auto latency = PercentileStats::compute(std::move(all));
+        const auto stats = engine.get_stats();
+        std::cout << (coalescing ? "coalescing_on" : "coalescing_off") << "\n";
+        std::cout << "  queries=" << latency.count << "\n";
+        std::cout << "  searches=" << stats.total_queries << "\n";
+        std::cout << "  coalesced=" << stats.total_coalesced_queries << "\n";
+        std::cout << "  cpu_ms=" << cpu_ms << "\n";
+        std::cout << "  wall_ms=" << wall.count() << "\n";
+        std::cout << "  p50_us=" << latency.p50 << "\n";
+        std::cout << "  p99_us=" << latency.p99 << "\n";
+        std::cout << "  max_us=" << latency.max << "\n";
+    }
+    std::cout << "\n";
+}
+
+// Routes the same random queries with blocking route() calls on the caller's
+// thread, then through route_batch on worker pools of 1..max_threads threads.
+void run_executor_scaling(std::size_t grid_size,
+                          std::size_t queries,
+                          std::size_t max_threads,
+                          const std::string& congestion_index,
+                          std::mt19937& rng) {
+    auto probe = build_bench_router(grid_size, congestion_index);
+    std::cout << "Graph: " << probe.node_count << " nodes, " << probe.edge_count << " edges\n";
+    std::cout << "Max threads: " << max_threads << "\n\n";
+    if (probe.node_count == 0 || max_threads == 0) {
+        return;
+    }
+
+    std::uniform_int_distribution<std::size_t> node_dist(0, probe.node_count - 1);
+    std::vector<georoute::RouteQuery> workload;
+    workload.reserve(queries);
+    for (std::size_t i = 0; i < queries; ++i) {
+        workload.push_back(georoute::RouteQuery{static_cast<georoute::node_id>(node_dist(rng)),
+                                                static_cast<georoute::node_id>(node_dist(rng))});
+    }
+
+    std::cout << "EXECUTOR_BENCH\n";
+    georoute::GeoRouteEngine caller{std::move(probe.router)};
+    const auto caller_begin = std::chrono::steady_clock::now();
+    for (const auto& query : workload) {
+        const auto response = caller.route(query.source, query.target);
+        (void)response;
+    }
+    const std::chrono::duration<double> caller_elapsed = std::chrono::steady_clock::now() - caller_begin;
+    const auto caller_qps = static_cast<double>(workload.size()) / caller_elapsed.count();
+    std::cout << "caller_thread\n";
+    std::cout << "  queries_per_sec=" << caller_qps << "\n";
+
+    for (std::size_t threads = 1; threads <= max_threads; ++threads) {
+        auto context = build_bench_router(grid_size, congestion_index);
+        georoute::GeoRouteEngine engine{std::move(context.router)};
+        engine.set_worker_threads(threads);
+        // Start the workers and size their scratch before timing.
+        const auto warmup = engine.route_batch(std::span{workload}.first(std::min(workload.size(), threads * 4)));
+        (void)warmup;
+
+        const auto begin = std::chrono::steady_clock::now();
+        const auto responses = engine.route_batch(workload);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        const auto qps = static_cast<double>(responses.size()) / elapsed.count();
+        std::cout << "batch_threads_" << threads << "\n";
+        std::cout << "  queries_per_sec=" << qps << "\n";
+        std::cout << "  speedup_vs_caller=" << qps / caller_qps << "\n";
+    }
+    std::cout << "\n";
+}
+
+// Same random queries without a budget, with a budget that never triggers
+// (cost of the checks alone), and with a settled-node cap of a quarter of the
+// graph (tail latency once far-apart pairs are cut off).
+void run_budget_benchmark(std::size_t grid_size,
+                          std::size_t queries,
+                          const std::string& congestion_index,
+                          std::mt19937& rng) {
+    auto context = build_bench_router(grid_size, congestion_index);
+    std::cout << "Graph: " << context.node_count << " nodes, " << context.edge_count << " edges\n\n";
+    if (context.node_count == 0) {
+        return;
+    }
+
+    std::uniform_int_distribution<std::size_t> node_dist(0, context.node_count - 1);
+    std::vector<georoute::RouteQuery> workload;
+    workload.reserve(queries);
+    for (std::size_t i = 0; i < queries; ++i) {
+        workload.push_back(georoute::RouteQuery{static_cast<georoute::node_id>(node_dist(rng)),
+                                                static_cast<georoute::node_id>(node_dist(rng))});
+    }
+
+    georoute::GeoRouteEngine engine{std::move(context.router)};
+    const auto run = [&](const std::string& label, const georoute::SearchBudget& budget) {
+        std::vector<double> times;
+        times.reserve(workload.size());
+        std::size_t cut = 0;
+        for (const auto& query : workload) {
+            const auto response = engine.route(query.source, query.target, budget);
+            times.push_back(response.compute_time_us);
+            cut += response.status != georoute::RouteStatus::complete ? 1 : 0;
+        }
+        print_percentile_stats(label, PercentileStats::compute(times));
+        std::cout << "  budget_exceeded=" << cut << "\n";
+    };
+
+    std::cout << "BUDGET_BENCH\n";
+    run("unlimited", georoute::SearchBudget{});
+    run("checks_only", georoute::SearchBudget::within(std::chrono::hours{1},
+                                                      static_cast<std::uint32_t>(context.node_count * 2)));
+    run("quarter_graph_cap", georoute::SearchBudget::within(std::chrono::milliseconds{0},
+                                                            static_cast<std::uint32_t>(context.node_count / 4)));
+    std::cout << "\n";
+}
+
+// Route latency on the caller thread while a GraphReloader keeps loading the
+// same graph from a JSON file and swapping it in (congestion carried over),
+// against the same queries with no reload running.
+void run_hot_swap_benchmark(std::size_t grid_size,
+                            std::size_t queries,
+                            std::size_t updates,
+                            const std::string& congestion_index,
+                            std::mt19937& rng) {
+    const auto graph = build_bench_graph(grid_size);
+    std::cout << "Graph: " << graph.node_count() << " nodes, " << graph.edge_count() << " edges\n\n";
+    if (graph.node_count() == 0 || graph.edge_count() == 0) {
+        return;
+    }
+
+    nlohmann::json config{{"nodes", graph.node_count()}, {"congestion_index", congestion_index}};
+    auto& edges = config["edges"] = nlohmann::json::array();
+    for (georoute::node_id u = 0; u < graph.node_count(); ++u) {
+        for (const auto& edge : graph.neighbors(u)) {
+            edges.push_back({{"from", u}, {"to", edge.to}, {"base_travel_time", edge.base_travel_time}});
+        }
+    }
+    const auto path = (std::filesystem::temp_directory_path() /
+                       ("georoute_hot_swap_" + std::to_string(::getpid()) + ".json"))
+                          .string();
+    std::ofstream{path} << config;
+
+    georoute::GeoRouteEngine engine{georoute::Router::from_json(config)};
+    const std::size_t max_span = std::min<std::size_t>(750, graph.edge_count() - 1);
+    for (std::size_t i = 0; i < updates; ++i) {
+        const auto update = random_update(rng, graph.edge_count(), max_span);
+        engine.apply_congestion_update(update.start, update.end, update.factor);
+    }
+
+    std::uniform_int_distribution<std::size_t> node_dist(0, graph.node_count() - 1);
+    std::vector<georoute::RouteQuery> workload;
+    workload.reserve(queries);
+    for (std::size_t i = 0; i < queries; ++i) {
+        workload.push_back(georoute::RouteQuery{static_cast<georoute::node_id>(node_dist(rng)),
+                                                static_cast<georoute::node_id>(node_dist(rng))});
+    }
+    const auto run_queries = [&] {
+        std::vector<double> times;
+        times.reserve(workload.size());
+        for (const auto& query : workload) {
+            const auto begin = std::chrono::steady_clock::now();
+            const auto response = engine.route(query.source, query.target);
+            const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - begin;
+            (void)response;
+            times.push_back(elapsed.count());
+        }
+        return PercentileStats::compute(std::move(times));
+    };
+
+    const auto idle = run_queries();
+
+    georoute::GraphReloader reloader{engine, path};
+    std::atomic<bool> stop{false};
+    std::vector<georoute::GraphReloadReport> reports;
+    std::thread reload_thread{[&] {
+        while (!stop.load()) {
+            if (auto report = reloader.reload()) {
+                reports.push_back(std::move(*report));
+            }
+        }
+    }};
+    const auto reloading = run_queries();
+    stop.store(true);
+    reload_thread.join();
+
+    double load_ms = 0.0;
+    double swap_us = 0.0;
+    double max_swap_us = 0.0;
+    double overlap_ms = 0.0;
+    std::size_t released = 0;
+    for (const auto& report : reports) {
+        load_ms += report.load_ms;
+        swap_us += report.swap.swap_time_us;
+        max_swap_us = std::max(max_swap_us, report.swap.swap_time_us);
+        if (report.overlap_ms) {
+            overlap_ms += *report.overlap_ms;
+            released++;
+        }
+    }
+    const auto reload_count = std::max<std::size_t>(1, reports.size());
+
+    std::cout << "HOT_SWAP_BENCH\n";
+    print_percentile_stats("idle", idle);
+    print_percentile_stats("during_reload", reloading);
+    std::cout << "  reloads=" << reports.size() << "\n";
+    std::cout << "  mean_load_ms=" << load_ms / static_cast<double>(reload_count) << "\n";
+    std::cout << "  mean_swap_us=" << swap_us / static_cast<double>(reload_count) << "\n";
+    std::cout << "  max_swap_us=" << max_swap_us << "\n";
+    std::cout << "  mean_overlap_ms=" << (released > 0 ? overlap_ms / static_cast<double>(released) : 0.0) << "\n";
+    if (!reports.empty()) {
+        std::cout << "  congestion_carried=" << (reports.back().swap.congestion_carried ? "yes" : "no") << "\n";
+        std::cout << "  router_bytes=" << reports.back().swap.next_memory_bytes << "\n";
+        std::cout << "  peak_overlap_bytes="
+                  << reports.back().swap.previous_memory_bytes + reports.back().swap.next_memory_bytes << "\n";
+    }
+    std::cout << "\n";
+
+    std::filesystem::remove(path);
+}
+
+// Heap allocations per route query along the request path: a fresh search
+// scratch per call (what GeoRouteEngine::route() did before it kept one per
+// thread), the per-thread scratch, and the per-thread scratch with the path in
+// a RequestArena; then a DOM parse of the request body against the SAX reader.
+void run_allocation_benchmark(std::size_t grid_size,
+                              std::size_t queries,
+                              const std::string& congestion_index,
+                              std::mt19937& rng) {
+    auto context = build_bench_router(grid_size, congestion_index);
+    std::cout << "Graph: " << context.node_count << " nodes, " << context.edge_count << " edges\n\n";
+    if (context.node_count == 0 || queries == 0) {
+        return;
+    }
+
+    std::uniform_int_distribution<std::size_t> node_dist(0, context.node_count - 1);
+    std::vector<georoute::RouteQuery> workload;
+    std::vector<std::string> bodies;
+    workload.reserve(queries);
+    bodies.reserve(queries);
+    for (std::size_t i = 0; i < queries; ++i) {
+        const auto source = static_cast<georoute::node_id>(node_dist(rng));
+        const auto target = static_cast<georoute::node_id>(node_dist(rng));
+        workload.push_back(georoute::RouteQuery{source, target});
+        bodies.push_back("{\"source\": " + std::to_string(source) + ", \"target\": " + std::to_string(target) +
+                         ", \"max_settled_nodes\": 100000000}");
+    }
+
+    auto fresh = build_bench_router(grid_size, congestion_index);
+    georoute::GeoRouteEngine engine{std::move(context.router)};
+
+    std::cout << "ALLOC_BENCH\n";
+    const auto measure = [&](const std::string& label, auto&& run_one) {
+        // One untimed pass sizes per-thread scratch and arena buffers.
+        for (std::size_t i = 0; i < std::min<std::size_t>(queries, 16); ++i) {
+            run_one(i);
+        }
+        const auto allocations_before = heap_allocations.load();
+        const auto bytes_before = heap_bytes.load();
+        const auto begin = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < queries; ++i) {
+            run_one(i);
+        }
+        const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - begin;
+        const auto count = static_cast<double>(queries);
+        std::cout << label << "\n";
+        std::cout << "  allocations_per_query=" << static_cast<double>(heap_allocations.load() - allocations_before) / count
+                  << "\n";
+        std::cout << "  bytes_per_query=" << static_cast<double>(heap_bytes.load() - bytes_before) / count << "\n";
+        std::cout << "  mean_us=" << elapsed.count() / count << "\n";
+    };
+
+    measure("fresh_scratch", [&](std::size_t i) {
+        const auto computation = fresh.router.compute_route(workload[i].source, workload[i].target);
+        (void)computation;
+    });
+    measure("thread_scratch", [&](std::size_t i) {
+        const auto response = engine.route(workload[i].source, workload[i].target);
+        (void)response;
+    });
+    measure("thread_scratch_arena", [&](std::size_t i) {
+        georoute::RequestArena::Scope arena{georoute::RequestArena::local()};
+        const auto response = engine.route(workload[i].source, workload[i].target, {}, arena.resource());
+        (void)response;
+    });
+    measure("json_dom_parse", [&](std::size_t i) {
+        const auto payload = nlohmann::json::parse(bodies[i]);
+        const auto source = payload.at("source").get<georoute::node_id>();
+        (void)source;
+    });
+    measure("sax_parse", [&](std::size_t i) {
+        const auto request = georoute::parse_route_request(bodies[i]);
+        (void)request;
+    });
+    std::cout << "  arena_capacity_bytes=" << georoute::RequestArena::local().capacity() << "\n";
+    std::cout << "  arena_overflow_allocations=" << georoute::RequestArena::local().overflow_allocations() << "\n\n";
+}
+
+// Serializing one route response: the nlohmann tree + dump() the HTTP handlers
+// used to build, against JsonWriter into a reused buffer followed by the copy
+// into the response body. Paths are synthetic node id sequences.
+void run_serialize_benchmark() {
+    std::cout << "SERIALIZE_BENCH\n";
+    for (const std::size_t length : {std::size_t{10}, std::size_t{100}, std::size_t{1000}, std::size_t{10000},
+                                     std::size_t{100000}}) {
+        georoute::RouteResponse response;
+        response.result.nodes.resize(length);
+        for (std::size_t i = 0; i < length; ++i) {
+            response.result.nodes[i] = static_cast<georoute::node_id>(i * 7919 % 1000003);
+        }
+        response.result.total_travel_time = 1234.5678F;
+        response.result.reachable = true;
+        response.compute_time_us = 812.25;
+        response.expanded_nodes = 20480;
+        response.congestion_epoch = 97;
+        const auto iterations = std::max<std::size_t>(20, 2'000'000 / length);
+
+        std::size_t sink = 0;
+        const auto measure = [&](const std::string& label, auto&& serialize) {
+            serialize();
+            const auto allocations_before = heap_allocations.load();
+            const auto bytes_before = heap_bytes.load();
+            const auto begin = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < iterations; ++i) {
+                sink += serialize().size();
+            }
+            const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - begin;
+            const auto count = static_cast<double>(iterations);
+            std::cout << label << "\n";
+            std::cout << "  path_length=" << length << "\n";
+            std::cout << "  body_bytes=" << serialize().size() << "\n";
+            std::cout << "  mean_us=" << elapsed.count() / count << "\n";
+            std::cout << "  allocations_per_response="
+                      << static_cast<double>(heap_allocations.load() - allocations_before) / count << "\n";
+            std::cout << "  bytes_per_response=" << static_cast<double>(heap_bytes.load() - bytes_before) / count
+                      << "\n";
+        };
+
+        measure("nlohmann_dump", [&] {
+            const nlohmann::json payload{
+                {"src", 0},
+                {"dst", 1},
+                {"distance", response.result.total_travel_time},
+                {"eta_ms", static_cast<int>(response.result.total_travel_time * 1000)},
+                {"path", response.result.nodes},
+                {"reachable", response.result.reachable},
+                {"epoch", response.congestion_epoch},
+                {"stats", {{"compute_us", response.compute_time_us}, {"expanded_nodes", response.expanded_nodes}}}};
+            return payload.dump();
+        });
+        std::string buffer;
+        measure("json_writer", [&] {
+            buffer.clear();
+            georoute::JsonWriter out{buffer};
+            out.begin_object();
+            georoute::write_route_fields(out, 0, 1, response);
+            out.end_object();
+            return std::string{buffer};
+        });
+        if (sink == 0) {
+            std::cout << "  (empty output)\n";
+        }
+    }
+    std::cout << "\n";
+}
+
+// Route response size and cost per path encoding. Paths are random
+// north/east walks on a 200-column grid with ~100 m spacing, so consecutive
+// ids differ by 1 or 200, as on a grid-like road graph numbered row by row.
+void run_path_encoding_benchmark(std::mt19937& rng) {
+    constexpr std::size_t columns = 200;
+    std::cout << "PATH_ENCODING_BENCH\n";
+    for (const std::size_t length : {std::size_t{10}, std::size_t{100}, std::size_t{1000}, std::size_t{2000},
+                                     std::size_t{10000}}) {
+        std::bernoulli_distribution step_east(0.5);
+        georoute::RouteResponse response;
+        std::size_t row = 0;
+        std::size_t column = 0;
+        for (std::size_t i = 0; i < length; ++i) {
+            response.result.nodes.push_back(static_cast<georoute::node_id>(row * columns + column));
+            if (column + 1 < columns && step_east(rng)) {
+                ++column;
+            } else {
+                ++row;
+            }
+        }
+        std::vector<georoute::Coordinate> coordinates((row + 1) * columns);
+        for (std::size_t node = 0; node < coordinates.size(); ++node) {
+            coordinates[node] = georoute::Coordinate{52.4 + static_cast<double>(node / columns) * 0.0009,
+                                                     13.2 + static_cast<double>(node % columns) * 0.0015};
+        }
+        response.coordinates = std::make_shared<const std::vector<georoute::Coordinate>>(std::move(coordinates));
+        response.result.total_travel_time = 1234.5678F;
+        response.result.reachable = true;
+        response.compute_time_us = 812.25;
+        response.expanded_nodes = 20480;
+        response.congestion_epoch = 97;
+        const auto iterations = std::max<std::size_t>(20, 2'000'000 / length);
+
+        std::string buffer;
+        std::size_t sink = 0;
+        for (const auto encoding : {georoute::PathEncoding::array, georoute::PathEncoding::varint,
+                                    georoute::PathEncoding::polyline}) {
+            const auto serialize = [&] {
+                buffer.clear();
+                georoute::JsonWriter out{buffer};
+                out.begin_object();
+                georoute::write_route_fields(out, 0, 1, response, true, encoding);
+                out.end_object();
+            };
+            // What a client does with the body: parse it and recover the path.
+            const auto parse = [&] {
+                const auto body = nlohmann::json::parse(buffer);
+                const auto& path = body.at("path");
+                switch (encoding) {
+                    case georoute::PathEncoding::array:
+                        return path.get<std::vector<georoute::node_id>>().size();
+                    case georoute::PathEncoding::varint:
+                        return georoute::decode_varint_path(path.get<std::string>()).size();
+                    case georoute::PathEncoding::polyline:
+                        return georoute::decode_polyline(path.get<std::string>()).size();
+                }
+                return std::size_t{0};
+            };
+
+            serialize();
+            const auto body_bytes = buffer.size();
+            auto begin = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < iterations; ++i) {
+                serialize();
+                sink += buffer.size();
+            }
+            const std::chrono::duration<double, std::micro> write_time = std::chrono::steady_clock::now() - begin;
+            begin = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < iterations; ++i) {
+                sink += parse();
+            }
+            const std::chrono::duration<double, std::micro> parse_time = std::chrono::steady_clock::now() - begin;
+
+            const auto count = static_cast<double>(iterations);
+            std::cout << georoute::path_encoding_name(encoding) << "\n";
+            std::cout << "  path_length=" << length << "\n";
+            std::cout << "  body_bytes=" << body_bytes << "\n";
+            std::cout << "  bytes_per_node=" << static_cast<double>(body_bytes) / static_cast<double>(length) << "\n";
+            std::cout << "  serialize_us=" << write_time.count() / count << "\n";
+            std::cout << "  client_parse_us=" << parse_time.count() / count << "\n";
+        }
+        if (sink == 0) {
+            std::cout << "  (empty output)\n";
+        }
+    }
+    std::cout << "\n";
+}
+
+// run_http_server on 127.0.0.1 in a background thread, for benchmarks that
+// go through the whole HTTP request path. Stops and joins when destroyed.
+class LocalHttpServer {
+public:
+    LocalHttpServer(georoute::GeoRouteEngine& engine, georoute::HttpServerOptions options)
+        : writer_{engine}, reloader_{engine, std::string{}} {
+        options.host = "127.0.0.1";
+        options.stop_token = stop_.get_token();
+        port_ = options.port;
+        thread_ = std::thread{[this, &engine, options] {
+            if (georoute::run_http_server(engine, writer_, reloader_, options) != 0) {
+                std::cerr << "LocalHttpServer failed to listen on port " << options.port << "\n";
+            }
+        }};
+        httplib::Client client{"127.0.0.1", port_};
+        for (int attempt = 0; attempt < 500 && !client.Get("/health"); ++attempt) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+    }
+    LocalHttpServer(const LocalHttpServer&) = delete;
+    LocalHttpServer& operator=(const LocalHttpServer&) = delete;
+    ~LocalHttpServer() {
+        stop_.request_stop();
+        thread_.join();
+    }
+
+    [[nodiscard]] std::uint16_t port() const noexcept { return port_; }
+
+private:
+    georoute::CongestionWriter writer_;
+    georoute::GraphReloader reloader_;
+    std::stop_source stop_;
+    std::uint16_t port_{0};
+    std::thread thread_;
+};
+
+// Routes per second through POST /api/v1/route (one pair per request) against
+// POST /api/v1/route/batch at several batch sizes. readers client threads
+// share the request list over keep-alive connections; latency is per request.
+void run_http_batch_benchmark(std::size_t grid_size,
+                              std::size_t queries,
+                              std::size_t batch_size,
+                              std::size_t readers,
+                              std::uint16_t port,
+                              const std::string& congestion_index,
+                              std::mt19937& rng) {
+    auto context = build_bench_router(grid_size, congestion_index);
+    std::cout << "Graph: " << context.node_count << " nodes, " << context.edge_count << " edges\n\n";
+    if (context.node_count == 0 || queries == 0) {
+        return;
+    }
+
+    std::uniform_int_distribution<std::size_t> node_dist(0, context.node_count - 1);
+    std::vector<georoute::RouteQuery> workload;
+    workload.reserve(queries);
+    for (std::size_t i = 0; i < queries; ++i) {
+        workload.push_back(georoute::RouteQuery{static_cast<georoute::node_id>(node_dist(rng)),
+                                                static_cast<georoute::node_id>(node_dist(rng))});
+    }
+
+    std::vector<std::size_t> batch_sizes{10, 100};
+    if (batch_size > 0 && std::find(batch_sizes.begin(), batch_sizes.end(), batch_size) == batch_sizes.end()) {
+        batch_sizes.push_back(batch_size);
+    }
+
+    georoute::GeoRouteEngine engine{std::move(context.router)};
+    georoute::HttpServerOptions options;
+    options.port = port;
+    options.max_route_batch_size = *std::max_element(batch_sizes.begin(), batch_sizes.end());
+    LocalHttpServer server{engine, options};
+    readers = std::max<std::size_t>(1, readers);
+
+    const auto run = [&](const std::string& label, const std::string& path, std::size_t per_request) {
+        std::vector<std::string> bodies;
+        for (std::size_t first = 0; first < workload.size(); first += per_request) {
+            const auto last = std::min(first + per_request, workload.size());
+            nlohmann::json body;
+            if (path == "/api/v1/route") {
+                body = {{"source", workload[first].source}, {"target", workload[first].target}};
+            } else {
+                auto& items = body["queries"] = nlohmann::json::array();
+                for (auto i = first; i < last; ++i) {
+                    items.push_back({{"source", workload[i].source}, {"target", workload[i].target}});
+                }
+            }
+            bodies.push_back(body.dump());
+        }
+
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> failures{0};
+        std::vector<std::vector<double>> latencies(readers);
+        const auto begin = std::chrono::steady_clock::now();
+        std::vector<std::thread> clients;
+        for (std::size_t c = 0; c < readers; ++c) {
+            clients.emplace_back([&, c] {
+                httplib::Client client{"127.0.0.1", server.port()};
+                client.set_keep_alive(true);
+                client.set_tcp_nodelay(true);
+                client.set_read_timeout(std::chrono::seconds{60});
+                for (auto i = next.fetch_add(1); i < bodies.size(); i = next.fetch_add(1)) {
+                    const auto sent = std::chrono::steady_clock::now();
+                    const auto result = client.Post(path, bodies[i], "application/json");
+                    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - sent;
+                    if (!result || result->status != 200) {
+                        failures.fetch_add(1);
+                    }
+                    latencies[c].push_back(elapsed.count());
+                }
+            });
+        }
+        for (auto& client : clients) {
+            client.join();
+        }
+        const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - begin;
+
+        std::vector<double> all;
+        for (auto& latency : latencies) {
+            all.insert(all.end(), latency.begin(), latency.end());
+        }
+        const auto stats = PercentileStats::compute(std::move(all));
+        std::cout << label << "\n";
+        std::cout << "  requests=" << bodies.size() << "\n";
+        std::cout << "  failed_requests=" << failures.load() << "\n";
+        std::cout << "  requests_per_sec=" << static_cast<double>(bodies.size()) / wall.count() << "\n";
+        std::cout << "  routes_per_sec=" << static_cast<double>(workload.size()) / wall.count() << "\n";
+        std::cout << "  request_p50_us=" << stats.p50 << "\n";
+        std::cout << "  request_p99_us=" << stats.p99 << "\n";
+    };
+
+    std::cout << "HTTP_BATCH_BENCH\n";
+    std::cout << "  clients=" << readers << "\n";
+    run("single", "/api/v1/route", 1);
+    for (const auto size : batch_sizes) {
+        run("batch_" + std::to_string(size), "/api/v1/route/batch", size);
+    }
+    std::cout << "\n";
+}
+
+// The same route workload over HTTP/JSON and over the binary protocol, one
+// pair per request and in batches of batch_size, plus a matrix request of
+// sqrt(batch_size) x sqrt(batch_size) cells. readers clients each hold one
+// keep-alive connection; latency is per request.
+void run_binary_benchmark(std::size_t grid_size,
+                          std::size_t queries,
+                          std::size_t batch_size,
+                          std::size_t readers,
+                          std::uint16_t port,
+                          const std::string& congestion_index,
+                          std::mt19937& rng) {
+    auto context = build_bench_router(grid_size, congestion_index);
+    std::cout << "Graph: " << context.node_count << " nodes, " << context.edge_count << " edges\n\n";
+    if (context.node_count == 0 || queries == 0) {
+        return;
+    }
+
+    std::uniform_int_distribution<std::size_t> node_dist(0, context.node_count - 1);
+    std::vector<georoute::RouteQuery> workload;
+    workload.reserve(queries);
+    for (std::size_t i = 0; i < queries; ++i) {
+        workload.push_back(georoute::RouteQuery{static_cast<georoute::node_id>(node_dist(rng)),
+                                                static_cast<georoute::node_id>(node_dist(rng))});
+    }
+    batch_size = std::clamp<std::size_t>(batch_size, 1, queries);
+    const auto side = std::max<std::size_t>(1, static_cast<std::size_t>(std::sqrt(static_cast<double>(batch_size))));
+
+    georoute::GeoRouteEngine engine{std::move(context.router)};
+    georoute::HttpServerOptions http_options;
+    http_options.port = port;
+    http_options.max_route_batch_size = batch_size;
+    LocalHttpServer http_server{engine, http_options};
+    georoute::CongestionWriter writer{engine};
+    georoute::BinaryServerOptions binary_options;
+    binary_options.host = "127.0.0.1";
+    binary_options.max_batch_size = batch_size;
+    georoute::BinaryProtocolServer binary_server{engine, writer, binary_options};
+    readers = std::max<std::size_t>(1, readers);
+
+    // send(client, first, last) issues one request covering workload[first, last).
+    const auto run = [&](const std::string& label, std::size_t per_request, auto make_client, auto send) {
+        const auto requests = (workload.size() + per_request - 1) / per_request;
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> failures{0};
+        std::vector<std::vector<double>> latencies(readers);
+        const auto begin = std::chrono::steady_clock::now();
+        std::vector<std::thread> clients;
+        for (std::size_t c = 0; c < readers; ++c) {
+            clients.emplace_back([&, c] {
+                auto client = make_client();
+                for (auto i = next.fetch_add(1); i < requests; i = next.fetch_add(1)) {
+                    const auto first = i * per_request;
+                    const auto sent = std::chrono::steady_clock::now();
+                    if (!send(*client, first, std::min(first + per_request, workload.size()))) {
+                        failures.fetch_add(1);
+                    }
+                    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - sent;
+                    latencies[c].push_back(elapsed.count());
+                }
+            });
+        }
+        for (auto& client : clients) {
+            client.join();
+        }
+        const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - begin;
+
+        std::vector<double> all;
+        for (auto& latency : latencies) {
+            all.insert(all.end(), latency.begin(), latency.end());
+        }
+        const auto stats = PercentileStats::compute(std::move(all));
+        std::cout << label << "\n";
+        std::cout << "  requests=" << requests << "\n";
+        std::cout << "  failed_requests=" << failures.load() << "\n";
+        std::cout << "  routes_per_sec=" << static_cast<double>(workload.size()) / wall.count() << "\n";
+        std::cout << "  request_p50_us=" << stats.p50 << "\n";
+        std::cout << "  request_p99_us=" << stats.p99 << "\n";
+    };
+
+    const auto http_client = [&] {
+        auto client = std::make_unique<httplib::Client>("127.0.0.1", http_server.port());
+        client->set_keep_alive(true);
+        client->set_tcp_nodelay(true);
+        client->set_read_timeout(std::chrono::seconds{60});
+        return client;
+    };
+    const auto binary_client = [&] {
+        return std::make_unique<georoute::BinaryClient>("127.0.0.1", binary_server.port());
+    };
+    const auto http_post = [](httplib::Client& client, const std::string& path, const nlohmann::json& body) {
+        const auto result = client.Post(path, body.dump(), "application/json");
+        return result && result->status == 200;
+    };
+
+    std::cout << "BINARY_PROTOCOL_BENCH\n";
+    std::cout << "  clients=" << readers << "\n";
+    std::cout << "  batch_size=" << batch_size << "\n";
+    run("http_single", 1, http_client, [&](httplib::Client& client, std::size_t first, std::size_t) {
+        return http_post(client, "/api/v1/route",
+                         {{"source", workload[first].source}, {"target", workload[first].target}});
+    });
+    run("binary_single", 1, binary_client, [&](georoute::BinaryClient& client, std::size_t first, std::size_t) {
+        return client.route(workload[first].source, workload[first].target).reachable;
+    });
+    run("http_batch", batch_size, http_client, [&](httplib::Client& client, std::size_t first, std::size_t last) {
+        nlohmann::json body;
+        auto& items = body["queries"] = nlohmann::json::array();
+        for (auto i = first; i < last; ++i) {
+            items.push_back({{"source", workload[i].source}, {"target", workload[i].target}});
+        }
+        return http_post(client, "/api/v1/route/batch", body);
+    });
+    run("binary_batch", batch_size, binary_client,
+        [&](georoute::BinaryClient& client, std::size_t first, std::size_t last) {
+            return client.route_batch(std::span{workload}.subspan(first, last - first)).size() == last - first;
+        });
+    // Sources and targets come from the workload, so every matrix is side x side.
+    run("binary_matrix", side * side, binary_client,
+        [&](georoute::BinaryClient& client, std::size_t first, std::size_t last) {
+            std::vector<georoute::node_id> sources;
+            std::vector<georoute::node_id> targets;
+            for (auto i = first; i < std::min(first + side, last); ++i) {
+                sources.push_back(workload[i].source);
+                targets.push_back(workload[i].target);
+            }
+            return client.matrix(sources, targets).travel_times.size() == sources.size() * targets.size();
+        });
+
+    const auto stats = binary_server.stats();
+    std::cout << "binary_server\n";
+    std::cout << "  requests=" << stats.requests << "\n";
+    std::cout << "  errors=" << stats.errors << "\n";
+    std::cout << "  bytes_in=" << stats.bytes_in << "\n";
+    std::cout << "  bytes_out=" << stats.bytes_out << "\n";
+    std::cout << "\n";
+}
+
+// Closed-loop clients (no think time) against a server with `workers`
+// connection workers, once with an unbounded connection queue and once with
+// a bounded one. Clients outnumber workers, so the server is saturated:
+// unbounded, every extra client waits behind keep-alive connections; bounded,
+// the overflow is answered 503 at once and the client reconnects.
+void run_overload_benchmark(std::size_t grid_size,
+                            std::size_t workers,
+                            std::size_t clients,
+                            std::size_t duration_ms,
+                            std::uint16_t port,
+                            const std::string& congestion_index,
+                            std::mt19937& rng) {
+    auto context = build_bench_router(grid_size, congestion_index);
+    std::cout << "Graph: " << context.node_count << " nodes, " << context.edge_count << " edges\n\n";
+    if (context.node_count == 0) {
+        return;
+    }
+    georoute::GeoRouteEngine engine{std::move(context.router)};
+    workers = std::max<std::size_t>(1, workers);
+    clients = std::max<std::size_t>(1, clients);
+    std::vector<std::string> targets;
+    std::uniform_int_distribution<std::size_t> node_dist(0, context.node_count - 1);
+    for (std::size_t i = 0; i < 4096; ++i) {
+        targets.push_back("/route?src=" + std::to_string(node_dist(rng)) + "&dst=" + std::to_string(node_dist(rng)));
+    }
+
+    const auto run = [&](const std::string& label, std::size_t max_queued, std::uint16_t run_port) {
+        georoute::HttpServerOptions options;
+        options.port = run_port;
+        options.worker_threads = workers;
+        options.max_queued_connections = max_queued;
+        LocalHttpServer server{engine, options};
+
+        std::atomic<bool> stop{false};
+        std::vector<std::vector<double>> ok_latencies(clients);
+        std::vector<std::vector<double>> rejected_latencies(clients);
+        std::atomic<std::size_t> failures{0};
+        std::vector<std::thread> threads;
+        const auto begin = std::chrono::steady_clock::now();
+        for (std::size_t c = 0; c < clients; ++c) {
+            threads.emplace_back([&, c] {
+                httplib::Client client{"127.0.0.1", server.port()};
+                client.set_keep_alive(true);
+                client.set_tcp_nodelay(true);
+                client.set_read_timeout(std::chrono::seconds{60});
+                for (std::size_t i = c; !stop.load(std::memory_order_relaxed); i += clients) {
+                    const auto sent = std::chrono::steady_clock::now();
+                    const auto result = client.Get(targets[i % targets.size()]);
+                    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - sent;
+                    if (result && result->status == 200) {
+                        ok_latencies[c].push_back(elapsed.count());
+                    } else if (result && result->status == 503) {
+                        rejected_latencies[c].push_back(elapsed.count());
+                    } else {
+                        failures.fetch_add(1);
+                    }
+                }
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{duration_ms});
+        stop.store(true);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - begin;
+
+        const auto collect = [](std::vector<std::vector<double>>& per_client) {
+            std::vector<double> all;
+            for (auto& latencies : per_client) {
+                all.insert(all.end(), latencies.begin(), latencies.end());
+            }
+            return all;
+        };
+        auto ok = collect(ok_latencies);
+        auto rejected = collect(rejected_latencies);
+        std::sort(ok.begin(), ok.end());
+        const auto ok_stats = PercentileStats::compute(ok);
+        const auto rejected_stats = PercentileStats::compute(std::move(rejected));
+        std::cout << label << "\n";
+        std::cout << "  max_queued_connections=" << max_queued << "\n";
+        std::cout << "  ok_per_sec=" << static_cast<double>(ok_stats.count) / wall.count() << "\n";
+        std::cout << "  rejected_per_sec=" << static_cast<double>(rejected_stats.count) / wall.count() << "\n";
+        std::cout << "  failed_requests=" << failures.load() << "\n";
+        std::cout << "  ok_p50_us=" << ok_stats.p50 << "\n";
+        std::cout << "  ok_p99_us=" << ok_stats.p99 << "\n";
+        std::cout << "  ok_p999_us=" << (ok.empty() ? 0.0 : percentile(ok, 0.999)) << "\n";
+        std::cout << "  ok_max_us=" << ok_stats.max << "\n";
+        std::cout << "  rejected_p50_us=" << rejected_stats.p50 << "\n";
+        std::cout << "  rejected_p99_us=" << rejected_stats.p99 << "\n";
+    };
+
+    std::cout << "HTTP_OVERLOAD_BENCH\n";
+    std::cout << "  workers=" << workers << "\n";
+    std::cout << "  clients=" << clients << "\n";
+    std::cout << "  duration_ms=" << duration_ms << "\n";
+    run("unbounded", 0, port);
+    run("bounded", workers, static_cast<std::uint16_t>(port + 1));
+    std::cout << "\n";
+}
+
 }  // namespace
 
+// Drops the file's pages from the page cache, so the next load reads it from
+// disk as a fresh Lambda execution environment would.
+void evict_from_page_cache(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    ::fdatasync(fd);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+}
+
+// Stand-in for the Lambda Runtime API on localhost. Hands out the queued
+// events in order and stamps when each is handed out and answered.
+class LocalRuntimeApi {
+public:
+    explicit LocalRuntimeApi(std::vector<std::string> events)
+        : events_(std::move(events)), handed_out_(events_.size()), answered_(events_.size()) {
+        server_.Get("/2018-06-01/runtime/invocation/next", [this](const httplib::Request&, httplib::Response& res) {
+            std::lock_guard lock{mutex_};
+            if (next_ == events_.size()) {
+                res.status = 500;
+                return;
+            }
+            handed_out_[next_] = std::chrono::steady_clock::now();
+            res.set_header("Lambda-Runtime-Aws-Request-Id", std::to_string(next_));
+            res.set_content(events_[next_++], "application/json");
+        });
+        server_.Post(R"(/2018-06-01/runtime/invocation/(\d+)/(response|error))",
+                     [this](const httplib::Request& req, httplib::Response& res) {
+                         std::lock_guard lock{mutex_};
+                         answered_[std::stoul(req.matches[1])] = std::chrono::steady_clock::now();
+                         errors_ += req.matches[2] == "error" ? 1 : 0;
+                         res.status = 202;
+                     });
+        server_.Post("/2018-06-01/runtime/init/error", [this](const httplib::Request&, httplib::Response& res) {
+            std::lock_guard lock{mutex_};
+            ++errors_;
+            res.status = 202;
+        });
+        // The Runtime API disables Nagle's algorithm, as Go servers do by default.
+        server_.set_tcp_nodelay(true);
+        port_ = server_.bind_to_any_port("127.0.0.1");
+        thread_ = std::thread{[this] { server_.listen_after_bind(); }};
+        server_.wait_until_ready();
+    }
+
+    LocalRuntimeApi(const LocalRuntimeApi&) = delete;
+    LocalRuntimeApi& operator=(const LocalRuntimeApi&) = delete;
+
+    ~LocalRuntimeApi() {
+        server_.stop();
+        thread_.join();
+    }
+
+    [[nodiscard]] std::string address() const { return "127.0.0.1:" + std::to_string(port_); }
+
+    // Valid once run_lambda has returned.
+    [[nodiscard]] const std::vector<std::chrono::steady_clock::time_point>& handed_out() const { return handed_out_; }
+    [[nodiscard]] const std::vector<std::chrono::steady_clock::time_point>& answered() const { return answered_; }
+    [[nodiscard]] std::size_t errors() const { return errors_; }
+
+private:
+    httplib::Server server_;
+    std::thread thread_;
+    int port_{0};
+    std::mutex mutex_;
+    std::vector<std::string> events_;
+    std::size_t next_{0};
+    std::vector<std::chrono::steady_clock::time_point> handed_out_;
+    std::vector<std::chrono::steady_clock::time_point> answered_;
+    std::size_t errors_{0};
+};
+
+// Cold start and warm invoke latency of the Lambda handler. Loads the same
+// graph from JSON and from a graph snapshot with the file evicted from the page
+// cache each time, then runs run_lambda against a local Runtime API for
+// `invocations` direct route events: init is start to the first /next call,
+// the first invoke pays the cold caches, the rest are warm.
+void run_lambda_benchmark(std::size_t grid_size,
+                          std::size_t invocations,
+                          const std::string& congestion_index,
+                          std::mt19937& rng) {
+    const auto graph = build_bench_graph(grid_size);
+    std::cout << "Graph: " << graph.node_count() << " nodes, " << graph.edge_count() << " edges\n\n";
+    if (graph.node_count() == 0 || invocations == 0) {
+        return;
+    }
+
+    nlohmann::json config{{"nodes", graph.node_count()}, {"congestion_index", congestion_index}};
+    auto& edges = config["edges"] = nlohmann::json::array();
+    for (georoute::node_id u = 0; u < graph.node_count(); ++u) {
+        for (const auto& edge : graph.neighbors(u)) {
+            edges.push_back({{"from", u}, {"to", edge.to}, {"base_travel_time", edge.base_travel_time}});
+        }
+    }
+    const auto base = std::filesystem::temp_directory_path() / ("georoute_lambda_" + std::to_string(::getpid()));
+    const auto json_path = base.string() + ".json";
+    const auto snapshot_path = base.string() + ".snapshot";
+    std::ofstream{json_path} << config;
+    georoute::write_graph_snapshot(graph, snapshot_path);
+
+    constexpr int load_runs = 5;
+    const auto median_load_ms = [](auto&& load, const std::string& path) {
+        std::vector<double> times;
+        for (int run = 0; run < load_runs; ++run) {
+            evict_from_page_cache(path);
+            const auto begin = std::chrono::steady_clock::now();
+            auto engine = load();
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+            times.push_back(elapsed.count());
+        }
+        std::sort(times.begin(), times.end());
+        return times[times.size() / 2];
+    };
+    const auto json_ms = median_load_ms(
+        [&] {
+            std::ifstream input{json_path};
+            nlohmann::json data;
+            input >> data;
+            return georoute::GeoRouteEngine::from_json(data);
+        },
+        json_path);
+    const auto snapshot_ms = median_load_ms(
+        [&] {
+            auto loaded = georoute::load_graph_snapshot(snapshot_path);
+            auto congestion = georoute::CongestionIndex::make(congestion_index, loaded.edge_count());
+            return georoute::GeoRouteEngine{georoute::Router{std::move(loaded), std::move(congestion)}};
+        },
+        snapshot_path);
+
+    std::uniform_int_distribution<std::size_t> node_dist(0, graph.node_count() - 1);
+    std::vector<std::string> events;
+    events.reserve(invocations);
+    for (std::size_t i = 0; i < invocations; ++i) {
+        events.push_back(nlohmann::json{{"source", node_dist(rng)}, {"target", node_dist(rng)}}.dump());
+    }
+    LocalRuntimeApi api{std::move(events)};
+    georoute::LambdaOptions options;
+    options.runtime_api = api.address();
+    options.graph_snapshot = snapshot_path;
+    options.congestion_index = congestion_index;
+    options.max_invocations = invocations;
+    evict_from_page_cache(snapshot_path);
+    const auto start = std::chrono::steady_clock::now();
+    const auto status = georoute::run_lambda(options);
+
+    const auto& handed_out = api.handed_out();
+    const auto& answered = api.answered();
+    const std::chrono::duration<double, std::milli> init = handed_out.front() - start;
+    const std::chrono::duration<double, std::milli> first_invoke = answered.front() - handed_out.front();
+    std::vector<double> warm;
+    for (std::size_t i = 1; i < answered.size(); ++i) {
+        warm.push_back(std::chrono::duration<double, std::micro>(answered[i] - handed_out[i]).count());
+    }
+
+    std::cout << "LAMBDA_BENCH\n";
+    std::cout << "graph_load\n";
+    std::cout << "  json_bytes=" << std::filesystem::file_size(json_path) << "\n";
+    std::cout << "  json_cold_load_ms=" << json_ms << "\n";
+    std::cout << "  snapshot_bytes=" << std::filesystem::file_size(snapshot_path) << "\n";
+    std::cout << "  snapshot_cold_load_ms=" << snapshot_ms << "\n";
+    std::cout << "runtime_loop\n";
+    std::cout << "  exit_status=" << status << "\n";
+    std::cout << "  errors=" << api.errors() << "\n";
+    std::cout << "  init_ms=" << init.count() << "\n";
+    std::cout << "  first_invoke_ms=" << first_invoke.count() << "\n";
+    print_percentile_stats("warm_invoke", PercentileStats::compute(std::move(warm)));
+    std::cout << "\n";
+
+    std::filesystem::remove(json_path);
+    std::filesystem::remove(snapshot_path);
+}
+
+// Starts a new peak-memory window: returns freed heap to the kernel, then
+// resets VmHWM to the current resident size. False where /proc/self/clear_refs
+// is not writable.
+bool reset_peak_memory() {
+    ::malloc_trim(0);
+    std::ofstream clear_refs{"/proc/self/clear_refs"};
+    clear_refs << "5";
+    clear_refs.close();
+    return static_cast<bool>(clear_refs);
+}
+
+// VmRSS or VmHWM from /proc/self/status, in MB.
+double process_memory_mb(const std::string& field) {
+    std::ifstream status{"/proc/self/status"};
+    for (std::string line; std::getline(status, line);) {
+        if (line.rfind(field + ":", 0) == 0) {
+            return std::stod(line.substr(field.size() + 1)) / 1024.0;
+        }
+    }
+    return 0.0;
+}
+
+// Streams graph as the JSON Router::from_json reads, without building a DOM.
+void write_graph_json(const georoute::Graph& graph, const std::string& path) {
+    std::ofstream output{path, std::ios::binary | std::ios::trunc};
+    std::string block = "{\"nodes\":" + std::to_string(graph.node_count()) + ",\"edges\":[";
+    const auto flush = [&] {
+        if (block.size() >= (1U << 20)) {
+            output << block;
+            block.clear();
+        }
+    };
+    // Edge id order, so the JSON graph gets the same edge ids as the others.
+    std::vector<std::pair<georoute::node_id, const georoute::Edge*>> by_id(graph.edge_count());
+    for (georoute::node_id u = 0; u < graph.node_count(); ++u) {
+        for (const auto& edge : graph.neighbors(u)) {
+            by_id[edge.id] = {u, &edge};
+        }
+    }
+    for (std::size_t i = 0; i < by_id.size(); ++i) {
+        const auto [from, edge] = by_id[i];
+        block += i == 0 ? "{\"from\":" : ",{\"from\":";
+        block += std::to_string(from) + ",\"to\":" + std::to_string(edge->to) + ",\"base_travel_time\":";
+        block += nlohmann::json(edge->base_travel_time).dump() + "}";
+        flush();
+    }
+    block += "]";
+    if (const auto& coordinates = graph.coordinates()) {
+        block += ",\"coordinates\":[";
+        for (std::size_t u = 0; u < coordinates->size(); ++u) {
+            block += u == 0 ? "[" : ",[";
+            block += nlohmann::json((*coordinates)[u].lat).dump() + "," + nlohmann::json((*coordinates)[u].lon).dump();
+            block += "]";
+            flush();
+        }
+        block += "]";
+    }
+    block += "}";
+    output << block;
+}
+
+// Writes the bench graph as JSON, as DIMACS .gr/.co and as a graph snapshot,
+// then loads each through Router::from_file from a cold page cache, as the
+// server and CLI do. Peak memory is the growth of the resident set during
+// the load. JSON is skipped above json_edge_limit edges: its DOM alone would
+// not fit in memory.
+void run_import_benchmark(std::size_t grid_size) {
+    constexpr std::size_t json_edge_limit = 10'000'000;
+    const auto base = std::filesystem::temp_directory_path() / ("georoute_import_" + std::to_string(::getpid()));
+    const auto json_path = base.string() + ".json";
+    const auto gr_path = base.string() + ".gr";
+    const auto co_path = base.string() + ".co";
+    const auto snapshot_path = base.string() + ".snapshot";
+
+    std::size_t edge_count = 0;
+    bool write_json = false;
+    {
+        const auto graph = build_bench_graph(grid_size);
+        edge_count = graph.edge_count();
+        std::cout << "Graph: " << graph.node_count() << " nodes, " << edge_count << " edges, "
+                  << (graph.coordinates() ? "with" : "without") << " coordinates\n\n";
+        if (edge_count == 0) {
+            return;
+        }
+        const auto begin = std::chrono::steady_clock::now();
+        georoute::write_dimacs(graph, gr_path, co_path);
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+        std::cout << "Wrote DIMACS in " << elapsed.count() << " ms\n";
+        georoute::write_graph_snapshot(graph, snapshot_path);
+        write_json = edge_count <= json_edge_limit;
+        if (write_json) {
+            write_graph_json(graph, json_path);
+        }
+    }
+    const bool peak_tracked = reset_peak_memory();
+    std::cout << "\nIMPORT_BENCH\n";
+
+    const auto file_mb = [](const std::string& path) {
+        std::error_code error;
+        const auto bytes = std::filesystem::file_size(path, error);
+        return error ? 0.0 : static_cast<double>(bytes) / (1024.0 * 1024.0);
+    };
+    const auto measure = [&](const std::string& label, const std::string& path) {
+        double megabytes = file_mb(path);
+        if (label == "dimacs") {
+            megabytes += file_mb(co_path);
+            evict_from_page_cache(co_path);
+        }
+        evict_from_page_cache(path);
+        reset_peak_memory();
+        const double resident_before = process_memory_mb("VmRSS");
+        const auto begin = std::chrono::steady_clock::now();
+        double graph_mb = 0.0;
+        double router_mb = 0.0;
+        {
+            const auto router = georoute::Router::from_file(path);
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+            graph_mb = static_cast<double>(router.graph().memory_bytes()) / (1024.0 * 1024.0);
+            router_mb = static_cast<double>(router.memory_bytes()) / (1024.0 * 1024.0);
+            const double seconds = elapsed.count() / 1000.0;
+            std::cout << label << "\n";
+            std::cout << "  file_mb=" << megabytes << "\n";
+            std::cout << "  load_ms=" << elapsed.count() << "\n";
+            std::cout << "  arcs_per_sec=" << static_cast<double>(edge_count) / seconds << "\n";
+            std::cout << "  mb_per_sec=" << megabytes / seconds << "\n";
+        }
+        std::cout << "  graph_mb=" << graph_mb << "\n";
+        std::cout << "  router_mb=" << router_mb << "\n";
+        if (peak_tracked) {
+            std::cout << "  peak_mb=" << process_memory_mb("VmHWM") - resident_before << "\n";
+        }
+    };
+    measure("dimacs", gr_path);
+    measure("snapshot", snapshot_path);
+    if (write_json) {
+        measure("json", json_path);
+    } else {
+        std::cout << "json\n  skipped: more than " << json_edge_limit << " edges\n";
+    }
+    std::cout << "\n";
+
+    for (const auto& path : {json_path, gr_path, co_path, snapshot_path}) {
+        std::filesystem::remove(path);
+    }
+}
+
 int main(int argc, char** argv) {
     std::string mode = "mixed";
     std::size_t queries = 10000;
     std::size_t updates = 1000;
     std::size_t seed = 0;
     std::size_t grid_size = 160;
+    std::string graph_type = "grid";
+    std::string congestion_index = "segment_tree";
+    std::size_t batch_size = 500;
+    std::uint16_t port = 18480;
+    std::size_t sparse_edges = 10000;
+    const std::size_t hardware_threads = std::thread::hardware_concurrency();
+    std::size_t readers = hardware_threads > 1 ? hardware_threads - 1 : 1;
+    std::size_t duration_ms = 2000;
+    std::size_t producers = 4;
+    std::size_t coalesce_window_us = 1000;
+    std::size_t writers = 2;
+    std::size_t update_rate = 1000;
 
     // Parse arguments
     for (int i = 1; i < argc; ++i) {
@@ -124,21 +2217,145 @@ int main(int argc, char** argv) {
             seed = static_cast<std::size_t>(std::stoul(argv[++i]));
         } else if (arg == "--grid-size" && i + 1 < argc) {
             grid_size = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--graph-type" && i + 1 < argc) {
+            graph_type = argv[++i];
+        } else if (arg == "--batch-size" && i + 1 < argc) {
+            batch_size = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--sparse-edges" && i + 1 < argc) {
+            sparse_edges = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--readers" && i + 1 < argc) {
+            readers = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--duration-ms" && i + 1 < argc) {
+            duration_ms = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--producers" && i + 1 < argc) {
+            producers = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--writers" && i + 1 < argc) {
+            writers = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--update-rate" && i + 1 < argc) {
+            update_rate = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--coalesce-window-us" && i + 1 < argc) {
+            coalesce_window_us = static_cast<std::size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--port" && i + 1 < argc) {
+            port = static_cast<std::uint16_t>(std::stoul(argv[++i]));
+        } else if (arg == "--congestion-index" && i + 1 < argc) {
+            congestion_index = argv[++i];
         }
     }
 
     std::mt19937 rng{seed == 0 ? std::random_device{}() : static_cast<std::mt19937::result_type>(seed)};
+    try {
+        bench_graph_type = georoute::parse_graph_type(graph_type);
+    } catch (const std::invalid_argument& ex) {
+        std::cerr << ex.what() << '\n';
+        return 1;
+    }
+    // Its own draw, so the query and update streams for a seed are the same
+    // on every graph type.
+    bench_graph_seed = seed == 0 ? std::random_device{}() : seed;
 
     std::cout << "GeoRoute Benchmark\n";
     std::cout << "==================\n";
     std::cout << "Mode: " << mode << "\n";
+    std::cout << "Graph type: " << georoute::graph_type_name(bench_graph_type) << "\n";
     std::cout << "Grid size: " << grid_size << "x" << grid_size << "\n";
     std::cout << "Queries: " << queries << "\n";
     std::cout << "Updates: " << updates << "\n";
+    std::cout << "Congestion index: " << congestion_index << "\n";
     std::cout << "Seed: " << (seed == 0 ? "random" : std::to_string(seed)) << "\n";
     std::cout << "\n";
 
-    auto context = build_grid_router(grid_size, grid_size);
+    if (mode == "cost-table") {
+        run_cost_table_comparison(grid_size, queries, updates, rng);
+        return 0;
+    }
+    if (mode == "batch") {
+        run_batch_comparison(grid_size, updates, batch_size, congestion_index, rng);
+        return 0;
+    }
+    if (mode == "sparse") {
+        run_sparse_comparison(grid_size, updates, sparse_edges, congestion_index, rng);
+        return 0;
+    }
+    if (mode == "contention") {
+        run_contention_benchmark(grid_size, readers, duration_ms, congestion_index, rng);
+        return 0;
+    }
+    if (mode == "concurrent") {
+        run_concurrent_benchmark(grid_size, readers, writers, update_rate, duration_ms, congestion_index, rng);
+        return 0;
+    }
+    if (mode == "writer") {
+        run_writer_comparison(grid_size, producers, updates,
+                              std::chrono::microseconds{static_cast<std::int64_t>(coalesce_window_us)},
+                              congestion_index, rng);
+        return 0;
+    }
+    if (mode == "budget") {
+        run_budget_benchmark(grid_size, queries, congestion_index, rng);
+        return 0;
+    }
+    if (mode == "executor") {
+        run_executor_scaling(grid_size, queries, readers, congestion_index, rng);
+        return 0;
+    }
+    if (mode == "stats") {
+        run_stats_benchmark(readers, queries * 100);
+        return 0;
+    }
+    if (mode == "http-batch") {
+        run_http_batch_benchmark(grid_size, queries, batch_size, readers, port, congestion_index, rng);
+        return 0;
+    }
+    if (mode == "overload") {
+        run_overload_benchmark(grid_size, readers, producers, duration_ms, port, congestion_index, rng);
+        return 0;
+    }
+    if (mode == "binary") {
+        run_binary_benchmark(grid_size, queries, batch_size, readers, port, congestion_index, rng);
+        return 0;
+    }
+    if (mode == "serialize") {
+        run_serialize_benchmark();
+        return 0;
+    }
+    if (mode == "burst") {
+        run_burst_benchmark(grid_size, queries, readers, congestion_index, rng);
+        return 0;
+    }
+    if (mode == "path-encoding") {
+        run_path_encoding_benchmark(rng);
+        return 0;
+    }
+    if (mode == "alloc") {
+        run_allocation_benchmark(grid_size, queries, congestion_index, rng);
+        return 0;
+    }
+    if (mode == "hot-swap") {
+        run_hot_swap_benchmark(grid_size, queries, updates, congestion_index, rng);
+        return 0;
+    }
+    if (mode == "persistence") {
+        run_persistence_benchmark(grid_size, updates, congestion_index, rng);
+        return 0;
+    }
+    if (mode == "lambda") {
+        run_lambda_benchmark(grid_size, queries, congestion_index, rng);
+        return 0;
+    }
+    if (mode == "import") {
+        run_import_benchmark(grid_size);
+        return 0;
+    }
+    if (mode == "graphs") {
+        run_graph_type_comparison(grid_size, queries, rng);
+        return 0;
+    }
+    if (mode == "congestion-index") {
+        run_congestion_index_comparison(grid_size, updates, rng);
+        return 0;
+    }
+
+    auto context = build_bench_router(grid_size, congestion_index);
     std::cout << "Graph: " << context.node_count << " nodes, " << context.edge_count << " edges\n\n";
 
     std::uniform_int_distribution<std::size_t> node_dist(0, context.node_count - 1);
@@ -181,7 +2398,7 @@ int main(int argc, char** argv) {
         const std::chrono::duration<double, std::micro> route_duration = route_end - route_begin;
         route_times.push_back(route_duration.count());
 
-        if (!result.reachable) {
+        if (!result.result.reachable) {
             ++unreachable_count;
         }
     }
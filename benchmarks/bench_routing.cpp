@@ -3,11 +3,13 @@
 #include <cmath>
 #include <iostream>
 #include <random>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "georoute/graph.hpp"
+#include "georoute/graph_generator.hpp"
 #include "georoute/router.hpp"
 #include "georoute/segment_tree.hpp"
 
@@ -19,35 +21,13 @@ struct BenchmarkContext {
     std::size_t edge_count;
 };
 
-BenchmarkContext build_grid_router(std::size_t rows, std::size_t cols) {
-    georoute::Graph graph{rows * cols};
-
-    const auto index = [cols](std::size_t r, std::size_t c) {
-        return static_cast<georoute::node_id>(r * cols + c);
-    };
-
-    for (std::size_t r = 0; r < rows; ++r) {
-        for (std::size_t c = 0; c < cols; ++c) {
-            const auto current = index(r, c);
-            if (c + 1 < cols) {
-                const auto right = index(r, c + 1);
-                const float base = 1.0F + static_cast<float>((r + c) % 7) * 0.1F;
-                graph.add_edge(current, right, base);
-                graph.add_edge(right, current, base);
-            }
-            if (r + 1 < rows) {
-                const auto down = index(r + 1, c);
-                const float base = 1.0F + static_cast<float>((r + c) % 5) * 0.15F;
-                graph.add_edge(current, down, base);
-                graph.add_edge(down, current, base);
-            }
-        }
-    }
-
+BenchmarkContext build_router(georoute::GraphType type, std::size_t size) {
+    auto graph = georoute::generate_graph(type, size, 1);
+    const auto node_count = graph.node_count();
     const auto edge_count = graph.edge_count();
     georoute::SegmentTree tree{edge_count};
 
-    return BenchmarkContext{georoute::Router{std::move(graph), std::move(tree)}, rows * cols, edge_count};
+    return BenchmarkContext{georoute::Router{std::move(graph), std::move(tree)}, node_count, edge_count};
 }
 
 struct Statistics {
@@ -71,13 +51,23 @@ struct Statistics {
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
     constexpr std::size_t rows = 160;
     constexpr std::size_t cols = 160;
     constexpr std::size_t total_queries = 200;
     constexpr std::size_t update_interval = 10;
 
-    auto context = build_grid_router(rows, cols);
+    // Optional: one of the graph types of georoute_bench_main --graph-type.
+    georoute::GraphType type = georoute::GraphType::grid;
+    if (argc > 1) {
+        try {
+            type = georoute::parse_graph_type(argv[1]);
+        } catch (const std::invalid_argument& ex) {
+            std::cerr << ex.what() << '\n';
+            return 1;
+        }
+    }
+    auto context = build_router(type, rows);
 
     std::mt19937 rng{std::random_device{}()};
     std::uniform_int_distribution<std::size_t> node_dist(0, context.node_count - 1);
@@ -120,14 +110,14 @@ int main() {
         const std::chrono::duration<double, std::micro> route_duration = route_end - route_begin;
         route_stats.add(route_duration.count());
 
-        if (!result.reachable) {
+        if (!result.result.reachable) {
             ++unreachable_count;
         }
     }
 
     std::cout << "GeoRoute Routing Benchmark\n";
-    std::cout << "Grid size: " << rows << " x " << cols << " (" << context.node_count << " nodes, "
-              << context.edge_count << " directed edges)\n";
+    std::cout << "Graph: " << georoute::graph_type_name(type) << ", " << rows << " x " << cols << " ("
+              << context.node_count << " nodes, " << context.edge_count << " directed edges)\n";
     std::cout << "Total queries: " << route_stats.count
               << ", average route time: " << route_stats.average() << " us, "
               << "max route time: " << route_stats.max_microseconds << " us\n";
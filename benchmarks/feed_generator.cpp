@@ -0,0 +1,227 @@
+// Local congestion feed generator: streams random update records into a
+// georoute_server --feed source and reports sustained updates/sec, both as
+// sent and as applied by the server (read from /metrics).
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+
+#include "georoute/congestion_feed.hpp"
+
+namespace {
+
+struct GeneratorOptions {
+    std::string target{};
+    georoute::FeedFormat format{georoute::FeedFormat::binary};
+    std::size_t records{1000000};
+    std::size_t edge_count{0};
+    std::size_t max_span{16};
+    std::size_t rate{0};
+    std::size_t seed{42};
+    std::string metrics_url{};
+};
+
+void print_usage(const char* binary) {
+    std::cout << "Usage: " << binary << " --target unix:<path>|tcp:[<host>:]<port>|file:<path> --edge-count <n>"
+              << " [--format ndjson|binary] [--records <n>] [--max-span <n>] [--rate <records/sec, 0 = max>]"
+              << " [--seed <n>] [--metrics-url http://127.0.0.1:8080]\n";
+}
+
+int open_target(const georoute::FeedSource& source) {
+    if (source.kind == georoute::FeedSource::Kind::file) {
+        return ::open(source.path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    }
+    if (source.kind == georoute::FeedSource::Kind::unix_socket) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, source.path.c_str(), sizeof(address.sun_path) - 1);
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(source.port);
+    ::inet_pton(AF_INET, source.path.c_str(), &address.sin_addr);
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd >= 0 && ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool write_all(int fd, const std::string& buffer) {
+    std::size_t written = 0;
+    while (written < buffer.size()) {
+        const auto count = ::write(fd, buffer.data() + written, buffer.size() - written);
+        if (count <= 0) {
+            return false;
+        }
+        written += static_cast<std::size_t>(count);
+    }
+    return true;
+}
+
+void append_record(std::string& buffer, georoute::FeedFormat format, std::uint32_t start, std::uint32_t end, float factor) {
+    if (format == georoute::FeedFormat::binary) {
+        char record[georoute::CongestionFeedParser::binary_record_size];
+        std::memcpy(record, &start, 4);
+        std::memcpy(record + 4, &end, 4);
+        std::memcpy(record + 8, &factor, 4);
+        buffer.append(record, sizeof(record));
+        return;
+    }
+    buffer += "{\"edge_start\":";
+    buffer += std::to_string(start);
+    buffer += ",\"edge_end\":";
+    buffer += std::to_string(end);
+    buffer += ",\"factor\":";
+    buffer += std::to_string(factor);
+    buffer += "}\n";
+}
+
+std::optional<std::uint64_t> applied_updates(const std::string& metrics_url) {
+    httplib::Client client{metrics_url};
+    const auto response = client.Get("/metrics");
+    if (!response || response->status != 200) {
+        return std::nullopt;
+    }
+    const auto metrics = nlohmann::json::parse(response->body, nullptr, false);
+    if (metrics.is_discarded() || !metrics.contains("congestion_writer")) {
+        return std::nullopt;
+    }
+    return metrics.at("congestion_writer").at("coalesced_updates_total").get<std::uint64_t>();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    GeneratorOptions options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg{argv[i]};
+            if (arg == "--target" && i + 1 < argc) {
+                options.target = argv[++i];
+            } else if (arg == "--format" && i + 1 < argc) {
+                options.format = georoute::parse_feed_format(argv[++i]);
+            } else if (arg == "--records" && i + 1 < argc) {
+                options.records = static_cast<std::size_t>(std::stoul(argv[++i]));
+            } else if (arg == "--edge-count" && i + 1 < argc) {
+                options.edge_count = static_cast<std::size_t>(std::stoul(argv[++i]));
+            } else if (arg == "--max-span" && i + 1 < argc) {
+                options.max_span = static_cast<std::size_t>(std::stoul(argv[++i]));
+            } else if (arg == "--rate" && i + 1 < argc) {
+                options.rate = static_cast<std::size_t>(std::stoul(argv[++i]));
+            } else if (arg == "--seed" && i + 1 < argc) {
+                options.seed = static_cast<std::size_t>(std::stoul(argv[++i]));
+            } else if (arg == "--metrics-url" && i + 1 < argc) {
+                options.metrics_url = argv[++i];
+            } else {
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << '\n';
+        return 1;
+    }
+    if (options.target.empty() || options.edge_count == 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const auto source = georoute::FeedSource::parse(options.target, options.format);
+    const int fd = open_target(source);
+    if (fd < 0) {
+        std::cerr << "Failed to open feed target " << options.target << ": " << std::strerror(errno) << '\n';
+        return 1;
+    }
+
+    std::optional<std::uint64_t> applied_before;
+    if (!options.metrics_url.empty()) {
+        applied_before = applied_updates(options.metrics_url);
+    }
+
+    std::mt19937 rng{static_cast<std::mt19937::result_type>(options.seed)};
+    std::uniform_int_distribution<std::uint32_t> edge_dist(0, static_cast<std::uint32_t>(options.edge_count - 1));
+    std::uniform_int_distribution<std::uint32_t> span_dist(0, static_cast<std::uint32_t>(options.max_span));
+    std::uniform_real_distribution<float> factor_dist(0.8F, 1.25F);
+
+    // Records are sent in chunks of up to ~64 KB; with --rate each chunk is
+    // paced to its share of the second.
+    const std::size_t chunk_records = options.format == georoute::FeedFormat::binary ? 5000 : 1000;
+    std::string buffer;
+    std::size_t sent = 0;
+    std::uint64_t bytes = 0;
+    const auto start = std::chrono::steady_clock::now();
+    while (sent < options.records) {
+        buffer.clear();
+        const auto count = std::min(chunk_records, options.records - sent);
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto edge_start = edge_dist(rng);
+            const auto edge_end = std::min<std::uint32_t>(edge_start + span_dist(rng),
+                                                          static_cast<std::uint32_t>(options.edge_count - 1));
+            append_record(buffer, options.format, edge_start, edge_end, factor_dist(rng));
+        }
+        if (!write_all(fd, buffer)) {
+            std::cerr << "Feed target closed after " << sent << " records\n";
+            break;
+        }
+        sent += count;
+        bytes += buffer.size();
+        if (options.rate > 0) {
+            std::this_thread::sleep_until(start + std::chrono::microseconds{sent * 1000000 / options.rate});
+        }
+    }
+    const std::chrono::duration<double> send_elapsed = std::chrono::steady_clock::now() - start;
+    ::close(fd);
+
+    std::cout << "FEED_GEN\n";
+    std::cout << "  target=" << options.target << "\n";
+    std::cout << "  records_sent=" << sent << "\n";
+    std::cout << "  bytes_per_record=" << (sent > 0 ? static_cast<double>(bytes) / static_cast<double>(sent) : 0.0)
+              << "\n";
+    std::cout << "  send_records_per_sec=" << static_cast<double>(sent) / send_elapsed.count() << "\n";
+
+    if (applied_before) {
+        // Wait until the server reports every record applied (or stops making progress).
+        std::uint64_t applied = 0;
+        auto last_progress = std::chrono::steady_clock::now();
+        while (applied < sent) {
+            const auto current = applied_updates(options.metrics_url);
+            if (current && *current - *applied_before > applied) {
+                applied = *current - *applied_before;
+                last_progress = std::chrono::steady_clock::now();
+            } else if (std::chrono::steady_clock::now() - last_progress > std::chrono::seconds{5}) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+        const std::chrono::duration<double> applied_elapsed = last_progress - start;
+        std::cout << "  records_applied=" << applied << "\n";
+        std::cout << "  applied_updates_per_sec=" << static_cast<double>(applied) / applied_elapsed.count() << "\n";
+    }
+    return 0;
+}
@@ -41,7 +41,7 @@ echo "2. Applying Congestion Update"
 echo "-----------------------------------"
 UPDATE_RESPONSE=$(curl -s -X POST "${BASE_URL}/api/v1/congestion/update" \
     -H "Content-Type: application/json" \
-    -d '{"edge_start": 0, "edge_end": 1, "factor": 2.5}')
+    -d '{"edge_start": 0, "edge_end": 1, "factor": 2.5, "wait": true}')
 echo "$UPDATE_RESPONSE" | python3 -m json.tool 2>/dev/null || echo "$UPDATE_RESPONSE"
 echo "Applied congestion factor 2.5 to edges [0, 1]"
 echo ""
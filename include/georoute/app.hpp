@@ -1,17 +1,49 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace georoute {
 
+class BinaryProtocolServer;
+class CongestionFeed;
+class CongestionJournal;
+class CongestionWriter;
 class GeoRouteEngine;
+class GraphReloader;
 
 struct AppConfig {
     std::string graph_path{};
     std::string host{"0.0.0.0"};
     std::uint16_t port{8080};
+    std::chrono::microseconds congestion_coalesce_window{1000};
+    // Streaming congestion sources, e.g. "unix:/run/georoute/feed.sock" (see FeedSource::parse).
+    std::vector<std::string> congestion_feeds{};
+    std::string congestion_feed_format{"ndjson"};
+    // Directory for congestion snapshots and the update log; empty disables persistence.
+    std::string state_dir{};
+    std::chrono::seconds snapshot_interval{60};
+    // Default route search budget (0 = unlimited); see HttpServerOptions.
+    std::chrono::milliseconds route_timeout{0};
+    std::uint32_t max_settled_nodes{0};
+    // Largest number of pairs accepted by POST /api/v1/route/batch.
+    std::size_t max_route_batch_size{1000};
+    // HTTP connection handling; see HttpServerOptions.
+    std::size_t http_worker_threads{0};
+    std::size_t http_max_queued_connections{64};
+    std::size_t keep_alive_max_count{100};
+    std::chrono::seconds keep_alive_timeout{5};
+    std::chrono::milliseconds read_timeout{5000};
+    std::chrono::milliseconds write_timeout{5000};
+    // Port for the binary protocol next to HTTP; 0 disables it.
+    std::uint16_t binary_port{0};
+    // Share one search among concurrent identical route queries.
+    bool route_coalescing{true};
 };
 
 class GeoRouteApp {
@@ -29,8 +61,18 @@ public:
     void shutdown();
 
 private:
+    void restore_congestion_state();
+    // Reloads the graph file on every SIGHUP.
+    void watch_reload_signal(std::stop_token stop);
+
     AppConfig config_;
     std::unique_ptr<GeoRouteEngine> engine_;
+    std::unique_ptr<CongestionJournal> journal_;
+    std::unique_ptr<CongestionWriter> writer_;
+    std::vector<std::unique_ptr<CongestionFeed>> feeds_;
+    std::unique_ptr<GraphReloader> reloader_;
+    std::unique_ptr<BinaryProtocolServer> binary_server_;
+    std::jthread signal_thread_;
     bool initialized_{false};
 };
 
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "georoute/binary_protocol.hpp"
+#include "georoute/engine.hpp"
+
+namespace georoute {
+
+struct WireRouteOptions {
+    bool include_path{true};
+    // 0 keeps the server default.
+    std::uint32_t timeout_ms{0};
+    std::uint32_t max_settled_nodes{0};
+};
+
+struct WireMatrix {
+    std::size_t source_count{0};
+    std::size_t target_count{0};
+    // Row-major travel times; +inf when unreachable, NaN when cut off by the budget.
+    std::vector<float> travel_times{};
+
+    [[nodiscard]] float at(std::size_t source_index, std::size_t target_index) const {
+        return travel_times[source_index * target_count + target_index];
+    }
+};
+
+struct WireCongestionResult {
+    std::uint64_t sequence{0};
+    bool visible{false};
+};
+
+// Blocking client for BinaryProtocolServer over one TCP connection. Not
+// thread-safe: use one client per thread. Requests answered with bad_request
+// or too_large throw std::invalid_argument with the server's message; other
+// failures throw std::runtime_error.
+class BinaryClient {
+public:
+    BinaryClient(const std::string& host, std::uint16_t port);
+    BinaryClient(const BinaryClient&) = delete;
+    BinaryClient& operator=(const BinaryClient&) = delete;
+    ~BinaryClient();
+
+    WireRoute route(node_id source, node_id target, const WireRouteOptions& options = {});
+    std::vector<WireRoute> route_batch(std::span<const RouteQuery> queries, const WireRouteOptions& options = {});
+    WireMatrix matrix(std::span<const node_id> sources,
+                      std::span<const node_id> targets,
+                      const WireRouteOptions& options = {});
+    WireCongestionResult update_congestion(std::span<const CongestionUpdate> updates, bool wait = false);
+
+private:
+    // Sends the frame in send_buffer_ and returns the payload of the response.
+    std::span<const std::byte> exchange(WireType type, const char* caller);
+
+    int fd_{-1};
+    std::uint32_t next_request_id_{1};
+    std::vector<std::byte> send_buffer_{};
+    std::vector<std::byte> receive_buffer_{};
+};
+
+}  // namespace georoute
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "georoute/types.hpp"
+
+namespace georoute {
+
+// Length-prefixed binary protocol for service-to-service traffic, served by
+// BinaryProtocolServer next to the HTTP API. All integers and floats are
+// little-endian, like the binary congestion feed.
+//
+// Every frame starts with a 12-byte header:
+//   u32 length      bytes after this field (8 + payload size)
+//   u8  type        WireType; a response echoes its request's type
+//   u8  flags       request: wire_flag_* bits; response: WireStatus
+//   u16 reserved    0
+//   u32 request_id  echoed in the response, so clients can pipeline
+//
+// Request payloads:
+//   route              u32 source, u32 target, u32 timeout_ms, u32 max_settled_nodes
+//   route_batch        u32 timeout_ms, u32 max_settled_nodes, u32 count, count x {u32 source, u32 target}
+//   matrix             u32 timeout_ms, u32 max_settled_nodes, u32 source_count, u32 target_count,
+//                      source_count x u32 source, target_count x u32 target
+//   congestion_update  u32 count, count x {u32 edge_start, u32 edge_end, f32 factor}
+// A limit of 0 keeps the server default; others only tighten it.
+//
+// Response payloads when the status is ok (any other status carries a UTF-8
+// error message as its payload):
+//   route              route record
+//   route_batch        u32 count, count route records in request order
+//   matrix             u32 source_count, u32 target_count, f32 travel time per
+//                      (source, target), row-major; +inf when unreachable, NaN
+//                      when the search budget ran out
+//   congestion_update  u64 sequence, u8 visible, 3 bytes padding
+// Route record: u8 RouteStatus, u8 reachable, u16 reserved, f32 travel time,
+// u32 expanded nodes, u32 path length, u64 congestion epoch, path length x u32
+// node (empty unless wire_flag_include_path was set and the route exists).
+static_assert(std::endian::native == std::endian::little, "the wire protocol is read and written in place");
+
+enum class WireType : std::uint8_t {
+    route = 1,
+    route_batch = 2,
+    matrix = 3,
+    congestion_update = 4,
+};
+
+enum class WireStatus : std::uint8_t {
+    ok = 0,
+    bad_request = 1,
+    too_large = 2,
+    server_error = 3,
+};
+
+// route, route_batch: include the node path in each route record.
+inline constexpr std::uint8_t wire_flag_include_path = 1;
+// congestion_update: respond once the updates are visible to queries.
+inline constexpr std::uint8_t wire_flag_wait = 2;
+
+inline constexpr std::size_t wire_header_size = 12;
+inline constexpr std::size_t wire_route_record_size = 24;
+// Frames above this are refused before they are buffered.
+inline constexpr std::size_t wire_max_frame_size = 16 * 1024 * 1024;
+
+struct WireHeader {
+    std::uint32_t length{0};
+    WireType type{WireType::route};
+    std::uint8_t flags{0};
+    std::uint32_t request_id{0};
+
+    [[nodiscard]] std::size_t frame_size() const noexcept { return sizeof(length) + length; }
+    [[nodiscard]] std::size_t payload_size() const noexcept { return length - (wire_header_size - sizeof(length)); }
+};
+
+// Bounds-checked little-endian reads straight out of a receive buffer. Reads
+// past the end throw std::invalid_argument.
+class WireReader {
+public:
+    explicit WireReader(std::span<const std::byte> bytes) noexcept : bytes_(bytes) {}
+
+    template <typename T>
+    T read() {
+        T value;
+        std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    // A view of the next size bytes; nothing is copied.
+    std::span<const std::byte> take(std::size_t size) {
+        if (size > bytes_.size() - offset_) {
+            throw std::invalid_argument{"WireReader::take payload truncated"};
+        }
+        const auto view = bytes_.subspan(offset_, size);
+        offset_ += size;
+        return view;
+    }
+
+    [[nodiscard]] std::size_t remaining() const noexcept { return bytes_.size() - offset_; }
+
+private:
+    std::span<const std::byte> bytes_;
+    std::size_t offset_{0};
+};
+
+// Appends little-endian fields to a send buffer.
+class WireWriter {
+public:
+    explicit WireWriter(std::vector<std::byte>& out) noexcept : out_(out) {}
+
+    template <typename T>
+    void write(T value) {
+        const auto offset = out_.size();
+        out_.resize(offset + sizeof(T));
+        std::memcpy(out_.data() + offset, &value, sizeof(T));
+    }
+
+    void write_bytes(std::span<const std::byte> bytes) { out_.insert(out_.end(), bytes.begin(), bytes.end()); }
+
+    // Writes a header with a placeholder length; end_frame() fills it in.
+    std::size_t begin_frame(WireType type, std::uint8_t flags, std::uint32_t request_id);
+    void end_frame(std::size_t frame_start);
+
+private:
+    std::vector<std::byte>& out_;
+};
+
+// Header of the frame at the front of bytes, once all 12 header bytes are
+// there. Throws std::invalid_argument if the length is impossible or above
+// wire_max_frame_size.
+[[nodiscard]] WireHeader decode_wire_header(std::span<const std::byte> bytes);
+
+// Request payload views. Pair, node and update arrays are read in place from
+// the frame; they stay valid as long as the receive buffer does.
+struct WireLimits {
+    std::uint32_t timeout_ms{0};
+    std::uint32_t max_settled_nodes{0};
+};
+
+struct WireRouteRequest {
+    node_id source{0};
+    node_id target{0};
+    WireLimits limits{};
+};
+
+class WireArray {
+public:
+    WireArray() = default;
+    WireArray(std::span<const std::byte> bytes, std::size_t stride) noexcept : bytes_(bytes), stride_(stride) {}
+
+    [[nodiscard]] std::size_t size() const noexcept { return stride_ == 0 ? 0 : bytes_.size() / stride_; }
+    // Field field_index (u32 / f32 slots) of element index.
+    template <typename T>
+    [[nodiscard]] T get(std::size_t index, std::size_t field_index = 0) const noexcept {
+        T value;
+        std::memcpy(&value, bytes_.data() + index * stride_ + field_index * 4, sizeof(T));
+        return value;
+    }
+
+private:
+    std::span<const std::byte> bytes_{};
+    std::size_t stride_{0};
+};
+
+struct WireBatchRequest {
+    WireLimits limits{};
+    WireArray pairs{};
+};
+
+struct WireMatrixRequest {
+    WireLimits limits{};
+    WireArray sources{};
+    WireArray targets{};
+};
+
+// Throw std::invalid_argument on a truncated payload or trailing bytes.
+[[nodiscard]] WireRouteRequest decode_route_request(std::span<const std::byte> payload);
+[[nodiscard]] WireBatchRequest decode_batch_request(std::span<const std::byte> payload);
+[[nodiscard]] WireMatrixRequest decode_matrix_request(std::span<const std::byte> payload);
+// Range checks are left to the congestion writer.
+[[nodiscard]] WireArray decode_congestion_request(std::span<const std::byte> payload);
+
+// Route record for one search; the path is written only if include_path.
+void write_route_record(WireWriter& out,
+                        RouteStatus status,
+                        const RouteResult& result,
+                        std::uint64_t expanded_nodes,
+                        std::uint64_t congestion_epoch,
+                        bool include_path);
+
+// A decoded route record (client side).
+struct WireRoute {
+    RouteStatus status{RouteStatus::complete};
+    bool reachable{false};
+    float travel_time{0.0F};
+    std::uint32_t expanded_nodes{0};
+    std::uint64_t congestion_epoch{0};
+    std::vector<node_id> path{};
+};
+
+[[nodiscard]] WireRoute read_route_record(WireReader& in);
+
+}  // namespace georoute
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "georoute/binary_protocol.hpp"
+#include "georoute/connection_threads.hpp"
+
+namespace georoute {
+
+class CongestionWriter;
+class GeoRouteEngine;
+
+struct BinaryServerOptions {
+    std::string host{"0.0.0.0"};
+    // 0 picks a free port; see BinaryProtocolServer::port().
+    std::uint16_t port{0};
+    // Default search budget, tightened by per-request limits (see HttpServerOptions).
+    std::chrono::milliseconds route_timeout{0};
+    std::uint32_t max_settled_nodes{0};
+    // Largest route_batch pair count and matrix cell count.
+    std::size_t max_batch_size{1000};
+};
+
+struct BinaryServerStats {
+    std::uint64_t connections{0};
+    // Connections currently open.
+    std::uint64_t open_connections{0};
+    std::uint64_t requests{0};
+    std::uint64_t errors{0};
+    std::uint64_t bytes_in{0};
+    std::uint64_t bytes_out{0};
+};
+
+// Serves the binary protocol (binary_protocol.hpp) on a TCP port. One thread
+// per connection reads frames into a buffer that grows to the largest frame
+// seen, decodes each request in place, and writes all responses for one read
+// back in one send, so pipelined requests share syscalls. Routes run on the
+// connection thread; batches and matrices go to the engine's worker pool.
+class BinaryProtocolServer {
+public:
+    // Binds and listens before returning; throws std::runtime_error on failure.
+    BinaryProtocolServer(GeoRouteEngine& engine, CongestionWriter& writer, BinaryServerOptions options);
+    BinaryProtocolServer(const BinaryProtocolServer&) = delete;
+    BinaryProtocolServer& operator=(const BinaryProtocolServer&) = delete;
+    BinaryProtocolServer(BinaryProtocolServer&&) = delete;
+    BinaryProtocolServer& operator=(BinaryProtocolServer&&) = delete;
+    // Stops accepting, lets every connection finish its current read, joins.
+    ~BinaryProtocolServer();
+
+    [[nodiscard]] std::uint16_t port() const noexcept;
+    [[nodiscard]] BinaryServerStats stats() const noexcept;
+
+private:
+    void run_listener();
+    void serve(int fd);
+    // Handles one complete frame and appends its response to out.
+    void handle(const WireHeader& header, std::span<const std::byte> payload, std::vector<std::byte>& out);
+    void handle_route(const WireHeader& header, std::span<const std::byte> payload, WireWriter& out);
+    void handle_batch(const WireHeader& header, std::span<const std::byte> payload, WireWriter& out);
+    void handle_matrix(const WireHeader& header, std::span<const std::byte> payload, WireWriter& out);
+    void handle_congestion(const WireHeader& header, std::span<const std::byte> payload, WireWriter& out);
+
+    GeoRouteEngine& engine_;
+    CongestionWriter& writer_;
+    BinaryServerOptions options_;
+    int listen_fd_{-1};
+    std::uint16_t port_{0};
+
+    std::atomic<bool> stopping_{false};
+    std::atomic<std::uint64_t> connections_total_{0};
+    std::atomic<std::uint64_t> requests_{0};
+    std::atomic<std::uint64_t> errors_{0};
+    std::atomic<std::uint64_t> bytes_in_{0};
+    std::atomic<std::uint64_t> bytes_out_{0};
+
+    ConnectionThreads connections_{};
+    std::thread thread_;
+};
+
+}  // namespace georoute
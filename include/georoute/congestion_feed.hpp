@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "georoute/connection_threads.hpp"
+#include "georoute/types.hpp"
+
+namespace georoute {
+
+class CongestionWriter;
+
+// Record encodings accepted on a congestion feed.
+//  ndjson: one object per line, {"edge_start": 0, "edge_end": 5, "factor": 1.5}
+//  binary: fixed 12-byte little-endian records {u32 edge_start, u32 edge_end, f32 factor}
+enum class FeedFormat { ndjson, binary };
+
+[[nodiscard]] FeedFormat parse_feed_format(std::string_view name);
+
+struct FeedSource {
+    enum class Kind { unix_socket, tcp, file };
+
+    Kind kind{Kind::unix_socket};
+    // Socket or file path; listen address for tcp.
+    std::string path{};
+    std::uint16_t port{0};
+    FeedFormat format{FeedFormat::ndjson};
+
+    // "unix:<path>", "tcp:<port>", "tcp:<host>:<port>" or "file:<path>".
+    // tcp without a host listens on 127.0.0.1.
+    static FeedSource parse(std::string_view spec, FeedFormat format);
+};
+
+struct FeedStats {
+    std::uint64_t bytes{0};
+    std::uint64_t records{0};
+    std::uint64_t rejected{0};
+};
+
+// Incremental record decoder for one byte stream. Records may be split across
+// consume() calls. Malformed records, ranges outside [0, edge_count) and
+// negative or non-finite factors are counted as rejected and skipped; the
+// stream itself is never aborted.
+class CongestionFeedParser {
+public:
+    static constexpr std::size_t binary_record_size = 12;
+
+    CongestionFeedParser(FeedFormat format, std::size_t edge_count);
+
+    // Appends every complete record in bytes (plus any carried-over prefix) to out.
+    void consume(std::span<const char> bytes, std::vector<CongestionUpdate>& out);
+
+    [[nodiscard]] const FeedStats& stats() const noexcept;
+    // Range limit for records decoded from now on (the graph may be swapped).
+    void set_edge_count(std::size_t edge_count) noexcept;
+
+private:
+    void consume_ndjson(std::span<const char> bytes, std::vector<CongestionUpdate>& out);
+    void consume_binary(std::span<const char> bytes, std::vector<CongestionUpdate>& out);
+    void accept(std::size_t edge_start, std::size_t edge_end, float factor, std::vector<CongestionUpdate>& out);
+
+    FeedFormat format_;
+    std::size_t edge_count_;
+    std::vector<char> partial_{};
+    bool discarding_{false};
+    FeedStats stats_{};
+};
+
+// Reads a feed source on background threads and queues every decoded chunk on
+// the congestion writer. Socket sources accept any number of concurrent
+// connections; file sources are read from the start and then followed for
+// appended data (a truncated file is re-read from the start).
+class CongestionFeed {
+public:
+    CongestionFeed(CongestionWriter& writer, std::size_t edge_count, FeedSource source);
+    CongestionFeed(const CongestionFeed&) = delete;
+    CongestionFeed& operator=(const CongestionFeed&) = delete;
+    CongestionFeed(CongestionFeed&&) = delete;
+    CongestionFeed& operator=(CongestionFeed&&) = delete;
+    ~CongestionFeed();
+
+    [[nodiscard]] const FeedSource& source() const noexcept;
+    [[nodiscard]] FeedStats stats() const noexcept;
+
+private:
+    void run_listener();
+    void run_file();
+    void read_stream(int fd);
+    void submit(CongestionFeedParser& parser, std::span<const char> bytes, std::vector<CongestionUpdate>& updates);
+
+    CongestionWriter& writer_;
+    std::size_t edge_count_;
+    FeedSource source_;
+    int listen_fd_{-1};
+
+    std::atomic<bool> stopping_{false};
+    std::atomic<std::uint64_t> bytes_{0};
+    std::atomic<std::uint64_t> records_{0};
+    std::atomic<std::uint64_t> rejected_{0};
+
+    ConnectionThreads connections_{};
+    std::thread thread_;
+};
+
+}  // namespace georoute
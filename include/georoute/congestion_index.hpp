@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "georoute/segment_tree.hpp"
+#include "georoute/sqrt_decomposition.hpp"
+#include "georoute/types.hpp"
+
+namespace georoute {
+
+// Range-multiply / point-query store for per-edge congestion factors. Wraps
+// one of the interchangeable backends so Router can be built with either.
+// Single-edge writes go to an append-only overlay that is folded into the
+// backend in one batch once it reaches the flush threshold.
+class CongestionIndex {
+public:
+    CongestionIndex(SegmentTree tree);
+    CongestionIndex(SqrtDecomposition blocks);
+
+    // Builds an all-ones index of the given size. kind is "segment_tree" or "blocked".
+    static CongestionIndex make(std::string_view kind, std::size_t size);
+
+    void range_multiply(std::size_t l, std::size_t r, float factor);
+    // ranges must be sorted and non-overlapping (see merge_congestion_updates).
+    void range_multiply_batch(std::span<const CongestionUpdate> ranges);
+    // Buffers per-edge factors in the overlay. Returns the number of ranges
+    // written into the backend if this call triggered a flush, otherwise 0.
+    std::size_t point_multiply(std::span<const EdgeFactorUpdate> updates);
+    // Folds the overlay into the backend. Returns the number of ranges written.
+    std::size_t flush_overlay();
+    // Backend factor combined with any overlay entries for idx. O(overlay size).
+    [[nodiscard]] float point_query(std::size_t idx) const;
+    // Every factor in index order, overlay included, in one O(n + overlay) pass.
+    [[nodiscard]] std::vector<float> values() const;
+
+    [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] std::string_view kind() const noexcept;
+    [[nodiscard]] std::size_t overlay_size() const noexcept;
+    void set_overlay_flush_threshold(std::size_t threshold) noexcept;
+
+    static constexpr std::size_t default_overlay_flush_threshold = 4096;
+
+private:
+    std::variant<SegmentTree, SqrtDecomposition> impl_;
+    std::vector<EdgeFactorUpdate> overlay_{};
+    std::size_t overlay_flush_threshold_{default_overlay_flush_threshold};
+};
+
+// Rewrites a batch of possibly overlapping updates as sorted, disjoint ranges
+// whose factor is the product of every update covering them. Adjacent pieces
+// with equal factors are joined.
+[[nodiscard]] std::vector<CongestionUpdate> merge_congestion_updates(std::span<const CongestionUpdate> updates);
+
+}  // namespace georoute
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "georoute/types.hpp"
+
+namespace georoute {
+
+struct CongestionJournalOptions {
+    // Holds congestion.snapshot and congestion.wal; created if missing.
+    std::string directory{};
+    // A new snapshot is written (and the log truncated) this often while updates arrive.
+    std::chrono::seconds snapshot_interval{60};
+    // fdatasync the log after each write.
+    bool sync{true};
+};
+
+// Congestion factors rebuilt from the latest snapshot plus the log tail.
+struct RecoveredCongestion {
+    std::vector<float> factors{};
+    std::uint64_t snapshot_sequence{0};
+    std::uint64_t last_sequence{0};
+    std::size_t replayed_batches{0};
+    std::size_t replayed_updates{0};
+    // Length of the log prefix that decoded cleanly; a torn tail is cut off.
+    std::uint64_t log_bytes{0};
+    bool from_snapshot{false};
+};
+
+struct CongestionJournalStats {
+    std::uint64_t sequence{0};
+    std::uint64_t pending_batches{0};
+    std::uint64_t log_bytes{0};
+    std::uint64_t snapshots{0};
+    double last_snapshot_ms{0.0};
+};
+
+// Durable record of congestion updates: an append-only log of update batches
+// plus periodic binary snapshots of every edge factor. record() only copies
+// the batch; a background thread appends it to the log, keeps a factor mirror
+// current and writes snapshots, so nothing here runs on the query path.
+class CongestionJournal {
+public:
+    static constexpr const char* snapshot_file = "congestion.snapshot";
+    static constexpr const char* log_file = "congestion.wal";
+
+    // Loads the snapshot (if any) and replays log entries newer than it.
+    // Throws std::runtime_error if the snapshot is corrupt or its edge count
+    // does not match.
+    static RecoveredCongestion recover(const std::string& directory, std::size_t edge_count);
+
+    CongestionJournal(CongestionJournalOptions options, RecoveredCongestion state);
+    CongestionJournal(const CongestionJournal&) = delete;
+    CongestionJournal& operator=(const CongestionJournal&) = delete;
+    CongestionJournal(CongestionJournal&&) = delete;
+    CongestionJournal& operator=(CongestionJournal&&) = delete;
+    // Writes out pending batches and a final snapshot.
+    ~CongestionJournal();
+
+    // Queues an applied batch for the log. Ranges must already be validated.
+    void record(std::span<const CongestionUpdate> updates);
+    // Blocks until every batch recorded so far is in the log.
+    void flush();
+    // Starts over for a new graph: after the batches already recorded, the
+    // mirror is reset to edge_count factors of 1.0 and written as a fresh
+    // snapshot, so recovery never replays updates meant for the old edges.
+    void restart(std::size_t edge_count);
+
+    [[nodiscard]] CongestionJournalStats stats() const;
+
+private:
+    struct Batch {
+        std::uint64_t sequence{0};
+        std::vector<CongestionUpdate> updates{};
+        // Set on restart() markers, which carry no updates.
+        std::optional<std::size_t> restart_edge_count{};
+    };
+
+    void run();
+    void write_batches(std::span<const Batch> batches);
+    void append(std::span<const Batch> batches);
+    void write_snapshot();
+
+    CongestionJournalOptions options_;
+    std::vector<float> factors_;
+    std::uint64_t snapshot_sequence_{0};
+    std::uint64_t written_sequence_{0};
+    int log_fd_{-1};
+    std::uint64_t log_bytes_{0};
+    std::chrono::steady_clock::time_point last_snapshot_{};
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable flushed_cv_;
+    std::vector<Batch> pending_{};
+    std::uint64_t next_sequence_{0};
+    std::uint64_t durable_sequence_{0};
+    std::uint64_t snapshots_{0};
+    double last_snapshot_ms_{0.0};
+    bool stopping_{false};
+
+    std::thread thread_;
+};
+
+// Rewrites per-edge factors as sorted ranges of equal factor, skipping 1.0.
+[[nodiscard]] std::vector<CongestionUpdate> factor_runs(std::span<const float> factors);
+
+}  // namespace georoute
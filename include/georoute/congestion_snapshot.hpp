@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace georoute {
+
+// Immutable-once-published version of the effective edge costs. Costs are
+// stored in fixed-size chunks shared between versions; a writer derives the
+// next version with next(), and only chunks it writes to are copied.
+class CongestionSnapshot {
+public:
+    static constexpr std::size_t chunk_shift = 12;
+    static constexpr std::size_t chunk_size = std::size_t{1} << chunk_shift;
+
+    CongestionSnapshot(std::uint64_t epoch, std::span<const float> edge_costs);
+
+    // Copy of this version with epoch + 1 that shares every chunk.
+    [[nodiscard]] std::shared_ptr<CongestionSnapshot> next() const;
+
+    // Multiplies costs of edges [first, last]. Must only be called before the
+    // snapshot is published.
+    void multiply(std::size_t first, std::size_t last, float factor);
+
+    [[nodiscard]] float cost(std::size_t edge) const noexcept {
+        return chunk_data_[edge >> chunk_shift][edge & (chunk_size - 1)];
+    }
+
+    [[nodiscard]] std::uint64_t epoch() const noexcept;
+    [[nodiscard]] std::size_t edge_count() const noexcept;
+
+private:
+    float* writable_chunk(std::size_t chunk);
+
+    std::uint64_t epoch_{0};
+    std::size_t edge_count_{0};
+    std::vector<std::shared_ptr<std::vector<float>>> chunks_{};
+    std::vector<float*> chunk_data_{};
+};
+
+}  // namespace georoute
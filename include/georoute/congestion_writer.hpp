@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "georoute/types.hpp"
+
+namespace georoute {
+
+class GeoRouteEngine;
+
+struct CongestionWriterOptions {
+    // How long the writer keeps collecting after the first queued update
+    // before applying everything queued as one batch. Zero applies whatever
+    // is queued as soon as the writer wakes up.
+    std::chrono::microseconds coalesce_window{1000};
+};
+
+struct CongestionWriterStats {
+    std::uint64_t enqueued_sequence{0};
+    std::uint64_t applied_sequence{0};
+    std::uint64_t queue_depth{0};
+    std::uint64_t batches{0};
+    std::uint64_t coalesced_updates{0};
+    // Queued updates whose range no longer fits after a graph swap.
+    std::uint64_t dropped_updates{0};
+    std::uint64_t epoch{0};
+    double last_apply_lag_us{0.0};
+    double max_apply_lag_us{0.0};
+    double mean_apply_lag_us{0.0};
+};
+
+// Single-writer pipeline for congestion updates. Producers push onto a
+// lock-free multi-producer/single-consumer queue and get a sequence number
+// back immediately; a dedicated thread drains the queue, merges everything
+// queued within the coalesce window and applies it to the engine as one
+// batch (one congestion epoch).
+class CongestionWriter {
+public:
+    explicit CongestionWriter(GeoRouteEngine& engine, CongestionWriterOptions options = {});
+    CongestionWriter(const CongestionWriter&) = delete;
+    CongestionWriter& operator=(const CongestionWriter&) = delete;
+    CongestionWriter(CongestionWriter&&) = delete;
+    CongestionWriter& operator=(CongestionWriter&&) = delete;
+    // Applies everything still queued, then stops the writer thread.
+    ~CongestionWriter();
+
+    // Validates and queues the update(s). Returns the sequence number that
+    // becomes visible once they are applied. Throws std::invalid_argument or
+    // std::out_of_range for bad ranges; nothing is queued in that case.
+    std::uint64_t enqueue(const CongestionUpdate& update);
+    std::uint64_t enqueue(std::span<const CongestionUpdate> updates);
+
+    // Blocks until every update up to and including sequence has been applied
+    // or the timeout expires. Returns whether the sequence is visible.
+    bool wait_for(std::uint64_t sequence, std::chrono::milliseconds timeout) const;
+
+    // Highest sequence whose updates, and those of every earlier sequence, are visible.
+    [[nodiscard]] std::uint64_t applied_sequence() const noexcept;
+    // Edge count enqueue currently validates against (follows graph swaps).
+    [[nodiscard]] std::size_t edge_count() const noexcept;
+    [[nodiscard]] CongestionWriterStats stats() const;
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        std::uint64_t sequence{0};
+        std::chrono::steady_clock::time_point enqueued_at{};
+        std::vector<CongestionUpdate> updates{};
+    };
+
+    void push(Node* node) noexcept;
+    Node* pop() noexcept;
+    void run();
+    void apply(std::vector<Node*>& drained);
+
+    GeoRouteEngine& engine_;
+    CongestionWriterOptions options_;
+
+    // Intrusive MPSC queue: producers exchange head_, the writer thread owns tail_.
+    Node stub_{};
+    std::atomic<Node*> head_{&stub_};
+    Node* tail_{&stub_};
+
+    std::atomic<std::uint64_t> next_sequence_{0};
+    std::atomic<std::uint64_t> enqueued_count_{0};
+    std::atomic<std::uint64_t> drained_count_{0};
+    std::atomic<std::uint32_t> signal_{0};
+    std::atomic<bool> stopping_{false};
+
+    std::atomic<std::uint64_t> applied_sequence_{0};
+    std::vector<std::uint64_t> out_of_order_{};
+    mutable std::mutex wait_mutex_;
+    mutable std::condition_variable applied_cv_;
+
+    mutable std::mutex stats_mutex_;
+    CongestionWriterStats stats_{};
+    double total_apply_lag_us_{0.0};
+    std::uint64_t lag_samples_{0};
+
+    std::thread thread_;
+};
+
+}  // namespace georoute
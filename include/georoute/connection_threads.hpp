@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace georoute {
+
+// One thread per accepted connection for the socket listeners. A thread that
+// returns is joined by the listener's next spawn() or reap(), so a
+// long-running server with short-lived clients only holds threads for the
+// connections still open.
+class ConnectionThreads {
+public:
+    ConnectionThreads() = default;
+    ConnectionThreads(const ConnectionThreads&) = delete;
+    ConnectionThreads& operator=(const ConnectionThreads&) = delete;
+    ConnectionThreads(ConnectionThreads&&) = delete;
+    ConnectionThreads& operator=(ConnectionThreads&&) = delete;
+    // Joins every thread (see join_all).
+    ~ConnectionThreads();
+
+    // Reaps finished threads, then runs serve on a new one.
+    void spawn(std::function<void()> serve);
+    // Joins the threads whose serve has returned.
+    void reap();
+    // Joins every thread; the caller must already have told them to stop.
+    void join_all();
+    // Threads still running serve.
+    [[nodiscard]] std::size_t active() const noexcept;
+
+private:
+    std::atomic<std::size_t> active_{0};
+    std::mutex mutex_;
+    std::vector<std::thread> threads_{};
+    std::vector<std::thread::id> finished_{};
+};
+
+}  // namespace georoute
@@ -1,24 +1,54 @@
 #pragma once
 
+#include <memory_resource>
 #include <optional>
 #include <vector>
 
+#include "georoute/congestion_snapshot.hpp"
 #include "georoute/graph.hpp"
 #include "georoute/segment_tree.hpp"
 #include "georoute/types.hpp"
 
 namespace georoute {
 
+struct SearchQueueEntry {
+    node_id node;
+    double cost;
+};
+
+// Search state reused across shortest_path calls on one thread. Arrays are
+// sized to the graph on first use; afterwards only the entries the previous
+// search touched are reset.
+struct SearchScratch {
+    std::vector<double> distances{};
+    std::vector<node_id> predecessors{};
+    std::vector<bool> visited{};
+    std::vector<node_id> touched{};
+    std::vector<SearchQueueEntry> queue{};
+};
+
 class DijkstraRouter {
 public:
+    // Looks up the congestion factor of every relaxed edge in the segment tree.
     DijkstraRouter(const Graph& graph, const SegmentTree& congestion_tree);
+    // Uses the precomputed effective costs (base travel time x congestion) of one snapshot.
+    DijkstraRouter(const Graph& graph, const CongestionSnapshot& snapshot);
 
     [[nodiscard]] RouteComputation shortest_path(node_id source, node_id target) const;
+    // Stops early with RouteStatus::deadline_exceeded or node_budget_exceeded
+    // once budget runs out. The path is allocated from resource, in one
+    // allocation of its exact length.
+    [[nodiscard]] RouteComputation shortest_path(
+        node_id source,
+        node_id target,
+        SearchScratch& scratch,
+        const SearchBudget& budget = {},
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
 
 private:
     const Graph& graph_;
-    const SegmentTree& congestion_tree_;
+    const SegmentTree* congestion_tree_{nullptr};
+    const CongestionSnapshot* snapshot_{nullptr};
 };
 
-} 
-
+}
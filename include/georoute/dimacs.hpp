@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+
+#include "georoute/graph.hpp"
+
+namespace georoute {
+
+// 9th DIMACS Implementation Challenge shortest-path files:
+//
+//   .gr   "p sp <nodes> <arcs>", then one "a <from> <to> <weight>" per arc
+//   .co   "p aux sp co <nodes>", then one "v <node> <lon> <lat>" per node,
+//         in millionths of a degree
+//
+// Node ids are 1-based in the files and 0-based in the Graph. Arc i of the
+// .gr file becomes edge id i, so congestion ranges follow file order.
+// Lines starting with 'c' are comments.
+
+struct DimacsImportOptions {
+    // Empty: no coordinates.
+    std::string coordinates_path{};
+    // Multiplies every arc weight, e.g. to turn the challenge's integer units
+    // into seconds.
+    double weight_scale{1.0};
+};
+
+// Reads path in two streaming passes: the first counts each node's arcs so
+// every adjacency list is allocated once at its final size, the second fills
+// them. Peak memory is the finished Graph plus 4 bytes per node. Throws
+// std::runtime_error naming the file and line for unreadable or malformed
+// input.
+[[nodiscard]] Graph read_dimacs(const std::string& path, const DimacsImportOptions& options = {});
+
+// The .co file next to a .gr file (same name, .co extension) if there is
+// one, otherwise empty.
+[[nodiscard]] std::string dimacs_coordinates_path(const std::string& graph_path);
+
+// Writes graph as a .gr file, arcs in edge id order, and its coordinates, if
+// any, as a .co file when coordinates_path is not empty. Weights that are
+// not whole numbers are written as decimals, which read_dimacs accepts but
+// other DIMACS tools may not. Throws std::runtime_error if a file cannot be
+// written.
+void write_dimacs(const Graph& graph, const std::string& path, const std::string& coordinates_path = {});
+
+}  // namespace georoute
@@ -1,64 +1,201 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <memory_resource>
 #include <mutex>
+#include <span>
 #include <vector>
 
 #include <nlohmann/json_fwd.hpp>
 
+#include "georoute/engine_stats.hpp"
+#include "georoute/query_executor.hpp"
 #include "georoute/router.hpp"
 #include "georoute/types.hpp"
 
 namespace georoute {
 
-struct EngineStats {
-    std::uint64_t total_queries{0};
-    std::uint64_t total_updates{0};
-    double total_compute_time_us{0.0};
-    double max_compute_time_us{0.0};
-};
+class CongestionJournal;
+class RouteCoalescer;
 
 struct RouteQuery {
     node_id source;
     node_id target;
 };
 
-struct CongestionUpdate {
-    std::size_t edge_start;
-    std::size_t edge_end;
-    float factor;
+struct CongestionBatchResult {
+    std::size_t updates{0};
+    std::size_t merged_ranges{0};
+    double apply_time_us{0.0};
+    std::uint64_t epoch{0};
 };
 
 struct RouteResponse {
     RouteResult result;
-    EngineStats stats;
+    // Anything but complete means the budget ran out and result is empty.
+    RouteStatus status{RouteStatus::complete};
     std::uint64_t expanded_nodes{0};
     double compute_time_us{0.0};
+    std::uint64_t congestion_epoch{0};
+    // Node coordinates of the graph that computed the path, which may have
+    // been swapped out since; null when that graph has none.
+    std::shared_ptr<const std::vector<Coordinate>> coordinates{};
+    // Copied from an identical search that was already running (see
+    // set_route_coalescing); expanded_nodes then describes that search and
+    // compute_time_us is the time spent waiting for it.
+    bool coalesced{false};
+};
+
+struct GraphSwapResult {
+    std::size_t node_count{0};
+    std::size_t edge_count{0};
+    // False when not requested or when edge ids differ; the new graph then
+    // starts with every congestion factor at 1.0.
+    bool congestion_carried{false};
+    // Epoch of the new router; epochs restart with every graph.
+    std::uint64_t epoch{0};
+    // Time congestion updates were held off. Queries never wait on a swap.
+    double swap_time_us{0.0};
+    // Both routers stay resident until the last query pinned to the old one
+    // returns (see Router::memory_bytes).
+    std::size_t previous_memory_bytes{0};
+    std::size_t next_memory_bytes{0};
+    // Expires once the old router has been freed.
+    std::weak_ptr<const Router> previous{};
 };
 
+// Queries, updates and stats over one routing graph at a time. Each query
+// pins the router current when it starts, so swap_router() can replace the
+// whole graph while queries run; the old router is freed by the last query
+// still holding it.
 class GeoRouteEngine {
 public:
-    GeoRouteEngine() = default;
     explicit GeoRouteEngine(Router router);
     
     GeoRouteEngine(const GeoRouteEngine&) = delete;
     GeoRouteEngine& operator=(const GeoRouteEngine&) = delete;
-    GeoRouteEngine(GeoRouteEngine&&) = default;
-    GeoRouteEngine& operator=(GeoRouteEngine&&) = default;
-    ~GeoRouteEngine() = default;
+    GeoRouteEngine(GeoRouteEngine&& other) noexcept;
+    GeoRouteEngine& operator=(GeoRouteEngine&&) = delete;
+    ~GeoRouteEngine();
+
+    // Every routing call takes an optional SearchBudget; a search that runs
+    // out of it returns with RouteResponse::status set instead of a route.
+    // route() and route_at_epoch() run on the calling thread with search
+    // arrays kept per thread, and allocate the path from resource; with a
+    // RequestArena the response must not outlive the arena scope.
+    [[nodiscard]] RouteResponse route(node_id source,
+                                      node_id target,
+                                      const SearchBudget& budget = {},
+                                      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    // Routes against a retained past congestion epoch (see Router::compute_route_at).
+    [[nodiscard]] RouteResponse route_at_epoch(
+        std::uint64_t epoch,
+        node_id source,
+        node_id target,
+        const SearchBudget& budget = {},
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // Number of query workers started on the first async or batch call;
+    // 0 (the default) means one per hardware thread. Throws std::logic_error
+    // once the workers are running.
+    void set_worker_threads(std::size_t threads);
+    [[nodiscard]] std::size_t worker_threads() const;
 
-    [[nodiscard]] RouteResponse route(node_id source, node_id target);
-    void apply_congestion_update(std::size_t edge_start, std::size_t edge_end, float factor);
+    // With coalescing on (the default), route(), route_async() and
+    // route_batch() share one search among concurrent identical queries: same
+    // endpoints, same node cap, same graph and congestion epoch. See
+    // RouteCoalescer. route_at_epoch() always runs its own search.
+    void set_route_coalescing(bool enabled) noexcept;
+    [[nodiscard]] bool route_coalescing() const noexcept;
+
+    // Queue one query on the worker pool. Node ids are checked on the calling
+    // thread and std::out_of_range is thrown there.
+    [[nodiscard]] std::future<RouteResponse> route_async(node_id source,
+                                                         node_id target,
+                                                         const SearchBudget& budget = {});
+    // on_done runs on a worker thread, exactly once: with the response and a
+    // null error, or with the exception the search threw (e.g. the graph was
+    // swapped for one without these nodes after they were checked).
+    void route_async(node_id source,
+                     node_id target,
+                     std::function<void(RouteResponse, std::exception_ptr)> on_done,
+                     const SearchBudget& budget = {});
+    // Spreads the queries over the worker pool in chunks and returns the
+    // responses in query order. Every node id is checked before anything
+    // runs. Called from a worker thread, the batch runs inline instead.
+    // budget applies to each query; its deadline is shared by the whole batch.
+    [[nodiscard]] std::vector<RouteResponse> route_batch(std::span<const RouteQuery> queries,
+                                                         const SearchBudget& budget = {});
+    std::uint64_t apply_congestion_update(std::size_t edge_start, std::size_t edge_end, float factor);
+    CongestionBatchResult apply_congestion_updates(std::span<const CongestionUpdate> updates);
+    CongestionBatchResult apply_edge_updates(std::span<const EdgeFactorUpdate> updates);
     
+    // Publishes next as the active router. Queries already running finish on
+    // the old graph. With carry_congestion, every current factor is copied to
+    // next before it goes live, provided both graphs assign the same edge ids
+    // (Graph::same_edge_ids). Otherwise an attached journal is restarted for
+    // the new edge count. Retained epochs of the old graph are not carried.
+    GraphSwapResult swap_router(Router next, bool carry_congestion = true);
+
+    // Every applied update is also recorded in journal (nullptr to stop).
+    // The journal must outlive its attachment.
+    void set_congestion_journal(CongestionJournal* journal) noexcept;
+
+    [[nodiscard]] std::uint64_t current_epoch() const;
+    [[nodiscard]] std::size_t node_count() const noexcept;
+    [[nodiscard]] std::size_t edge_count() const noexcept;
+    // Settings of the active router; see Router::settings.
+    [[nodiscard]] RouterSettings router_settings() const;
+    // Aggregated over every stats shard on each call; see EngineStatsRecorder.
     [[nodiscard]] EngineStats get_stats() const noexcept;
+    [[nodiscard]] LatencyHistogramSnapshot compute_time_histogram() const noexcept;
+    [[nodiscard]] MetricHistogramSnapshot expanded_nodes_histogram() const;
+    [[nodiscard]] MetricHistogramSnapshot relaxed_edges_histogram() const;
+    // Time to publish each congestion update call, in nanoseconds.
+    [[nodiscard]] MetricHistogramSnapshot update_apply_histogram() const;
+    // Time each congestion update call waited for another update or a graph
+    // swap to finish before it could start, in nanoseconds.
+    [[nodiscard]] MetricHistogramSnapshot update_lock_wait_histogram() const;
     void reset_stats() noexcept;
     
     static GeoRouteEngine from_json(const nlohmann::json& config);
 
 private:
-    Router router_;
-    mutable EngineStats stats_;
-    mutable std::mutex stats_mutex_;
+    [[nodiscard]] std::shared_ptr<Router> router() const;
+    RouteResponse record_route(RouteComputation&& computation,
+                               std::chrono::nanoseconds compute_time,
+                               const Graph& graph);
+    RouteResponse route_with(node_id source,
+                             node_id target,
+                             SearchScratch& scratch,
+                             const SearchBudget& budget,
+                             std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    void check_nodes(node_id source, node_id target, const char* caller) const;
+    QueryExecutor& executor();
+
+#if defined(__cpp_lib_atomic_shared_ptr)
+    std::atomic<std::shared_ptr<Router>> router_;
+#else
+    std::shared_ptr<Router> router_;
+#endif
+    // Serializes updates with swap_router so none lands on a retired router.
+    std::mutex update_mutex_;
+    CongestionJournal* journal_{nullptr};
+    EngineStatsRecorder stats_;
+    std::size_t worker_threads_{0};
+    std::atomic<bool> route_coalescing_{true};
+    std::unique_ptr<RouteCoalescer> coalescer_;
+    std::mutex executor_mutex_;
+    std::atomic<QueryExecutor*> executor_view_{nullptr};
+    // Declared last: workers still running tasks are joined before anything
+    // they use is destroyed.
+    std::unique_ptr<QueryExecutor> executor_;
 };
 
 }  // namespace georoute
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "georoute/types.hpp"
+
+namespace georoute {
+
+// Log-linear (HDR-style) bucketing of nanosecond values: values below 64 get
+// one bucket each, every higher power of two is split into 32 equal buckets,
+// so any recorded value is reported within ~3% of its true magnitude. Values
+// at or above 2^40 ns (~18 minutes) land in the last bucket.
+struct LatencyBuckets {
+    static constexpr std::size_t sub_bucket_bits = 5;
+    static constexpr std::size_t sub_bucket_count = std::size_t{1} << sub_bucket_bits;
+    static constexpr std::size_t max_value_bits = 40;
+    static constexpr std::size_t count = (max_value_bits - sub_bucket_bits + 1) * sub_bucket_count;
+
+    [[nodiscard]] static std::size_t index(std::uint64_t value) noexcept;
+    // Smallest and largest value that map to bucket index.
+    [[nodiscard]] static std::uint64_t lower_bound(std::size_t index) noexcept;
+    [[nodiscard]] static std::uint64_t upper_bound(std::size_t index) noexcept;
+};
+
+// Plain copy of a histogram, summed over every shard at read time.
+struct LatencyHistogramSnapshot {
+    std::array<std::uint64_t, LatencyBuckets::count> counts{};
+    std::uint64_t total_count{0};
+    std::uint64_t total_ns{0};
+    std::uint64_t max_ns{0};
+
+    // Upper bound of the bucket holding the p-th quantile (p in [0, 1]),
+    // capped at the recorded maximum. Zero when empty.
+    [[nodiscard]] std::uint64_t percentile_ns(double p) const noexcept;
+};
+
+// Plain copy of a MetricHistogram. counts[i] is the number of values in
+// (upper_bounds[i-1], upper_bounds[i]]; the last entry counts values above
+// every bound.
+struct MetricHistogramSnapshot {
+    std::vector<std::uint64_t> upper_bounds{};
+    std::vector<std::uint64_t> counts{};
+    std::uint64_t total_count{0};
+    std::uint64_t sum{0};
+};
+
+// Fixed-bucket histogram for exported metrics (a few dozen buckets at most,
+// unlike the fine LatencyBuckets). Recording is a short bucket search and two
+// relaxed atomic adds on the calling thread's shard; reads sum the shards.
+class MetricHistogram {
+public:
+    static constexpr std::size_t max_bounds = 24;
+    static constexpr std::size_t shard_count = 16;
+
+    // upper_bounds must be strictly ascending and at most max_bounds long;
+    // throws std::invalid_argument otherwise.
+    explicit MetricHistogram(std::span<const std::uint64_t> upper_bounds);
+    MetricHistogram(const MetricHistogram&) = delete;
+    MetricHistogram& operator=(const MetricHistogram&) = delete;
+    // A moved-from histogram may only be destroyed.
+    MetricHistogram(MetricHistogram&&) noexcept;
+    MetricHistogram& operator=(MetricHistogram&&) = delete;
+    ~MetricHistogram();
+
+    void observe(std::uint64_t value) noexcept;
+    [[nodiscard]] MetricHistogramSnapshot snapshot() const;
+    void reset() noexcept;
+
+private:
+    struct Shard;
+
+    std::array<std::uint64_t, max_bounds> bounds_{};
+    std::size_t bound_count_{0};
+    std::unique_ptr<Shard[]> shards_;
+};
+
+struct EngineStats {
+    std::uint64_t total_queries{0};
+    std::uint64_t total_updates{0};
+    std::uint64_t total_update_batches{0};
+    std::uint64_t total_expanded_nodes{0};
+    std::uint64_t total_relaxed_edges{0};
+    // Searches cut short by SearchBudget (also counted in total_queries).
+    std::uint64_t total_deadline_exceeded{0};
+    std::uint64_t total_node_budget_exceeded{0};
+    // Queries answered from an identical search already in flight; these ran
+    // no search and are not counted in total_queries.
+    std::uint64_t total_coalesced_queries{0};
+    double total_compute_time_us{0.0};
+    double max_compute_time_us{0.0};
+    double p50_compute_time_us{0.0};
+    double p90_compute_time_us{0.0};
+    double p99_compute_time_us{0.0};
+    double p999_compute_time_us{0.0};
+};
+
+// Engine counters and route latency histogram without a shared lock. Each
+// thread is pinned to one of shard_count cache-line-aligned shards and only
+// issues relaxed atomic adds there; readers sum the shards. Aggregates are
+// therefore not a single point-in-time cut while writes are in flight, but
+// every completed record is counted exactly once.
+class EngineStatsRecorder {
+public:
+    static constexpr std::size_t shard_count = 16;
+
+    EngineStatsRecorder();
+    EngineStatsRecorder(const EngineStatsRecorder&) = delete;
+    EngineStatsRecorder& operator=(const EngineStatsRecorder&) = delete;
+    // A moved-from recorder may only be destroyed.
+    EngineStatsRecorder(EngineStatsRecorder&&) noexcept;
+    EngineStatsRecorder& operator=(EngineStatsRecorder&&) = delete;
+    ~EngineStatsRecorder();
+
+    void record_route(std::uint64_t compute_time_ns,
+                      std::uint64_t expanded_nodes,
+                      std::uint64_t relaxed_edges,
+                      RouteStatus status = RouteStatus::complete) noexcept;
+    // A query that shared another query's search instead of running one.
+    void record_coalesced() noexcept;
+    // apply_time_ns is the time spent publishing the updates, if measured;
+    // lock_wait_ns is how long the call waited for the update lock before
+    // that, and is only recorded alongside a measured apply time.
+    void record_updates(std::uint64_t updates,
+                        std::uint64_t batches,
+                        std::uint64_t apply_time_ns = 0,
+                        std::uint64_t lock_wait_ns = 0) noexcept;
+
+    [[nodiscard]] EngineStats aggregate() const noexcept;
+    [[nodiscard]] LatencyHistogramSnapshot compute_time_histogram() const noexcept;
+    // Per-query search work and per-call congestion apply time and lock wait.
+    [[nodiscard]] MetricHistogramSnapshot expanded_nodes_histogram() const;
+    [[nodiscard]] MetricHistogramSnapshot relaxed_edges_histogram() const;
+    [[nodiscard]] MetricHistogramSnapshot update_apply_histogram() const;
+    [[nodiscard]] MetricHistogramSnapshot update_lock_wait_histogram() const;
+    void reset() noexcept;
+
+private:
+    struct Shard;
+    static constexpr std::size_t search_work_bucket_count = 16;
+    using SearchWorkBuckets = std::array<std::atomic<std::uint64_t>, search_work_bucket_count>;
+
+    Shard& local_shard() const noexcept;
+    MetricHistogramSnapshot search_work_histogram(SearchWorkBuckets Shard::*buckets,
+                                                  std::atomic<std::uint64_t> Shard::*sum) const;
+
+    std::unique_ptr<Shard[]> shards_;
+    // Congestion updates are rare next to queries, so they get their own shards.
+    MetricHistogram update_apply_ns_;
+    MetricHistogram update_lock_wait_ns_;
+};
+
+}  // namespace georoute
@@ -2,12 +2,19 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "georoute/types.hpp"
 
 namespace georoute {
 
+// WGS84 position of a node, in degrees.
+struct Coordinate {
+    double lat{0.0};
+    double lon{0.0};
+};
+
 struct Edge {
     node_id to{0};
     float base_travel_time{0.0F};
@@ -18,16 +25,39 @@ class Graph {
 public:
     explicit Graph(std::size_t node_count = 0);
 
+    // Adopts prebuilt adjacency lists, as read back from a graph snapshot.
+    // Throws std::invalid_argument unless every edge leads to a node of the
+    // graph and the edge ids are 0..edge_count-1, each used once.
+    [[nodiscard]] static Graph from_adjacency(std::vector<std::vector<Edge>> adjacency);
+
     void add_edge(node_id from, node_id to, float base_travel_time);
 
     [[nodiscard]] const std::vector<Edge>& neighbors(node_id u) const noexcept;
 
+    // Base travel times indexed by edge id.
+    [[nodiscard]] std::vector<float> base_travel_times() const;
+
+    // Optional, one per node. Shared so responses can keep the coordinates of
+    // the graph that computed their path across a graph swap. Throws
+    // std::invalid_argument unless there is exactly one per node, each within
+    // +-90 degrees latitude and +-180 longitude.
+    void set_coordinates(std::vector<Coordinate> coordinates);
+    // Null when the graph was loaded without coordinates.
+    [[nodiscard]] const std::shared_ptr<const std::vector<Coordinate>>& coordinates() const noexcept;
+
     [[nodiscard]] std::size_t node_count() const noexcept;
     [[nodiscard]] std::size_t edge_count() const noexcept;
 
+    // True when other has the same nodes and every edge id joins the same
+    // endpoints in both graphs, so per-edge state can move between them.
+    [[nodiscard]] bool same_edge_ids(const Graph& other) const noexcept;
+    // Heap bytes held by the adjacency lists and coordinates (capacity, not size).
+    [[nodiscard]] std::size_t memory_bytes() const noexcept;
+
 private:
     std::vector<std::vector<Edge>> adjacency_{};
     edge_id next_edge_id_{0};
+    std::shared_ptr<const std::vector<Coordinate>> coordinates_{};
 };
 
 }  // namespace georoute
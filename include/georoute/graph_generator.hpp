@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "georoute/graph.hpp"
+
+namespace georoute {
+
+// Synthetic road networks for benchmarks and tests. Every generator is
+// deterministic for a given size and seed. size is the side of the grid, or
+// its equivalent: each graph has about size * size nodes.
+//
+//   grid       uniform bidirectional grid with near-constant edge costs and
+//              no coordinates; the baseline the benchmarks have always used
+//   geometric  random points joined by short non-crossing streets, so the
+//              graph is planar, with dead ends and a mean degree near 3
+//              like real roads
+//   highway    grid of local streets with a faster arterial every eighth row
+//              and column, and limited-access highways whose edges skip
+//              straight between interchanges
+//   city       mostly one-way grid, two-way arterials, and closed-off pockets
+//              that can be entered but not left, left but not entered, or
+//              neither
+//
+// All but grid carry WGS84 coordinates with about 100 m between neighbours,
+// and travel times are seconds at the street's speed.
+enum class GraphType : std::uint8_t { grid, geometric, highway, city };
+
+// "grid", "geometric", "highway" or "city"; throws std::invalid_argument
+// otherwise.
+[[nodiscard]] GraphType parse_graph_type(std::string_view name);
+[[nodiscard]] std::string_view graph_type_name(GraphType type) noexcept;
+
+[[nodiscard]] Graph generate_graph(GraphType type, std::size_t size, std::uint64_t seed);
+
+[[nodiscard]] Graph make_grid_graph(std::size_t rows, std::size_t cols);
+[[nodiscard]] Graph make_geometric_graph(std::size_t nodes, std::uint64_t seed);
+[[nodiscard]] Graph make_highway_grid(std::size_t rows, std::size_t cols, std::uint64_t seed);
+[[nodiscard]] Graph make_city_grid(std::size_t rows, std::size_t cols, std::uint64_t seed);
+
+}  // namespace georoute
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "georoute/engine.hpp"
+
+namespace georoute {
+
+struct GraphReloadReport {
+    std::string path{};
+    // Reading, parsing and building the new router; queries keep running on
+    // the old graph meanwhile.
+    double load_ms{0.0};
+    GraphSwapResult swap{};
+    // How long both graphs stayed resident after the swap, i.e. until the
+    // last query on the old graph returned (1 ms resolution). Unset if it was
+    // still pinned when the reloader stopped waiting.
+    std::optional<double> overlap_ms{};
+};
+
+enum class GraphReloadState : std::uint8_t {
+    idle,
+    running,
+    succeeded,
+    failed,
+};
+
+[[nodiscard]] const char* graph_reload_state_name(GraphReloadState state) noexcept;
+
+// Outcome of the last reload started with GraphReloader::start().
+struct GraphReloadStatus {
+    GraphReloadState state{GraphReloadState::idle};
+    std::string path{};
+    // Set once the reload succeeded.
+    std::optional<GraphReloadReport> report{};
+    // Why the reload failed; the previous graph stays active.
+    std::string error{};
+};
+
+// Loads graph files into new routers and swaps them into the engine. Reloads
+// are serialized, and keep the congestion index kind and snapshot history of
+// the active router unless a JSON graph sets its own. Only files inside the
+// directory of the startup graph are loaded, so a reload request cannot read
+// arbitrary files.
+class GraphReloader {
+public:
+    GraphReloader(GeoRouteEngine& engine,
+                  std::string graph_path,
+                  std::chrono::milliseconds release_wait = std::chrono::milliseconds{1000});
+    ~GraphReloader();
+
+    GraphReloader(const GraphReloader&) = delete;
+    GraphReloader& operator=(const GraphReloader&) = delete;
+
+    // Loads path (empty = the last loaded file, which picks up a file replaced
+    // in place) on the calling thread and swaps it in. Returns std::nullopt
+    // without loading anything if another reload is still running. Throws
+    // std::runtime_error or std::invalid_argument if the file cannot be
+    // loaded or lies outside graph_directory(); the active graph is untouched
+    // in that case.
+    std::optional<GraphReloadReport> reload(const std::string& path = {}, bool carry_congestion = true);
+
+    // Same as reload(), but loads on the reloader's own thread; poll status()
+    // for the outcome. Returns false if a reload is still running. A path
+    // outside graph_directory() throws std::invalid_argument right away.
+    bool start(const std::string& path = {}, bool carry_congestion = true);
+    [[nodiscard]] GraphReloadStatus status() const;
+
+    [[nodiscard]] std::string graph_path() const;
+    [[nodiscard]] const std::filesystem::path& graph_directory() const noexcept;
+    [[nodiscard]] std::uint64_t reloads() const noexcept;
+
+private:
+    std::string resolve_path(const std::string& path) const;
+
+    GeoRouteEngine& engine_;
+    std::chrono::milliseconds release_wait_;
+    std::filesystem::path graph_directory_;
+    std::mutex reload_mutex_;
+    mutable std::mutex path_mutex_;
+    std::string graph_path_;
+    std::atomic<std::uint64_t> reloads_{0};
+    mutable std::mutex status_mutex_;
+    GraphReloadStatus status_{};
+    // Declared last: joined before the members it uses are destroyed.
+    std::jthread worker_;
+};
+
+}  // namespace georoute
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+
+#include "georoute/graph.hpp"
+
+namespace georoute {
+
+// Precompiled binary image of a Graph, for processes that must start fast
+// (the Lambda handler loads one bundled in its image). Layout, native-endian:
+//
+//   header      magic "GRGS", version, node_count, edge_count, flags
+//   offsets     node_count + 1 u64 prefix sums of the out-degrees
+//   edges       edge_count Edge records {to, base_travel_time, id}, by source node
+//   coordinates node_count {lat, lon} doubles, if flags has the coordinates bit
+//
+// The edge records are the in-memory Edge layout, so loading copies each
+// adjacency list out of the mapping in one piece and parses nothing. Edge ids
+// are kept, so congestion updates address the same edges as with the JSON
+// graph the image was built from.
+
+// Throws std::runtime_error if the file cannot be written.
+void write_graph_snapshot(const Graph& graph, const std::string& path);
+
+// Maps the file and reads it front to back, so pages are faulted in as the
+// adjacency lists are copied rather than read into a buffer first. Throws
+// std::runtime_error if the file cannot be read or is not a well-formed image,
+// std::invalid_argument if its edges or coordinates are out of range.
+[[nodiscard]] Graph load_graph_snapshot(const std::string& path);
+
+// True when the file starts with the snapshot magic; false if it does not or
+// cannot be read.
+[[nodiscard]] bool is_graph_snapshot(const std::string& path);
+
+}  // namespace georoute
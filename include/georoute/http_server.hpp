@@ -1,18 +1,49 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <stop_token>
 #include <string>
 
 namespace georoute {
 
+class CongestionWriter;
 class GeoRouteEngine;
+class GraphReloader;
 
 struct HttpServerOptions {
     std::string host{"0.0.0.0"};
     std::uint16_t port{8080};
+    // Default search budget for route requests (0 = unlimited). Requests may
+    // pass timeout_ms / max_settled_nodes to tighten, but not loosen, these.
+    std::chrono::milliseconds route_timeout{0};
+    std::uint32_t max_settled_nodes{0};
+    // Larger route batches are rejected with 413.
+    std::size_t max_route_batch_size{1000};
+    // Connection workers; 0 sizes the pool from the engine at twice its
+    // query workers (at least 4), since idle keep-alive connections hold one.
+    std::size_t worker_threads{0};
+    // Accepted connections that may wait for a worker. Past this, requests
+    // are answered 503 at once; 0 queues without bound.
+    std::size_t max_queued_connections{64};
+    // Requests served per connection before it is closed, and how long an
+    // idle keep-alive connection holds its worker.
+    std::size_t keep_alive_max_count{100};
+    std::chrono::seconds keep_alive_timeout{5};
+    std::chrono::milliseconds read_timeout{5000};
+    std::chrono::milliseconds write_timeout{5000};
+    // Requesting a stop makes run_http_server return. The server app never
+    // sets it; in-process benchmarks do.
+    std::stop_token stop_token{};
 };
 
-int run_http_server(GeoRouteEngine& engine, const HttpServerOptions& options);
+// Congestion updates posted to the server are queued on writer; graph
+// reloads requested through the admin endpoint go through reloader.
+int run_http_server(GeoRouteEngine& engine,
+                    CongestionWriter& writer,
+                    GraphReloader& reloader,
+                    const HttpServerOptions& options);
 
 }  // namespace georoute
 
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace georoute {
+
+struct HttpWorkerPoolStats {
+    std::size_t threads{0};
+    // Jobs running on a worker / waiting for one.
+    std::size_t active{0};
+    std::size_t queued{0};
+    std::size_t max_queued{0};
+    std::uint64_t accepted_total{0};
+    // Jobs handed to the shed thread because the queue was full.
+    std::uint64_t shed_total{0};
+    // Jobs refused outright because the shed queue was full as well.
+    std::uint64_t dropped_total{0};
+};
+
+// Fixed pool of HTTP connection workers in front of a bounded queue. The
+// HTTP server submits one job per accepted connection. When max_queued jobs
+// are already waiting, the job runs on a single shed thread instead, where
+// shedding() is true, so the server can answer with a fast 503 rather than
+// letting the queue (and latency) grow without bound. The shed thread's own
+// queue holds 16 x max_queued jobs; past that, submit() refuses the job.
+class HttpWorkerPool {
+public:
+    // threads must be at least 1; max_queued == 0 leaves the queue unbounded
+    // and never sheds.
+    HttpWorkerPool(std::size_t threads, std::size_t max_queued);
+    HttpWorkerPool(const HttpWorkerPool&) = delete;
+    HttpWorkerPool& operator=(const HttpWorkerPool&) = delete;
+    HttpWorkerPool(HttpWorkerPool&&) = delete;
+    HttpWorkerPool& operator=(HttpWorkerPool&&) = delete;
+    ~HttpWorkerPool();
+
+    // False if the job was not queued; the caller then owns the cleanup.
+    bool submit(std::function<void()> job);
+    // Refuses new jobs, runs every queued one, joins. Idempotent.
+    void shutdown();
+
+    [[nodiscard]] HttpWorkerPoolStats stats() const;
+
+    // True on the shed thread while it runs a job.
+    [[nodiscard]] static bool shedding() noexcept;
+
+private:
+    struct Lane {
+        mutable std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<std::function<void()>> jobs;
+        std::vector<std::thread> threads;
+        bool stopping{false};
+    };
+
+    static bool push(Lane& lane, std::function<void()>& job, std::size_t max_queued);
+    void run(Lane& lane, bool shed);
+
+    std::size_t max_queued_;
+    Lane workers_;
+    Lane shed_;
+    std::atomic<std::size_t> active_{0};
+    std::atomic<std::uint64_t> accepted_{0};
+    std::atomic<std::uint64_t> shed_total_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+};
+
+}  // namespace georoute
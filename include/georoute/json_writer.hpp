@@ -0,0 +1,86 @@
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace georoute {
+
+// Appends compact JSON to a caller-owned string, so one buffer can serve many
+// responses. Numbers go through std::to_chars: integers directly, floating
+// point in shortest round-trip form (non-finite values become null). Commas
+// are inserted automatically; inside an object every value must follow a
+// key(), which is not checked.
+class JsonWriter {
+public:
+    static constexpr std::size_t max_depth = 64;
+
+    explicit JsonWriter(std::string& out) noexcept : out_(out) {}
+
+    JsonWriter& begin_object();
+    JsonWriter& end_object();
+    JsonWriter& begin_array();
+    JsonWriter& end_array();
+
+    JsonWriter& key(std::string_view name);
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(const char* text) { return value(std::string_view{text}); }
+    JsonWriter& value(bool flag);
+    JsonWriter& value(double number);
+    JsonWriter& value(float number);
+    JsonWriter& null();
+
+    template <std::integral Integer>
+        requires(!std::same_as<Integer, bool>)
+    JsonWriter& value(Integer number) {
+        separator();
+        char digits[24];
+        const auto end = std::to_chars(digits, digits + sizeof(digits), number).ptr;
+        out_.append(digits, end);
+        return *this;
+    }
+
+    // A whole array of node ids (or any unsigned 32-bit values), formatted in
+    // place after one resize of the output.
+    JsonWriter& value(std::span<const std::uint32_t> numbers);
+
+    // A string whose characters append(std::string&) writes straight into the
+    // output, escaped afterwards only if it produced any character that needs
+    // it. For encoded paths, which are mostly or entirely plain ASCII.
+    template <typename Append>
+    JsonWriter& string_from(Append&& append) {
+        separator();
+        out_ += '"';
+        const auto start = out_.size();
+        append(out_);
+        escape_from(start);
+        out_ += '"';
+        return *this;
+    }
+
+    // key(name).value(v)
+    template <typename Value>
+    JsonWriter& field(std::string_view name, const Value& v) {
+        return key(name).value(v);
+    }
+
+private:
+    void separator();
+    void open(char bracket);
+    void close(char bracket);
+    void write_string(std::string_view text);
+    void write_escaped(std::string_view text);
+    void escape_from(std::size_t start);
+
+    std::string& out_;
+    // Bit d is set once the container at depth d has an element.
+    std::uint64_t has_items_{0};
+    std::size_t depth_{0};
+    bool after_key_{false};
+};
+
+}  // namespace georoute
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace httplib {
+class Client;
+}
+
+namespace georoute {
+
+class GeoRouteEngine;
+
+struct LambdaOptions {
+    // host:port of the Runtime API (AWS_LAMBDA_RUNTIME_API).
+    std::string runtime_api{};
+    // Graph image written by georoute_cli --write-snapshot (GEOROUTE_GRAPH_SNAPSHOT,
+    // default $LAMBDA_TASK_ROOT/graph.snapshot).
+    std::string graph_snapshot{};
+    // CongestionIndex kind (GEOROUTE_CONGESTION_INDEX).
+    std::string congestion_index{"segment_tree"};
+    // Default search budget, tightened per event like the HTTP server's
+    // (GEOROUTE_ROUTE_TIMEOUT_MS, GEOROUTE_MAX_SETTLED_NODES; 0 = unlimited).
+    std::chrono::milliseconds route_timeout{0};
+    std::uint32_t max_settled_nodes{0};
+    // Invocations to answer before returning; 0 runs until the process is
+    // frozen or killed, as Lambda expects. Local harnesses set it.
+    std::size_t max_invocations{0};
+};
+
+// One event handed out by GET /runtime/invocation/next.
+struct LambdaInvocation {
+    std::string request_id{};
+    std::string event{};
+    // Lambda-Runtime-Deadline-Ms as a steady_clock time; max when absent.
+    std::chrono::steady_clock::time_point deadline{std::chrono::steady_clock::time_point::max()};
+};
+
+// Answers route events against a warm engine. Two event shapes are accepted:
+//
+//   direct invoke    the POST /api/v1/route body; the payload is that
+//                    endpoint's response body
+//   API Gateway      a proxy event (REST or HTTP API) whose "body" is the
+//                    POST /api/v1/route body; the payload is a proxy response
+//                    {statusCode, headers, body} with the same status codes
+//
+// Searches stop at the invocation deadline (less a margin for posting the
+// response) if that comes before the route timeout.
+class LambdaHandler {
+public:
+    static constexpr std::chrono::milliseconds deadline_margin{50};
+
+    LambdaHandler(GeoRouteEngine& engine, std::chrono::milliseconds route_timeout, std::uint32_t max_settled_nodes);
+
+    // Throws std::invalid_argument when a direct event is not a valid route
+    // request, and std::out_of_range for an unknown node id or an epoch no
+    // longer retained; the runtime reports either as an invocation error.
+    // Proxy events never throw for bad input; they get a 400 response.
+    [[nodiscard]] std::string handle(const LambdaInvocation& invocation);
+
+private:
+    // Writes the route response body for request_body and returns its HTTP
+    // status.
+    int route(std::string_view request_body,
+              std::chrono::steady_clock::time_point deadline,
+              std::string& body);
+
+    GeoRouteEngine& engine_;
+    std::chrono::milliseconds route_timeout_;
+    std::uint32_t max_settled_nodes_;
+};
+
+// Client for the Lambda Runtime API (2018-06-01) over one keep-alive HTTP
+// connection. Calls throw std::runtime_error if the API cannot be reached or
+// rejects the call.
+class LambdaRuntimeClient {
+public:
+    explicit LambdaRuntimeClient(const std::string& runtime_api);
+    LambdaRuntimeClient(const LambdaRuntimeClient&) = delete;
+    LambdaRuntimeClient& operator=(const LambdaRuntimeClient&) = delete;
+    ~LambdaRuntimeClient();
+
+    // Blocks until the next invocation arrives.
+    [[nodiscard]] LambdaInvocation next();
+    void respond(const std::string& request_id, std::string_view payload);
+    void fail(const std::string& request_id, std::string_view error_type, std::string_view message);
+    // Reports a failure before the first invocation; Lambda then discards the
+    // execution environment.
+    void fail_init(std::string_view error_type, std::string_view message);
+
+private:
+    void post(const std::string& path, std::string_view body, const char* caller);
+
+    std::unique_ptr<httplib::Client> client_;
+};
+
+// Reads LambdaOptions from the environment variables named above. Throws
+// std::invalid_argument or std::out_of_range for a malformed number.
+[[nodiscard]] LambdaOptions lambda_options_from_env();
+
+// Loads the graph snapshot once (the cold start), then answers invocations
+// with the same engine until max_invocations. Returns the process exit code:
+// non-zero if the runtime API is unset or unreachable, or the graph fails to
+// load (reported through fail_init).
+int run_lambda(const LambdaOptions& options);
+
+// Entry point of the georoute_lambda bootstrap: run_lambda(lambda_options_from_env()).
+int lambda_entry_point();
+
+}  // namespace georoute
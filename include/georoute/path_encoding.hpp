@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "georoute/graph.hpp"
+#include "georoute/types.hpp"
+
+namespace georoute {
+
+// How a route response carries its path.
+enum class PathEncoding : std::uint8_t {
+    // JSON array of node ids (the default).
+    array,
+    // Node ids as delta-zigzag varints, base64 encoded (see append_varint_path).
+    varint,
+    // Node coordinates as an encoded polyline (see append_polyline).
+    polyline,
+};
+
+// "array", "varint" or "polyline"; throws std::invalid_argument otherwise.
+[[nodiscard]] PathEncoding parse_path_encoding(std::string_view name);
+[[nodiscard]] const char* path_encoding_name(PathEncoding encoding) noexcept;
+
+// Each id minus the previous one (the first minus 0), zigzag mapped so small
+// steps either way stay small, as LEB128 varints, then standard base64 with
+// padding. Neighbouring nodes of a road graph usually have nearby ids, so most
+// steps take one byte instead of the five to eleven of a JSON array element.
+// Writes straight from nodes into out after one resize.
+void append_varint_path(std::string& out, std::span<const node_id> nodes);
+// Inverse of append_varint_path; throws std::invalid_argument on malformed input.
+[[nodiscard]] std::vector<node_id> decode_varint_path(std::string_view encoded);
+
+// Google's encoded polyline format at 1e-5 degree precision, lat before lon.
+// Every node must have a coordinate. The output can contain '\', so it must be
+// escaped inside a JSON string.
+void append_polyline(std::string& out, std::span<const node_id> nodes, std::span<const Coordinate> coordinates);
+// Inverse of append_polyline, rounded to 1e-5 degrees; throws
+// std::invalid_argument on malformed input.
+[[nodiscard]] std::vector<Coordinate> decode_polyline(std::string_view encoded);
+
+}  // namespace georoute
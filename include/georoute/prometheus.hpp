@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "georoute/engine_stats.hpp"
+
+namespace georoute {
+
+using PrometheusLabels = std::initializer_list<std::pair<std::string_view, std::string_view>>;
+
+// Appends the Prometheus text exposition format (version 0.0.4) to a
+// caller-owned string. Only runs when the endpoint is scraped; recording stays
+// in the lock-free histograms and counters it reads.
+class PrometheusWriter {
+public:
+    static constexpr std::string_view content_type = "text/plain; version=0.0.4; charset=utf-8";
+
+    explicit PrometheusWriter(std::string& out) noexcept : out_(out) {}
+
+    // # HELP and # TYPE lines; call once per metric name, before its samples.
+    PrometheusWriter& family(std::string_view name, std::string_view type, std::string_view help);
+
+    PrometheusWriter& sample(std::string_view name, double value, PrometheusLabels labels = {});
+    PrometheusWriter& sample(std::string_view name, std::uint64_t value, PrometheusLabels labels = {});
+
+    // _bucket (cumulative, with le), _sum and _count samples. Bounds and the
+    // sum are divided by unit, e.g. 1e9 to export nanoseconds as seconds.
+    PrometheusWriter& histogram(std::string_view name,
+                                const MetricHistogramSnapshot& histogram,
+                                double unit = 1.0,
+                                PrometheusLabels labels = {});
+
+private:
+    void write_name(std::string_view name, std::string_view suffix, PrometheusLabels labels, std::string_view le);
+    void write_value(double value);
+    void write_value(std::uint64_t value);
+
+    std::string& out_;
+};
+
+// Folds the engine's fine log-linear histogram into fixed bucket bounds (in
+// nanoseconds). A fine bucket counts towards a bound once its upper edge is
+// at or below it, so boundaries are resolved to the ~3% width of the fine
+// buckets.
+[[nodiscard]] MetricHistogramSnapshot fold_latency_histogram(const LatencyHistogramSnapshot& histogram,
+                                                             std::span<const std::uint64_t> upper_bounds_ns);
+
+// 50 us to 30 s, for request and search latencies.
+[[nodiscard]] std::span<const std::uint64_t> prometheus_latency_bounds_ns() noexcept;
+
+}  // namespace georoute
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "georoute/dijkstra.hpp"
+
+namespace georoute {
+
+// Fixed pool of query workers, each with its own SearchScratch. Every worker
+// owns a task deque: tasks submitted from a worker go to the back of its own
+// deque and are taken LIFO (cache-warm), tasks submitted from other threads
+// are dealt round-robin, and a worker whose deque is empty steals from the
+// front (oldest end) of the others before going to sleep.
+class QueryExecutor {
+public:
+    class Task {
+    public:
+        virtual ~Task() = default;
+        virtual void run(SearchScratch& scratch) = 0;
+    };
+
+    // threads == 0 starts one worker per hardware thread (at least one).
+    explicit QueryExecutor(std::size_t threads = 0);
+    QueryExecutor(const QueryExecutor&) = delete;
+    QueryExecutor& operator=(const QueryExecutor&) = delete;
+    QueryExecutor(QueryExecutor&&) = delete;
+    QueryExecutor& operator=(QueryExecutor&&) = delete;
+    // Runs every task already submitted, then joins the workers.
+    ~QueryExecutor();
+
+    void submit(std::unique_ptr<Task> task);
+
+    // fn is invoked as fn(SearchScratch&) on a worker thread. Exceptions that
+    // escape a task are logged and dropped.
+    template <typename Function>
+    void submit(Function&& fn) {
+        submit(std::unique_ptr<Task>{
+            std::make_unique<FunctionTask<std::decay_t<Function>>>(std::forward<Function>(fn))});
+    }
+
+    [[nodiscard]] std::size_t thread_count() const noexcept;
+    // Tasks a worker took from another worker's deque.
+    [[nodiscard]] std::uint64_t steals() const noexcept;
+    // True when called from one of this executor's worker threads.
+    [[nodiscard]] bool on_worker_thread() const noexcept;
+
+private:
+    template <typename Function>
+    class FunctionTask final : public Task {
+    public:
+        explicit FunctionTask(Function fn) : fn_(std::move(fn)) {}
+        void run(SearchScratch& scratch) override { fn_(scratch); }
+
+    private:
+        Function fn_;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::unique_ptr<Task>> tasks;
+        SearchScratch scratch;
+        std::thread thread;
+    };
+
+    void run_worker(std::size_t index);
+    std::unique_ptr<Task> take(std::size_t index);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<std::size_t> next_worker_{0};
+    std::atomic<std::size_t> pending_{0};
+    std::atomic<std::size_t> sleepers_{0};
+    std::atomic<std::uint64_t> steals_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_cv_;
+    bool stopping_{false};
+};
+
+}  // namespace georoute
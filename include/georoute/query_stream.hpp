@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string_view>
+#include <variant>
+
+#include "georoute/engine.hpp"
+
+namespace georoute {
+
+// One entry of a queries file: a route, or a congestion update that applies
+// to every route after it.
+using QueryStreamItem = std::variant<RouteQuery, CongestionUpdate>;
+
+// Queries file layouts:
+//
+//   json    an array of {"source", "target"} route objects and
+//           {"edge_start", "edge_end", "factor"} update objects
+//   csv     "source,target" route rows and "edge_start,edge_end,factor"
+//           update rows; blank lines, '#' comments and a header are skipped
+//   binary  little-endian u32 {source, target} pairs, routes only
+enum class QueryFileFormat : std::uint8_t { json, csv, binary };
+
+// One line per route, in input order.
+enum class RouteOutputFormat : std::uint8_t { csv, ndjson };
+
+// "json", "csv" or "bin"; throws std::invalid_argument otherwise.
+[[nodiscard]] QueryFileFormat parse_query_file_format(std::string_view name);
+// From the extension: .json, .csv, or .bin. Throws std::invalid_argument for
+// anything else.
+[[nodiscard]] QueryFileFormat query_file_format_for(std::string_view path);
+// "csv" or "ndjson"; throws std::invalid_argument otherwise.
+[[nodiscard]] RouteOutputFormat parse_route_output_format(std::string_view name);
+
+// Reads input as it arrives and hands each item to sink in file order, so a
+// file of any size is read in constant memory. Throws std::invalid_argument,
+// naming the item, for malformed input.
+void read_query_stream(std::istream& input,
+                       QueryFileFormat format,
+                       const std::function<void(const QueryStreamItem&)>& sink);
+
+struct QueryStreamOptions {
+    RouteOutputFormat output_format{RouteOutputFormat::csv};
+    // Routes handed to route_batch at once.
+    std::size_t chunk_size{4096};
+    bool include_path{false};
+    // Applies to each route; see GeoRouteEngine::route_batch.
+    SearchBudget budget{};
+};
+
+struct QueryStreamSummary {
+    std::size_t routes{0};
+    std::size_t unreachable{0};
+    // Routes cut short by the search budget.
+    std::size_t budget_exceeded{0};
+    std::size_t updates{0};
+    std::size_t chunks{0};
+    double elapsed_ms{0.0};
+    // Time the reading thread waited for a chunk's routes; close to
+    // elapsed_ms when routing, not reading and writing, is the bottleneck.
+    double route_wait_ms{0.0};
+
+    [[nodiscard]] double routes_per_second() const noexcept;
+};
+
+// Runs a queries file through engine. Consecutive routes are gathered into
+// chunks and spread over the engine's workers with route_batch, while the
+// next chunk is read. An update waits for every route before it and is
+// applied before any route after it, so each route sees exactly the updates
+// listed above it. Results are written to output in input order, a chunk at
+// a time. Throws std::invalid_argument for malformed input and
+// std::out_of_range, naming the item, for a node id outside the graph.
+QueryStreamSummary run_query_stream(GeoRouteEngine& engine,
+                                    std::istream& input,
+                                    QueryFileFormat format,
+                                    std::ostream& output,
+                                    const QueryStreamOptions& options = {});
+
+}  // namespace georoute
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+namespace georoute {
+
+// Bump allocator for request-scoped data (parsed request fields, the route
+// path). Allocations inside a Scope come out of one buffer and are released
+// together when the Scope ends; the buffer is kept for the next request. If a
+// request overflows the buffer, the overflow comes from the heap and the
+// buffer is grown to the largest request seen so far, up to max_capacity, so
+// a thread settles at zero heap allocations per request. Requests larger than
+// max_capacity keep overflowing to the heap: one huge batch must not pin a
+// huge buffer on every thread for the life of the process.
+class RequestArena {
+public:
+    static constexpr std::size_t default_capacity = 16 * 1024;
+    static constexpr std::size_t default_max_capacity = 1024 * 1024;
+
+    // Releases everything allocated from the arena when it goes out of scope.
+    class Scope {
+    public:
+        explicit Scope(RequestArena& arena) noexcept : arena_(arena) {}
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope() { arena_.reset(); }
+
+        [[nodiscard]] std::pmr::memory_resource* resource() noexcept { return arena_.resource(); }
+
+    private:
+        RequestArena& arena_;
+    };
+
+    // max_capacity below capacity is raised to capacity.
+    explicit RequestArena(std::size_t capacity = default_capacity,
+                          std::size_t max_capacity = default_max_capacity);
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+    ~RequestArena();
+
+    [[nodiscard]] std::pmr::memory_resource* resource() noexcept;
+    // Releases every allocation and grows the buffer (up to max_capacity) if
+    // the last request overflowed.
+    void reset();
+
+    [[nodiscard]] std::size_t capacity() const noexcept;
+    [[nodiscard]] std::size_t max_capacity() const noexcept;
+    // Heap allocations made because a request did not fit the buffer.
+    [[nodiscard]] std::uint64_t overflow_allocations() const noexcept;
+
+    // The calling thread's arena.
+    static RequestArena& local();
+
+private:
+    // Heap fallback that remembers how many bytes a request overflowed by.
+    class Overflow final : public std::pmr::memory_resource {
+    public:
+        std::size_t bytes{0};
+        std::uint64_t allocations{0};
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+    std::size_t capacity_;
+    std::size_t max_capacity_;
+    std::unique_ptr<std::byte[]> buffer_;
+    Overflow overflow_;
+    std::optional<std::pmr::monotonic_buffer_resource> resource_;
+};
+
+}  // namespace georoute
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string_view>
+
+#include "georoute/engine.hpp"
+#include "georoute/json_writer.hpp"
+#include "georoute/path_encoding.hpp"
+
+namespace georoute {
+
+// Bodies of the HTTP route responses, written from RouteResponse straight into
+// a JsonWriter. Each function writes fields into an object the caller has
+// opened, so endpoints can add their own fields around them.
+
+[[nodiscard]] const char* route_status_name(RouteStatus status) noexcept;
+
+// src, dst, distance, eta_ms, path (unless include_path is false),
+// reachable, epoch and stats of a completed search. With a path_encoding
+// other than array, path is an encoded string and a path_encoding field names
+// the format. Throws std::invalid_argument for polyline when the graph that
+// computed the route has no coordinates.
+void write_route_fields(JsonWriter& out,
+                        node_id source,
+                        node_id target,
+                        const RouteResponse& response,
+                        bool include_path = true,
+                        PathEncoding path_encoding = PathEncoding::array);
+
+// "stats": {"compute_us", "expanded_nodes"}
+void write_route_stats(JsonWriter& out, const RouteResponse& response);
+
+// {"error": message}
+void write_error(JsonWriter& out, std::string_view message);
+
+}  // namespace georoute
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+#include "georoute/engine.hpp"
+#include "georoute/types.hpp"
+
+namespace georoute {
+
+// Searches that must find the same route: same graph, same congestion epoch,
+// same endpoints and node cap. Deadlines are deliberately not part of it.
+struct RouteFlightKey {
+    const void* graph{nullptr};
+    std::uint64_t epoch{0};
+    node_id source{0};
+    node_id target{0};
+    std::uint32_t max_settled_nodes{0};
+
+    friend bool operator==(const RouteFlightKey&, const RouteFlightKey&) = default;
+};
+
+// Single-flight deduplication of identical concurrent route searches. The
+// first caller for a key (the leader) runs its search; callers arriving with
+// the same key while it runs wait and receive a copy of the leader's response,
+// with RouteResponse::coalesced set. Only complete results are shared: if the
+// leader's own budget cuts its search short, or the search throws, every
+// follower runs its own. A follower stops waiting at its own deadline.
+//
+// In-flight searches live in shard_count mutex-guarded maps keyed by a hash of
+// the key, so a caller with no match pays one short lock to register and one
+// to deregister. The leader copies its path only when someone joined.
+class RouteCoalescer {
+public:
+    static constexpr std::size_t shard_count = 16;
+
+    RouteCoalescer();
+    RouteCoalescer(const RouteCoalescer&) = delete;
+    RouteCoalescer& operator=(const RouteCoalescer&) = delete;
+    ~RouteCoalescer();
+
+    // Returns compute() for a leader, otherwise the shared response with its
+    // path copied into resource. compute() must return a RouteResponse.
+    template <typename Compute>
+    RouteResponse run(const RouteFlightKey& key,
+                      std::chrono::steady_clock::time_point deadline,
+                      std::pmr::memory_resource* resource,
+                      Compute&& compute) {
+        auto ticket = join(key);
+        if (!ticket.leader) {
+            if (auto shared = wait(*ticket.flight, deadline)) {
+                return copy_shared(*shared, resource);
+            }
+            return compute();
+        }
+        auto response = [&] {
+            try {
+                return compute();
+            } catch (...) {
+                finish(key, ticket.flight, nullptr);
+                throw;
+            }
+        }();
+        finish(key, ticket.flight, &response);
+        return response;
+    }
+
+    // Searches currently registered as leaders, and callers waiting on them.
+    [[nodiscard]] std::size_t in_flight() const;
+    [[nodiscard]] std::size_t waiting() const;
+
+private:
+    struct Flight;
+    struct Shard;
+    struct Ticket {
+        std::shared_ptr<Flight> flight;
+        bool leader{false};
+    };
+
+    Ticket join(const RouteFlightKey& key);
+    // Deregisters the flight and hands response (null when it cannot be
+    // shared) to any followers.
+    void finish(const RouteFlightKey& key, const std::shared_ptr<Flight>& flight, const RouteResponse* response);
+    // Null when the leader had nothing to share or the deadline passed first.
+    [[nodiscard]] static std::shared_ptr<const RouteResponse> wait(Flight& flight,
+                                                                   std::chrono::steady_clock::time_point deadline);
+    [[nodiscard]] static RouteResponse copy_shared(const RouteResponse& shared, std::pmr::memory_resource* resource);
+    Shard& shard_for(const RouteFlightKey& key) const noexcept;
+
+    std::unique_ptr<Shard[]> shards_;
+};
+
+}  // namespace georoute
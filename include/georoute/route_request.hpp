@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "georoute/path_encoding.hpp"
+#include "georoute/types.hpp"
+
+namespace georoute {
+
+// Fields of a POST /api/v1/route body.
+struct RouteRequest {
+    node_id source{0};
+    node_id target{0};
+    std::optional<std::uint64_t> epoch{};
+    std::optional<std::int64_t> timeout_ms{};
+    std::optional<std::uint32_t> max_settled_nodes{};
+    PathEncoding path_encoding{PathEncoding::array};
+};
+
+// Reads the body with nlohmann's SAX interface, so no JSON tree is built.
+// Unknown and nested fields are skipped. Throws std::invalid_argument for
+// malformed JSON, a missing source or target, a numeric field that is not a
+// non-negative integer in range (timeout_ms may be negative), or an unknown
+// path_encoding.
+[[nodiscard]] RouteRequest parse_route_request(std::string_view body);
+
+// Search budget for one request: the server defaults (0 = unlimited), each
+// replaced by the request's own limit only if that is tighter. Absent,
+// zero or negative request limits leave the default in place.
+[[nodiscard]] SearchBudget make_request_budget(std::chrono::milliseconds server_timeout,
+                                               std::uint32_t server_max_settled_nodes,
+                                               std::optional<std::int64_t> timeout_ms,
+                                               std::optional<std::uint32_t> max_settled_nodes);
+
+}  // namespace georoute
@@ -1,35 +1,138 @@
 #pragma once
 
-#include <shared_mutex>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
 
 #include <nlohmann/json_fwd.hpp>
 
+#include "georoute/congestion_index.hpp"
+#include "georoute/congestion_snapshot.hpp"
 #include "georoute/dijkstra.hpp"
 #include "georoute/graph.hpp"
-#include "georoute/segment_tree.hpp"
 #include "georoute/types.hpp"
 
 namespace georoute {
 
+inline constexpr std::size_t default_snapshot_history = 64;
+
+// Router settings a graph file may leave out. Only JSON graphs can carry them
+// ("congestion_index", "snapshot_history"); snapshots and DIMACS files always
+// take them from here.
+struct RouterSettings {
+    std::string congestion_index{"segment_tree"};
+    std::size_t snapshot_history{default_snapshot_history};
+};
+
+struct CongestionPublish {
+    std::size_t ranges_written{0};
+    std::uint64_t epoch{0};
+};
+
+// Routes against versioned congestion state. Every update publishes a new
+// CongestionSnapshot epoch; a query pins the snapshot current when it starts,
+// so route queries never wait on writers. Writers are serialized among
+// themselves only.
 class Router {
 public:
-    Router(Graph graph, SegmentTree segment_tree);
+    Router(Graph graph, CongestionIndex congestion);
     Router(const Router&) = delete;
     Router& operator=(const Router&) = delete;
-    Router(Router&&) = delete;
+    Router(Router&& other) noexcept;
     Router& operator=(Router&&) = delete;
     ~Router();
 
-    void apply_congestion_update(std::size_t edge_start, std::size_t edge_end, float factor);
+    // Returns the epoch that contains the update.
+    std::uint64_t apply_congestion_update(std::size_t edge_start, std::size_t edge_end, float factor);
+    // Validates the whole batch, merges overlapping ranges, then publishes
+    // them as a single epoch. ranges_written counts the merged ranges.
+    CongestionPublish apply_congestion_updates(std::span<const CongestionUpdate> updates);
+    // Multiplies scattered edges by their own factors and publishes one epoch.
+    // The congestion index buffers the writes in its overlay; ranges_written
+    // counts the entries flushed into the index by this call.
+    CongestionPublish apply_edge_updates(std::span<const EdgeFactorUpdate> updates);
+    // Current congestion factor of one edge, overlay included.
+    [[nodiscard]] float congestion_factor(edge_id edge) const;
+    // Every edge's congestion factor, indexed by edge id.
+    [[nodiscard]] std::vector<float> congestion_factors() const;
+
     [[nodiscard]] RouteComputation compute_route(node_id source, node_id target) const;
+    // Same search reusing the caller's per-thread scratch space, optionally
+    // cut short by budget (see RouteComputation::status). The path is
+    // allocated from resource.
+    [[nodiscard]] RouteComputation compute_route(
+        node_id source,
+        node_id target,
+        SearchScratch& scratch,
+        const SearchBudget& budget = {},
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+    // Same search against snapshot, which must come from this router's
+    // snapshot(); lets the caller know the epoch before the search runs.
+    [[nodiscard]] RouteComputation compute_route_on(
+        const CongestionSnapshot& snapshot,
+        node_id source,
+        node_id target,
+        SearchScratch& scratch,
+        const SearchBudget& budget = {},
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+    // Routes against a retained past epoch. Throws std::out_of_range if the
+    // epoch is no longer (or not yet) retained.
+    [[nodiscard]] RouteComputation compute_route_at(std::uint64_t epoch, node_id source, node_id target) const;
+    [[nodiscard]] RouteComputation compute_route_at(
+        std::uint64_t epoch,
+        node_id source,
+        node_id target,
+        SearchScratch& scratch,
+        const SearchBudget& budget = {},
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+    [[nodiscard]] std::uint64_t current_epoch() const;
+    [[nodiscard]] std::size_t node_count() const noexcept;
+    [[nodiscard]] std::size_t edge_count() const noexcept;
+    [[nodiscard]] std::shared_ptr<const CongestionSnapshot> snapshot() const;
+    [[nodiscard]] const Graph& graph() const noexcept;
+    // Approximate heap bytes of the graph plus one full cost snapshot; older
+    // epochs share most chunks with it and are not counted.
+    [[nodiscard]] std::size_t memory_bytes() const noexcept;
+    // Number of most recent epochs kept for compute_route_at (at least 1).
+    void set_snapshot_history(std::size_t epochs);
+    // Congestion index kind and snapshot history, e.g. to load the next
+    // version of the graph with the same settings.
+    [[nodiscard]] RouterSettings settings() const;
+
+    static constexpr std::size_t default_snapshot_history = georoute::default_snapshot_history;
 
-    static Router from_json(const nlohmann::json& config);
+    // Fields missing from config fall back to defaults.
+    static Router from_json(const nlohmann::json& config, const RouterSettings& defaults = {});
+    // Loads a graph file in any supported format: a graph snapshot (told by
+    // its magic bytes), a DIMACS .gr file with the .co file next to it if
+    // there is one, or the JSON read by from_json. Settings the file does not
+    // carry come from defaults. Throws std::runtime_error if the file cannot
+    // be read, plus whatever the format's loader throws for malformed content.
+    static Router from_file(const std::string& path, const RouterSettings& defaults = {});
 
 private:
+    void publish(std::shared_ptr<const CongestionSnapshot> next);
+    [[nodiscard]] std::shared_ptr<const CongestionSnapshot> retained_snapshot(std::uint64_t epoch) const;
+
     Graph graph_;
-    SegmentTree congestion_tree_;
-    mutable std::shared_mutex mutex_;
+    // Writer-side factor store; guarded by writer_mutex_.
+    CongestionIndex congestion_;
+#if defined(__cpp_lib_atomic_shared_ptr)
+    std::atomic<std::shared_ptr<const CongestionSnapshot>> current_;
+#else
+    std::shared_ptr<const CongestionSnapshot> current_;
+#endif
+    std::deque<std::shared_ptr<const CongestionSnapshot>> history_;
+    std::size_t history_limit_{default_snapshot_history};
+    mutable std::mutex writer_mutex_;
+    mutable std::mutex history_mutex_;
 };
 
 }  // namespace georoute
-
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <cstddef>
+#include <span>
 #include <vector>
 
 #include <cstdint>
 
+#include "georoute/types.hpp"
+
 namespace georoute {
 
 class SegmentTree {
@@ -12,7 +15,11 @@ public:
     explicit SegmentTree(std::size_t size = 0);
 
     void range_multiply(std::size_t l, std::size_t r, float factor);
+    // Applies sorted, non-overlapping ranges in a single top-down traversal.
+    void range_multiply_batch(std::span<const CongestionUpdate> ranges);
     [[nodiscard]] float point_query(std::size_t idx) const;
+    // Every factor in index order from one traversal, O(n) instead of n point queries.
+    [[nodiscard]] std::vector<float> values() const;
 
     [[nodiscard]] std::size_t size() const noexcept;
 
@@ -23,11 +30,20 @@ private:
                              std::size_t ql,
                              std::size_t qr,
                              float factor);
+    void range_multiply_batch_impl(std::size_t node,
+                                   std::size_t node_l,
+                                   std::size_t node_r,
+                                   std::span<const CongestionUpdate> ranges);
     [[nodiscard]] float point_query_impl(std::size_t node,
                                          std::size_t node_l,
                                          std::size_t node_r,
                                          std::size_t idx,
                                          float accumulated_factor) const;
+    void values_impl(std::size_t node,
+                     std::size_t node_l,
+                     std::size_t node_r,
+                     float accumulated_factor,
+                     std::vector<float>& out) const;
     void apply(std::size_t node, float factor, std::size_t node_l, std::size_t node_r);
     void push(std::size_t node, std::size_t node_l, std::size_t node_r);
 
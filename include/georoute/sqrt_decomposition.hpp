@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "georoute/types.hpp"
+
+namespace georoute {
+
+// Blocked range-multiply / point-query structure. Each element keeps its own
+// factor and every block of block_size() elements shares a lazy block factor,
+// so a range update multiplies at most two partial blocks element-wise (AVX2
+// when available) plus one factor per covered block, and a point query is two
+// loads.
+class SqrtDecomposition {
+public:
+    explicit SqrtDecomposition(std::size_t size = 0);
+
+    void range_multiply(std::size_t l, std::size_t r, float factor);
+    void range_multiply_batch(std::span<const CongestionUpdate> ranges);
+    [[nodiscard]] float point_query(std::size_t idx) const;
+    // Every factor in index order.
+    [[nodiscard]] std::vector<float> values() const;
+
+    [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] std::size_t block_size() const noexcept;
+
+    // True when the library was built with the AVX2 multiply kernel.
+    [[nodiscard]] static bool uses_avx2() noexcept;
+
+private:
+    std::size_t n_{0};
+    std::size_t block_shift_{0};
+    std::vector<float> values_{};
+    std::vector<float> block_factors_{};
+};
+
+}  // namespace georoute
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <memory_resource>
 #include <vector>
 
 namespace georoute {
@@ -9,7 +13,9 @@ using node_id = std::uint32_t;
 using edge_id = std::uint32_t;
 
 struct RouteResult {
-    std::vector<node_id> nodes{};
+    // Allocated from the memory resource passed to the search (the default
+    // heap resource unless the caller supplies a request arena).
+    std::pmr::vector<node_id> nodes{};
     float total_travel_time{0.0F};
     bool reachable{false};
 };
@@ -20,9 +26,60 @@ struct RouteStats {
     std::uint32_t visited_nodes{0};
 };
 
+// How a search ended. Budget-limited searches return an empty, unreachable
+// RouteResult; they say nothing about whether a route exists.
+enum class RouteStatus {
+    complete,
+    deadline_exceeded,
+    node_budget_exceeded,
+};
+
+// Limits for one search; the defaults impose none. The node cap is exact;
+// the deadline is compared every clock_check_interval settled nodes, so a
+// search can run past it by that many pops.
+struct SearchBudget {
+    static constexpr std::uint32_t clock_check_interval = 256;
+
+    std::chrono::steady_clock::time_point deadline{std::chrono::steady_clock::time_point::max()};
+    // 0 = unlimited.
+    std::uint32_t max_settled_nodes{0};
+
+    // Budget with a deadline timeout from now (0 = none) and an optional node cap.
+    [[nodiscard]] static SearchBudget within(std::chrono::milliseconds timeout, std::uint32_t max_settled_nodes = 0) {
+        SearchBudget budget;
+        if (timeout.count() > 0) {
+            budget.deadline = std::chrono::steady_clock::now() + timeout;
+        }
+        budget.max_settled_nodes = max_settled_nodes;
+        return budget;
+    }
+};
+
 struct RouteComputation {
     RouteResult result;
     RouteStats stats;
+    RouteStatus status{RouteStatus::complete};
+    // Congestion version the search ran against.
+    std::uint64_t congestion_epoch{0};
+};
+
+// Congestion factors multiply edge costs, so they must be finite and
+// non-negative for routes to keep non-negative costs.
+[[nodiscard]] inline bool valid_congestion_factor(float factor) noexcept {
+    return std::isfinite(factor) && factor >= 0.0F;
+}
+
+// Multiplies the congestion factor of edges [edge_start, edge_end] by factor.
+struct CongestionUpdate {
+    std::size_t edge_start;
+    std::size_t edge_end;
+    float factor;
+};
+
+// Multiplies the congestion factor of a single edge by factor.
+struct EdgeFactorUpdate {
+    edge_id edge;
+    float factor;
 };
 
 }  // namespace georoute
@@ -1,15 +1,36 @@
 #include "georoute/app.hpp"
 
-#include <fstream>
+#include <chrono>
+#include <ctime>
 #include <iostream>
 
-#include <nlohmann/json.hpp>
+#include <pthread.h>
+#include <signal.h>
 
+#include "georoute/binary_server.hpp"
+#include "georoute/congestion_feed.hpp"
+#include "georoute/congestion_journal.hpp"
+#include "georoute/congestion_writer.hpp"
 #include "georoute/engine.hpp"
+#include "georoute/graph_reloader.hpp"
 #include "georoute/http_server.hpp"
 
 namespace georoute {
 
+namespace {
+
+// How often the signal thread checks for shutdown between signals.
+constexpr std::timespec signal_poll_interval{0, 200'000'000};
+
+sigset_t reload_signals() {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+    return signals;
+}
+
+}  // namespace
+
 GeoRouteApp::GeoRouteApp(AppConfig config)
     : config_(std::move(config)) {}
 
@@ -22,25 +43,85 @@ bool GeoRouteApp::initialize() {
         return true;
     }
     
-    std::ifstream input{config_.graph_path};
-    if (!input) {
-        std::cerr << "Failed to open graph file: " << config_.graph_path << '\n';
-        return false;
-    }
-    
+    const auto start = std::chrono::steady_clock::now();
+    // Block SIGHUP before any thread starts so every thread inherits the mask
+    // and only the signal thread's sigtimedwait receives it.
+    const auto signals = reload_signals();
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
     try {
-        nlohmann::json data;
-        input >> data;
-        engine_ = std::make_unique<GeoRouteEngine>(GeoRouteEngine::from_json(data));
+        engine_ = std::make_unique<GeoRouteEngine>(Router::from_file(config_.graph_path));
+        engine_->set_route_coalescing(config_.route_coalescing);
+        if (!config_.state_dir.empty()) {
+            restore_congestion_state();
+        }
+        writer_ = std::make_unique<CongestionWriter>(
+            *engine_, CongestionWriterOptions{config_.congestion_coalesce_window});
+        const auto feed_format = parse_feed_format(config_.congestion_feed_format);
+        for (const auto& spec : config_.congestion_feeds) {
+            feeds_.push_back(std::make_unique<CongestionFeed>(*writer_, engine_->edge_count(),
+                                                              FeedSource::parse(spec, feed_format)));
+            std::cout << "Ingesting " << config_.congestion_feed_format << " congestion feed from: " << spec << '\n';
+        }
+        reloader_ = std::make_unique<GraphReloader>(*engine_, config_.graph_path);
+        signal_thread_ = std::jthread{[this](std::stop_token stop) { watch_reload_signal(stop); }};
         initialized_ = true;
-        std::cout << "GeoRoute engine initialized with graph from: " << config_.graph_path << '\n';
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "GeoRoute engine initialized with graph from: " << config_.graph_path << " (ready in "
+                  << elapsed.count() << " ms)\n";
         return true;
     } catch (const std::exception& ex) {
         std::cerr << "Failed to initialize engine: " << ex.what() << '\n';
+        feeds_.clear();
+        writer_.reset();
+        if (engine_) {
+            engine_->set_congestion_journal(nullptr);
+        }
+        journal_.reset();
         return false;
     }
 }
 
+void GeoRouteApp::restore_congestion_state() {
+    const auto start = std::chrono::steady_clock::now();
+    auto recovered = CongestionJournal::recover(config_.state_dir, engine_->edge_count());
+    const auto runs = factor_runs(recovered.factors);
+    if (!runs.empty()) {
+        engine_->apply_congestion_updates(runs);
+        engine_->reset_stats();
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Restored congestion state from " << config_.state_dir << ": "
+              << (recovered.from_snapshot ? "snapshot" : "no snapshot") << " + " << recovered.replayed_batches
+              << " logged batches (" << recovered.replayed_updates << " updates) in " << elapsed.count() << " ms\n";
+
+    journal_ = std::make_unique<CongestionJournal>(
+        CongestionJournalOptions{config_.state_dir, config_.snapshot_interval}, std::move(recovered));
+    engine_->set_congestion_journal(journal_.get());
+}
+
+void GeoRouteApp::watch_reload_signal(std::stop_token stop) {
+    const auto signals = reload_signals();
+    while (!stop.stop_requested()) {
+        if (sigtimedwait(&signals, nullptr, &signal_poll_interval) != SIGHUP) {
+            continue;
+        }
+        try {
+            const auto report = reloader_->reload();
+            if (!report) {
+                std::cerr << "SIGHUP ignored: graph reload already in progress\n";
+                continue;
+            }
+            std::cout << "Reloaded graph from " << report->path << ": " << report->swap.node_count << " nodes, "
+                      << report->swap.edge_count << " edges, loaded in " << report->load_ms << " ms, swapped in "
+                      << report->swap.swap_time_us << " us"
+                      << (report->swap.congestion_carried ? " (congestion carried over)" : "") << '\n';
+        } catch (const std::exception& ex) {
+            std::cerr << "Graph reload failed, keeping the current graph: " << ex.what() << '\n';
+        }
+    }
+}
+
 int GeoRouteApp::run() {
     if (!initialized_) {
         if (!initialize()) {
@@ -50,13 +131,46 @@ int GeoRouteApp::run() {
     
     std::cout << "Starting GeoRoute server on " << config_.host << ':' << config_.port << '\n';
     
-    HttpServerOptions options{config_.host, config_.port};
-    return run_http_server(*engine_, options);
+    HttpServerOptions options{config_.host,
+                              config_.port,
+                              config_.route_timeout,
+                              config_.max_settled_nodes,
+                              config_.max_route_batch_size};
+    options.worker_threads = config_.http_worker_threads;
+    options.max_queued_connections = config_.http_max_queued_connections;
+    options.keep_alive_max_count = config_.keep_alive_max_count;
+    options.keep_alive_timeout = config_.keep_alive_timeout;
+    options.read_timeout = config_.read_timeout;
+    options.write_timeout = config_.write_timeout;
+    if (config_.binary_port != 0) {
+        try {
+            binary_server_ = std::make_unique<BinaryProtocolServer>(
+                *engine_, *writer_,
+                BinaryServerOptions{config_.host, config_.binary_port, config_.route_timeout,
+                                    config_.max_settled_nodes, config_.max_route_batch_size});
+        } catch (const std::exception& ex) {
+            std::cerr << "Failed to start binary protocol server: " << ex.what() << '\n';
+            return 1;
+        }
+        std::cout << "Serving binary protocol on " << config_.host << ':' << binary_server_->port() << '\n';
+    }
+    return run_http_server(*engine_, *writer_, *reloader_, options);
 }
 
 void GeoRouteApp::shutdown() {
     if (initialized_) {
         std::cout << "Shutting down GeoRoute server...\n";
+        signal_thread_ = std::jthread{};
+        reloader_.reset();
+        binary_server_.reset();
+        // Feeds first so nothing is queued after the writer drains, and the
+        // writer before the journal so its final batch is logged.
+        feeds_.clear();
+        writer_.reset();
+        if (engine_) {
+            engine_->set_congestion_journal(nullptr);
+        }
+        journal_.reset();
         initialized_ = false;
     }
 }
@@ -0,0 +1,192 @@
+#include "georoute/binary_client.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace georoute {
+
+namespace {
+
+std::runtime_error client_error(const char* caller, const std::string& what) {
+    return std::runtime_error{std::string{"BinaryClient::"} + caller + " " + what};
+}
+
+void write_limits(WireWriter& out, const WireRouteOptions& options) {
+    out.write(options.timeout_ms);
+    out.write(options.max_settled_nodes);
+}
+
+std::uint8_t route_flags(const WireRouteOptions& options) {
+    return options.include_path ? wire_flag_include_path : 0;
+}
+
+}  // namespace
+
+BinaryClient::BinaryClient(const std::string& host, std::uint16_t port) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (const int error = ::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses); error != 0) {
+        throw std::runtime_error{"BinaryClient cannot resolve " + host + ": " + ::gai_strerror(error)};
+    }
+    for (auto* address = addresses; address != nullptr; address = address->ai_next) {
+        fd_ = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd_ < 0) {
+            continue;
+        }
+        if (::connect(fd_, address->ai_addr, address->ai_addrlen) == 0) {
+            break;
+        }
+        ::close(fd_);
+        fd_ = -1;
+    }
+    ::freeaddrinfo(addresses);
+    if (fd_ < 0) {
+        throw std::runtime_error{"BinaryClient cannot connect to " + host + ":" + std::to_string(port) + ": " +
+                                 std::strerror(errno)};
+    }
+    const int nodelay = 1;
+    ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+}
+
+BinaryClient::~BinaryClient() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+WireRoute BinaryClient::route(node_id source, node_id target, const WireRouteOptions& options) {
+    send_buffer_.clear();
+    WireWriter out{send_buffer_};
+    const auto frame = out.begin_frame(WireType::route, route_flags(options), next_request_id_);
+    out.write(source);
+    out.write(target);
+    write_limits(out, options);
+    out.end_frame(frame);
+
+    WireReader in{exchange(WireType::route, "route")};
+    return read_route_record(in);
+}
+
+std::vector<WireRoute> BinaryClient::route_batch(std::span<const RouteQuery> queries, const WireRouteOptions& options) {
+    send_buffer_.clear();
+    WireWriter out{send_buffer_};
+    const auto frame = out.begin_frame(WireType::route_batch, route_flags(options), next_request_id_);
+    write_limits(out, options);
+    out.write(static_cast<std::uint32_t>(queries.size()));
+    for (const auto& query : queries) {
+        out.write(query.source);
+        out.write(query.target);
+    }
+    out.end_frame(frame);
+
+    WireReader in{exchange(WireType::route_batch, "route_batch")};
+    std::vector<WireRoute> routes(in.read<std::uint32_t>());
+    for (auto& route : routes) {
+        route = read_route_record(in);
+    }
+    return routes;
+}
+
+WireMatrix BinaryClient::matrix(std::span<const node_id> sources,
+                                std::span<const node_id> targets,
+                                const WireRouteOptions& options) {
+    send_buffer_.clear();
+    WireWriter out{send_buffer_};
+    const auto frame = out.begin_frame(WireType::matrix, 0, next_request_id_);
+    write_limits(out, options);
+    out.write(static_cast<std::uint32_t>(sources.size()));
+    out.write(static_cast<std::uint32_t>(targets.size()));
+    out.write_bytes(std::as_bytes(sources));
+    out.write_bytes(std::as_bytes(targets));
+    out.end_frame(frame);
+
+    WireReader in{exchange(WireType::matrix, "matrix")};
+    WireMatrix matrix;
+    matrix.source_count = in.read<std::uint32_t>();
+    matrix.target_count = in.read<std::uint32_t>();
+    const auto cells = matrix.source_count * matrix.target_count;
+    const auto bytes = in.take(cells * sizeof(float));
+    matrix.travel_times.resize(cells);
+    std::memcpy(matrix.travel_times.data(), bytes.data(), bytes.size());
+    return matrix;
+}
+
+WireCongestionResult BinaryClient::update_congestion(std::span<const CongestionUpdate> updates, bool wait) {
+    send_buffer_.clear();
+    WireWriter out{send_buffer_};
+    const auto frame = out.begin_frame(WireType::congestion_update, wait ? wire_flag_wait : 0, next_request_id_);
+    out.write(static_cast<std::uint32_t>(updates.size()));
+    for (const auto& update : updates) {
+        out.write(static_cast<std::uint32_t>(update.edge_start));
+        out.write(static_cast<std::uint32_t>(update.edge_end));
+        out.write(update.factor);
+    }
+    out.end_frame(frame);
+
+    WireReader in{exchange(WireType::congestion_update, "update_congestion")};
+    WireCongestionResult result;
+    result.sequence = in.read<std::uint64_t>();
+    result.visible = in.read<std::uint8_t>() != 0;
+    return result;
+}
+
+std::span<const std::byte> BinaryClient::exchange(WireType type, const char* caller) {
+    const auto request_id = next_request_id_++;
+    for (std::span<const std::byte> pending{send_buffer_}; !pending.empty();) {
+        const auto sent = ::send(fd_, pending.data(), pending.size(), MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            throw client_error(caller, std::string{"send failed: "} + std::strerror(errno));
+        }
+        pending = pending.subspan(static_cast<std::size_t>(sent));
+    }
+
+    const auto receive = [&](std::size_t offset, std::size_t size) {
+        while (offset < size) {
+            const auto count = ::recv(fd_, receive_buffer_.data() + offset, size - offset, 0);
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count <= 0) {
+                throw client_error(caller, "connection closed by server");
+            }
+            offset += static_cast<std::size_t>(count);
+        }
+    };
+    receive_buffer_.resize(std::max(receive_buffer_.size(), wire_header_size));
+    receive(0, wire_header_size);
+    const auto header = decode_wire_header(std::span{receive_buffer_}.first(wire_header_size));
+    if (receive_buffer_.size() < header.frame_size()) {
+        receive_buffer_.resize(header.frame_size());
+    }
+    receive(wire_header_size, header.frame_size());
+    const auto payload = std::span<const std::byte>{receive_buffer_}.subspan(wire_header_size, header.payload_size());
+
+    const auto status = static_cast<WireStatus>(header.flags);
+    if (status != WireStatus::ok) {
+        const std::string message{reinterpret_cast<const char*>(payload.data()), payload.size()};
+        if (status == WireStatus::bad_request || status == WireStatus::too_large) {
+            throw std::invalid_argument{message};
+        }
+        throw client_error(caller, "server error: " + message);
+    }
+    if (header.type != type || header.request_id != request_id) {
+        throw client_error(caller, "response does not match the request");
+    }
+    return payload;
+}
+
+}  // namespace georoute
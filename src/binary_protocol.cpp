@@ -0,0 +1,137 @@
+#include "georoute/binary_protocol.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+
+namespace georoute {
+
+namespace {
+
+WireLimits read_limits(WireReader& in) {
+    WireLimits limits;
+    limits.timeout_ms = in.read<std::uint32_t>();
+    limits.max_settled_nodes = in.read<std::uint32_t>();
+    return limits;
+}
+
+// count elements of stride bytes, checked against what is left so a forged
+// count cannot overflow the multiplication.
+WireArray read_array(WireReader& in, std::uint32_t count, std::size_t stride) {
+    if (count > in.remaining() / stride) {
+        throw std::invalid_argument{"decode_wire payload truncated"};
+    }
+    return WireArray{in.take(count * stride), stride};
+}
+
+void expect_end(const WireReader& in) {
+    if (in.remaining() != 0) {
+        throw std::invalid_argument{"decode_wire unexpected trailing bytes"};
+    }
+}
+
+}  // namespace
+
+std::size_t WireWriter::begin_frame(WireType type, std::uint8_t flags, std::uint32_t request_id) {
+    const auto start = out_.size();
+    write(std::uint32_t{0});
+    write(static_cast<std::uint8_t>(type));
+    write(flags);
+    write(std::uint16_t{0});
+    write(request_id);
+    return start;
+}
+
+void WireWriter::end_frame(std::size_t frame_start) {
+    const auto length = static_cast<std::uint32_t>(out_.size() - frame_start - sizeof(std::uint32_t));
+    std::memcpy(out_.data() + frame_start, &length, sizeof(length));
+}
+
+WireHeader decode_wire_header(std::span<const std::byte> bytes) {
+    WireReader in{bytes};
+    WireHeader header;
+    header.length = in.read<std::uint32_t>();
+    header.type = static_cast<WireType>(in.read<std::uint8_t>());
+    header.flags = in.read<std::uint8_t>();
+    (void)in.read<std::uint16_t>();
+    header.request_id = in.read<std::uint32_t>();
+    if (header.length < wire_header_size - sizeof(header.length) || header.frame_size() > wire_max_frame_size) {
+        throw std::invalid_argument{"decode_wire_header invalid frame length " + std::to_string(header.length)};
+    }
+    return header;
+}
+
+WireRouteRequest decode_route_request(std::span<const std::byte> payload) {
+    WireReader in{payload};
+    WireRouteRequest request;
+    request.source = in.read<std::uint32_t>();
+    request.target = in.read<std::uint32_t>();
+    request.limits = read_limits(in);
+    expect_end(in);
+    return request;
+}
+
+WireBatchRequest decode_batch_request(std::span<const std::byte> payload) {
+    WireReader in{payload};
+    WireBatchRequest request;
+    request.limits = read_limits(in);
+    request.pairs = read_array(in, in.read<std::uint32_t>(), 8);
+    expect_end(in);
+    return request;
+}
+
+WireMatrixRequest decode_matrix_request(std::span<const std::byte> payload) {
+    WireReader in{payload};
+    WireMatrixRequest request;
+    request.limits = read_limits(in);
+    const auto source_count = in.read<std::uint32_t>();
+    const auto target_count = in.read<std::uint32_t>();
+    request.sources = read_array(in, source_count, 4);
+    request.targets = read_array(in, target_count, 4);
+    expect_end(in);
+    return request;
+}
+
+WireArray decode_congestion_request(std::span<const std::byte> payload) {
+    WireReader in{payload};
+    const auto updates = read_array(in, in.read<std::uint32_t>(), 12);
+    expect_end(in);
+    return updates;
+}
+
+void write_route_record(WireWriter& out,
+                        RouteStatus status,
+                        const RouteResult& result,
+                        std::uint64_t expanded_nodes,
+                        std::uint64_t congestion_epoch,
+                        bool include_path) {
+    const auto path_length = include_path ? result.nodes.size() : 0;
+    out.write(static_cast<std::uint8_t>(status));
+    out.write(static_cast<std::uint8_t>(result.reachable ? 1 : 0));
+    out.write(std::uint16_t{0});
+    out.write(result.total_travel_time);
+    const auto expanded = std::min<std::uint64_t>(expanded_nodes, std::numeric_limits<std::uint32_t>::max());
+    out.write(static_cast<std::uint32_t>(expanded));
+    out.write(static_cast<std::uint32_t>(path_length));
+    out.write(congestion_epoch);
+    out.write_bytes(std::as_bytes(std::span{result.nodes.data(), path_length}));
+}
+
+WireRoute read_route_record(WireReader& in) {
+    WireRoute route;
+    route.status = static_cast<RouteStatus>(in.read<std::uint8_t>());
+    route.reachable = in.read<std::uint8_t>() != 0;
+    (void)in.read<std::uint16_t>();
+    route.travel_time = in.read<float>();
+    route.expanded_nodes = in.read<std::uint32_t>();
+    const auto path_length = in.read<std::uint32_t>();
+    route.congestion_epoch = in.read<std::uint64_t>();
+    if (path_length > in.remaining() / sizeof(node_id)) {
+        throw std::invalid_argument{"read_route_record path truncated"};
+    }
+    route.path.resize(path_length);
+    std::memcpy(route.path.data(), in.take(path_length * sizeof(node_id)).data(), path_length * sizeof(node_id));
+    return route;
+}
+
+}  // namespace georoute
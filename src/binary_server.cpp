@@ -0,0 +1,351 @@
+#include "georoute/binary_server.hpp"
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "georoute/congestion_writer.hpp"
+#include "georoute/engine.hpp"
+#include "georoute/request_arena.hpp"
+#include "georoute/route_request.hpp"
+
+namespace georoute {
+
+namespace {
+
+constexpr std::size_t read_buffer_size = 64 * 1024;
+constexpr int poll_interval_ms = 100;
+constexpr auto congestion_wait_timeout = std::chrono::milliseconds{5000};
+
+std::runtime_error socket_error(const std::string& what) {
+    return std::runtime_error{"BinaryProtocolServer " + what + ": " + std::strerror(errno)};
+}
+
+bool send_all(int fd, std::span<const std::byte> bytes) {
+    while (!bytes.empty()) {
+        const auto sent = ::send(fd, bytes.data(), bytes.size(), MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        bytes = bytes.subspan(static_cast<std::size_t>(sent));
+    }
+    return true;
+}
+
+SearchBudget wire_budget(const BinaryServerOptions& options, const WireLimits& limits) {
+    return make_request_budget(options.route_timeout,
+                               options.max_settled_nodes,
+                               std::optional<std::int64_t>{limits.timeout_ms},
+                               std::optional<std::uint32_t>{limits.max_settled_nodes});
+}
+
+std::length_error too_large(const std::string& what, std::size_t limit) {
+    return std::length_error{what + " exceeds max_batch_size " + std::to_string(limit)};
+}
+
+// Gathers pairs out of the receive buffer into the contiguous array
+// GeoRouteEngine::route_batch takes; reused across requests on a thread.
+std::vector<RouteQuery>& query_buffer() {
+    thread_local std::vector<RouteQuery> queries;
+    queries.clear();
+    return queries;
+}
+
+}  // namespace
+
+BinaryProtocolServer::BinaryProtocolServer(GeoRouteEngine& engine,
+                                           CongestionWriter& writer,
+                                           BinaryServerOptions options)
+    : engine_(engine), writer_(writer), options_(std::move(options)) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options_.port);
+    if (::inet_pton(AF_INET, options_.host.c_str(), &address.sin_addr) != 1) {
+        throw std::invalid_argument{"BinaryProtocolServer invalid listen address: " + options_.host};
+    }
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        throw socket_error("socket");
+    }
+    const int reuse = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(listen_fd_, SOMAXCONN) < 0) {
+        const auto error = socket_error("listen " + options_.host + ":" + std::to_string(options_.port));
+        ::close(listen_fd_);
+        throw error;
+    }
+    socklen_t length = sizeof(address);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length);
+    port_ = ntohs(address.sin_port);
+
+    thread_ = std::thread{[this] { run_listener(); }};
+}
+
+BinaryProtocolServer::~BinaryProtocolServer() {
+    stopping_.store(true, std::memory_order_release);
+    thread_.join();
+    connections_.join_all();
+    ::close(listen_fd_);
+}
+
+std::uint16_t BinaryProtocolServer::port() const noexcept {
+    return port_;
+}
+
+BinaryServerStats BinaryProtocolServer::stats() const noexcept {
+    return BinaryServerStats{connections_total_.load(std::memory_order_relaxed),
+                             connections_.active(),
+                             requests_.load(std::memory_order_relaxed),
+                             errors_.load(std::memory_order_relaxed),
+                             bytes_in_.load(std::memory_order_relaxed),
+                             bytes_out_.load(std::memory_order_relaxed)};
+}
+
+void BinaryProtocolServer::run_listener() {
+    while (!stopping_.load(std::memory_order_acquire)) {
+        // Also frees the threads of closed connections while no client connects.
+        connections_.reap();
+        pollfd listener{listen_fd_, POLLIN, 0};
+        if (::poll(&listener, 1, poll_interval_ms) <= 0) {
+            continue;
+        }
+        const int connection = ::accept(listen_fd_, nullptr, nullptr);
+        if (connection < 0) {
+            continue;
+        }
+        connections_total_.fetch_add(1, std::memory_order_relaxed);
+        connections_.spawn([this, connection] {
+            serve(connection);
+            ::close(connection);
+        });
+    }
+}
+
+void BinaryProtocolServer::serve(int fd) {
+    // Responses are written in one send per read; never hold them back.
+    const int nodelay = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    std::vector<std::byte> in(read_buffer_size);
+    std::vector<std::byte> out;
+    std::size_t filled = 0;
+
+    while (!stopping_.load(std::memory_order_acquire)) {
+        pollfd connection{fd, POLLIN, 0};
+        if (::poll(&connection, 1, poll_interval_ms) <= 0) {
+            continue;
+        }
+        const auto count = ::read(fd, in.data() + filled, in.size() - filled);
+        if (count <= 0) {
+            return;
+        }
+        filled += static_cast<std::size_t>(count);
+        bytes_in_.fetch_add(static_cast<std::uint64_t>(count), std::memory_order_relaxed);
+
+        std::size_t offset = 0;
+        std::optional<WireHeader> pending;
+        bool broken = false;
+        while (filled - offset >= wire_header_size) {
+            WireHeader header;
+            try {
+                header = decode_wire_header(std::span{in}.subspan(offset, wire_header_size));
+            } catch (const std::invalid_argument& ex) {
+                // The stream cannot be resynchronised: answer once, then close.
+                errors_.fetch_add(1, std::memory_order_relaxed);
+                WireWriter writer{out};
+                const auto frame = writer.begin_frame(WireType{}, static_cast<std::uint8_t>(WireStatus::bad_request), 0);
+                writer.write_bytes(std::as_bytes(std::span{ex.what(), std::strlen(ex.what())}));
+                writer.end_frame(frame);
+                broken = true;
+                break;
+            }
+            if (filled - offset < header.frame_size()) {
+                pending = header;
+                break;
+            }
+            handle(header, std::span{in}.subspan(offset + wire_header_size, header.payload_size()), out);
+            offset += header.frame_size();
+        }
+
+        if (!out.empty()) {
+            if (!send_all(fd, out)) {
+                return;
+            }
+            bytes_out_.fetch_add(out.size(), std::memory_order_relaxed);
+            out.clear();
+        }
+        if (broken) {
+            return;
+        }
+        // Keep the unfinished frame at the front and make room for all of it.
+        if (offset > 0) {
+            std::memmove(in.data(), in.data() + offset, filled - offset);
+            filled -= offset;
+        }
+        if (pending && pending->frame_size() > in.size()) {
+            in.resize(pending->frame_size());
+        }
+    }
+}
+
+void BinaryProtocolServer::handle(const WireHeader& header,
+                                  std::span<const std::byte> payload,
+                                  std::vector<std::byte>& out) {
+    requests_.fetch_add(1, std::memory_order_relaxed);
+    const auto frame_start = out.size();
+    WireWriter writer{out};
+    std::optional<WireStatus> failure;
+    std::string message;
+    try {
+        switch (header.type) {
+            case WireType::route:
+                handle_route(header, payload, writer);
+                return;
+            case WireType::route_batch:
+                handle_batch(header, payload, writer);
+                return;
+            case WireType::matrix:
+                handle_matrix(header, payload, writer);
+                return;
+            case WireType::congestion_update:
+                handle_congestion(header, payload, writer);
+                return;
+        }
+        failure = WireStatus::bad_request;
+        message = "unknown message type " + std::to_string(static_cast<int>(header.type));
+    } catch (const std::length_error& ex) {
+        failure = WireStatus::too_large;
+        message = ex.what();
+    } catch (const std::invalid_argument& ex) {
+        failure = WireStatus::bad_request;
+        message = ex.what();
+    } catch (const std::out_of_range& ex) {
+        failure = WireStatus::bad_request;
+        message = ex.what();
+    } catch (const std::exception& ex) {
+        failure = WireStatus::server_error;
+        message = ex.what();
+    }
+
+    errors_.fetch_add(1, std::memory_order_relaxed);
+    out.resize(frame_start);
+    const auto frame = writer.begin_frame(header.type, static_cast<std::uint8_t>(*failure), header.request_id);
+    writer.write_bytes(std::as_bytes(std::span{message}));
+    writer.end_frame(frame);
+}
+
+void BinaryProtocolServer::handle_route(const WireHeader& header,
+                                        std::span<const std::byte> payload,
+                                        WireWriter& out) {
+    const auto request = decode_route_request(payload);
+    // The path stays in this thread's arena until it is copied into the frame.
+    RequestArena::Scope arena{RequestArena::local()};
+    const auto response =
+        engine_.route(request.source, request.target, wire_budget(options_, request.limits), arena.resource());
+
+    const auto frame = out.begin_frame(header.type, static_cast<std::uint8_t>(WireStatus::ok), header.request_id);
+    write_route_record(out, response.status, response.result, response.expanded_nodes, response.congestion_epoch,
+                       (header.flags & wire_flag_include_path) != 0);
+    out.end_frame(frame);
+}
+
+void BinaryProtocolServer::handle_batch(const WireHeader& header,
+                                        std::span<const std::byte> payload,
+                                        WireWriter& out) {
+    const auto request = decode_batch_request(payload);
+    if (request.pairs.size() > options_.max_batch_size) {
+        throw too_large("route_batch of " + std::to_string(request.pairs.size()) + " pairs", options_.max_batch_size);
+    }
+    auto& queries = query_buffer();
+    queries.reserve(request.pairs.size());
+    for (std::size_t i = 0; i < request.pairs.size(); ++i) {
+        queries.push_back(RouteQuery{request.pairs.get<node_id>(i, 0), request.pairs.get<node_id>(i, 1)});
+    }
+    const auto responses = engine_.route_batch(queries, wire_budget(options_, request.limits));
+
+    const bool include_path = (header.flags & wire_flag_include_path) != 0;
+    const auto frame = out.begin_frame(header.type, static_cast<std::uint8_t>(WireStatus::ok), header.request_id);
+    out.write(static_cast<std::uint32_t>(responses.size()));
+    for (const auto& response : responses) {
+        write_route_record(out, response.status, response.result, response.expanded_nodes, response.congestion_epoch,
+                           include_path);
+    }
+    out.end_frame(frame);
+}
+
+void BinaryProtocolServer::handle_matrix(const WireHeader& header,
+                                         std::span<const std::byte> payload,
+                                         WireWriter& out) {
+    const auto request = decode_matrix_request(payload);
+    const auto sources = request.sources.size();
+    const auto targets = request.targets.size();
+    if (targets != 0 && sources > options_.max_batch_size / targets) {
+        throw too_large("matrix of " + std::to_string(sources) + " x " + std::to_string(targets) + " cells",
+                        options_.max_batch_size);
+    }
+    auto& queries = query_buffer();
+    queries.reserve(sources * targets);
+    for (std::size_t s = 0; s < sources; ++s) {
+        for (std::size_t t = 0; t < targets; ++t) {
+            queries.push_back(RouteQuery{request.sources.get<node_id>(s), request.targets.get<node_id>(t)});
+        }
+    }
+    const auto responses = engine_.route_batch(queries, wire_budget(options_, request.limits));
+
+    const auto frame = out.begin_frame(header.type, static_cast<std::uint8_t>(WireStatus::ok), header.request_id);
+    out.write(static_cast<std::uint32_t>(sources));
+    out.write(static_cast<std::uint32_t>(targets));
+    for (const auto& response : responses) {
+        if (response.status != RouteStatus::complete) {
+            out.write(std::numeric_limits<float>::quiet_NaN());
+        } else if (!response.result.reachable) {
+            out.write(std::numeric_limits<float>::infinity());
+        } else {
+            out.write(response.result.total_travel_time);
+        }
+    }
+    out.end_frame(frame);
+}
+
+void BinaryProtocolServer::handle_congestion(const WireHeader& header,
+                                             std::span<const std::byte> payload,
+                                             WireWriter& out) {
+    const auto records = decode_congestion_request(payload);
+    std::vector<CongestionUpdate> updates;
+    updates.reserve(records.size());
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        updates.push_back(CongestionUpdate{records.get<std::uint32_t>(i, 0), records.get<std::uint32_t>(i, 1),
+                                           records.get<float>(i, 2)});
+    }
+    // Same path as POST /api/v1/congestion/update: validated, queued and coalesced.
+    const auto sequence = writer_.enqueue(updates);
+    const bool visible = (header.flags & wire_flag_wait) != 0 ? writer_.wait_for(sequence, congestion_wait_timeout)
+                                                               : writer_.applied_sequence() >= sequence;
+
+    const auto frame = out.begin_frame(header.type, static_cast<std::uint8_t>(WireStatus::ok), header.request_id);
+    out.write(sequence);
+    out.write(static_cast<std::uint8_t>(visible ? 1 : 0));
+    out.write(std::uint8_t{0});
+    out.write(std::uint16_t{0});
+    out.end_frame(frame);
+}
+
+}  // namespace georoute
@@ -0,0 +1,506 @@
+#include "georoute/congestion_feed.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "georoute/congestion_writer.hpp"
+
+namespace georoute {
+
+namespace {
+
+constexpr std::size_t read_buffer_size = 64 * 1024;
+constexpr std::size_t max_ndjson_line = 1024;
+constexpr int poll_interval_ms = 100;
+constexpr auto file_poll_interval = std::chrono::milliseconds{50};
+
+std::runtime_error socket_error(const std::string& what) {
+    return std::runtime_error{"CongestionFeed " + what + ": " + std::strerror(errno)};
+}
+
+bool is_space(char c) noexcept {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+struct Cursor {
+    const char* pos;
+    const char* end;
+
+    void skip_space() noexcept {
+        while (pos != end && is_space(*pos)) {
+            ++pos;
+        }
+    }
+
+    bool expect(char c) noexcept {
+        skip_space();
+        if (pos == end || *pos != c) {
+            return false;
+        }
+        ++pos;
+        return true;
+    }
+
+    bool peek(char c) noexcept {
+        skip_space();
+        return pos != end && *pos == c;
+    }
+
+    template <typename T>
+    bool number(T& value) noexcept {
+        skip_space();
+        const auto [next, ec] = std::from_chars(pos, end, value);
+        if (ec != std::errc{}) {
+            return false;
+        }
+        pos = next;
+        return true;
+    }
+
+    bool string(std::string_view& value) noexcept {
+        if (!expect('"')) {
+            return false;
+        }
+        const char* begin = pos;
+        while (pos != end && *pos != '"') {
+            if (*pos == '\\' && pos + 1 != end) {
+                ++pos;
+            }
+            ++pos;
+        }
+        if (pos == end) {
+            return false;
+        }
+        value = std::string_view{begin, static_cast<std::size_t>(pos - begin)};
+        ++pos;
+        return true;
+    }
+
+    // Skips a scalar value of a field we do not use.
+    bool skip_value() noexcept {
+        skip_space();
+        if (pos != end && *pos == '"') {
+            std::string_view ignored;
+            return string(ignored);
+        }
+        while (pos != end && *pos != ',' && *pos != '}') {
+            if (*pos == '{' || *pos == '[') {
+                return false;
+            }
+            ++pos;
+        }
+        return true;
+    }
+};
+
+enum class LineResult { record, blank, malformed };
+
+// Flat single-object scanner: no DOM, no allocation. Unknown scalar fields
+// are skipped; nested values are rejected.
+LineResult parse_ndjson_line(std::string_view line, std::size_t& edge_start, std::size_t& edge_end, float& factor) {
+    Cursor cursor{line.data(), line.data() + line.size()};
+    cursor.skip_space();
+    if (cursor.pos == cursor.end) {
+        return LineResult::blank;
+    }
+    if (!cursor.expect('{')) {
+        return LineResult::malformed;
+    }
+
+    bool has_start = false;
+    bool has_end = false;
+    bool has_factor = false;
+    if (!cursor.peek('}')) {
+        do {
+            std::string_view key;
+            if (!cursor.string(key) || !cursor.expect(':')) {
+                return LineResult::malformed;
+            }
+            bool ok = true;
+            if (key == "edge_start") {
+                ok = cursor.number(edge_start);
+                has_start = true;
+            } else if (key == "edge_end") {
+                ok = cursor.number(edge_end);
+                has_end = true;
+            } else if (key == "factor") {
+                ok = cursor.number(factor);
+                has_factor = true;
+            } else {
+                ok = cursor.skip_value();
+            }
+            if (!ok) {
+                return LineResult::malformed;
+            }
+        } while (cursor.expect(','));
+    }
+    if (!cursor.expect('}')) {
+        return LineResult::malformed;
+    }
+    cursor.skip_space();
+    if (cursor.pos != cursor.end || !has_start || !has_end || !has_factor) {
+        return LineResult::malformed;
+    }
+    return LineResult::record;
+}
+
+}  // namespace
+
+FeedFormat parse_feed_format(std::string_view name) {
+    if (name == "ndjson") {
+        return FeedFormat::ndjson;
+    }
+    if (name == "binary") {
+        return FeedFormat::binary;
+    }
+    throw std::invalid_argument{"unknown feed format: " + std::string{name}};
+}
+
+FeedSource FeedSource::parse(std::string_view spec, FeedFormat format) {
+    const auto colon = spec.find(':');
+    if (colon == std::string_view::npos || colon + 1 == spec.size()) {
+        throw std::invalid_argument{"FeedSource::parse expected <kind>:<target>, got: " + std::string{spec}};
+    }
+    const auto kind = spec.substr(0, colon);
+    const auto target = spec.substr(colon + 1);
+
+    FeedSource source;
+    source.format = format;
+    if (kind == "unix") {
+        source.kind = Kind::unix_socket;
+        source.path = std::string{target};
+    } else if (kind == "file") {
+        source.kind = Kind::file;
+        source.path = std::string{target};
+    } else if (kind == "tcp") {
+        source.kind = Kind::tcp;
+        const auto port_colon = target.rfind(':');
+        const auto host = port_colon == std::string_view::npos ? std::string_view{"127.0.0.1"}
+                                                               : target.substr(0, port_colon);
+        const auto port = port_colon == std::string_view::npos ? target : target.substr(port_colon + 1);
+        unsigned value = 0;
+        const auto [next, ec] = std::from_chars(port.data(), port.data() + port.size(), value);
+        if (ec != std::errc{} || next != port.data() + port.size() || value == 0 || value > 65535) {
+            throw std::invalid_argument{"FeedSource::parse invalid tcp port: " + std::string{port}};
+        }
+        source.path = std::string{host};
+        source.port = static_cast<std::uint16_t>(value);
+    } else {
+        throw std::invalid_argument{"FeedSource::parse unknown source kind: " + std::string{kind}};
+    }
+    return source;
+}
+
+CongestionFeedParser::CongestionFeedParser(FeedFormat format, std::size_t edge_count)
+    : format_(format), edge_count_(edge_count) {}
+
+void CongestionFeedParser::consume(std::span<const char> bytes, std::vector<CongestionUpdate>& out) {
+    stats_.bytes += bytes.size();
+    if (format_ == FeedFormat::ndjson) {
+        consume_ndjson(bytes, out);
+    } else {
+        consume_binary(bytes, out);
+    }
+}
+
+const FeedStats& CongestionFeedParser::stats() const noexcept {
+    return stats_;
+}
+
+void CongestionFeedParser::set_edge_count(std::size_t edge_count) noexcept {
+    edge_count_ = edge_count;
+}
+
+void CongestionFeedParser::consume_ndjson(std::span<const char> bytes, std::vector<CongestionUpdate>& out) {
+    const auto parse_line = [this, &out](std::string_view line) {
+        std::size_t edge_start = 0;
+        std::size_t edge_end = 0;
+        float factor = 0.0F;
+        switch (parse_ndjson_line(line, edge_start, edge_end, factor)) {
+            case LineResult::record:
+                accept(edge_start, edge_end, factor, out);
+                break;
+            case LineResult::malformed:
+                ++stats_.rejected;
+                break;
+            case LineResult::blank:
+                break;
+        }
+    };
+
+    const char* pos = bytes.data();
+    const char* const end = bytes.data() + bytes.size();
+    while (pos != end) {
+        const char* newline = std::find(pos, end, '\n');
+        if (newline == end) {
+            // Keep the unterminated tail for the next call; an over-long line
+            // is dropped as one rejected record.
+            if (!discarding_) {
+                if (partial_.size() + static_cast<std::size_t>(end - pos) > max_ndjson_line) {
+                    ++stats_.rejected;
+                    partial_.clear();
+                    discarding_ = true;
+                } else {
+                    partial_.insert(partial_.end(), pos, end);
+                }
+            }
+            return;
+        }
+        if (discarding_) {
+            discarding_ = false;
+        } else if (partial_.empty()) {
+            parse_line(std::string_view{pos, static_cast<std::size_t>(newline - pos)});
+        } else {
+            partial_.insert(partial_.end(), pos, newline);
+            parse_line(std::string_view{partial_.data(), partial_.size()});
+            partial_.clear();
+        }
+        pos = newline + 1;
+    }
+}
+
+void CongestionFeedParser::consume_binary(std::span<const char> bytes, std::vector<CongestionUpdate>& out) {
+    const auto decode = [this, &out](const char* record) {
+        std::uint32_t edge_start = 0;
+        std::uint32_t edge_end = 0;
+        float factor = 0.0F;
+        std::memcpy(&edge_start, record, sizeof(edge_start));
+        std::memcpy(&edge_end, record + 4, sizeof(edge_end));
+        std::memcpy(&factor, record + 8, sizeof(factor));
+        accept(edge_start, edge_end, factor, out);
+    };
+
+    const char* pos = bytes.data();
+    const char* const end = bytes.data() + bytes.size();
+    if (!partial_.empty()) {
+        const auto needed = std::min(binary_record_size - partial_.size(), static_cast<std::size_t>(end - pos));
+        partial_.insert(partial_.end(), pos, pos + needed);
+        pos += needed;
+        if (partial_.size() < binary_record_size) {
+            return;
+        }
+        decode(partial_.data());
+        partial_.clear();
+    }
+
+    out.reserve(out.size() + static_cast<std::size_t>(end - pos) / binary_record_size);
+    while (static_cast<std::size_t>(end - pos) >= binary_record_size) {
+        decode(pos);
+        pos += binary_record_size;
+    }
+    partial_.assign(pos, end);
+}
+
+void CongestionFeedParser::accept(std::size_t edge_start,
+                                  std::size_t edge_end,
+                                  float factor,
+                                  std::vector<CongestionUpdate>& out) {
+    if (edge_start > edge_end || edge_end >= edge_count_ || !valid_congestion_factor(factor)) {
+        ++stats_.rejected;
+        return;
+    }
+    ++stats_.records;
+    out.push_back(CongestionUpdate{edge_start, edge_end, factor});
+}
+
+CongestionFeed::CongestionFeed(CongestionWriter& writer, std::size_t edge_count, FeedSource source)
+    : writer_(writer), edge_count_(edge_count), source_(std::move(source)) {
+    if (source_.kind == FeedSource::Kind::unix_socket) {
+        sockaddr_un address{};
+        if (source_.path.size() >= sizeof(address.sun_path)) {
+            throw std::invalid_argument{"CongestionFeed unix socket path too long: " + source_.path};
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, source_.path.c_str(), source_.path.size() + 1);
+
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd_ < 0) {
+            throw socket_error("socket");
+        }
+        ::unlink(source_.path.c_str());
+        if (::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+            const auto error = socket_error("bind " + source_.path);
+            ::close(listen_fd_);
+            throw error;
+        }
+    } else if (source_.kind == FeedSource::Kind::tcp) {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(source_.port);
+        if (::inet_pton(AF_INET, source_.path.c_str(), &address.sin_addr) != 1) {
+            throw std::invalid_argument{"CongestionFeed invalid tcp listen address: " + source_.path};
+        }
+
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listen_fd_ < 0) {
+            throw socket_error("socket");
+        }
+        const int reuse = 1;
+        ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+            const auto error = socket_error("bind " + source_.path + ":" + std::to_string(source_.port));
+            ::close(listen_fd_);
+            throw error;
+        }
+    }
+
+    if (listen_fd_ >= 0) {
+        if (::listen(listen_fd_, SOMAXCONN) < 0) {
+            const auto error = socket_error("listen");
+            ::close(listen_fd_);
+            throw error;
+        }
+        thread_ = std::thread{[this] { run_listener(); }};
+    } else {
+        thread_ = std::thread{[this] { run_file(); }};
+    }
+}
+
+CongestionFeed::~CongestionFeed() {
+    stopping_.store(true, std::memory_order_release);
+    thread_.join();
+    connections_.join_all();
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        if (source_.kind == FeedSource::Kind::unix_socket) {
+            ::unlink(source_.path.c_str());
+        }
+    }
+}
+
+const FeedSource& CongestionFeed::source() const noexcept {
+    return source_;
+}
+
+FeedStats CongestionFeed::stats() const noexcept {
+    return FeedStats{bytes_.load(std::memory_order_relaxed),
+                     records_.load(std::memory_order_relaxed),
+                     rejected_.load(std::memory_order_relaxed)};
+}
+
+void CongestionFeed::run_listener() {
+    while (!stopping_.load(std::memory_order_acquire)) {
+        connections_.reap();
+        pollfd listener{listen_fd_, POLLIN, 0};
+        if (::poll(&listener, 1, poll_interval_ms) <= 0) {
+            continue;
+        }
+        const int connection = ::accept(listen_fd_, nullptr, nullptr);
+        if (connection < 0) {
+            continue;
+        }
+        connections_.spawn([this, connection] {
+            read_stream(connection);
+            ::close(connection);
+        });
+    }
+}
+
+void CongestionFeed::run_file() {
+    std::array<char, read_buffer_size> buffer{};
+    std::vector<CongestionUpdate> updates;
+    CongestionFeedParser parser{source_.format, edge_count_};
+    int fd = -1;
+    off_t offset = 0;
+
+    while (!stopping_.load(std::memory_order_acquire)) {
+        if (fd < 0) {
+            fd = ::open(source_.path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                std::this_thread::sleep_for(file_poll_interval);
+                continue;
+            }
+            offset = 0;
+            parser = CongestionFeedParser{source_.format, edge_count_};
+        }
+
+        const auto count = ::read(fd, buffer.data(), buffer.size());
+        if (count > 0) {
+            offset += count;
+            submit(parser, std::span<const char>{buffer.data(), static_cast<std::size_t>(count)}, updates);
+            continue;
+        }
+
+        // At end of file: follow truncation in place and replacement by rename.
+        struct stat opened {};
+        struct stat current {};
+        const bool replaced = ::stat(source_.path.c_str(), &current) == 0 && ::fstat(fd, &opened) == 0 &&
+                              (current.st_ino != opened.st_ino || current.st_dev != opened.st_dev);
+        if (replaced) {
+            ::close(fd);
+            fd = -1;
+            continue;
+        }
+        if (::fstat(fd, &opened) == 0 && opened.st_size < offset) {
+            ::lseek(fd, 0, SEEK_SET);
+            offset = 0;
+            parser = CongestionFeedParser{source_.format, edge_count_};
+            continue;
+        }
+        std::this_thread::sleep_for(file_poll_interval);
+    }
+
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+void CongestionFeed::read_stream(int fd) {
+    std::array<char, read_buffer_size> buffer{};
+    std::vector<CongestionUpdate> updates;
+    CongestionFeedParser parser{source_.format, edge_count_};
+
+    while (!stopping_.load(std::memory_order_acquire)) {
+        pollfd connection{fd, POLLIN, 0};
+        if (::poll(&connection, 1, poll_interval_ms) <= 0) {
+            continue;
+        }
+        const auto count = ::read(fd, buffer.data(), buffer.size());
+        if (count <= 0) {
+            return;
+        }
+        submit(parser, std::span<const char>{buffer.data(), static_cast<std::size_t>(count)}, updates);
+    }
+}
+
+void CongestionFeed::submit(CongestionFeedParser& parser,
+                            std::span<const char> bytes,
+                            std::vector<CongestionUpdate>& updates) {
+    const auto before = parser.stats();
+    parser.set_edge_count(writer_.edge_count());
+    parser.consume(bytes, updates);
+    const auto& after = parser.stats();
+
+    std::uint64_t refused = 0;
+    if (!updates.empty()) {
+        // One queue entry per read; the writer coalesces it with everything else queued.
+        // The graph can be swapped for a smaller one between decode and enqueue.
+        try {
+            writer_.enqueue(updates);
+        } catch (const std::exception&) {
+            refused = updates.size();
+        }
+        updates.clear();
+    }
+    bytes_.fetch_add(after.bytes - before.bytes, std::memory_order_relaxed);
+    records_.fetch_add(after.records - before.records, std::memory_order_relaxed);
+    rejected_.fetch_add(after.rejected - before.rejected + refused, std::memory_order_relaxed);
+}
+
+}  // namespace georoute
@@ -0,0 +1,165 @@
+#include "georoute/congestion_index.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace georoute {
+
+CongestionIndex::CongestionIndex(SegmentTree tree)
+    : impl_(std::move(tree)) {}
+
+CongestionIndex::CongestionIndex(SqrtDecomposition blocks)
+    : impl_(std::move(blocks)) {}
+
+CongestionIndex CongestionIndex::make(std::string_view kind, std::size_t size) {
+    if (kind == "segment_tree") {
+        return CongestionIndex{SegmentTree{size}};
+    }
+    if (kind == "blocked") {
+        return CongestionIndex{SqrtDecomposition{size}};
+    }
+    throw std::invalid_argument{"CongestionIndex unknown kind '" + std::string{kind} + "'"};
+}
+
+void CongestionIndex::range_multiply(std::size_t l, std::size_t r, float factor) {
+    std::visit([&](auto& impl) { impl.range_multiply(l, r, factor); }, impl_);
+}
+
+void CongestionIndex::range_multiply_batch(std::span<const CongestionUpdate> ranges) {
+    std::visit([ranges](auto& impl) { impl.range_multiply_batch(ranges); }, impl_);
+}
+
+std::size_t CongestionIndex::point_multiply(std::span<const EdgeFactorUpdate> updates) {
+    for (const auto& update : updates) {
+        if (update.edge >= size()) {
+            throw std::out_of_range{"CongestionIndex::point_multiply edge id out of range"};
+        }
+    }
+    overlay_.insert(overlay_.end(), updates.begin(), updates.end());
+    if (overlay_.size() < overlay_flush_threshold_) {
+        return 0;
+    }
+    return flush_overlay();
+}
+
+std::size_t CongestionIndex::flush_overlay() {
+    if (overlay_.empty()) {
+        return 0;
+    }
+
+    const auto written = std::visit(
+        [this](auto& impl) -> std::size_t {
+            using Impl = std::decay_t<decltype(impl)>;
+            if constexpr (std::is_same_v<Impl, SqrtDecomposition>) {
+                // Single-element updates are O(1) here; sorting would cost more than it saves.
+                for (const auto& update : overlay_) {
+                    impl.range_multiply(update.edge, update.edge, update.factor);
+                }
+                return overlay_.size();
+            } else {
+                std::sort(overlay_.begin(), overlay_.end(),
+                          [](const EdgeFactorUpdate& lhs, const EdgeFactorUpdate& rhs) { return lhs.edge < rhs.edge; });
+
+                std::vector<CongestionUpdate> ranges;
+                ranges.reserve(overlay_.size());
+                for (const auto& update : overlay_) {
+                    if (!ranges.empty() && ranges.back().edge_start == update.edge) {
+                        ranges.back().factor *= update.factor;
+                    } else {
+                        ranges.push_back(CongestionUpdate{update.edge, update.edge, update.factor});
+                    }
+                }
+                impl.range_multiply_batch(ranges);
+                return ranges.size();
+            }
+        },
+        impl_);
+
+    overlay_.clear();
+    return written;
+}
+
+float CongestionIndex::point_query(std::size_t idx) const {
+    auto factor = std::visit([idx](const auto& impl) { return impl.point_query(idx); }, impl_);
+    for (const auto& update : overlay_) {
+        if (update.edge == idx) {
+            factor *= update.factor;
+        }
+    }
+    return factor;
+}
+
+std::vector<float> CongestionIndex::values() const {
+    auto factors = std::visit([](const auto& impl) { return impl.values(); }, impl_);
+    for (const auto& update : overlay_) {
+        factors[update.edge] *= update.factor;
+    }
+    return factors;
+}
+
+std::size_t CongestionIndex::size() const noexcept {
+    return std::visit([](const auto& impl) { return impl.size(); }, impl_);
+}
+
+std::string_view CongestionIndex::kind() const noexcept {
+    return std::holds_alternative<SegmentTree>(impl_) ? "segment_tree" : "blocked";
+}
+
+std::size_t CongestionIndex::overlay_size() const noexcept {
+    return overlay_.size();
+}
+
+void CongestionIndex::set_overlay_flush_threshold(std::size_t threshold) noexcept {
+    overlay_flush_threshold_ = threshold;
+}
+
+std::vector<CongestionUpdate> merge_congestion_updates(std::span<const CongestionUpdate> updates) {
+    std::vector<CongestionUpdate> merged;
+    if (updates.empty()) {
+        return merged;
+    }
+
+    // Elementary pieces start at every edge_start and every edge_end + 1.
+    std::vector<std::size_t> bounds;
+    bounds.reserve(updates.size() * 2);
+    for (const auto& update : updates) {
+        if (update.edge_start > update.edge_end) {
+            throw std::invalid_argument{"merge_congestion_updates invalid range"};
+        }
+        bounds.push_back(update.edge_start);
+        bounds.push_back(update.edge_end + 1);
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+    std::vector<float> factors(bounds.size() - 1, 1.0F);
+    std::vector<std::uint8_t> covered(bounds.size() - 1, 0);
+    for (const auto& update : updates) {
+        const auto first = static_cast<std::size_t>(
+            std::lower_bound(bounds.begin(), bounds.end(), update.edge_start) - bounds.begin());
+        for (auto piece = first; bounds[piece] <= update.edge_end; ++piece) {
+            factors[piece] *= update.factor;
+            covered[piece] = 1;
+        }
+    }
+
+    for (std::size_t piece = 0; piece < factors.size(); ++piece) {
+        if (!covered[piece]) {
+            continue;
+        }
+        const auto start = bounds[piece];
+        const auto end = bounds[piece + 1] - 1;
+        if (!merged.empty() && merged.back().edge_end + 1 == start && merged.back().factor == factors[piece]) {
+            merged.back().edge_end = end;
+        } else {
+            merged.push_back(CongestionUpdate{start, end, factors[piece]});
+        }
+    }
+    return merged;
+}
+
+}  // namespace georoute
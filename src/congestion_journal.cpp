@@ -0,0 +1,362 @@
+#include "georoute/congestion_journal.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace georoute {
+
+namespace {
+
+// Snapshot: header followed by edge_count native-endian floats.
+struct SnapshotHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t edge_count;
+    std::uint64_t sequence;
+    std::uint64_t checksum;
+};
+
+// Log entry: header followed by update_count packed {u32 start, u32 end, f32 factor}.
+struct LogEntryHeader {
+    std::uint64_t sequence;
+    std::uint32_t update_count;
+    std::uint32_t checksum;
+};
+
+constexpr char snapshot_magic[4] = {'G', 'R', 'C', 'S'};
+constexpr std::uint32_t snapshot_version = 1;
+constexpr std::size_t log_record_size = 12;
+
+std::uint64_t fnv1a(const char* data, std::size_t size) noexcept {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::runtime_error io_error(const std::string& what, const std::string& path) {
+    return std::runtime_error{"CongestionJournal " + what + " " + path + ": " + std::strerror(errno)};
+}
+
+void write_all(int fd, const char* data, std::size_t size, const std::string& path) {
+    while (size > 0) {
+        const auto written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw io_error("write", path);
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+std::vector<char> read_file(const std::filesystem::path& path) {
+    std::ifstream input{path, std::ios::binary};
+    if (!input) {
+        return {};
+    }
+    return std::vector<char>{std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{}};
+}
+
+void apply_factors(std::vector<float>& factors, std::span<const CongestionUpdate> updates) {
+    for (const auto& update : updates) {
+        for (auto i = update.edge_start; i <= update.edge_end; ++i) {
+            factors[i] *= update.factor;
+        }
+    }
+}
+
+}  // namespace
+
+RecoveredCongestion CongestionJournal::recover(const std::string& directory, std::size_t edge_count) {
+    RecoveredCongestion state;
+    state.factors.assign(edge_count, 1.0F);
+    const std::filesystem::path root{directory};
+
+    const auto snapshot = read_file(root / snapshot_file);
+    if (!snapshot.empty()) {
+        SnapshotHeader header{};
+        if (snapshot.size() < sizeof(header)) {
+            throw std::runtime_error{"CongestionJournal::recover truncated snapshot"};
+        }
+        std::memcpy(&header, snapshot.data(), sizeof(header));
+        if (std::memcmp(header.magic, snapshot_magic, sizeof(snapshot_magic)) != 0 ||
+            header.version != snapshot_version) {
+            throw std::runtime_error{"CongestionJournal::recover unrecognized snapshot format"};
+        }
+        if (header.edge_count != edge_count) {
+            throw std::runtime_error{"CongestionJournal::recover snapshot edge count does not match graph"};
+        }
+        const auto payload_size = edge_count * sizeof(float);
+        if (snapshot.size() != sizeof(header) + payload_size ||
+            fnv1a(snapshot.data() + sizeof(header), payload_size) != header.checksum) {
+            throw std::runtime_error{"CongestionJournal::recover snapshot checksum mismatch"};
+        }
+        std::memcpy(state.factors.data(), snapshot.data() + sizeof(header), payload_size);
+        state.snapshot_sequence = header.sequence;
+        state.last_sequence = header.sequence;
+        state.from_snapshot = true;
+    }
+
+    // Replay until the first entry that is truncated, fails its checksum or
+    // is out of range; anything after it is a torn write from a crash.
+    const auto log = read_file(root / log_file);
+    std::size_t offset = 0;
+    std::vector<CongestionUpdate> updates;
+    while (log.size() - offset >= sizeof(LogEntryHeader)) {
+        LogEntryHeader header{};
+        std::memcpy(&header, log.data() + offset, sizeof(header));
+        const auto payload_size = static_cast<std::size_t>(header.update_count) * log_record_size;
+        const char* payload = log.data() + offset + sizeof(header);
+        if (log.size() - offset - sizeof(header) < payload_size ||
+            static_cast<std::uint32_t>(fnv1a(payload, payload_size)) != header.checksum) {
+            break;
+        }
+
+        updates.clear();
+        bool valid = true;
+        for (std::size_t i = 0; i < header.update_count && valid; ++i) {
+            std::uint32_t edge_start = 0;
+            std::uint32_t edge_end = 0;
+            float factor = 0.0F;
+            std::memcpy(&edge_start, payload + i * log_record_size, 4);
+            std::memcpy(&edge_end, payload + i * log_record_size + 4, 4);
+            std::memcpy(&factor, payload + i * log_record_size + 8, 4);
+            valid = edge_start <= edge_end && edge_end < edge_count;
+            updates.push_back(CongestionUpdate{edge_start, edge_end, factor});
+        }
+        if (!valid) {
+            break;
+        }
+
+        // Entries already folded into the snapshot survive a crash between
+        // writing the snapshot and truncating the log.
+        if (header.sequence > state.snapshot_sequence) {
+            apply_factors(state.factors, updates);
+            state.replayed_batches++;
+            state.replayed_updates += updates.size();
+            state.last_sequence = std::max(state.last_sequence, header.sequence);
+        }
+        offset += sizeof(header) + payload_size;
+    }
+    state.log_bytes = offset;
+    return state;
+}
+
+CongestionJournal::CongestionJournal(CongestionJournalOptions options, RecoveredCongestion state)
+    : options_(std::move(options)),
+      factors_(std::move(state.factors)),
+      snapshot_sequence_(state.snapshot_sequence),
+      written_sequence_(state.last_sequence),
+      log_bytes_(state.log_bytes),
+      last_snapshot_(std::chrono::steady_clock::now()),
+      next_sequence_(state.last_sequence),
+      durable_sequence_(state.last_sequence) {
+    std::filesystem::create_directories(options_.directory);
+    const auto path = (std::filesystem::path{options_.directory} / log_file).string();
+    log_fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (log_fd_ < 0) {
+        throw io_error("open", path);
+    }
+    // Drop a torn tail so new entries follow the last valid one.
+    if (::ftruncate(log_fd_, static_cast<off_t>(log_bytes_)) < 0 ||
+        ::lseek(log_fd_, 0, SEEK_END) < 0) {
+        const auto error = io_error("truncate", path);
+        ::close(log_fd_);
+        throw error;
+    }
+    thread_ = std::thread{[this] { run(); }};
+}
+
+CongestionJournal::~CongestionJournal() {
+    {
+        std::lock_guard lock{mutex_};
+        stopping_ = true;
+    }
+    work_cv_.notify_one();
+    thread_.join();
+    ::close(log_fd_);
+}
+
+void CongestionJournal::record(std::span<const CongestionUpdate> updates) {
+    {
+        std::lock_guard lock{mutex_};
+        pending_.push_back(Batch{++next_sequence_, std::vector<CongestionUpdate>{updates.begin(), updates.end()}});
+    }
+    work_cv_.notify_one();
+}
+
+void CongestionJournal::flush() {
+    std::unique_lock lock{mutex_};
+    const auto target = next_sequence_;
+    flushed_cv_.wait(lock, [this, target] { return durable_sequence_ >= target; });
+}
+
+void CongestionJournal::restart(std::size_t edge_count) {
+    {
+        std::lock_guard lock{mutex_};
+        pending_.push_back(Batch{++next_sequence_, {}, edge_count});
+    }
+    work_cv_.notify_one();
+}
+
+CongestionJournalStats CongestionJournal::stats() const {
+    std::lock_guard lock{mutex_};
+    return CongestionJournalStats{next_sequence_, pending_.size(), log_bytes_, snapshots_, last_snapshot_ms_};
+}
+
+void CongestionJournal::run() {
+    std::vector<Batch> batches;
+    std::unique_lock lock{mutex_};
+    for (;;) {
+        work_cv_.wait_for(lock, options_.snapshot_interval, [this] { return stopping_ || !pending_.empty(); });
+        batches.swap(pending_);
+        const bool stopping = stopping_;
+        lock.unlock();
+
+        // A failed write leaves the batch unlogged, but must not take down
+        // the writer pipeline; the next snapshot captures it from the mirror.
+        try {
+            if (!batches.empty()) {
+                write_batches(batches);
+            }
+            const bool due = std::chrono::steady_clock::now() - last_snapshot_ >= options_.snapshot_interval;
+            if (written_sequence_ > snapshot_sequence_ && (due || stopping)) {
+                write_snapshot();
+            }
+        } catch (const std::exception& ex) {
+            std::cerr << ex.what() << '\n';
+        }
+        batches.clear();
+
+        lock.lock();
+        durable_sequence_ = written_sequence_;
+        flushed_cv_.notify_all();
+        if (stopping && pending_.empty()) {
+            return;
+        }
+    }
+}
+
+void CongestionJournal::write_batches(std::span<const Batch> batches) {
+    std::size_t first = 0;
+    for (std::size_t i = 0; i < batches.size(); ++i) {
+        if (!batches[i].restart_edge_count) {
+            continue;
+        }
+        if (i > first) {
+            append(batches.subspan(first, i - first));
+        }
+        factors_.assign(*batches[i].restart_edge_count, 1.0F);
+        written_sequence_ = batches[i].sequence;
+        write_snapshot();
+        first = i + 1;
+    }
+    if (first < batches.size()) {
+        append(batches.subspan(first));
+    }
+}
+
+void CongestionJournal::append(std::span<const Batch> batches) {
+    std::vector<char> buffer;
+    for (const auto& batch : batches) {
+        apply_factors(factors_, batch.updates);
+        written_sequence_ = batch.sequence;
+
+        const auto header_offset = buffer.size();
+        buffer.resize(header_offset + sizeof(LogEntryHeader) + batch.updates.size() * log_record_size);
+        char* payload = buffer.data() + header_offset + sizeof(LogEntryHeader);
+        for (std::size_t i = 0; i < batch.updates.size(); ++i) {
+            const auto edge_start = static_cast<std::uint32_t>(batch.updates[i].edge_start);
+            const auto edge_end = static_cast<std::uint32_t>(batch.updates[i].edge_end);
+            std::memcpy(payload + i * log_record_size, &edge_start, 4);
+            std::memcpy(payload + i * log_record_size + 4, &edge_end, 4);
+            std::memcpy(payload + i * log_record_size + 8, &batch.updates[i].factor, 4);
+        }
+        const LogEntryHeader header{batch.sequence, static_cast<std::uint32_t>(batch.updates.size()),
+                                    static_cast<std::uint32_t>(fnv1a(payload, batch.updates.size() * log_record_size))};
+        std::memcpy(buffer.data() + header_offset, &header, sizeof(header));
+    }
+
+    const auto path = (std::filesystem::path{options_.directory} / log_file).string();
+    write_all(log_fd_, buffer.data(), buffer.size(), path);
+    if (options_.sync) {
+        ::fdatasync(log_fd_);
+    }
+    std::lock_guard lock{mutex_};
+    log_bytes_ += buffer.size();
+}
+
+void CongestionJournal::write_snapshot() {
+    const auto start = std::chrono::steady_clock::now();
+    const std::filesystem::path root{options_.directory};
+    const auto path = (root / snapshot_file).string();
+    const auto temp_path = path + ".tmp";
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, snapshot_magic, sizeof(snapshot_magic));
+    header.version = snapshot_version;
+    header.edge_count = factors_.size();
+    header.sequence = written_sequence_;
+    header.checksum = fnv1a(reinterpret_cast<const char*>(factors_.data()), factors_.size() * sizeof(float));
+
+    const int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw io_error("open", temp_path);
+    }
+    try {
+        write_all(fd, reinterpret_cast<const char*>(&header), sizeof(header), temp_path);
+        write_all(fd, reinterpret_cast<const char*>(factors_.data()), factors_.size() * sizeof(float), temp_path);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::fsync(fd);
+    ::close(fd);
+    std::filesystem::rename(temp_path, path);
+
+    // Entries up to written_sequence_ are now in the snapshot.
+    snapshot_sequence_ = written_sequence_;
+    if (::ftruncate(log_fd_, 0) == 0) {
+        ::lseek(log_fd_, 0, SEEK_SET);
+    }
+    last_snapshot_ = std::chrono::steady_clock::now();
+
+    const std::chrono::duration<double, std::milli> elapsed = last_snapshot_ - start;
+    std::lock_guard lock{mutex_};
+    log_bytes_ = 0;
+    snapshots_++;
+    last_snapshot_ms_ = elapsed.count();
+}
+
+std::vector<CongestionUpdate> factor_runs(std::span<const float> factors) {
+    std::vector<CongestionUpdate> runs;
+    std::size_t i = 0;
+    while (i < factors.size()) {
+        std::size_t end = i;
+        while (end + 1 < factors.size() && factors[end + 1] == factors[i]) {
+            ++end;
+        }
+        if (factors[i] != 1.0F) {
+            runs.push_back(CongestionUpdate{i, end, factors[i]});
+        }
+        i = end + 1;
+    }
+    return runs;
+}
+
+}  // namespace georoute
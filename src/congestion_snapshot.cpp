@@ -0,0 +1,62 @@
+#include "georoute/congestion_snapshot.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace georoute {
+
+CongestionSnapshot::CongestionSnapshot(std::uint64_t epoch, std::span<const float> edge_costs)
+    : epoch_(epoch), edge_count_(edge_costs.size()) {
+    const auto chunk_count = (edge_count_ + chunk_size - 1) >> chunk_shift;
+    chunks_.reserve(chunk_count);
+    chunk_data_.reserve(chunk_count);
+    for (std::size_t chunk = 0; chunk < chunk_count; ++chunk) {
+        const auto begin = chunk << chunk_shift;
+        const auto end = std::min(begin + chunk_size, edge_count_);
+        auto data = std::make_shared<std::vector<float>>(edge_costs.begin() + static_cast<std::ptrdiff_t>(begin),
+                                                         edge_costs.begin() + static_cast<std::ptrdiff_t>(end));
+        chunk_data_.push_back(data->data());
+        chunks_.push_back(std::move(data));
+    }
+}
+
+std::shared_ptr<CongestionSnapshot> CongestionSnapshot::next() const {
+    auto copy = std::make_shared<CongestionSnapshot>(*this);
+    copy->epoch_ = epoch_ + 1;
+    return copy;
+}
+
+void CongestionSnapshot::multiply(std::size_t first, std::size_t last, float factor) {
+    if (first > last || last >= edge_count_) {
+        throw std::out_of_range{"CongestionSnapshot::multiply range out of bounds"};
+    }
+    for (auto chunk = first >> chunk_shift; chunk <= last >> chunk_shift; ++chunk) {
+        float* data = writable_chunk(chunk);
+        const auto chunk_begin = chunk << chunk_shift;
+        const auto begin = std::max(first, chunk_begin) - chunk_begin;
+        const auto end = std::min(last, chunk_begin + chunk_size - 1) - chunk_begin;
+        for (auto i = begin; i <= end; ++i) {
+            data[i] *= factor;
+        }
+    }
+}
+
+std::uint64_t CongestionSnapshot::epoch() const noexcept {
+    return epoch_;
+}
+
+std::size_t CongestionSnapshot::edge_count() const noexcept {
+    return edge_count_;
+}
+
+float* CongestionSnapshot::writable_chunk(std::size_t chunk) {
+    // An unpublished snapshot is the only place a new reference to its chunks
+    // can come from, so a count of one means nobody else can observe the chunk.
+    if (chunks_[chunk].use_count() > 1) {
+        chunks_[chunk] = std::make_shared<std::vector<float>>(*chunks_[chunk]);
+        chunk_data_[chunk] = chunks_[chunk]->data();
+    }
+    return chunk_data_[chunk];
+}
+
+}  // namespace georoute
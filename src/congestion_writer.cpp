@@ -0,0 +1,221 @@
+#include "georoute/congestion_writer.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include "georoute/engine.hpp"
+
+namespace georoute {
+
+CongestionWriter::CongestionWriter(GeoRouteEngine& engine, CongestionWriterOptions options)
+    : engine_(engine), options_(options), thread_([this] { run(); }) {}
+
+CongestionWriter::~CongestionWriter() {
+    stopping_.store(true, std::memory_order_release);
+    signal_.fetch_add(1, std::memory_order_release);
+    signal_.notify_one();
+    thread_.join();
+}
+
+std::uint64_t CongestionWriter::enqueue(const CongestionUpdate& update) {
+    return enqueue(std::span<const CongestionUpdate>{&update, 1});
+}
+
+std::uint64_t CongestionWriter::enqueue(std::span<const CongestionUpdate> updates) {
+    const auto edge_count = engine_.edge_count();
+    for (const auto& update : updates) {
+        if (update.edge_start > update.edge_end) {
+            throw std::invalid_argument{"CongestionWriter::enqueue invalid range"};
+        }
+        if (update.edge_end >= edge_count) {
+            throw std::out_of_range{"CongestionWriter::enqueue range exceeds edge count"};
+        }
+        if (!valid_congestion_factor(update.factor)) {
+            throw std::invalid_argument{"CongestionWriter::enqueue factor must be finite and non-negative"};
+        }
+    }
+
+    auto* node = new Node{};
+    node->updates.assign(updates.begin(), updates.end());
+    node->enqueued_at = std::chrono::steady_clock::now();
+    node->sequence = next_sequence_.fetch_add(1, std::memory_order_relaxed) + 1;
+    const auto sequence = node->sequence;
+
+    push(node);
+    enqueued_count_.fetch_add(1, std::memory_order_relaxed);
+    signal_.fetch_add(1, std::memory_order_release);
+    signal_.notify_one();
+    return sequence;
+}
+
+bool CongestionWriter::wait_for(std::uint64_t sequence, std::chrono::milliseconds timeout) const {
+    if (applied_sequence() >= sequence) {
+        return true;
+    }
+    std::unique_lock lock{wait_mutex_};
+    return applied_cv_.wait_for(lock, timeout, [this, sequence] { return applied_sequence() >= sequence; });
+}
+
+std::uint64_t CongestionWriter::applied_sequence() const noexcept {
+    return applied_sequence_.load(std::memory_order_acquire);
+}
+
+std::size_t CongestionWriter::edge_count() const noexcept {
+    return engine_.edge_count();
+}
+
+CongestionWriterStats CongestionWriter::stats() const {
+    CongestionWriterStats snapshot;
+    {
+        std::lock_guard lock{stats_mutex_};
+        snapshot = stats_;
+    }
+    const auto enqueued = enqueued_count_.load(std::memory_order_relaxed);
+    const auto drained = drained_count_.load(std::memory_order_relaxed);
+    snapshot.enqueued_sequence = next_sequence_.load(std::memory_order_relaxed);
+    snapshot.applied_sequence = applied_sequence();
+    snapshot.queue_depth = enqueued > drained ? enqueued - drained : 0;
+    return snapshot;
+}
+
+void CongestionWriter::push(Node* node) noexcept {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node* previous = head_.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+}
+
+CongestionWriter::Node* CongestionWriter::pop() noexcept {
+    Node* tail = tail_;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &stub_) {
+        if (next == nullptr) {
+            return nullptr;
+        }
+        tail_ = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+        tail_ = next;
+        return tail;
+    }
+    // tail is the last linked node. If a producer has exchanged head_ but not
+    // linked its node yet, leave tail in place; its signal wakes us again.
+    if (tail != head_.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    push(&stub_);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+        tail_ = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+void CongestionWriter::run() {
+    std::vector<Node*> drained;
+    auto observed = signal_.load(std::memory_order_acquire);
+    for (;;) {
+        const bool stopping = stopping_.load(std::memory_order_acquire);
+        if (!stopping && enqueued_count_.load(std::memory_order_relaxed) ==
+                             drained_count_.load(std::memory_order_relaxed)) {
+            signal_.wait(observed, std::memory_order_acquire);
+            observed = signal_.load(std::memory_order_acquire);
+            continue;
+        }
+
+        if (!stopping && options_.coalesce_window.count() > 0) {
+            std::this_thread::sleep_for(options_.coalesce_window);
+        }
+        observed = signal_.load(std::memory_order_acquire);
+
+        while (Node* node = pop()) {
+            drained.push_back(node);
+        }
+        if (!drained.empty()) {
+            apply(drained);
+        }
+        if (stopping && enqueued_count_.load(std::memory_order_acquire) ==
+                            drained_count_.load(std::memory_order_acquire)) {
+            return;
+        }
+    }
+}
+
+void CongestionWriter::apply(std::vector<Node*>& drained) {
+    std::vector<CongestionUpdate> updates;
+    for (const auto* node : drained) {
+        updates.insert(updates.end(), node->updates.begin(), node->updates.end());
+    }
+
+    // Ranges were validated by enqueue against the graph of that moment. A
+    // graph swap in between can leave some out of range; those are dropped
+    // rather than failing the whole batch, and the sequences still advance.
+    const auto edge_count = engine_.edge_count();
+    auto dropped = static_cast<std::uint64_t>(
+        std::erase_if(updates, [edge_count](const auto& update) { return update.edge_end >= edge_count; }));
+    CongestionBatchResult result{};
+    if (!updates.empty()) {
+        try {
+            result = engine_.apply_congestion_updates(updates);
+        } catch (const std::exception& ex) {
+            std::cerr << "CongestionWriter::apply dropped batch: " << ex.what() << '\n';
+            dropped += updates.size();
+            updates.clear();
+        }
+    }
+    const auto epoch = updates.empty() ? engine_.current_epoch() : result.epoch;
+    const auto applied_at = std::chrono::steady_clock::now();
+
+    double batch_max_lag = 0.0;
+    double batch_total_lag = 0.0;
+    for (const auto* node : drained) {
+        const std::chrono::duration<double, std::micro> lag = applied_at - node->enqueued_at;
+        batch_max_lag = std::max(batch_max_lag, lag.count());
+        batch_total_lag += lag.count();
+        out_of_order_.push_back(node->sequence);
+        std::push_heap(out_of_order_.begin(), out_of_order_.end(), std::greater<>{});
+    }
+
+    // Sequences are taken before the queue push, so a later sequence can be
+    // drained while an earlier one is still being linked. Only advance the
+    // visible sequence over a contiguous prefix.
+    auto applied = applied_sequence_.load(std::memory_order_relaxed);
+    while (!out_of_order_.empty() && out_of_order_.front() == applied + 1) {
+        std::pop_heap(out_of_order_.begin(), out_of_order_.end(), std::greater<>{});
+        out_of_order_.pop_back();
+        ++applied;
+    }
+
+    {
+        std::lock_guard lock{stats_mutex_};
+        stats_.batches++;
+        stats_.coalesced_updates += updates.size();
+        stats_.dropped_updates += dropped;
+        stats_.epoch = epoch;
+        stats_.last_apply_lag_us = batch_max_lag;
+        stats_.max_apply_lag_us = std::max(stats_.max_apply_lag_us, batch_max_lag);
+        total_apply_lag_us_ += batch_total_lag;
+        lag_samples_ += drained.size();
+        stats_.mean_apply_lag_us = total_apply_lag_us_ / static_cast<double>(lag_samples_);
+    }
+
+    drained_count_.fetch_add(drained.size(), std::memory_order_release);
+    for (auto* node : drained) {
+        delete node;
+    }
+    drained.clear();
+
+    {
+        std::lock_guard lock{wait_mutex_};
+        applied_sequence_.store(applied, std::memory_order_release);
+    }
+    applied_cv_.notify_all();
+}
+
+}  // namespace georoute
@@ -0,0 +1,64 @@
+#include "georoute/connection_threads.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace georoute {
+
+ConnectionThreads::~ConnectionThreads() {
+    join_all();
+}
+
+void ConnectionThreads::spawn(std::function<void()> serve) {
+    reap();
+    std::lock_guard lock{mutex_};
+    // The new thread reports itself finished under mutex_, so it is always
+    // in threads_ by then.
+    active_.fetch_add(1, std::memory_order_relaxed);
+    threads_.emplace_back([this, serve = std::move(serve)] {
+        serve();
+        active_.fetch_sub(1, std::memory_order_relaxed);
+        std::lock_guard finished_lock{mutex_};
+        finished_.push_back(std::this_thread::get_id());
+    });
+}
+
+void ConnectionThreads::reap() {
+    std::vector<std::thread> done;
+    {
+        std::lock_guard lock{mutex_};
+        for (const auto id : finished_) {
+            const auto thread = std::find_if(threads_.begin(), threads_.end(), [id](const std::thread& candidate) {
+                return candidate.get_id() == id;
+            });
+            if (thread != threads_.end()) {
+                done.push_back(std::move(*thread));
+                threads_.erase(thread);
+            }
+        }
+        finished_.clear();
+    }
+    // Joined outside the lock: each has at most its finished_ push left to run.
+    for (auto& thread : done) {
+        thread.join();
+    }
+}
+
+void ConnectionThreads::join_all() {
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard lock{mutex_};
+        threads.swap(threads_);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::lock_guard lock{mutex_};
+    finished_.clear();
+}
+
+std::size_t ConnectionThreads::active() const noexcept {
+    return active_.load(std::memory_order_relaxed);
+}
+
+}  // namespace georoute
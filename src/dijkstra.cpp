@@ -2,56 +2,77 @@
 
 #include <algorithm>
 #include <limits>
-#include <queue>
 #include <stdexcept>
 #include <utility>
 
 namespace georoute {
 
-DijkstraRouter::DijkstraRouter(const Graph& graph, const SegmentTree& congestion_tree)
-    : graph_(graph), congestion_tree_(congestion_tree) {}
+namespace {
 
-RouteComputation DijkstraRouter::shortest_path(node_id source, node_id target) const {
-    const auto node_count = graph_.node_count();
+constexpr double unreached = std::numeric_limits<double>::infinity();
+constexpr node_id no_predecessor = std::numeric_limits<node_id>::max();
+
+struct CompareEntry {
+    bool operator()(const SearchQueueEntry& lhs, const SearchQueueEntry& rhs) const noexcept {
+        return lhs.cost > rhs.cost;
+    }
+};
+
+void prepare_scratch(SearchScratch& scratch, std::size_t node_count) {
+    if (scratch.distances.size() != node_count) {
+        scratch.distances.assign(node_count, unreached);
+        scratch.predecessors.assign(node_count, no_predecessor);
+        scratch.visited.assign(node_count, false);
+    } else {
+        for (const auto node : scratch.touched) {
+            scratch.distances[node] = unreached;
+            scratch.predecessors[node] = no_predecessor;
+            scratch.visited[node] = false;
+        }
+    }
+    scratch.touched.clear();
+    scratch.queue.clear();
+}
+
+template <typename EdgeCost>
+RouteComputation run_dijkstra(const Graph& graph,
+                              node_id source,
+                              node_id target,
+                              SearchScratch& scratch,
+                              const SearchBudget& budget,
+                              std::pmr::memory_resource* resource,
+                              EdgeCost&& edge_cost_of) {
+    const auto node_count = graph.node_count();
     if (source >= node_count || target >= node_count) {
         throw std::out_of_range{"DijkstraRouter::shortest_path node id out of range"};
     }
 
     RouteStats stats{};
-    RouteResult result{};
+    RouteResult result{std::pmr::vector<node_id>{resource}};
 
     if (source == target) {
-        result.nodes = {source};
+        result.nodes.push_back(source);
         result.total_travel_time = 0.0F;
         result.reachable = true;
         stats.expanded_nodes = 1;
         stats.visited_nodes = 1;
-        return RouteComputation{result, stats};
+        return RouteComputation{std::move(result), stats};
     }
 
-    constexpr double inf = std::numeric_limits<double>::infinity();
-    std::vector<double> distances(node_count, inf);
-    std::vector<node_id> predecessors(node_count, std::numeric_limits<node_id>::max());
-    std::vector<bool> visited(node_count, false);
+    prepare_scratch(scratch, node_count);
+    auto& distances = scratch.distances;
+    auto& predecessors = scratch.predecessors;
+    auto& visited = scratch.visited;
+    auto& queue = scratch.queue;
 
     distances[source] = 0.0;
-
-    struct QueueEntry {
-        node_id node;
-        double cost;
-    };
-    struct CompareEntry {
-        bool operator()(const QueueEntry& lhs, const QueueEntry& rhs) const noexcept {
-            return lhs.cost > rhs.cost;
-        }
-    };
-
-    std::priority_queue<QueueEntry, std::vector<QueueEntry>, CompareEntry> queue;
-    queue.push(QueueEntry{source, 0.0});
+    scratch.touched.push_back(source);
+    queue.push_back(SearchQueueEntry{source, 0.0});
 
     while (!queue.empty()) {
-        const auto current = queue.top();
-        queue.pop();
+        std::pop_heap(queue.begin(), queue.end(), CompareEntry{});
+        const auto current = queue.back();
+        queue.pop_back();
 
         // Skip stale entries
         if (current.cost > distances[current.node]) {
@@ -71,43 +92,97 @@ RouteComputation DijkstraRouter::shortest_path(node_id source, node_id target) c
             break;
         }
 
-        for (const auto& edge : graph_.neighbors(current.node)) {
-            const float congestion_factor = congestion_tree_.point_query(edge.id);
-            const double edge_cost = static_cast<double>(edge.base_travel_time) * static_cast<double>(congestion_factor);
+        if (budget.max_settled_nodes != 0 && stats.expanded_nodes >= budget.max_settled_nodes) {
+            return RouteComputation{RouteResult{}, stats, RouteStatus::node_budget_exceeded};
+        }
+        // Reading the clock costs more than a whole pop, so only sample it.
+        if (stats.expanded_nodes % SearchBudget::clock_check_interval == 0 &&
+            std::chrono::steady_clock::now() >= budget.deadline) {
+            return RouteComputation{RouteResult{}, stats, RouteStatus::deadline_exceeded};
+        }
+
+        for (const auto& edge : graph.neighbors(current.node)) {
+            const double edge_cost = edge_cost_of(edge);
             const double new_cost = current.cost + edge_cost;
 
             if (new_cost < distances[edge.to]) {
+                if (distances[edge.to] == unreached) {
+                    scratch.touched.push_back(edge.to);
+                }
                 distances[edge.to] = new_cost;
                 predecessors[edge.to] = current.node;
                 stats.relaxed_edges++;
 
-                queue.push(QueueEntry{edge.to, new_cost});
+                queue.push_back(SearchQueueEntry{edge.to, new_cost});
+                std::push_heap(queue.begin(), queue.end(), CompareEntry{});
             }
         }
     }
 
-    if (distances[target] == inf) {
-        return RouteComputation{result, stats};
+    if (distances[target] == unreached) {
+        return RouteComputation{std::move(result), stats};
     }
 
-    std::vector<node_id> path;
-    for (node_id current = target; current != std::numeric_limits<node_id>::max(); current = predecessors[current]) {
-        path.push_back(current);
+    // Walk the predecessor chain twice, once to size the path and once to
+    // fill it back to front, so the path costs a single allocation.
+    std::size_t length = 0;
+    node_id first = target;
+    for (node_id current = target; current != no_predecessor; current = predecessors[current]) {
+        ++length;
+        first = current;
         if (current == source) {
             break;
         }
     }
 
-    if (path.empty() || path.back() != source) {
-        return RouteComputation{result, stats};
+    if (first != source) {
+        return RouteComputation{std::move(result), stats};
     }
 
-    std::reverse(path.begin(), path.end());
-
-    result.nodes = std::move(path);
+    result.nodes.resize(length);
+    auto slot = length;
+    for (node_id current = target; slot > 0; current = predecessors[current]) {
+        result.nodes[--slot] = current;
+    }
     result.total_travel_time = static_cast<float>(distances[target]);
     result.reachable = true;
-    return RouteComputation{result, stats};
+    return RouteComputation{std::move(result), stats};
+}
+
+}  // namespace
+
+DijkstraRouter::DijkstraRouter(const Graph& graph, const SegmentTree& congestion_tree)
+    : graph_(graph), congestion_tree_(&congestion_tree) {}
+
+DijkstraRouter::DijkstraRouter(const Graph& graph, const CongestionSnapshot& snapshot)
+    : graph_(graph), snapshot_(&snapshot) {
+    if (snapshot.edge_count() < graph_.edge_count()) {
+        throw std::invalid_argument{"DijkstraRouter congestion snapshot smaller than edge count"};
+    }
+}
+
+RouteComputation DijkstraRouter::shortest_path(node_id source, node_id target) const {
+    SearchScratch scratch;
+    return shortest_path(source, target, scratch);
+}
+
+RouteComputation DijkstraRouter::shortest_path(node_id source,
+                                               node_id target,
+                                               SearchScratch& scratch,
+                                               const SearchBudget& budget,
+                                               std::pmr::memory_resource* resource) const {
+    if (congestion_tree_ != nullptr) {
+        const auto& tree = *congestion_tree_;
+        return run_dijkstra(graph_, source, target, scratch, budget, resource, [&tree](const Edge& edge) {
+            const float congestion_factor = tree.point_query(edge.id);
+            return static_cast<double>(edge.base_travel_time) * static_cast<double>(congestion_factor);
+        });
+    }
+
+    const auto& snapshot = *snapshot_;
+    return run_dijkstra(graph_, source, target, scratch, budget, resource, [&snapshot](const Edge& edge) {
+        return static_cast<double>(snapshot.cost(edge.id));
+    });
 }
 
 }  // namespace georoute
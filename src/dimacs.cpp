@@ -0,0 +1,456 @@
+#include "georoute/dimacs.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace georoute {
+
+namespace {
+
+constexpr std::size_t read_block_bytes = std::size_t{1} << 20;
+constexpr double degree_units = 1e6;
+
+// Hands out the lines of a file, read in large blocks and parsed in place
+// from the block, so even a multi-gigabyte file costs one buffer.
+class LineReader {
+public:
+    explicit LineReader(const std::string& path) : path_(path), buffer_(read_block_bytes) {
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            throw std::runtime_error{"read_dimacs open " + path + ": " + std::strerror(errno)};
+        }
+        ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+
+    ~LineReader() { ::close(fd_); }
+
+    // False at the end of the file. The line has no line terminator and is
+    // valid until the next call.
+    bool next(std::string_view& line) {
+        while (true) {
+            const auto* start = buffer_.data() + begin_;
+            const auto* newline = static_cast<const char*>(std::memchr(start, '\n', end_ - begin_));
+            if (newline != nullptr) {
+                line = std::string_view{start, static_cast<std::size_t>(newline - start)};
+                begin_ += line.size() + 1;
+                break;
+            }
+            if (eof_) {
+                if (begin_ == end_) {
+                    return false;
+                }
+                line = std::string_view{start, end_ - begin_};
+                begin_ = end_;
+                break;
+            }
+            fill();
+        }
+        ++line_number_;
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        return true;
+    }
+
+    [[nodiscard]] std::runtime_error error(const std::string& what) const {
+        return std::runtime_error{"read_dimacs " + path_ + " line " + std::to_string(line_number_) + ": " + what};
+    }
+
+private:
+    // Moves the partial line to the front and reads behind it, growing the
+    // buffer only for a line longer than a block.
+    void fill() {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+        if (end_ == buffer_.size()) {
+            buffer_.resize(buffer_.size() * 2);
+        }
+        const auto bytes = ::read(fd_, buffer_.data() + end_, buffer_.size() - end_);
+        if (bytes < 0) {
+            if (errno == EINTR) {
+                return;
+            }
+            throw std::runtime_error{"read_dimacs read " + path_ + ": " + std::strerror(errno)};
+        }
+        if (bytes == 0) {
+            eof_ = true;
+        }
+        end_ += static_cast<std::size_t>(bytes);
+    }
+
+    std::string path_;
+    int fd_{-1};
+    std::vector<char> buffer_;
+    std::size_t begin_{0};
+    std::size_t end_{0};
+    bool eof_{false};
+    std::size_t line_number_{0};
+};
+
+// Splits a line into whitespace-separated fields without copying.
+class Fields {
+public:
+    explicit Fields(std::string_view line) : rest_(line) {}
+
+    bool next(std::string_view& field) {
+        const auto start = rest_.find_first_not_of(" \t");
+        if (start == std::string_view::npos) {
+            return false;
+        }
+        rest_.remove_prefix(start);
+        const auto length = std::min(rest_.find_first_of(" \t"), rest_.size());
+        field = rest_.substr(0, length);
+        rest_.remove_prefix(length);
+        return true;
+    }
+
+    template <typename T>
+    bool next_number(T& out) {
+        std::string_view field;
+        if (!next(field)) {
+            return false;
+        }
+        const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), out);
+        return error == std::errc{} && end == field.data() + field.size();
+    }
+
+    [[nodiscard]] bool done() {
+        std::string_view field;
+        return !next(field);
+    }
+
+private:
+    std::string_view rest_;
+};
+
+// The line without leading blanks; empty for blank lines and comments.
+std::string_view significant(std::string_view line) noexcept {
+    const auto start = line.find_first_not_of(" \t");
+    if (start == std::string_view::npos || line[start] == 'c') {
+        return {};
+    }
+    return line.substr(start);
+}
+
+// Parses "p <words...> <count>..." and returns the counts.
+template <std::size_t Counts>
+std::array<std::uint64_t, Counts> parse_problem(LineReader& reader,
+                                                 std::string_view line,
+                                                 std::initializer_list<std::string_view> words) {
+    Fields fields{line};
+    std::string_view field;
+    fields.next(field);
+    for (const auto word : words) {
+        if (!fields.next(field) || field != word) {
+            throw reader.error("expected the problem line 'p " + std::string{*words.begin()} + " ...'");
+        }
+    }
+    std::array<std::uint64_t, Counts> counts{};
+    for (auto& count : counts) {
+        if (!fields.next_number(count)) {
+            throw reader.error("malformed problem line");
+        }
+    }
+    if (!fields.done()) {
+        throw reader.error("malformed problem line");
+    }
+    return counts;
+}
+
+node_id parse_node(LineReader& reader, Fields& fields, std::uint64_t node_count) {
+    std::uint64_t id = 0;
+    if (!fields.next_number(id)) {
+        throw reader.error("malformed node id");
+    }
+    if (id == 0 || id > node_count) {
+        throw reader.error("node id " + std::to_string(id) + " outside 1.." + std::to_string(node_count));
+    }
+    return static_cast<node_id>(id - 1);
+}
+
+struct Arc {
+    node_id from;
+    node_id to;
+    double weight;
+};
+
+Arc parse_arc(LineReader& reader, std::string_view line, std::uint64_t node_count) {
+    Fields fields{line};
+    std::string_view tag;
+    fields.next(tag);
+    Arc arc{};
+    arc.from = parse_node(reader, fields, node_count);
+    arc.to = parse_node(reader, fields, node_count);
+    if (!fields.next_number(arc.weight) || !fields.done()) {
+        throw reader.error("arc lines are 'a <from> <to> <weight>'");
+    }
+    if (!(arc.weight >= 0.0) || !std::isfinite(arc.weight)) {
+        throw reader.error("arc weight must be a non-negative number");
+    }
+    return arc;
+}
+
+std::vector<Coordinate> read_coordinates(const std::string& path, std::size_t node_count) {
+    LineReader reader{path};
+    std::string_view line;
+    std::vector<Coordinate> coordinates;
+    std::vector<bool> seen;
+    std::size_t read = 0;
+    bool have_problem = false;
+    while (reader.next(line)) {
+        line = significant(line);
+        if (line.empty()) {
+            continue;
+        }
+        if (line.front() == 'p') {
+            if (have_problem) {
+                throw reader.error("second problem line");
+            }
+            const auto [nodes] = parse_problem<1>(reader, line, {"aux", "sp", "co"});
+            if (nodes != node_count) {
+                throw reader.error("has " + std::to_string(nodes) + " nodes, the graph " +
+                                   std::to_string(node_count));
+            }
+            coordinates.resize(node_count);
+            seen.resize(node_count, false);
+            have_problem = true;
+            continue;
+        }
+        if (line.front() != 'v' || !have_problem) {
+            throw reader.error("expected 'v <node> <lon> <lat>' after the problem line");
+        }
+        Fields fields{line};
+        std::string_view tag;
+        fields.next(tag);
+        const auto node = parse_node(reader, fields, node_count);
+        std::int64_t lon = 0;
+        std::int64_t lat = 0;
+        if (!fields.next_number(lon) || !fields.next_number(lat) || !fields.done()) {
+            throw reader.error("coordinate lines are 'v <node> <lon> <lat>'");
+        }
+        if (seen[node]) {
+            throw reader.error("second coordinate for node " + std::to_string(node + 1));
+        }
+        seen[node] = true;
+        coordinates[node] =
+            Coordinate{static_cast<double>(lat) / degree_units, static_cast<double>(lon) / degree_units};
+        ++read;
+    }
+    if (read != node_count) {
+        throw reader.error("has coordinates for " + std::to_string(read) + " of " + std::to_string(node_count) +
+                           " nodes");
+    }
+    return coordinates;
+}
+
+std::runtime_error write_error(const std::string& path) {
+    return std::runtime_error{"write_dimacs failed to write " + path};
+}
+
+template <typename T>
+void append_number(std::string& out, T value) {
+    char digits[32];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+// Whole-number weights are written as integers, as the challenge files are.
+void append_weight(std::string& out, float weight) {
+    if (std::trunc(weight) == weight && std::fabs(weight) < 1e15F) {
+        append_number(out, static_cast<std::int64_t>(weight));
+    } else {
+        append_number(out, weight);
+    }
+}
+
+void flush_block(std::ofstream& output, std::string& block, const std::string& path) {
+    output.write(block.data(), static_cast<std::streamsize>(block.size()));
+    if (!output) {
+        throw write_error(path);
+    }
+    block.clear();
+}
+
+}  // namespace
+
+Graph read_dimacs(const std::string& path, const DimacsImportOptions& options) {
+    std::uint64_t node_count = 0;
+    std::uint64_t arc_count = 0;
+    std::vector<std::uint32_t> out_degree;
+    {
+        LineReader reader{path};
+        std::string_view line;
+        bool have_problem = false;
+        std::uint64_t arcs = 0;
+        while (reader.next(line)) {
+            line = significant(line);
+            if (line.empty()) {
+                continue;
+            }
+            if (line.front() == 'p') {
+                if (have_problem) {
+                    throw reader.error("second problem line");
+                }
+                const auto counts = parse_problem<2>(reader, line, {"sp"});
+                node_count = counts[0];
+                arc_count = counts[1];
+                if (node_count > std::numeric_limits<node_id>::max() ||
+                    arc_count > std::numeric_limits<edge_id>::max()) {
+                    throw reader.error("graph too large for 32-bit node and edge ids");
+                }
+                out_degree.assign(node_count, 0);
+                have_problem = true;
+                continue;
+            }
+            if (line.front() != 'a' || !have_problem) {
+                throw reader.error("expected 'a <from> <to> <weight>' after the problem line");
+            }
+            if (arcs == arc_count) {
+                throw reader.error("more arcs than the " + std::to_string(arc_count) + " declared");
+            }
+            // Only the source is needed to size the lists; the second pass
+            // checks the rest of the line.
+            Fields fields{line};
+            std::string_view tag;
+            fields.next(tag);
+            ++out_degree[parse_node(reader, fields, node_count)];
+            ++arcs;
+        }
+        if (!have_problem) {
+            throw reader.error("no problem line");
+        }
+        if (arcs != arc_count) {
+            throw reader.error("has " + std::to_string(arcs) + " of the " + std::to_string(arc_count) +
+                               " declared arcs");
+        }
+    }
+
+    std::vector<std::vector<Edge>> adjacency(node_count);
+    for (std::size_t u = 0; u < node_count; ++u) {
+        adjacency[u].reserve(out_degree[u]);
+    }
+    std::vector<std::uint32_t>{}.swap(out_degree);
+
+    LineReader reader{path};
+    std::string_view line;
+    edge_id next_id = 0;
+    while (reader.next(line)) {
+        line = significant(line);
+        if (line.empty() || line.front() != 'a') {
+            continue;
+        }
+        const auto arc = parse_arc(reader, line, node_count);
+        auto& edges = adjacency[arc.from];
+        if (edges.size() == edges.capacity() || next_id == arc_count) {
+            throw reader.error("file changed while it was read");
+        }
+        edges.push_back(Edge{arc.to, static_cast<float>(arc.weight * options.weight_scale), next_id++});
+    }
+
+    auto graph = Graph::from_adjacency(std::move(adjacency));
+    if (!options.coordinates_path.empty()) {
+        graph.set_coordinates(read_coordinates(options.coordinates_path, node_count));
+    }
+    return graph;
+}
+
+std::string dimacs_coordinates_path(const std::string& graph_path) {
+    std::filesystem::path path{graph_path};
+    if (path.extension() != ".gr") {
+        return {};
+    }
+    path.replace_extension(".co");
+    std::error_code error;
+    return std::filesystem::is_regular_file(path, error) ? path.string() : std::string{};
+}
+
+void write_dimacs(const Graph& graph, const std::string& path, const std::string& coordinates_path) {
+    // Arcs go out in edge id order, so read_dimacs gives every edge its id back.
+    std::vector<std::pair<node_id, const Edge*>> by_id(graph.edge_count());
+    for (node_id u = 0; u < graph.node_count(); ++u) {
+        for (const auto& edge : graph.neighbors(u)) {
+            by_id[edge.id] = {u, &edge};
+        }
+    }
+
+    std::ofstream output{path, std::ios::binary | std::ios::trunc};
+    if (!output) {
+        throw write_error(path);
+    }
+    std::string block;
+    block.reserve(read_block_bytes + 64);
+    block += "c written by georoute\np sp ";
+    append_number(block, graph.node_count());
+    block += ' ';
+    append_number(block, graph.edge_count());
+    block += '\n';
+    for (const auto& [from, edge] : by_id) {
+        block += "a ";
+        append_number(block, from + 1);
+        block += ' ';
+        append_number(block, edge->to + 1);
+        block += ' ';
+        append_weight(block, edge->base_travel_time);
+        block += '\n';
+        if (block.size() >= read_block_bytes) {
+            flush_block(output, block, path);
+        }
+    }
+    flush_block(output, block, path);
+    output.close();
+    if (!output) {
+        throw write_error(path);
+    }
+
+    const auto& coordinates = graph.coordinates();
+    if (coordinates_path.empty() || !coordinates) {
+        return;
+    }
+    std::ofstream co{coordinates_path, std::ios::binary | std::ios::trunc};
+    if (!co) {
+        throw write_error(coordinates_path);
+    }
+    block += "c written by georoute\np aux sp co ";
+    append_number(block, graph.node_count());
+    block += '\n';
+    for (node_id u = 0; u < coordinates->size(); ++u) {
+        block += "v ";
+        append_number(block, u + 1);
+        block += ' ';
+        append_number(block, std::llround((*coordinates)[u].lon * degree_units));
+        block += ' ';
+        append_number(block, std::llround((*coordinates)[u].lat * degree_units));
+        block += '\n';
+        if (block.size() >= read_block_bytes) {
+            flush_block(co, block, coordinates_path);
+        }
+    }
+    flush_block(co, block, coordinates_path);
+    co.close();
+    if (!co) {
+        throw write_error(coordinates_path);
+    }
+}
+
+}  // namespace georoute
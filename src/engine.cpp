@@ -1,55 +1,406 @@
 #include "georoute/engine.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <exception>
+#include <latch>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
 #include <nlohmann/json.hpp>
 
+#include "georoute/congestion_journal.hpp"
+#include "georoute/route_coalescer.hpp"
+
 namespace georoute {
 
+namespace {
+
+#if defined(__cpp_lib_atomic_shared_ptr)
+using RouterSlot = std::atomic<std::shared_ptr<Router>>;
+
+std::shared_ptr<Router> load_router(const RouterSlot& slot) {
+    return slot.load(std::memory_order_acquire);
+}
+
+void store_router(RouterSlot& slot, std::shared_ptr<Router> router) {
+    slot.store(std::move(router), std::memory_order_release);
+}
+#else
+using RouterSlot = std::shared_ptr<Router>;
+
+std::shared_ptr<Router> load_router(const RouterSlot& slot) {
+    return std::atomic_load_explicit(&slot, std::memory_order_acquire);
+}
+
+void store_router(RouterSlot& slot, std::shared_ptr<Router> router) {
+    std::atomic_store_explicit(&slot, std::move(router), std::memory_order_release);
+}
+#endif
+
+// Search arrays for route() / route_at_epoch() on threads outside the worker
+// pool (HTTP handlers, the CLI). Sized to the graph on a thread's first query
+// and reused by every later one, like a worker's own scratch.
+SearchScratch& caller_scratch() {
+    thread_local SearchScratch scratch;
+    return scratch;
+}
+
+std::uint64_t elapsed_ns(std::chrono::high_resolution_clock::time_point start,
+                         std::chrono::high_resolution_clock::time_point end) {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+}  // namespace
+
 GeoRouteEngine::GeoRouteEngine(Router router)
-    : router_(std::move(router)), stats_{} {}
+    : router_(std::make_shared<Router>(std::move(router))), coalescer_(std::make_unique<RouteCoalescer>()) {}
+
+GeoRouteEngine::GeoRouteEngine(GeoRouteEngine&& other) noexcept
+    : router_(load_router(other.router_)), journal_(other.journal_),
+      stats_(std::move(other.stats_)),
+      worker_threads_(other.worker_threads_),
+      route_coalescing_(other.route_coalescing_.load()),
+      coalescer_(std::move(other.coalescer_)),
+      executor_view_(other.executor_view_.load()),
+      executor_(std::move(other.executor_)) {}
+
+GeoRouteEngine::~GeoRouteEngine() = default;
+
+RouteResponse GeoRouteEngine::route(node_id source,
+                                    node_id target,
+                                    const SearchBudget& budget,
+                                    std::pmr::memory_resource* resource) {
+    return route_with(source, target, caller_scratch(), budget, resource);
+}
 
-RouteResponse GeoRouteEngine::route(node_id source, node_id target) {
+RouteResponse GeoRouteEngine::route_at_epoch(std::uint64_t epoch,
+                                             node_id source,
+                                             node_id target,
+                                             const SearchBudget& budget,
+                                             std::pmr::memory_resource* resource) {
+    const auto pinned = router();
     const auto start = std::chrono::high_resolution_clock::now();
     
-    const auto computation = router_.compute_route(source, target);
+    auto computation = pinned->compute_route_at(epoch, source, target, caller_scratch(), budget, resource);
     
     const auto end = std::chrono::high_resolution_clock::now();
-    const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-    const double compute_time_us = static_cast<double>(duration.count());
-    
-    {
-        std::lock_guard<std::mutex> lock{stats_mutex_};
-        stats_.total_queries++;
-        stats_.total_compute_time_us += compute_time_us;
-        stats_.max_compute_time_us = std::max(stats_.max_compute_time_us, compute_time_us);
+    return record_route(std::move(computation),
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start),
+                        pinned->graph());
+}
+
+RouteResponse GeoRouteEngine::route_with(node_id source,
+                                         node_id target,
+                                         SearchScratch& scratch,
+                                         const SearchBudget& budget,
+                                         std::pmr::memory_resource* resource) {
+    const auto pinned = router();
+    if (!route_coalescing_.load(std::memory_order_relaxed)) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        
+        auto computation = pinned->compute_route(source, target, scratch, budget, resource);
+        
+        const auto end = std::chrono::high_resolution_clock::now();
+        return record_route(std::move(computation),
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start),
+                            pinned->graph());
     }
-    
-    RouteResponse response;
-    response.result = computation.result;
-    response.compute_time_us = compute_time_us;
-    response.expanded_nodes = computation.stats.expanded_nodes;
-    {
-        std::lock_guard<std::mutex> lock{stats_mutex_};
-        response.stats = stats_;
+
+    // Pin the snapshot first so the flight key names the epoch the search uses.
+    const auto snapshot = pinned->snapshot();
+    const RouteFlightKey key{pinned.get(), snapshot->epoch(), source, target, budget.max_settled_nodes};
+    const auto start = std::chrono::high_resolution_clock::now();
+    auto response = coalescer_->run(key, budget.deadline, resource, [&] {
+        auto computation = pinned->compute_route_on(*snapshot, source, target, scratch, budget, resource);
+        const auto end = std::chrono::high_resolution_clock::now();
+        return record_route(std::move(computation),
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start),
+                            pinned->graph());
+    });
+    if (response.coalesced) {
+        const auto end = std::chrono::high_resolution_clock::now();
+        response.compute_time_us = static_cast<double>(elapsed_ns(start, end)) / 1000.0;
+        stats_.record_coalesced();
     }
-    
     return response;
 }
 
-void GeoRouteEngine::apply_congestion_update(std::size_t edge_start, std::size_t edge_end, float factor) {
-    router_.apply_congestion_update(edge_start, edge_end, factor);
-    std::lock_guard<std::mutex> lock{stats_mutex_};
-    stats_.total_updates++;
+void GeoRouteEngine::set_route_coalescing(bool enabled) noexcept {
+    route_coalescing_.store(enabled, std::memory_order_relaxed);
+}
+
+bool GeoRouteEngine::route_coalescing() const noexcept {
+    return route_coalescing_.load(std::memory_order_relaxed);
+}
+
+void GeoRouteEngine::check_nodes(node_id source, node_id target, const char* caller) const {
+    const auto nodes = router()->node_count();
+    if (source >= nodes || target >= nodes) {
+        throw std::out_of_range{std::string{"GeoRouteEngine::"} + caller + " node id out of range"};
+    }
+}
+
+void GeoRouteEngine::set_worker_threads(std::size_t threads) {
+    std::lock_guard lock{executor_mutex_};
+    if (executor_) {
+        throw std::logic_error{"GeoRouteEngine::set_worker_threads workers already running"};
+    }
+    worker_threads_ = threads;
+}
+
+std::size_t GeoRouteEngine::worker_threads() const {
+    if (const auto* running = executor_view_.load(std::memory_order_acquire)) {
+        return running->thread_count();
+    }
+    return worker_threads_ > 0 ? worker_threads_ : std::max(1U, std::thread::hardware_concurrency());
+}
+
+QueryExecutor& GeoRouteEngine::executor() {
+    if (auto* running = executor_view_.load(std::memory_order_acquire)) {
+        return *running;
+    }
+    std::lock_guard lock{executor_mutex_};
+    if (!executor_) {
+        executor_ = std::make_unique<QueryExecutor>(worker_threads_);
+        executor_view_.store(executor_.get(), std::memory_order_release);
+    }
+    return *executor_;
+}
+
+std::future<RouteResponse> GeoRouteEngine::route_async(node_id source,
+                                                       node_id target,
+                                                       const SearchBudget& budget) {
+    check_nodes(source, target, "route_async");
+    auto promise = std::make_shared<std::promise<RouteResponse>>();
+    auto future = promise->get_future();
+    executor().submit([this, source, target, budget, promise](SearchScratch& scratch) {
+        try {
+            promise->set_value(route_with(source, target, scratch, budget));
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    });
+    return future;
+}
+
+void GeoRouteEngine::route_async(node_id source,
+                                 node_id target,
+                                 std::function<void(RouteResponse, std::exception_ptr)> on_done,
+                                 const SearchBudget& budget) {
+    check_nodes(source, target, "route_async");
+    executor().submit([this, source, target, budget, on_done = std::move(on_done)](SearchScratch& scratch) {
+        RouteResponse response;
+        try {
+            response = route_with(source, target, scratch, budget);
+        } catch (...) {
+            on_done(RouteResponse{}, std::current_exception());
+            return;
+        }
+        on_done(std::move(response), nullptr);
+    });
+}
+
+std::vector<RouteResponse> GeoRouteEngine::route_batch(std::span<const RouteQuery> queries,
+                                                       const SearchBudget& budget) {
+    for (const auto& query : queries) {
+        check_nodes(query.source, query.target, "route_batch");
+    }
+    std::vector<RouteResponse> responses(queries.size());
+    if (queries.empty()) {
+        return responses;
+    }
+
+    auto& pool = executor();
+    if (pool.on_worker_thread()) {
+        SearchScratch scratch;
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            responses[i] = route_with(queries[i].source, queries[i].target, scratch, budget);
+        }
+        return responses;
+    }
+
+    // A few chunks per worker so stealing can even out uneven query costs.
+    const auto chunk_size = std::max<std::size_t>(1, queries.size() / (pool.thread_count() * 4));
+    const auto chunks = (queries.size() + chunk_size - 1) / chunk_size;
+    std::latch done{static_cast<std::ptrdiff_t>(chunks)};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+        const auto first = chunk * chunk_size;
+        const auto last = std::min(first + chunk_size, queries.size());
+        pool.submit([&, first, last](SearchScratch& scratch) {
+            try {
+                for (auto i = first; i < last; ++i) {
+                    responses[i] = route_with(queries[i].source, queries[i].target, scratch, budget);
+                }
+            } catch (...) {
+                std::lock_guard lock{error_mutex};
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            done.count_down();
+        });
+    }
+    done.wait();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return responses;
+}
+
+RouteResponse GeoRouteEngine::record_route(RouteComputation&& computation,
+                                           std::chrono::nanoseconds compute_time,
+                                           const Graph& graph) {
+    const auto compute_ns = static_cast<std::uint64_t>(compute_time.count());
+    stats_.record_route(compute_ns, computation.stats.expanded_nodes, computation.stats.relaxed_edges,
+                        computation.status);
+
+    // Move-constructed, not assigned: assigning a pmr vector into one on a
+    // different resource copies the elements to the destination's resource.
+    return RouteResponse{std::move(computation.result),
+                         computation.status,
+                         computation.stats.expanded_nodes,
+                         static_cast<double>(compute_ns) / 1000.0,
+                         computation.congestion_epoch,
+                         graph.coordinates()};
+}
+
+std::shared_ptr<Router> GeoRouteEngine::router() const {
+    return load_router(router_);
+}
+
+std::uint64_t GeoRouteEngine::apply_congestion_update(std::size_t edge_start, std::size_t edge_end, float factor) {
+    const auto requested = std::chrono::high_resolution_clock::now();
+    std::lock_guard lock{update_mutex_};
+    const auto start = std::chrono::high_resolution_clock::now();
+    const auto epoch = router()->apply_congestion_update(edge_start, edge_end, factor);
+    const auto end = std::chrono::high_resolution_clock::now();
+    if (journal_ != nullptr) {
+        const CongestionUpdate update{edge_start, edge_end, factor};
+        journal_->record(std::span<const CongestionUpdate>{&update, 1});
+    }
+    stats_.record_updates(1, 0, elapsed_ns(start, end), elapsed_ns(requested, start));
+    return epoch;
+}
+
+CongestionBatchResult GeoRouteEngine::apply_congestion_updates(std::span<const CongestionUpdate> updates) {
+    const auto requested = std::chrono::high_resolution_clock::now();
+    std::lock_guard lock{update_mutex_};
+    const auto start = std::chrono::high_resolution_clock::now();
+    const auto published = router()->apply_congestion_updates(updates);
+    const auto end = std::chrono::high_resolution_clock::now();
+    if (journal_ != nullptr) {
+        journal_->record(updates);
+    }
+    const std::chrono::duration<double, std::micro> duration = end - start;
+
+    stats_.record_updates(updates.size(), 1, elapsed_ns(start, end), elapsed_ns(requested, start));
+
+    return CongestionBatchResult{updates.size(), published.ranges_written, duration.count(), published.epoch};
+}
+
+CongestionBatchResult GeoRouteEngine::apply_edge_updates(std::span<const EdgeFactorUpdate> updates) {
+    const auto requested = std::chrono::high_resolution_clock::now();
+    std::lock_guard lock{update_mutex_};
+    const auto start = std::chrono::high_resolution_clock::now();
+    const auto published = router()->apply_edge_updates(updates);
+    const auto end = std::chrono::high_resolution_clock::now();
+    if (journal_ != nullptr) {
+        std::vector<CongestionUpdate> ranges;
+        ranges.reserve(updates.size());
+        for (const auto& update : updates) {
+            ranges.push_back(CongestionUpdate{update.edge, update.edge, update.factor});
+        }
+        journal_->record(ranges);
+    }
+    const std::chrono::duration<double, std::micro> duration = end - start;
+
+    stats_.record_updates(updates.size(), 1, elapsed_ns(start, end), elapsed_ns(requested, start));
+
+    return CongestionBatchResult{updates.size(), published.ranges_written, duration.count(), published.epoch};
+}
+
+GraphSwapResult GeoRouteEngine::swap_router(Router next, bool carry_congestion) {
+    std::lock_guard lock{update_mutex_};
+    const auto start = std::chrono::steady_clock::now();
+    const auto previous = router();
+
+    GraphSwapResult result;
+    if (carry_congestion && previous->graph().same_edge_ids(next.graph())) {
+        // Runs of equal factor, so a mostly-uncongested graph costs a few ranges.
+        const auto runs = factor_runs(previous->congestion_factors());
+        if (!runs.empty()) {
+            next.apply_congestion_updates(runs);
+        }
+        result.congestion_carried = true;
+    }
+
+    auto incoming = std::make_shared<Router>(std::move(next));
+    result.node_count = incoming->node_count();
+    result.edge_count = incoming->edge_count();
+    result.epoch = incoming->current_epoch();
+    result.previous_memory_bytes = previous->memory_bytes();
+    result.next_memory_bytes = incoming->memory_bytes();
+    store_router(router_, incoming);
+    if (journal_ != nullptr && !result.congestion_carried) {
+        journal_->restart(result.edge_count);
+    }
+    result.previous = previous;
+
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    result.swap_time_us = elapsed.count();
+    return result;
+}
+
+void GeoRouteEngine::set_congestion_journal(CongestionJournal* journal) noexcept {
+    journal_ = journal;
+}
+
+std::uint64_t GeoRouteEngine::current_epoch() const {
+    return router()->current_epoch();
+}
+
+std::size_t GeoRouteEngine::node_count() const noexcept {
+    return router()->node_count();
+}
+
+std::size_t GeoRouteEngine::edge_count() const noexcept {
+    return router()->edge_count();
+}
+
+RouterSettings GeoRouteEngine::router_settings() const {
+    return router()->settings();
 }
 
 EngineStats GeoRouteEngine::get_stats() const noexcept {
-    std::lock_guard<std::mutex> lock{stats_mutex_};
-    return stats_;
+    return stats_.aggregate();
+}
+
+LatencyHistogramSnapshot GeoRouteEngine::compute_time_histogram() const noexcept {
+    return stats_.compute_time_histogram();
+}
+
+MetricHistogramSnapshot GeoRouteEngine::expanded_nodes_histogram() const {
+    return stats_.expanded_nodes_histogram();
+}
+
+MetricHistogramSnapshot GeoRouteEngine::relaxed_edges_histogram() const {
+    return stats_.relaxed_edges_histogram();
+}
+
+MetricHistogramSnapshot GeoRouteEngine::update_apply_histogram() const {
+    return stats_.update_apply_histogram();
+}
+
+MetricHistogramSnapshot GeoRouteEngine::update_lock_wait_histogram() const {
+    return stats_.update_lock_wait_histogram();
 }
 
 void GeoRouteEngine::reset_stats() noexcept {
-    std::lock_guard<std::mutex> lock{stats_mutex_};
-    stats_ = EngineStats{};
+    stats_.reset();
 }
 
 GeoRouteEngine GeoRouteEngine::from_json(const nlohmann::json& config) {
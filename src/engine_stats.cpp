@@ -0,0 +1,312 @@
+#include "georoute/engine_stats.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <new>
+#include <stdexcept>
+
+namespace georoute {
+
+namespace {
+
+// Round-robin thread-to-shard assignment shared by every recorder.
+std::atomic<std::size_t> next_shard_index{0};
+
+// 1, 3, 10, 30, ... 10^7: search work per query spans many orders of magnitude.
+constexpr std::array<std::uint64_t, 15> search_work_bounds{
+    1, 3, 10, 30, 100, 300, 1'000, 3'000, 10'000, 30'000, 100'000, 300'000, 1'000'000, 3'000'000, 10'000'000};
+// 10 us to 10 s.
+constexpr std::array<std::uint64_t, 16> apply_time_bounds_ns{
+    10'000, 25'000, 50'000, 100'000, 250'000, 500'000, 1'000'000, 2'500'000, 5'000'000, 10'000'000,
+    25'000'000, 50'000'000, 100'000'000, 1'000'000'000, 5'000'000'000, 10'000'000'000};
+// 1 us to 10 s; an uncontended lock is taken well under the first bound.
+constexpr std::array<std::uint64_t, 16> lock_wait_bounds_ns{
+    1'000, 2'500, 5'000, 10'000, 25'000, 50'000, 100'000, 250'000, 500'000, 1'000'000,
+    2'500'000, 5'000'000, 10'000'000, 100'000'000, 1'000'000'000, 10'000'000'000};
+
+static_assert(search_work_bounds.size() + 1 == 16, "search_work_bucket_count must match search_work_bounds");
+
+std::size_t search_work_bucket(std::uint64_t value) noexcept {
+    return static_cast<std::size_t>(std::lower_bound(search_work_bounds.begin(), search_work_bounds.end(), value) -
+                                    search_work_bounds.begin());
+}
+
+std::size_t local_shard_index(std::size_t shard_count) noexcept {
+    thread_local const std::size_t index = next_shard_index.fetch_add(1, std::memory_order_relaxed);
+    return index % shard_count;
+}
+
+void store_max(std::atomic<std::uint64_t>& target, std::uint64_t value) noexcept {
+    auto current = target.load(std::memory_order_relaxed);
+    while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+}  // namespace
+
+std::size_t LatencyBuckets::index(std::uint64_t value) noexcept {
+    if (value < 2 * sub_bucket_count) {
+        return static_cast<std::size_t>(value);
+    }
+    const auto width = static_cast<std::size_t>(std::bit_width(value));
+    if (width > max_value_bits) {
+        return count - 1;
+    }
+    const auto shift = width - (sub_bucket_bits + 1);
+    return (shift + 1) * sub_bucket_count + static_cast<std::size_t>(value >> shift) - sub_bucket_count;
+}
+
+std::uint64_t LatencyBuckets::lower_bound(std::size_t index) noexcept {
+    if (index < 2 * sub_bucket_count) {
+        return index;
+    }
+    const auto shift = index / sub_bucket_count - 1;
+    return static_cast<std::uint64_t>(index % sub_bucket_count + sub_bucket_count) << shift;
+}
+
+std::uint64_t LatencyBuckets::upper_bound(std::size_t index) noexcept {
+    if (index < 2 * sub_bucket_count) {
+        return index;
+    }
+    const auto shift = index / sub_bucket_count - 1;
+    return (static_cast<std::uint64_t>(index % sub_bucket_count + sub_bucket_count + 1) << shift) - 1;
+}
+
+std::uint64_t LatencyHistogramSnapshot::percentile_ns(double p) const noexcept {
+    if (total_count == 0) {
+        return 0;
+    }
+    const auto clamped = std::clamp(p, 0.0, 1.0);
+    const auto rank = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(std::ceil(clamped * static_cast<double>(total_count))));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(LatencyBuckets::upper_bound(i), max_ns);
+        }
+    }
+    return max_ns;
+}
+
+struct alignas(64) MetricHistogram::Shard {
+    std::array<std::atomic<std::uint64_t>, max_bounds + 1> counts{};
+    std::atomic<std::uint64_t> sum{0};
+};
+
+MetricHistogram::MetricHistogram(std::span<const std::uint64_t> upper_bounds)
+    : bound_count_(upper_bounds.size()), shards_(std::make_unique<Shard[]>(shard_count)) {
+    if (upper_bounds.size() > max_bounds) {
+        throw std::invalid_argument{"MetricHistogram more than max_bounds bucket bounds"};
+    }
+    for (std::size_t i = 0; i < upper_bounds.size(); ++i) {
+        if (i > 0 && upper_bounds[i] <= upper_bounds[i - 1]) {
+            throw std::invalid_argument{"MetricHistogram bucket bounds must be strictly ascending"};
+        }
+        bounds_[i] = upper_bounds[i];
+    }
+}
+
+MetricHistogram::MetricHistogram(MetricHistogram&&) noexcept = default;
+
+MetricHistogram::~MetricHistogram() = default;
+
+void MetricHistogram::observe(std::uint64_t value) noexcept {
+    const auto* bucket = std::lower_bound(bounds_.data(), bounds_.data() + bound_count_, value);
+    auto& shard = shards_[local_shard_index(shard_count)];
+    shard.counts[static_cast<std::size_t>(bucket - bounds_.data())].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+MetricHistogramSnapshot MetricHistogram::snapshot() const {
+    MetricHistogramSnapshot snapshot;
+    snapshot.upper_bounds.assign(bounds_.begin(), bounds_.begin() + static_cast<std::ptrdiff_t>(bound_count_));
+    snapshot.counts.assign(bound_count_ + 1, 0);
+    for (std::size_t s = 0; s < shard_count; ++s) {
+        const auto& shard = shards_[s];
+        for (std::size_t i = 0; i <= bound_count_; ++i) {
+            const auto count = shard.counts[i].load(std::memory_order_relaxed);
+            snapshot.counts[i] += count;
+            snapshot.total_count += count;
+        }
+        snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+void MetricHistogram::reset() noexcept {
+    for (std::size_t s = 0; s < shard_count; ++s) {
+        for (auto& count : shards_[s].counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        shards_[s].sum.store(0, std::memory_order_relaxed);
+    }
+}
+
+struct alignas(64) EngineStatsRecorder::Shard {
+    std::atomic<std::uint64_t> queries{0};
+    std::atomic<std::uint64_t> updates{0};
+    std::atomic<std::uint64_t> update_batches{0};
+    std::atomic<std::uint64_t> expanded_nodes{0};
+    std::atomic<std::uint64_t> relaxed_edges{0};
+    std::atomic<std::uint64_t> deadline_exceeded{0};
+    std::atomic<std::uint64_t> node_budget_exceeded{0};
+    std::atomic<std::uint64_t> coalesced_queries{0};
+    std::atomic<std::uint64_t> compute_ns{0};
+    std::atomic<std::uint64_t> max_compute_ns{0};
+    std::array<std::atomic<std::uint64_t>, LatencyBuckets::count> buckets{};
+    // Per-query search work; the sums are expanded_nodes / relaxed_edges.
+    SearchWorkBuckets expanded_buckets{};
+    SearchWorkBuckets relaxed_buckets{};
+};
+
+EngineStatsRecorder::EngineStatsRecorder()
+    : shards_(std::make_unique<Shard[]>(shard_count)), update_apply_ns_(apply_time_bounds_ns),
+      update_lock_wait_ns_(lock_wait_bounds_ns) {}
+
+EngineStatsRecorder::EngineStatsRecorder(EngineStatsRecorder&&) noexcept = default;
+
+EngineStatsRecorder::~EngineStatsRecorder() = default;
+
+EngineStatsRecorder::Shard& EngineStatsRecorder::local_shard() const noexcept {
+    return shards_[local_shard_index(shard_count)];
+}
+
+void EngineStatsRecorder::record_route(std::uint64_t compute_time_ns,
+                                       std::uint64_t expanded_nodes,
+                                       std::uint64_t relaxed_edges,
+                                       RouteStatus status) noexcept {
+    auto& shard = local_shard();
+    if (status == RouteStatus::deadline_exceeded) {
+        shard.deadline_exceeded.fetch_add(1, std::memory_order_relaxed);
+    } else if (status == RouteStatus::node_budget_exceeded) {
+        shard.node_budget_exceeded.fetch_add(1, std::memory_order_relaxed);
+    }
+    shard.queries.fetch_add(1, std::memory_order_relaxed);
+    shard.expanded_nodes.fetch_add(expanded_nodes, std::memory_order_relaxed);
+    shard.relaxed_edges.fetch_add(relaxed_edges, std::memory_order_relaxed);
+    shard.compute_ns.fetch_add(compute_time_ns, std::memory_order_relaxed);
+    store_max(shard.max_compute_ns, compute_time_ns);
+    shard.buckets[LatencyBuckets::index(compute_time_ns)].fetch_add(1, std::memory_order_relaxed);
+    shard.expanded_buckets[search_work_bucket(expanded_nodes)].fetch_add(1, std::memory_order_relaxed);
+    shard.relaxed_buckets[search_work_bucket(relaxed_edges)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void EngineStatsRecorder::record_coalesced() noexcept {
+    local_shard().coalesced_queries.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EngineStatsRecorder::record_updates(std::uint64_t updates,
+                                         std::uint64_t batches,
+                                         std::uint64_t apply_time_ns,
+                                         std::uint64_t lock_wait_ns) noexcept {
+    auto& shard = local_shard();
+    shard.updates.fetch_add(updates, std::memory_order_relaxed);
+    shard.update_batches.fetch_add(batches, std::memory_order_relaxed);
+    if (apply_time_ns > 0) {
+        update_apply_ns_.observe(apply_time_ns);
+        update_lock_wait_ns_.observe(lock_wait_ns);
+    }
+}
+
+MetricHistogramSnapshot EngineStatsRecorder::expanded_nodes_histogram() const {
+    return search_work_histogram(&Shard::expanded_buckets, &Shard::expanded_nodes);
+}
+
+MetricHistogramSnapshot EngineStatsRecorder::relaxed_edges_histogram() const {
+    return search_work_histogram(&Shard::relaxed_buckets, &Shard::relaxed_edges);
+}
+
+MetricHistogramSnapshot EngineStatsRecorder::search_work_histogram(SearchWorkBuckets Shard::*buckets,
+                                                                   std::atomic<std::uint64_t> Shard::*sum) const {
+    MetricHistogramSnapshot snapshot;
+    snapshot.upper_bounds.assign(search_work_bounds.begin(), search_work_bounds.end());
+    snapshot.counts.assign(search_work_bounds.size() + 1, 0);
+    for (std::size_t s = 0; s < shard_count; ++s) {
+        const auto& shard = shards_[s];
+        for (std::size_t i = 0; i < snapshot.counts.size(); ++i) {
+            const auto count = (shard.*buckets)[i].load(std::memory_order_relaxed);
+            snapshot.counts[i] += count;
+            snapshot.total_count += count;
+        }
+        snapshot.sum += (shard.*sum).load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+MetricHistogramSnapshot EngineStatsRecorder::update_apply_histogram() const {
+    return update_apply_ns_.snapshot();
+}
+
+MetricHistogramSnapshot EngineStatsRecorder::update_lock_wait_histogram() const {
+    return update_lock_wait_ns_.snapshot();
+}
+
+LatencyHistogramSnapshot EngineStatsRecorder::compute_time_histogram() const noexcept {
+    LatencyHistogramSnapshot snapshot;
+    for (std::size_t s = 0; s < shard_count; ++s) {
+        const auto& shard = shards_[s];
+        for (std::size_t i = 0; i < LatencyBuckets::count; ++i) {
+            const auto count = shard.buckets[i].load(std::memory_order_relaxed);
+            snapshot.counts[i] += count;
+            snapshot.total_count += count;
+        }
+        snapshot.total_ns += shard.compute_ns.load(std::memory_order_relaxed);
+        snapshot.max_ns = std::max(snapshot.max_ns, shard.max_compute_ns.load(std::memory_order_relaxed));
+    }
+    return snapshot;
+}
+
+EngineStats EngineStatsRecorder::aggregate() const noexcept {
+    EngineStats stats;
+    for (std::size_t s = 0; s < shard_count; ++s) {
+        const auto& shard = shards_[s];
+        stats.total_queries += shard.queries.load(std::memory_order_relaxed);
+        stats.total_updates += shard.updates.load(std::memory_order_relaxed);
+        stats.total_update_batches += shard.update_batches.load(std::memory_order_relaxed);
+        stats.total_expanded_nodes += shard.expanded_nodes.load(std::memory_order_relaxed);
+        stats.total_relaxed_edges += shard.relaxed_edges.load(std::memory_order_relaxed);
+        stats.total_deadline_exceeded += shard.deadline_exceeded.load(std::memory_order_relaxed);
+        stats.total_node_budget_exceeded += shard.node_budget_exceeded.load(std::memory_order_relaxed);
+        stats.total_coalesced_queries += shard.coalesced_queries.load(std::memory_order_relaxed);
+    }
+
+    const auto histogram = compute_time_histogram();
+    constexpr double ns_per_us = 1000.0;
+    stats.total_compute_time_us = static_cast<double>(histogram.total_ns) / ns_per_us;
+    stats.max_compute_time_us = static_cast<double>(histogram.max_ns) / ns_per_us;
+    stats.p50_compute_time_us = static_cast<double>(histogram.percentile_ns(0.50)) / ns_per_us;
+    stats.p90_compute_time_us = static_cast<double>(histogram.percentile_ns(0.90)) / ns_per_us;
+    stats.p99_compute_time_us = static_cast<double>(histogram.percentile_ns(0.99)) / ns_per_us;
+    stats.p999_compute_time_us = static_cast<double>(histogram.percentile_ns(0.999)) / ns_per_us;
+    return stats;
+}
+
+void EngineStatsRecorder::reset() noexcept {
+    for (std::size_t s = 0; s < shard_count; ++s) {
+        auto& shard = shards_[s];
+        shard.queries.store(0, std::memory_order_relaxed);
+        shard.updates.store(0, std::memory_order_relaxed);
+        shard.update_batches.store(0, std::memory_order_relaxed);
+        shard.expanded_nodes.store(0, std::memory_order_relaxed);
+        shard.relaxed_edges.store(0, std::memory_order_relaxed);
+        shard.deadline_exceeded.store(0, std::memory_order_relaxed);
+        shard.node_budget_exceeded.store(0, std::memory_order_relaxed);
+        shard.coalesced_queries.store(0, std::memory_order_relaxed);
+        shard.compute_ns.store(0, std::memory_order_relaxed);
+        shard.max_compute_ns.store(0, std::memory_order_relaxed);
+        for (auto& bucket : shard.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        for (auto* work : {&shard.expanded_buckets, &shard.relaxed_buckets}) {
+            for (auto& bucket : *work) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+    update_apply_ns_.reset();
+    update_lock_wait_ns_.reset();
+}
+
+}  // namespace georoute
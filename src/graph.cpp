@@ -1,12 +1,38 @@
 #include "georoute/graph.hpp"
 
+#include <cmath>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace georoute {
 
 Graph::Graph(std::size_t node_count)
     : adjacency_(node_count), next_edge_id_(0) {}
 
+Graph Graph::from_adjacency(std::vector<std::vector<Edge>> adjacency) {
+    std::size_t edge_count = 0;
+    for (const auto& edges : adjacency) {
+        edge_count += edges.size();
+    }
+    std::vector<bool> seen(edge_count, false);
+    for (const auto& edges : adjacency) {
+        for (const auto& edge : edges) {
+            if (edge.to >= adjacency.size()) {
+                throw std::invalid_argument{"Graph::from_adjacency edge target out of range"};
+            }
+            if (edge.id >= edge_count || seen[edge.id]) {
+                throw std::invalid_argument{"Graph::from_adjacency edge ids must be 0..edge_count-1, each once"};
+            }
+            seen[edge.id] = true;
+        }
+    }
+    Graph graph;
+    graph.adjacency_ = std::move(adjacency);
+    graph.next_edge_id_ = static_cast<edge_id>(edge_count);
+    return graph;
+}
+
 void Graph::add_edge(node_id from, node_id to, float base_travel_time) {
     if (from >= adjacency_.size() || to >= adjacency_.size()) {
         throw std::out_of_range{"Graph::add_edge node id out of range"};
@@ -24,6 +50,33 @@ const std::vector<Edge>& Graph::neighbors(node_id u) const noexcept {
     return adjacency_[u];
 }
 
+std::vector<float> Graph::base_travel_times() const {
+    std::vector<float> times(next_edge_id_, 0.0F);
+    for (const auto& edges : adjacency_) {
+        for (const auto& edge : edges) {
+            times[edge.id] = edge.base_travel_time;
+        }
+    }
+    return times;
+}
+
+void Graph::set_coordinates(std::vector<Coordinate> coordinates) {
+    if (coordinates.size() != adjacency_.size()) {
+        throw std::invalid_argument{"Graph::set_coordinates expected one coordinate per node"};
+    }
+    for (const auto& point : coordinates) {
+        // Negated comparisons also reject NaN.
+        if (!(std::abs(point.lat) <= 90.0) || !(std::abs(point.lon) <= 180.0)) {
+            throw std::invalid_argument{"Graph::set_coordinates coordinate out of range"};
+        }
+    }
+    coordinates_ = std::make_shared<const std::vector<Coordinate>>(std::move(coordinates));
+}
+
+const std::shared_ptr<const std::vector<Coordinate>>& Graph::coordinates() const noexcept {
+    return coordinates_;
+}
+
 std::size_t Graph::node_count() const noexcept {
     return adjacency_.size();
 }
@@ -32,5 +85,35 @@ std::size_t Graph::edge_count() const noexcept {
     return next_edge_id_;
 }
 
+bool Graph::same_edge_ids(const Graph& other) const noexcept {
+    if (adjacency_.size() != other.adjacency_.size() || next_edge_id_ != other.next_edge_id_) {
+        return false;
+    }
+    for (std::size_t u = 0; u < adjacency_.size(); ++u) {
+        const auto& mine = adjacency_[u];
+        const auto& theirs = other.adjacency_[u];
+        if (mine.size() != theirs.size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < mine.size(); ++i) {
+            if (mine[i].id != theirs[i].id || mine[i].to != theirs[i].to) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::size_t Graph::memory_bytes() const noexcept {
+    auto bytes = adjacency_.capacity() * sizeof(std::vector<Edge>);
+    for (const auto& edges : adjacency_) {
+        bytes += edges.capacity() * sizeof(Edge);
+    }
+    if (coordinates_) {
+        bytes += coordinates_->capacity() * sizeof(Coordinate);
+    }
+    return bytes;
+}
+
 }  // namespace georoute
 
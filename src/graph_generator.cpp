@@ -0,0 +1,448 @@
+#include "georoute/graph_generator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace georoute {
+
+namespace {
+
+// Distance between neighbouring intersections, in metres.
+constexpr double block_metres = 100.0;
+// South-west corner of every generated network.
+constexpr Coordinate origin{52.40, 13.20};
+constexpr double metres_per_degree = 111320.0;
+
+// Every eighth row and column is an arterial; highways follow every 32nd.
+constexpr std::size_t arterial_spacing = 8;
+constexpr std::size_t highway_spacing = 32;
+
+Coordinate to_coordinate(double x_metres, double y_metres) {
+    constexpr double pi = 3.14159265358979323846;
+    const double lon_scale = metres_per_degree * std::cos(origin.lat * pi / 180.0);
+    return Coordinate{origin.lat + y_metres / metres_per_degree, origin.lon + x_metres / lon_scale};
+}
+
+float travel_seconds(double metres, double km_per_hour) {
+    return static_cast<float>(metres / (km_per_hour / 3.6));
+}
+
+std::vector<Coordinate> grid_coordinates(std::size_t rows, std::size_t cols) {
+    std::vector<Coordinate> coordinates;
+    coordinates.reserve(rows * cols);
+    for (std::size_t r = 0; r < rows; ++r) {
+        for (std::size_t c = 0; c < cols; ++c) {
+            coordinates.push_back(to_coordinate(static_cast<double>(c) * block_metres,
+                                                static_cast<double>(r) * block_metres));
+        }
+    }
+    return coordinates;
+}
+
+bool is_arterial(std::size_t line) noexcept {
+    return line % arterial_spacing == 0;
+}
+
+struct Point {
+    double x;
+    double y;
+};
+
+// Sign of the turn a -> b -> c.
+int orientation(const Point& a, const Point& b, const Point& c) noexcept {
+    const double cross = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    return (cross > 0.0) - (cross < 0.0);
+}
+
+// True when the segments cross at a point interior to both. Segments that
+// only share an endpoint do not cross.
+bool segments_cross(const Point& a, const Point& b, const Point& c, const Point& d) noexcept {
+    return orientation(a, b, c) * orientation(a, b, d) < 0 && orientation(c, d, a) * orientation(c, d, b) < 0;
+}
+
+class DisjointSets {
+public:
+    explicit DisjointSets(std::size_t count) : parent_(count) {
+        std::iota(parent_.begin(), parent_.end(), std::size_t{0});
+    }
+
+    std::size_t find(std::size_t item) {
+        while (parent_[item] != item) {
+            parent_[item] = parent_[parent_[item]];
+            item = parent_[item];
+        }
+        return item;
+    }
+
+    bool unite(std::size_t a, std::size_t b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) {
+            return false;
+        }
+        parent_[b] = a;
+        return true;
+    }
+
+private:
+    std::vector<std::size_t> parent_;
+};
+
+}  // namespace
+
+GraphType parse_graph_type(std::string_view name) {
+    if (name == "grid") {
+        return GraphType::grid;
+    }
+    if (name == "geometric") {
+        return GraphType::geometric;
+    }
+    if (name == "highway") {
+        return GraphType::highway;
+    }
+    if (name == "city") {
+        return GraphType::city;
+    }
+    throw std::invalid_argument{"graph type must be 'grid', 'geometric', 'highway' or 'city'"};
+}
+
+std::string_view graph_type_name(GraphType type) noexcept {
+    switch (type) {
+        case GraphType::grid:
+            return "grid";
+        case GraphType::geometric:
+            return "geometric";
+        case GraphType::highway:
+            return "highway";
+        case GraphType::city:
+            return "city";
+    }
+    return "unknown";
+}
+
+Graph generate_graph(GraphType type, std::size_t size, std::uint64_t seed) {
+    switch (type) {
+        case GraphType::grid:
+            return make_grid_graph(size, size);
+        case GraphType::geometric:
+            return make_geometric_graph(size * size, seed);
+        case GraphType::highway:
+            return make_highway_grid(size, size, seed);
+        case GraphType::city:
+            return make_city_grid(size, size, seed);
+    }
+    throw std::invalid_argument{"generate_graph unknown graph type"};
+}
+
+Graph make_grid_graph(std::size_t rows, std::size_t cols) {
+    Graph graph{rows * cols};
+
+    const auto index = [cols](std::size_t r, std::size_t c) {
+        return static_cast<node_id>(r * cols + c);
+    };
+
+    for (std::size_t r = 0; r < rows; ++r) {
+        for (std::size_t c = 0; c < cols; ++c) {
+            const auto current = index(r, c);
+            if (c + 1 < cols) {
+                const auto right = index(r, c + 1);
+                const float base = 1.0F + static_cast<float>((r + c) % 7) * 0.1F;
+                graph.add_edge(current, right, base);
+                graph.add_edge(right, current, base);
+            }
+            if (r + 1 < rows) {
+                const auto down = index(r + 1, c);
+                const float base = 1.0F + static_cast<float>((r + c) % 5) * 0.15F;
+                graph.add_edge(current, down, base);
+                graph.add_edge(down, current, base);
+            }
+        }
+    }
+
+    return graph;
+}
+
+Graph make_geometric_graph(std::size_t nodes, std::uint64_t seed) {
+    // Candidate streets join each point to its nearest neighbours.
+    constexpr std::size_t nearest = 6;
+    // Share of the non-tree streets kept, which sets the mean degree near 3.
+    constexpr double loop_street_share = 0.3;
+
+    Graph graph{nodes};
+    if (nodes == 0) {
+        return graph;
+    }
+    std::mt19937_64 rng{seed};
+
+    // About one point per block-sized cell, numbered cell by cell so that
+    // node ids follow the map the way real extracts do.
+    const auto cells = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(nodes))));
+    const double side = static_cast<double>(cells) * block_metres;
+    std::uniform_real_distribution<double> position(0.0, side);
+    std::vector<Point> points(nodes);
+    for (auto& point : points) {
+        point = Point{position(rng), position(rng)};
+    }
+    const auto cell_of = [cells](double metres) {
+        return std::min(cells - 1, static_cast<std::size_t>(metres / block_metres));
+    };
+    std::sort(points.begin(), points.end(), [&cell_of](const Point& a, const Point& b) {
+        const auto cell_a = std::pair{cell_of(a.y), cell_of(a.x)};
+        const auto cell_b = std::pair{cell_of(b.y), cell_of(b.x)};
+        return cell_a != cell_b ? cell_a < cell_b : a.x < b.x;
+    });
+    // Points are sorted by cell, so each cell is a range of ids.
+    std::vector<std::size_t> cell_start(cells * cells + 1, 0);
+    for (const auto& point : points) {
+        ++cell_start[cell_of(point.y) * cells + cell_of(point.x) + 1];
+    }
+    std::partial_sum(cell_start.begin(), cell_start.end(), cell_start.begin());
+
+    const auto length = [&points](std::size_t a, std::size_t b) {
+        return std::hypot(points[a].x - points[b].x, points[a].y - points[b].y);
+    };
+
+    // Nearest neighbours among the surrounding 5x5 cells.
+    std::vector<std::pair<std::size_t, std::size_t>> candidates;
+    candidates.reserve(nodes * nearest);
+    std::vector<std::pair<double, std::size_t>> around;
+    for (std::size_t u = 0; u < nodes; ++u) {
+        around.clear();
+        const auto row = static_cast<std::ptrdiff_t>(cell_of(points[u].y));
+        const auto col = static_cast<std::ptrdiff_t>(cell_of(points[u].x));
+        for (std::ptrdiff_t r = std::max<std::ptrdiff_t>(0, row - 2);
+             r <= std::min<std::ptrdiff_t>(static_cast<std::ptrdiff_t>(cells) - 1, row + 2); ++r) {
+            for (std::ptrdiff_t c = std::max<std::ptrdiff_t>(0, col - 2);
+                 c <= std::min<std::ptrdiff_t>(static_cast<std::ptrdiff_t>(cells) - 1, col + 2); ++c) {
+                const auto cell = static_cast<std::size_t>(r) * cells + static_cast<std::size_t>(c);
+                for (auto v = cell_start[cell]; v < cell_start[cell + 1]; ++v) {
+                    if (v != u) {
+                        around.emplace_back(length(u, v), v);
+                    }
+                }
+            }
+        }
+        const auto keep = std::min(nearest, around.size());
+        std::partial_sort(around.begin(), around.begin() + static_cast<std::ptrdiff_t>(keep), around.end());
+        for (std::size_t i = 0; i < keep; ++i) {
+            candidates.emplace_back(std::min(u, around[i].second), std::max(u, around[i].second));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    std::stable_sort(candidates.begin(), candidates.end(), [&length](const auto& a, const auto& b) {
+        return length(a.first, a.second) < length(b.first, b.second);
+    });
+
+    // Shortest first, a street is laid unless it crosses one already laid.
+    // Streets are indexed by every cell of their bounding box; two streets
+    // that cross share the cell holding the crossing.
+    std::vector<std::vector<std::size_t>> cell_streets(cells * cells);
+    std::vector<std::pair<std::size_t, std::size_t>> streets;
+    for (const auto& [u, v] : candidates) {
+        const auto r0 = std::min(cell_of(points[u].y), cell_of(points[v].y));
+        const auto r1 = std::max(cell_of(points[u].y), cell_of(points[v].y));
+        const auto c0 = std::min(cell_of(points[u].x), cell_of(points[v].x));
+        const auto c1 = std::max(cell_of(points[u].x), cell_of(points[v].x));
+        bool crosses = false;
+        for (auto r = r0; r <= r1 && !crosses; ++r) {
+            for (auto c = c0; c <= c1 && !crosses; ++c) {
+                for (const auto street : cell_streets[r * cells + c]) {
+                    const auto [a, b] = streets[street];
+                    if (segments_cross(points[u], points[v], points[a], points[b])) {
+                        crosses = true;
+                        break;
+                    }
+                }
+            }
+        }
+        if (crosses) {
+            continue;
+        }
+        for (auto r = r0; r <= r1; ++r) {
+            for (auto c = c0; c <= c1; ++c) {
+                cell_streets[r * cells + c].push_back(streets.size());
+            }
+        }
+        streets.emplace_back(u, v);
+    }
+
+    // The planar graph is nearly a triangulation, far denser than a road
+    // network. Keep a spanning tree of it (shortest streets first) plus a
+    // share of the rest, which leaves dead ends, T-junctions and crossroads.
+    DisjointSets components{nodes};
+    std::bernoulli_distribution keep_loop{loop_street_share};
+    std::vector<std::pair<std::size_t, std::size_t>> kept;
+    for (const auto& [u, v] : streets) {
+        const bool tree = components.unite(u, v);
+        if (keep_loop(rng) || tree) {
+            kept.emplace_back(u, v);
+        }
+    }
+    std::sort(kept.begin(), kept.end());
+
+    std::uniform_real_distribution<double> speed(30.0, 60.0);
+    for (const auto& [u, v] : kept) {
+        const float seconds = travel_seconds(length(u, v), speed(rng));
+        graph.add_edge(static_cast<node_id>(u), static_cast<node_id>(v), seconds);
+        graph.add_edge(static_cast<node_id>(v), static_cast<node_id>(u), seconds);
+    }
+
+    std::vector<Coordinate> coordinates;
+    coordinates.reserve(nodes);
+    for (const auto& point : points) {
+        coordinates.push_back(to_coordinate(point.x, point.y));
+    }
+    graph.set_coordinates(std::move(coordinates));
+    return graph;
+}
+
+Graph make_highway_grid(std::size_t rows, std::size_t cols, std::uint64_t seed) {
+    constexpr double arterial_speed = 60.0;
+    constexpr double highway_speed = 110.0;
+
+    Graph graph{rows * cols};
+    std::mt19937_64 rng{seed};
+    std::uniform_real_distribution<double> local_speed(25.0, 40.0);
+
+    const auto index = [cols](std::size_t r, std::size_t c) {
+        return static_cast<node_id>(r * cols + c);
+    };
+    const auto add_street = [&graph](node_id a, node_id b, float seconds) {
+        graph.add_edge(a, b, seconds);
+        graph.add_edge(b, a, seconds);
+    };
+    // Interchanges sit where a highway meets an arterial, and each highway
+    // edge runs straight to the next one.
+    const double highway_seconds =
+        travel_seconds(static_cast<double>(arterial_spacing) * block_metres, highway_speed);
+    const auto is_highway = [](std::size_t line) {
+        return line % highway_spacing == highway_spacing / 2;
+    };
+
+    for (std::size_t r = 0; r < rows; ++r) {
+        for (std::size_t c = 0; c < cols; ++c) {
+            const auto current = index(r, c);
+            if (c + 1 < cols) {
+                const double speed = is_arterial(r) ? arterial_speed : local_speed(rng);
+                add_street(current, index(r, c + 1), travel_seconds(block_metres, speed));
+            }
+            if (r + 1 < rows) {
+                const double speed = is_arterial(c) ? arterial_speed : local_speed(rng);
+                add_street(current, index(r + 1, c), travel_seconds(block_metres, speed));
+            }
+            if (is_highway(r) && is_arterial(c) && c + arterial_spacing < cols) {
+                add_street(current, index(r, c + arterial_spacing), static_cast<float>(highway_seconds));
+            }
+            if (is_highway(c) && is_arterial(r) && r + arterial_spacing < rows) {
+                add_street(current, index(r + arterial_spacing, c), static_cast<float>(highway_seconds));
+            }
+        }
+    }
+
+    graph.set_coordinates(grid_coordinates(rows, cols));
+    return graph;
+}
+
+Graph make_city_grid(std::size_t rows, std::size_t cols, std::uint64_t seed) {
+    constexpr double arterial_speed = 50.0;
+    // Share of the non-arterial streets that are one-way.
+    constexpr double one_way_share = 0.85;
+    // One closed pocket per this many nodes.
+    constexpr std::size_t nodes_per_pocket = 400;
+
+    Graph graph{rows * cols};
+    std::mt19937_64 rng{seed};
+
+    // Per street (a whole row or column): 0 two-way, +1 towards higher ids,
+    // -1 towards lower ids.
+    std::bernoulli_distribution one_way{one_way_share};
+    std::bernoulli_distribution forward{0.5};
+    const auto street_direction = [&](std::size_t line) {
+        if (is_arterial(line) || !one_way(rng)) {
+            return 0;
+        }
+        return forward(rng) ? 1 : -1;
+    };
+    std::vector<int> row_direction(rows);
+    std::vector<int> col_direction(cols);
+    for (std::size_t r = 0; r < rows; ++r) {
+        row_direction[r] = street_direction(r);
+    }
+    for (std::size_t c = 0; c < cols; ++c) {
+        col_direction[c] = street_direction(c);
+    }
+
+    // Pockets are small blocks of 2-4 x 2-4 nodes whose boundary streets
+    // are closed in one direction or both: gated estates, construction,
+    // a bridge out. Pocket 0 means none.
+    enum class Pocket : std::uint8_t { island, trap, exit_only };
+    std::vector<std::uint32_t> pocket_of(rows * cols, 0);
+    std::vector<Pocket> pockets(1, Pocket::island);
+    if (rows >= 4 && cols >= 4) {
+        std::uniform_int_distribution<std::size_t> extent(2, 4);
+        std::uniform_int_distribution<std::size_t> top(0, rows - 4);
+        std::uniform_int_distribution<std::size_t> left(0, cols - 4);
+        std::uniform_int_distribution<int> kind(0, 2);
+        for (std::size_t p = 0; p < rows * cols / nodes_per_pocket; ++p) {
+            const auto r0 = top(rng);
+            const auto c0 = left(rng);
+            const auto height = extent(rng);
+            const auto width = extent(rng);
+            pockets.push_back(static_cast<Pocket>(kind(rng)));
+            for (auto r = r0; r < r0 + height; ++r) {
+                for (auto c = c0; c < c0 + width; ++c) {
+                    pocket_of[r * cols + c] = static_cast<std::uint32_t>(pockets.size() - 1);
+                }
+            }
+        }
+    }
+    const auto open = [&](node_id from, node_id to) {
+        const auto leaving = pocket_of[from];
+        const auto entering = pocket_of[to];
+        if (leaving == entering) {
+            return true;
+        }
+        if (leaving != 0 && pockets[leaving] != Pocket::exit_only) {
+            return false;
+        }
+        return entering == 0 || pockets[entering] == Pocket::trap;
+    };
+
+    std::uniform_real_distribution<double> local_speed(20.0, 35.0);
+    const auto add_street = [&](node_id lower, node_id higher, int direction, double speed) {
+        const float seconds = travel_seconds(block_metres, speed);
+        if (direction >= 0 && open(lower, higher)) {
+            graph.add_edge(lower, higher, seconds);
+        }
+        if (direction <= 0 && open(higher, lower)) {
+            graph.add_edge(higher, lower, seconds);
+        }
+    };
+    for (std::size_t r = 0; r < rows; ++r) {
+        for (std::size_t c = 0; c < cols; ++c) {
+            const auto current = static_cast<node_id>(r * cols + c);
+            if (c + 1 < cols) {
+                add_street(current, current + 1, row_direction[r],
+                           is_arterial(r) ? arterial_speed : local_speed(rng));
+            }
+            if (r + 1 < rows) {
+                add_street(current, static_cast<node_id>(current + cols), col_direction[c],
+                           is_arterial(c) ? arterial_speed : local_speed(rng));
+            }
+        }
+    }
+
+    graph.set_coordinates(grid_coordinates(rows, cols));
+    return graph;
+}
+
+}  // namespace georoute
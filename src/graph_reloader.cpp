@@ -0,0 +1,141 @@
+#include "georoute/graph_reloader.hpp"
+
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+namespace georoute {
+
+namespace {
+
+constexpr std::chrono::milliseconds release_poll_interval{1};
+
+std::filesystem::path canonical_location(const std::string& path) {
+    return std::filesystem::weakly_canonical(std::filesystem::absolute(path));
+}
+
+}  // namespace
+
+const char* graph_reload_state_name(GraphReloadState state) noexcept {
+    switch (state) {
+        case GraphReloadState::running:
+            return "running";
+        case GraphReloadState::succeeded:
+            return "succeeded";
+        case GraphReloadState::failed:
+            return "failed";
+        case GraphReloadState::idle:
+            break;
+    }
+    return "idle";
+}
+
+GraphReloader::GraphReloader(GeoRouteEngine& engine, std::string graph_path, std::chrono::milliseconds release_wait)
+    : engine_(engine),
+      release_wait_(release_wait),
+      graph_directory_(canonical_location(graph_path).parent_path()),
+      graph_path_(std::move(graph_path)) {}
+
+GraphReloader::~GraphReloader() = default;
+
+std::optional<GraphReloadReport> GraphReloader::reload(const std::string& path, bool carry_congestion) {
+    std::unique_lock lock{reload_mutex_, std::try_to_lock};
+    if (!lock.owns_lock()) {
+        return std::nullopt;
+    }
+
+    GraphReloadReport report;
+    report.path = resolve_path(path);
+
+    const auto load_start = std::chrono::steady_clock::now();
+    // The file may not say which congestion index or history it wants (a
+    // snapshot or DIMACS graph never does); keep those of the current graph.
+    auto next = Router::from_file(report.path, engine_.router_settings());
+    const std::chrono::duration<double, std::milli> load_time = std::chrono::steady_clock::now() - load_start;
+    report.load_ms = load_time.count();
+
+    const auto swapped_at = std::chrono::steady_clock::now();
+    report.swap = engine_.swap_router(std::move(next), carry_congestion);
+    {
+        std::lock_guard path_lock{path_mutex_};
+        graph_path_ = report.path;
+    }
+    reloads_.fetch_add(1, std::memory_order_relaxed);
+
+    // In-flight queries are bounded by their search budgets, so the old graph
+    // normally goes away within one query latency.
+    const auto give_up = swapped_at + release_wait_;
+    while (!report.swap.previous.expired() && std::chrono::steady_clock::now() < give_up) {
+        std::this_thread::sleep_for(release_poll_interval);
+    }
+    if (report.swap.previous.expired()) {
+        const std::chrono::duration<double, std::milli> overlap = std::chrono::steady_clock::now() - swapped_at;
+        report.overlap_ms = overlap.count();
+    }
+    return report;
+}
+
+bool GraphReloader::start(const std::string& path, bool carry_congestion) {
+    auto resolved = resolve_path(path);
+
+    std::lock_guard lock{status_mutex_};
+    if (status_.state == GraphReloadState::running) {
+        return false;
+    }
+    status_ = GraphReloadStatus{GraphReloadState::running, resolved, std::nullopt, {}};
+    // The previous worker has published its result, so this join is short.
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    worker_ = std::jthread{[this, path = std::move(resolved), carry_congestion] {
+        GraphReloadStatus finished{GraphReloadState::failed, path, std::nullopt, {}};
+        try {
+            finished.report = reload(path, carry_congestion);
+            if (finished.report) {
+                finished.state = GraphReloadState::succeeded;
+            } else {
+                finished.error = "graph reload already in progress";
+            }
+        } catch (const std::exception& ex) {
+            finished.error = ex.what();
+        }
+        std::lock_guard status_lock{status_mutex_};
+        status_ = std::move(finished);
+    }};
+    return true;
+}
+
+GraphReloadStatus GraphReloader::status() const {
+    std::lock_guard lock{status_mutex_};
+    return status_;
+}
+
+std::string GraphReloader::graph_path() const {
+    std::lock_guard lock{path_mutex_};
+    return graph_path_;
+}
+
+const std::filesystem::path& GraphReloader::graph_directory() const noexcept {
+    return graph_directory_;
+}
+
+std::uint64_t GraphReloader::reloads() const noexcept {
+    return reloads_.load(std::memory_order_relaxed);
+}
+
+std::string GraphReloader::resolve_path(const std::string& path) const {
+    if (path.empty()) {
+        return graph_path();
+    }
+    // Symlinks are resolved first, so a link inside the directory cannot
+    // point the reload elsewhere, and the resolved path is what gets opened:
+    // re-pointing the link after this check changes nothing.
+    auto resolved = canonical_location(path);
+    const auto relative = resolved.lexically_relative(graph_directory_);
+    if (relative.empty() || *relative.begin() == "..") {
+        throw std::invalid_argument("GraphReloader::reload path must be inside " + graph_directory_.string());
+    }
+    return resolved.string();
+}
+
+}  // namespace georoute
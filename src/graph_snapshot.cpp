@@ -0,0 +1,207 @@
+#include "georoute/graph_snapshot.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace georoute {
+
+namespace {
+
+struct SnapshotHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t node_count;
+    std::uint64_t edge_count;
+    std::uint64_t flags;
+};
+
+constexpr char snapshot_magic[4] = {'G', 'R', 'G', 'S'};
+constexpr std::uint32_t snapshot_version = 1;
+constexpr std::uint64_t has_coordinates = 1;
+
+static_assert(std::is_trivially_copyable_v<Edge> && sizeof(Edge) == 12);
+static_assert(std::is_trivially_copyable_v<Coordinate> && sizeof(Coordinate) == 16);
+
+// Edge records end on a 4-byte boundary; coordinates start on the next 8.
+std::size_t align8(std::size_t offset) noexcept {
+    return (offset + 7) & ~std::size_t{7};
+}
+
+std::runtime_error io_error(const std::string& what, const std::string& path) {
+    return std::runtime_error{"load_graph_snapshot " + what + " " + path + ": " + std::strerror(errno)};
+}
+
+std::runtime_error format_error(const std::string& what, const std::string& path) {
+    return std::runtime_error{"load_graph_snapshot " + path + " " + what};
+}
+
+// Read-only mapping of a whole file, unmapped on destruction.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw io_error("open", path);
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw io_error("stat", path);
+        }
+        size_ = static_cast<std::size_t>(info.st_size);
+        if (size_ > 0) {
+            data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (data_ == MAP_FAILED) {
+            data_ = nullptr;
+            throw io_error("mmap", path);
+        }
+        if (data_ != nullptr) {
+            // Read ahead of the copy and let pages go once it has passed them.
+            ::madvise(data_, size_, MADV_SEQUENTIAL);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (data_ != nullptr) {
+            ::munmap(data_, size_);
+        }
+    }
+
+    [[nodiscard]] const char* data() const noexcept { return static_cast<const char*>(data_); }
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+private:
+    void* data_{nullptr};
+    std::size_t size_{0};
+};
+
+}  // namespace
+
+void write_graph_snapshot(const Graph& graph, const std::string& path) {
+    std::ofstream output{path, std::ios::binary | std::ios::trunc};
+    if (!output) {
+        throw std::runtime_error{"write_graph_snapshot cannot open " + path};
+    }
+    const auto& coordinates = graph.coordinates();
+    SnapshotHeader header{};
+    std::memcpy(header.magic, snapshot_magic, sizeof(snapshot_magic));
+    header.version = snapshot_version;
+    header.node_count = graph.node_count();
+    header.edge_count = graph.edge_count();
+    header.flags = coordinates ? has_coordinates : 0;
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<std::uint64_t> offsets;
+    offsets.reserve(graph.node_count() + 1);
+    offsets.push_back(0);
+    for (std::size_t u = 0; u < graph.node_count(); ++u) {
+        offsets.push_back(offsets.back() + graph.neighbors(static_cast<node_id>(u)).size());
+    }
+    output.write(reinterpret_cast<const char*>(offsets.data()),
+                 static_cast<std::streamsize>(offsets.size() * sizeof(std::uint64_t)));
+
+    std::size_t written = sizeof(header) + offsets.size() * sizeof(std::uint64_t);
+    for (std::size_t u = 0; u < graph.node_count(); ++u) {
+        const auto& edges = graph.neighbors(static_cast<node_id>(u));
+        output.write(reinterpret_cast<const char*>(edges.data()),
+                     static_cast<std::streamsize>(edges.size() * sizeof(Edge)));
+        written += edges.size() * sizeof(Edge);
+    }
+    if (coordinates) {
+        const char padding[8] = {};
+        output.write(padding, static_cast<std::streamsize>(align8(written) - written));
+        output.write(reinterpret_cast<const char*>(coordinates->data()),
+                     static_cast<std::streamsize>(coordinates->size() * sizeof(Coordinate)));
+    }
+    output.flush();
+    if (!output) {
+        throw std::runtime_error{"write_graph_snapshot failed writing " + path};
+    }
+}
+
+Graph load_graph_snapshot(const std::string& path) {
+    const MappedFile file{path};
+    SnapshotHeader header{};
+    if (file.size() < sizeof(header)) {
+        throw format_error("is too short for a graph snapshot", path);
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, snapshot_magic, sizeof(snapshot_magic)) != 0) {
+        throw format_error("is not a graph snapshot", path);
+    }
+    if (header.version != snapshot_version) {
+        throw format_error("has unsupported version " + std::to_string(header.version), path);
+    }
+
+    // Sizes are checked against the file before anything is allocated.
+    const auto available = file.size() - sizeof(header);
+    if (header.node_count >= available / sizeof(std::uint64_t) ||
+        header.edge_count > available / sizeof(Edge)) {
+        throw format_error("is truncated", path);
+    }
+    const auto offsets_bytes = (header.node_count + 1) * sizeof(std::uint64_t);
+    const auto edges_begin = sizeof(header) + offsets_bytes;
+    const auto edges_end = edges_begin + header.edge_count * sizeof(Edge);
+    const auto coordinates_begin = align8(edges_end);
+    const auto with_coordinates = (header.flags & has_coordinates) != 0;
+    const auto expected_size =
+        with_coordinates ? coordinates_begin + header.node_count * sizeof(Coordinate) : edges_end;
+    if (edges_end > file.size() || file.size() != expected_size) {
+        throw format_error("has the wrong size for its node and edge counts", path);
+    }
+
+    const char* offsets = file.data() + sizeof(header);
+    std::vector<std::vector<Edge>> adjacency(header.node_count);
+    std::uint64_t begin = 0;
+    std::memcpy(&begin, offsets, sizeof(begin));
+    if (begin != 0) {
+        throw format_error("has corrupt edge offsets", path);
+    }
+    for (std::size_t u = 0; u < header.node_count; ++u) {
+        std::uint64_t end = 0;
+        std::memcpy(&end, offsets + (u + 1) * sizeof(std::uint64_t), sizeof(end));
+        if (end < begin || end > header.edge_count) {
+            throw format_error("has corrupt edge offsets", path);
+        }
+        auto& edges = adjacency[u];
+        edges.resize(static_cast<std::size_t>(end - begin));
+        std::memcpy(edges.data(), file.data() + edges_begin + begin * sizeof(Edge), edges.size() * sizeof(Edge));
+        begin = end;
+    }
+    if (begin != header.edge_count) {
+        throw format_error("has corrupt edge offsets", path);
+    }
+
+    auto graph = Graph::from_adjacency(std::move(adjacency));
+    if (with_coordinates) {
+        std::vector<Coordinate> coordinates(header.node_count);
+        std::memcpy(coordinates.data(), file.data() + coordinates_begin, coordinates.size() * sizeof(Coordinate));
+        graph.set_coordinates(std::move(coordinates));
+    }
+    return graph;
+}
+
+bool is_graph_snapshot(const std::string& path) {
+    std::ifstream input{path, std::ios::binary};
+    char magic[sizeof(snapshot_magic)] = {};
+    input.read(magic, sizeof(magic));
+    return input.gcount() == sizeof(magic) && std::memcmp(magic, snapshot_magic, sizeof(magic)) == 0;
+}
+
+}  // namespace georoute
@@ -1,23 +1,72 @@
 #include "georoute/http_server.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
 #include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include <httplib.h>
 #include <nlohmann/json.hpp>
 
+#include "georoute/congestion_writer.hpp"
 #include "georoute/engine.hpp"
+#include "georoute/graph_reloader.hpp"
+#include "georoute/http_worker_pool.hpp"
+#include "georoute/json_writer.hpp"
+#include "georoute/path_encoding.hpp"
+#include "georoute/prometheus.hpp"
+#include "georoute/request_arena.hpp"
+#include "georoute/response_json.hpp"
+#include "georoute/route_request.hpp"
 
 namespace georoute {
 
 namespace {
 
+constexpr std::int64_t default_wait_timeout_ms = 5000;
+// Route searches that run out of their SearchBudget.
+constexpr int budget_exceeded_status = 504;
+// Graph reload requested while another one is still loading.
+constexpr int reload_busy_status = 409;
+// Graph reload started on the reloader thread.
+constexpr int reload_accepted_status = 202;
+// Route batch larger than HttpServerOptions::max_route_batch_size.
+constexpr int batch_too_large_status = 413;
+// Connection arrived while max_queued_connections were already waiting.
+constexpr int overloaded_status = 503;
+constexpr std::size_t min_worker_threads = 4;
+
 nlohmann::json make_health_response() {
     return nlohmann::json{{"status", "ok"}};
 }
 
-nlohmann::json make_error_response(const std::string& message) {
-    return nlohmann::json{{"error", message}};
+// Route, error and metrics bodies are serialized into this thread's buffer,
+// which keeps its capacity between requests; the finished body is copied into
+// the response in one allocation.
+template <typename Write>
+void set_json_content(httplib::Response& res, Write&& write) {
+    thread_local std::string buffer;
+    buffer.clear();
+    JsonWriter out{buffer};
+    write(out);
+    res.set_content(buffer, "application/json");
+}
+
+void set_error_content(httplib::Response& res, std::string_view message) {
+    set_json_content(res, [message](JsonWriter& out) { write_error(out, message); });
 }
 
 template <typename Handler>
@@ -28,14 +77,97 @@ void wrap_endpoint(httplib::Server& server, const std::string& path, Handler&& h
             handler(req, res);
         } catch (const std::exception& ex) {
             res.status = 400;
-            res.set_content(make_error_response(ex.what()).dump(), "application/json");
+            set_error_content(res, ex.what());
         } catch (...) {
             res.status = 500;
-            res.set_content(make_error_response("internal server error").dump(), "application/json");
+            set_error_content(res, "internal server error");
         }
     });
 }
 
+// std::stoul takes values past 2^32 (and "-1") and the cast would wrap them
+// into a different node id or node cap.
+std::uint32_t parse_uint32_param(const std::string& value, std::string_view name) {
+    std::uint32_t parsed{0};
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), parsed);
+    if (error != std::errc{} || end != value.data() + value.size()) {
+        throw std::invalid_argument{"'" + std::string{name} + "' must be an integer from 0 to 4294967295"};
+    }
+    return parsed;
+}
+
+// Same check for numbers in JSON bodies: get<std::uint32_t>() would wrap
+// 2^32 to 0 and -1 to 4294967295 just the same.
+template <typename T>
+T json_unsigned(const nlohmann::json& value, const std::string& name) {
+    if (!value.is_number_unsigned() || value.get<std::uint64_t>() > std::numeric_limits<T>::max()) {
+        throw std::invalid_argument{"'" + name + "' must be an integer from 0 to " +
+                                    std::to_string(std::numeric_limits<T>::max())};
+    }
+    return static_cast<T>(value.get<std::uint64_t>());
+}
+
+std::int64_t json_int64(const nlohmann::json& value, const std::string& name) {
+    if (!value.is_number_integer() ||
+        (value.is_number_unsigned() &&
+         value.get<std::uint64_t>() > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()))) {
+        throw std::invalid_argument{"'" + name + "' must be a 64-bit integer"};
+    }
+    return value.get<std::int64_t>();
+}
+
+SearchBudget make_search_budget(const HttpServerOptions& options,
+                                std::optional<std::int64_t> timeout_ms,
+                                std::optional<std::uint32_t> max_settled_nodes) {
+    return make_request_budget(options.route_timeout, options.max_settled_nodes, timeout_ms, max_settled_nodes);
+}
+
+void set_route_content(httplib::Response& res,
+                       node_id source,
+                       node_id target,
+                       const RouteResponse& response,
+                       PathEncoding path_encoding) {
+    if (response.status != RouteStatus::complete) {
+        res.status = budget_exceeded_status;
+        set_json_content(res, [&](JsonWriter& out) {
+            out.begin_object()
+                .field("error", "route search budget exceeded")
+                .field("status", route_status_name(response.status))
+                .field("src", source)
+                .field("dst", target);
+            write_route_stats(out, response);
+            out.end_object();
+        });
+        return;
+    }
+    set_json_content(res, [&](JsonWriter& out) {
+        out.begin_object();
+        write_route_fields(out, source, target, response, true, path_encoding);
+        out.end_object();
+    });
+}
+
+// One element of a route batch response. Searches cut short by the budget
+// report their status in place of a path instead of failing the batch.
+void write_batch_entry(JsonWriter& out,
+                       const RouteQuery& query,
+                       const RouteResponse& response,
+                       bool include_path,
+                       PathEncoding path_encoding) {
+    out.begin_object();
+    if (response.status != RouteStatus::complete) {
+        out.field("src", query.source)
+            .field("dst", query.target)
+            .field("status", route_status_name(response.status))
+            .field("reachable", false);
+        write_route_stats(out, response);
+    } else {
+        write_route_fields(out, query.source, query.target, response, include_path, path_encoding);
+        out.field("status", route_status_name(response.status));
+    }
+    out.end_object();
+}
+
 std::optional<nlohmann::json> parse_json(const httplib::Request& req) {
     nlohmann::json body = nlohmann::json::parse(req.body, nullptr, false);
     if (body.is_discarded()) {
@@ -44,10 +176,263 @@ std::optional<nlohmann::json> parse_json(const httplib::Request& req) {
     return body;
 }
 
+// httplib owns and deletes its task queue; this forwards to the pool that
+// run_http_server owns, so /metrics can read the pool's counters.
+class PooledTaskQueue final : public httplib::TaskQueue {
+public:
+    explicit PooledTaskQueue(HttpWorkerPool& pool) noexcept : pool_(pool) {}
+
+    bool enqueue(std::function<void()> fn) override { return pool_.submit(std::move(fn)); }
+    void shutdown() override { pool_.shutdown(); }
+
+private:
+    HttpWorkerPool& pool_;
+};
+
+std::size_t resolve_worker_threads(const GeoRouteEngine& engine, const HttpServerOptions& options) {
+    if (options.worker_threads > 0) {
+        return options.worker_threads;
+    }
+    return std::max(min_worker_threads, 2 * engine.worker_threads());
+}
+
+// Per-endpoint request latency, in-flight gauge and response classes for
+// GET /metrics/prometheus. Paths outside endpoint_paths share the "other"
+// entry, so stray requests cannot grow the label set. Everything is relaxed
+// atomics on fixed slots: nothing is allocated or locked per request.
+class EndpointMetrics {
+public:
+    static constexpr std::array<std::string_view, 14> endpoint_paths{
+        "/health",
+        "/api/v1/health",
+        "/route",
+        "/api/v1/route",
+        "/api/v1/route/batch",
+        "/api/v1/congestion/update",
+        "/api/v1/congestion/wait",
+        "/api/v1/congestion/batch",
+        "/api/v1/congestion/edges",
+        "/api/v1/admin/graph/reload",
+        "/api/v1/admin/graph/reload/status",
+        "/metrics",
+        "/metrics/prometheus",
+        "other",
+    };
+    static constexpr std::array<std::string_view, 5> status_classes{"1xx", "2xx", "3xx", "4xx", "5xx"};
+
+    EndpointMetrics() {
+        for (auto& endpoint : endpoints_) {
+            endpoint = std::make_unique<Endpoint>();
+        }
+    }
+
+    // Called from the pre-routing handler, once the request line and headers
+    // are parsed.
+    void begin(std::string_view path) noexcept {
+        auto& current = current_request();
+        if (current.endpoint != nullptr) {
+            // The last response on this thread was never logged (write error).
+            current.endpoint->in_flight.fetch_sub(1, std::memory_order_relaxed);
+        }
+        current.endpoint = endpoints_[index(path)].get();
+        current.start = std::chrono::steady_clock::now();
+        current.endpoint->in_flight.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Called from the server logger once the response has been written.
+    void end(int status) noexcept {
+        auto& current = current_request();
+        if (current.endpoint == nullptr) {
+            return;
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - current.start;
+        current.endpoint->handler_ns.observe(
+            static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        const auto status_class = static_cast<std::size_t>(std::clamp(status / 100, 1, 5) - 1);
+        current.endpoint->responses[status_class].fetch_add(1, std::memory_order_relaxed);
+        current.endpoint->in_flight.fetch_sub(1, std::memory_order_relaxed);
+        current.endpoint = nullptr;
+    }
+
+    void write(PrometheusWriter& out) const {
+        out.family("georoute_http_request_duration_seconds", "histogram",
+                   "Time from parsed request headers to the last byte of the response.");
+        for (std::size_t i = 0; i < endpoint_paths.size(); ++i) {
+            out.histogram("georoute_http_request_duration_seconds", endpoints_[i]->handler_ns.snapshot(), 1e9,
+                          {{"endpoint", endpoint_paths[i]}});
+        }
+        out.family("georoute_http_requests_in_flight", "gauge", "Requests currently being handled.");
+        for (std::size_t i = 0; i < endpoint_paths.size(); ++i) {
+            const auto in_flight = endpoints_[i]->in_flight.load(std::memory_order_relaxed);
+            out.sample("georoute_http_requests_in_flight", static_cast<double>(in_flight),
+                       {{"endpoint", endpoint_paths[i]}});
+        }
+        out.family("georoute_http_responses_total", "counter", "Responses written, by status class.");
+        for (std::size_t i = 0; i < endpoint_paths.size(); ++i) {
+            for (std::size_t c = 0; c < status_classes.size(); ++c) {
+                const auto count = endpoints_[i]->responses[c].load(std::memory_order_relaxed);
+                if (count > 0) {
+                    out.sample("georoute_http_responses_total", count,
+                               {{"endpoint", endpoint_paths[i]}, {"code", status_classes[c]}});
+                }
+            }
+        }
+    }
+
+private:
+    struct Endpoint {
+        MetricHistogram handler_ns{prometheus_latency_bounds_ns()};
+        std::atomic<std::int64_t> in_flight{0};
+        std::array<std::atomic<std::uint64_t>, status_classes.size()> responses{};
+    };
+
+    struct CurrentRequest {
+        Endpoint* endpoint{nullptr};
+        std::chrono::steady_clock::time_point start{};
+    };
+
+    // Each worker thread handles one request at a time.
+    static CurrentRequest& current_request() noexcept {
+        thread_local CurrentRequest current;
+        return current;
+    }
+
+    static std::size_t index(std::string_view path) noexcept {
+        const auto known = std::find(endpoint_paths.begin(), endpoint_paths.end() - 1, path);
+        return static_cast<std::size_t>(known - endpoint_paths.begin());
+    }
+
+    std::array<std::unique_ptr<Endpoint>, endpoint_paths.size()> endpoints_{};
+};
+
+void write_prometheus_metrics(PrometheusWriter& out,
+                              const GeoRouteEngine& engine,
+                              const CongestionWriter& writer,
+                              const GraphReloader& reloader,
+                              const HttpWorkerPool& pool,
+                              const EndpointMetrics& endpoints) {
+    const auto stats = engine.get_stats();
+    const auto writer_stats = writer.stats();
+    const auto pool_stats = pool.stats();
+    const auto latency_bounds = prometheus_latency_bounds_ns();
+
+    out.family("georoute_route_compute_seconds", "histogram", "Route search time per query.")
+        .histogram("georoute_route_compute_seconds",
+                   fold_latency_histogram(engine.compute_time_histogram(), latency_bounds), 1e9);
+    out.family("georoute_route_expanded_nodes", "histogram", "Nodes settled per route query.")
+        .histogram("georoute_route_expanded_nodes", engine.expanded_nodes_histogram());
+    out.family("georoute_route_relaxed_edges", "histogram", "Edges relaxed per route query.")
+        .histogram("georoute_route_relaxed_edges", engine.relaxed_edges_histogram());
+    out.family("georoute_route_budget_exceeded_total", "counter", "Route queries cut short by their search budget.")
+        .sample("georoute_route_budget_exceeded_total", stats.total_deadline_exceeded, {{"reason", "deadline"}})
+        .sample("georoute_route_budget_exceeded_total", stats.total_node_budget_exceeded, {{"reason", "node_budget"}});
+    out.family("georoute_route_coalesced_total", "counter",
+               "Route queries answered by an identical search already in flight.")
+        .sample("georoute_route_coalesced_total", stats.total_coalesced_queries);
+
+    out.family("georoute_congestion_apply_seconds", "histogram", "Time to publish one congestion update call.")
+        .histogram("georoute_congestion_apply_seconds", engine.update_apply_histogram(), 1e9);
+    out.family("georoute_congestion_lock_wait_seconds", "histogram", "Time an update call waited for the update lock.")
+        .histogram("georoute_congestion_lock_wait_seconds", engine.update_lock_wait_histogram(), 1e9);
+    out.family("georoute_congestion_updates_total", "counter", "Congestion updates applied.")
+        .sample("georoute_congestion_updates_total", stats.total_updates);
+    out.family("georoute_congestion_batches_total", "counter", "Congestion batches applied.")
+        .sample("georoute_congestion_batches_total", stats.total_update_batches);
+    out.family("georoute_congestion_epoch", "gauge", "Congestion epoch served to new queries.")
+        .sample("georoute_congestion_epoch", engine.current_epoch());
+    out.family("georoute_congestion_queue_depth", "gauge", "Updates queued for the congestion writer.")
+        .sample("georoute_congestion_queue_depth", static_cast<std::uint64_t>(writer_stats.queue_depth));
+    out.family("georoute_congestion_dropped_updates_total", "counter",
+               "Queued updates dropped because a graph swap left their edges out of range.")
+        .sample("georoute_congestion_dropped_updates_total", writer_stats.dropped_updates);
+
+    out.family("georoute_graph_nodes", "gauge", "Nodes in the graph being served.")
+        .sample("georoute_graph_nodes", static_cast<std::uint64_t>(engine.node_count()));
+    out.family("georoute_graph_edges", "gauge", "Edges in the graph being served.")
+        .sample("georoute_graph_edges", static_cast<std::uint64_t>(engine.edge_count()));
+    out.family("georoute_graph_reloads_total", "counter", "Graphs swapped in since startup.")
+        .sample("georoute_graph_reloads_total", reloader.reloads());
+
+    endpoints.write(out);
+    out.family("georoute_http_workers", "gauge", "HTTP connection workers.")
+        .sample("georoute_http_workers", static_cast<std::uint64_t>(pool_stats.threads));
+    out.family("georoute_http_connections_active", "gauge", "Connections held by a worker.")
+        .sample("georoute_http_connections_active", static_cast<std::uint64_t>(pool_stats.active));
+    out.family("georoute_http_connections_queued", "gauge", "Connections waiting for a worker.")
+        .sample("georoute_http_connections_queued", static_cast<std::uint64_t>(pool_stats.queued));
+    out.family("georoute_http_connections_rejected_total", "counter", "Connections answered 503 by the shed thread.")
+        .sample("georoute_http_connections_rejected_total", pool_stats.shed_total);
+}
+
+nlohmann::json make_reload_report(const GraphReloadReport& report) {
+    nlohmann::json payload{
+        {"path", report.path},
+        {"nodes", report.swap.node_count},
+        {"edges", report.swap.edge_count},
+        {"congestion_carried", report.swap.congestion_carried},
+        {"epoch", report.swap.epoch},
+        {"load_ms", report.load_ms},
+        {"swap_us", report.swap.swap_time_us},
+        {"previous_memory_bytes", report.swap.previous_memory_bytes},
+        {"next_memory_bytes", report.swap.next_memory_bytes},
+        {"overlap_ms", nullptr}
+    };
+    if (report.overlap_ms) {
+        payload["overlap_ms"] = *report.overlap_ms;
+    }
+    return payload;
+}
+
+nlohmann::json make_reload_status_response(const GraphReloadStatus& status) {
+    nlohmann::json payload{
+        {"state", graph_reload_state_name(status.state)},
+        {"path", status.path},
+        {"error", nullptr},
+        {"result", nullptr}
+    };
+    if (!status.error.empty()) {
+        payload["error"] = status.error;
+    }
+    if (status.report) {
+        payload["result"] = make_reload_report(*status.report);
+    }
+    return payload;
+}
+
 }  // namespace
 
-int run_http_server(GeoRouteEngine& engine, const HttpServerOptions& options) {
+int run_http_server(GeoRouteEngine& engine,
+                    CongestionWriter& writer,
+                    GraphReloader& reloader,
+                    const HttpServerOptions& options) {
     httplib::Server server;
+    // Responses are written in one piece; without this, Nagle plus delayed
+    // ACKs hold each keep-alive response back by tens of milliseconds.
+    server.set_tcp_nodelay(true);
+    server.set_keep_alive_max_count(std::max<std::size_t>(1, options.keep_alive_max_count));
+    server.set_keep_alive_timeout(options.keep_alive_timeout.count());
+    server.set_read_timeout(options.read_timeout);
+    server.set_write_timeout(options.write_timeout);
+
+    HttpWorkerPool pool{resolve_worker_threads(engine, options), options.max_queued_connections};
+    server.new_task_queue = [&pool] { return new PooledTaskQueue{pool}; };
+    // Connections that overflowed the queue run on the pool's shed thread;
+    // answer before the body is read and close, so the client backs off.
+    EndpointMetrics endpoint_metrics;
+    server.set_logger([&endpoint_metrics](const httplib::Request&, const httplib::Response& res) {
+        endpoint_metrics.end(res.status);
+    });
+    server.set_pre_routing_handler([&endpoint_metrics](const httplib::Request& req, httplib::Response& res) {
+        endpoint_metrics.begin(req.path);
+        if (!HttpWorkerPool::shedding()) {
+            return httplib::Server::HandlerResponse::Unhandled;
+        }
+        res.status = overloaded_status;
+        res.set_header("Retry-After", "1");
+        res.set_header("Connection", "close");
+        set_error_content(res, "server overloaded, retry later");
+        return httplib::Server::HandlerResponse::Handled;
+    });
 
     server.Get("/health", [](const httplib::Request&, httplib::Response& res) {
         const auto payload = make_health_response();
@@ -59,112 +444,372 @@ int run_http_server(GeoRouteEngine& engine, const HttpServerOptions& options) {
         res.set_content(payload.dump(), "application/json");
     });
 
-    server.Get("/route", [&engine](const httplib::Request& req, httplib::Response& res) {
+    server.Get("/route", [&engine, &options](const httplib::Request& req, httplib::Response& res) {
         const auto src_param = req.get_param_value("src");
         const auto dst_param = req.get_param_value("dst");
         
         if (src_param.empty() || dst_param.empty()) {
             res.status = 400;
-            res.set_content(make_error_response("missing 'src' or 'dst' query parameters").dump(), "application/json");
+            set_error_content(res, "missing 'src' or 'dst' query parameters");
             return;
         }
         
         try {
-            const auto source = static_cast<node_id>(std::stoul(src_param));
-            const auto target = static_cast<node_id>(std::stoul(dst_param));
+            const auto source = parse_uint32_param(src_param, "src");
+            const auto target = parse_uint32_param(dst_param, "dst");
             
-            const auto response = engine.route(source, target);
-            
-            nlohmann::json json_response{
-                {"src", source},
-                {"dst", target},
-                {"distance", response.result.total_travel_time},
-                {"eta_ms", static_cast<int>(response.result.total_travel_time * 1000)},
-                {"path", response.result.nodes},
-                {"reachable", response.result.reachable},
-                {"stats", {
-                    {"compute_us", response.compute_time_us},
-                    {"expanded_nodes", response.expanded_nodes}
-                }}
-            };
+            const auto timeout_param = req.get_param_value("timeout_ms");
+            const auto nodes_param = req.get_param_value("max_settled_nodes");
+            const auto budget = make_search_budget(
+                options,
+                timeout_param.empty() ? std::nullopt : std::optional{std::stoll(timeout_param)},
+                nodes_param.empty() ? std::nullopt
+                                    : std::optional{parse_uint32_param(nodes_param, "max_settled_nodes")});
+
+            const auto encoding_param = req.get_param_value("path_encoding");
+            const auto path_encoding =
+                encoding_param.empty() ? PathEncoding::array : parse_path_encoding(encoding_param);
+
+            // The path lives in this thread's arena until the response is written.
+            RequestArena::Scope arena{RequestArena::local()};
+            const auto epoch_param = req.get_param_value("epoch");
+            const auto response =
+                epoch_param.empty()
+                    ? engine.route(source, target, budget, arena.resource())
+                    : engine.route_at_epoch(std::stoull(epoch_param), source, target, budget, arena.resource());
             
-            res.set_content(json_response.dump(), "application/json");
+            set_route_content(res, source, target, response, path_encoding);
         } catch (const std::exception& ex) {
             res.status = 400;
-            res.set_content(make_error_response(ex.what()).dump(), "application/json");
+            set_error_content(res, ex.what());
         }
     });
 
-    wrap_endpoint(server, "/api/v1/route", [&engine](const httplib::Request& req, httplib::Response& res) {
+    wrap_endpoint(server, "/api/v1/route", [&engine, &options](const httplib::Request& req, httplib::Response& res) {
+        // Read without building a JSON tree; malformed bodies and missing
+        // fields throw std::invalid_argument, answered with 400.
+        const auto request = parse_route_request(req.body);
+        const auto budget = make_search_budget(options, request.timeout_ms, request.max_settled_nodes);
+
+        RequestArena::Scope arena{RequestArena::local()};
+        const auto response =
+            request.epoch
+                ? engine.route_at_epoch(*request.epoch, request.source, request.target, budget, arena.resource())
+                : engine.route(request.source, request.target, budget, arena.resource());
+        set_route_content(res, request.source, request.target, response, request.path_encoding);
+    });
+
+    wrap_endpoint(server, "/api/v1/route/batch", [&engine, &options](const httplib::Request& req, httplib::Response& res) {
         const auto payload = parse_json(req);
         if (!payload) {
             res.status = 400;
-            res.set_content(make_error_response("invalid JSON payload").dump(), "application/json");
+            set_error_content(res, "invalid JSON payload");
             return;
         }
-        if (!payload->contains("source") || !payload->contains("target")) {
+        if (!payload->contains("queries") || !payload->at("queries").is_array()) {
             res.status = 400;
-            res.set_content(make_error_response("missing 'source' or 'target'").dump(), "application/json");
+            set_error_content(res, "missing 'queries' array");
+            return;
+        }
+
+        const auto& items = payload->at("queries");
+        if (items.size() > options.max_route_batch_size) {
+            res.status = batch_too_large_status;
+            set_error_content(res, "batch of " + std::to_string(items.size()) + " queries exceeds max_batch_size " +
+                                       std::to_string(options.max_route_batch_size));
             return;
         }
+        std::vector<RouteQuery> queries;
+        queries.reserve(items.size());
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            const auto& item = items[i];
+            if (!item.contains("source") || !item.contains("target")) {
+                res.status = 400;
+                set_error_content(res, "query missing 'source' or 'target'");
+                return;
+            }
+            const auto prefix = "queries[" + std::to_string(i) + "].";
+            queries.push_back(RouteQuery{json_unsigned<node_id>(item.at("source"), prefix + "source"),
+                                         json_unsigned<node_id>(item.at("target"), prefix + "target")});
+        }
 
-        const auto source = payload->at("source").get<node_id>();
-        const auto target = payload->at("target").get<node_id>();
+        // One budget for the whole batch: timeout_ms is a deadline shared by
+        // every pair, max_settled_nodes caps each search.
+        const auto include_path = payload->value("include_path", true);
+        const auto path_encoding = parse_path_encoding(payload->value("path_encoding", std::string{"array"}));
+        const auto budget = make_search_budget(
+            options,
+            payload->contains("timeout_ms") ? std::optional{json_int64(payload->at("timeout_ms"), "timeout_ms")}
+                                            : std::nullopt,
+            payload->contains("max_settled_nodes")
+                ? std::optional{json_unsigned<std::uint32_t>(payload->at("max_settled_nodes"), "max_settled_nodes")}
+                : std::nullopt);
 
-        const auto response = engine.route(source, target);
-        nlohmann::json json_response{
-            {"src", source},
-            {"dst", target},
-            {"distance", response.result.total_travel_time},
-            {"eta_ms", static_cast<int>(response.result.total_travel_time * 1000)},
-            {"path", response.result.nodes},
-            {"reachable", response.result.reachable},
-            {"stats", {
-                {"compute_us", response.compute_time_us},
-                {"expanded_nodes", response.expanded_nodes}
-            }}
-        };
+        const auto start = std::chrono::steady_clock::now();
+        const auto responses = engine.route_batch(queries, budget);
+        const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
 
-        res.set_content(json_response.dump(), "application/json");
+        set_json_content(res, [&](JsonWriter& out) {
+            out.begin_object().field("count", queries.size()).field("batch_us", elapsed.count());
+            out.key("results").begin_array();
+            for (std::size_t i = 0; i < queries.size(); ++i) {
+                write_batch_entry(out, queries[i], responses[i], include_path, path_encoding);
+            }
+            out.end_array().end_object();
+        });
     });
 
-    wrap_endpoint(server, "/api/v1/congestion/update", [&engine](const httplib::Request& req, httplib::Response& res) {
+    wrap_endpoint(server, "/api/v1/congestion/update", [&engine, &writer](const httplib::Request& req, httplib::Response& res) {
         const auto payload = parse_json(req);
         if (!payload) {
             res.status = 400;
-            res.set_content(make_error_response("invalid JSON payload").dump(), "application/json");
+            set_error_content(res, "invalid JSON payload");
             return;
         }
 
         if (!payload->contains("edge_start") || !payload->contains("edge_end") || !payload->contains("factor")) {
             res.status = 400;
-            res.set_content(make_error_response("missing 'edge_start', 'edge_end', or 'factor'").dump(),
-                            "application/json");
+            set_error_content(res, "missing 'edge_start', 'edge_end', or 'factor'");
             return;
         }
 
         const auto edge_start = payload->at("edge_start").get<std::size_t>();
         const auto edge_end = payload->at("edge_end").get<std::size_t>();
         const auto factor = payload->at("factor").get<float>();
-        engine.apply_congestion_update(edge_start, edge_end, factor);
+        const auto sequence = writer.enqueue(CongestionUpdate{edge_start, edge_end, factor});
 
-        res.set_content(nlohmann::json{{"status", "ok"}}.dump(), "application/json");
+        if (!payload->value("wait", false)) {
+            res.set_content(nlohmann::json{{"status", "queued"}, {"sequence", sequence}}.dump(), "application/json");
+            return;
+        }
+        const std::chrono::milliseconds timeout{payload->value("timeout_ms", default_wait_timeout_ms)};
+        if (!writer.wait_for(sequence, timeout)) {
+            res.status = 504;
+            res.set_content(nlohmann::json{{"status", "queued"}, {"sequence", sequence}}.dump(), "application/json");
+            return;
+        }
+        res.set_content(nlohmann::json{{"status", "ok"}, {"sequence", sequence}, {"epoch", engine.current_epoch()}}.dump(),
+                        "application/json");
     });
 
-    server.Get("/metrics", [&engine](const httplib::Request&, httplib::Response& res) {
-        const auto stats = engine.get_stats();
-        nlohmann::json metrics{
-            {"queries_total", stats.total_queries},
-            {"updates_total", stats.total_updates},
-            {"compute_time_total_us", stats.total_compute_time_us},
-            {"compute_time_max_us", stats.max_compute_time_us},
-            {"compute_time_avg_us", stats.total_queries > 0 ? stats.total_compute_time_us / stats.total_queries : 0.0}
+    server.Get("/api/v1/congestion/wait", [&engine, &writer](const httplib::Request& req, httplib::Response& res) {
+        const auto sequence_param = req.get_param_value("sequence");
+        if (sequence_param.empty()) {
+            res.status = 400;
+            set_error_content(res, "missing 'sequence' query parameter");
+            return;
+        }
+
+        try {
+            const auto sequence = std::stoull(sequence_param);
+            const auto timeout_param = req.get_param_value("timeout_ms");
+            const std::chrono::milliseconds timeout{timeout_param.empty() ? default_wait_timeout_ms
+                                                                          : std::stoll(timeout_param)};
+            const bool visible = writer.wait_for(sequence, timeout);
+            nlohmann::json json_response{
+                {"sequence", sequence},
+                {"visible", visible},
+                {"applied_sequence", writer.applied_sequence()},
+                {"epoch", engine.current_epoch()}
+            };
+            if (!visible) {
+                res.status = 504;
+            }
+            res.set_content(json_response.dump(), "application/json");
+        } catch (const std::exception& ex) {
+            res.status = 400;
+            set_error_content(res, ex.what());
+        }
+    });
+
+    wrap_endpoint(server, "/api/v1/congestion/batch", [&engine](const httplib::Request& req, httplib::Response& res) {
+        const auto payload = parse_json(req);
+        if (!payload) {
+            res.status = 400;
+            set_error_content(res, "invalid JSON payload");
+            return;
+        }
+        if (!payload->contains("updates") || !payload->at("updates").is_array()) {
+            res.status = 400;
+            set_error_content(res, "missing 'updates' array");
+            return;
+        }
+
+        const auto& items = payload->at("updates");
+        std::vector<CongestionUpdate> updates;
+        updates.reserve(items.size());
+        for (const auto& item : items) {
+            if (!item.contains("edge_start") || !item.contains("edge_end") || !item.contains("factor")) {
+                res.status = 400;
+                set_error_content(res, "update missing 'edge_start', 'edge_end', or 'factor'");
+                return;
+            }
+            updates.push_back(CongestionUpdate{item.at("edge_start").get<std::size_t>(),
+                                               item.at("edge_end").get<std::size_t>(),
+                                               item.at("factor").get<float>()});
+        }
+
+        const auto result = engine.apply_congestion_updates(updates);
+        nlohmann::json json_response{
+            {"status", "ok"},
+            {"updates", result.updates},
+            {"merged_ranges", result.merged_ranges},
+            {"apply_us", result.apply_time_us},
+            {"epoch", result.epoch}
+        };
+        res.set_content(json_response.dump(), "application/json");
+    });
+
+    wrap_endpoint(server, "/api/v1/congestion/edges", [&engine](const httplib::Request& req, httplib::Response& res) {
+        const auto payload = parse_json(req);
+        if (!payload) {
+            res.status = 400;
+            set_error_content(res, "invalid JSON payload");
+            return;
+        }
+        if (!payload->contains("edges") || !payload->at("edges").is_array()) {
+            res.status = 400;
+            set_error_content(res, "missing 'edges' array");
+            return;
+        }
+
+        const auto& items = payload->at("edges");
+        std::vector<EdgeFactorUpdate> updates;
+        updates.reserve(items.size());
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            const auto& item = items[i];
+            if (!item.contains("edge_id") || !item.contains("factor")) {
+                res.status = 400;
+                set_error_content(res, "edge update missing 'edge_id' or 'factor'");
+                return;
+            }
+            const auto id = json_unsigned<edge_id>(item.at("edge_id"), "edges[" + std::to_string(i) + "].edge_id");
+            updates.push_back(EdgeFactorUpdate{id, item.at("factor").get<float>()});
+        }
+
+        const auto result = engine.apply_edge_updates(updates);
+        nlohmann::json json_response{
+            {"status", "ok"},
+            {"updates", result.updates},
+            {"flushed_ranges", result.merged_ranges},
+            {"apply_us", result.apply_time_us},
+            {"epoch", result.epoch}
         };
-        res.set_content(metrics.dump(2), "application/json");
+        res.set_content(json_response.dump(), "application/json");
+    });
+
+    wrap_endpoint(server, "/api/v1/admin/graph/reload", [&reloader](const httplib::Request& req, httplib::Response& res) {
+        // An empty body reloads the current graph file with congestion carried over.
+        auto payload = nlohmann::json::object();
+        if (!req.body.empty()) {
+            const auto parsed = parse_json(req);
+            if (!parsed || !parsed->is_object()) {
+                res.status = 400;
+                set_error_content(res, "invalid JSON payload");
+                return;
+            }
+            payload = *parsed;
+        }
+
+        // A multi-gigabyte graph takes seconds to load, so it is not loaded on
+        // an HTTP worker; the outcome is polled from the status endpoint.
+        if (!reloader.start(payload.value("path", std::string{}), payload.value("carry_congestion", true))) {
+            res.status = reload_busy_status;
+            set_error_content(res, "graph reload already in progress");
+            return;
+        }
+        res.status = reload_accepted_status;
+        res.set_content(make_reload_status_response(reloader.status()).dump(), "application/json");
+    });
+
+    server.Get("/api/v1/admin/graph/reload/status", [&reloader](const httplib::Request&, httplib::Response& res) {
+        res.set_content(make_reload_status_response(reloader.status()).dump(), "application/json");
     });
 
-    const auto success = server.listen(options.host.c_str(), static_cast<int>(options.port));
-    return success ? 0 : 1;
+    server.Get("/metrics", [&engine, &writer, &reloader, &pool](const httplib::Request&, httplib::Response& res) {
+        const auto stats = engine.get_stats();
+        const auto writer_stats = writer.stats();
+        const auto pool_stats = pool.stats();
+        const auto average_us =
+            stats.total_queries > 0 ? stats.total_compute_time_us / static_cast<double>(stats.total_queries) : 0.0;
+        set_json_content(res, [&](JsonWriter& out) {
+            out.begin_object()
+                .field("queries_total", stats.total_queries)
+                .field("updates_total", stats.total_updates)
+                .field("update_batches_total", stats.total_update_batches)
+                .field("congestion_epoch", engine.current_epoch())
+                .field("compute_time_total_us", stats.total_compute_time_us)
+                .field("compute_time_max_us", stats.max_compute_time_us)
+                .field("compute_time_avg_us", average_us)
+                .field("compute_time_p50_us", stats.p50_compute_time_us)
+                .field("compute_time_p90_us", stats.p90_compute_time_us)
+                .field("compute_time_p99_us", stats.p99_compute_time_us)
+                .field("compute_time_p999_us", stats.p999_compute_time_us)
+                .field("expanded_nodes_total", stats.total_expanded_nodes)
+                .field("relaxed_edges_total", stats.total_relaxed_edges)
+                .field("route_deadline_exceeded_total", stats.total_deadline_exceeded)
+                .field("route_node_budget_exceeded_total", stats.total_node_budget_exceeded)
+                .field("route_coalesced_total", stats.total_coalesced_queries)
+                .field("graph_nodes", engine.node_count())
+                .field("graph_edges", engine.edge_count())
+                .field("graph_reloads_total", reloader.reloads());
+            out.key("congestion_writer")
+                .begin_object()
+                .field("enqueued_sequence", writer_stats.enqueued_sequence)
+                .field("applied_sequence", writer_stats.applied_sequence)
+                .field("queue_depth", writer_stats.queue_depth)
+                .field("batches_total", writer_stats.batches)
+                .field("coalesced_updates_total", writer_stats.coalesced_updates)
+                .field("dropped_updates_total", writer_stats.dropped_updates)
+                .field("apply_lag_last_us", writer_stats.last_apply_lag_us)
+                .field("apply_lag_max_us", writer_stats.max_apply_lag_us)
+                .field("apply_lag_avg_us", writer_stats.mean_apply_lag_us)
+                .end_object();
+            out.key("http")
+                .begin_object()
+                .field("worker_threads", pool_stats.threads)
+                .field("active_connections", pool_stats.active)
+                .field("queued_connections", pool_stats.queued)
+                .field("max_queued_connections", pool_stats.max_queued)
+                .field("connections_total", pool_stats.accepted_total)
+                .field("rejected_total", pool_stats.shed_total)
+                .field("dropped_total", pool_stats.dropped_total)
+                .end_object();
+            out.end_object();
+        });
+    });
+
+    server.Get("/metrics/prometheus", [&](const httplib::Request&, httplib::Response& res) {
+        thread_local std::string buffer;
+        buffer.clear();
+        PrometheusWriter out{buffer};
+        write_prometheus_metrics(out, engine, writer, reloader, pool, endpoint_metrics);
+        res.set_content(buffer, std::string{PrometheusWriter::content_type});
+    });
+
+    if (options.stop_token.stop_requested()) {
+        return 0;
+    }
+    if (!server.bind_to_port(options.host, static_cast<int>(options.port))) {
+        return 1;
+    }
+    // httplib's stop() does nothing until listen_after_bind() is running, so
+    // a stop is only forwarded once the server is ready.
+    const auto forward_stop = [&server] {
+        server.wait_until_ready();
+        server.stop();
+    };
+    std::jthread late_stop;
+    const auto listening_thread = std::this_thread::get_id();
+    std::stop_callback stop_listening{options.stop_token, [&] {
+        if (std::this_thread::get_id() == listening_thread) {
+            // Requested since the check above; this thread is about to listen.
+            late_stop = std::jthread{forward_stop};
+        } else {
+            forward_stop();
+        }
+    }};
+    return server.listen_after_bind() ? 0 : 1;
 }
 
 }  // namespace georoute
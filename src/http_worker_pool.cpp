@@ -0,0 +1,122 @@
+#include "georoute/http_worker_pool.hpp"
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+namespace georoute {
+
+namespace {
+
+thread_local bool on_shed_thread = false;
+
+// A shed job only reads a request line and headers and writes a short 503,
+// so the shed thread can keep up with a much longer queue than the workers.
+constexpr std::size_t shed_queue_factor = 16;
+
+}  // namespace
+
+HttpWorkerPool::HttpWorkerPool(std::size_t threads, std::size_t max_queued) : max_queued_(max_queued) {
+    if (threads == 0) {
+        throw std::invalid_argument{"HttpWorkerPool needs at least one thread"};
+    }
+    workers_.threads.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers_.threads.emplace_back([this] { run(workers_, false); });
+    }
+    if (max_queued_ > 0) {
+        shed_.threads.emplace_back([this] { run(shed_, true); });
+    }
+}
+
+HttpWorkerPool::~HttpWorkerPool() {
+    shutdown();
+}
+
+bool HttpWorkerPool::submit(std::function<void()> job) {
+    if (push(workers_, job, max_queued_)) {
+        accepted_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    if (max_queued_ > 0 && push(shed_, job, shed_queue_factor * max_queued_)) {
+        shed_total_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void HttpWorkerPool::shutdown() {
+    for (auto* lane : {&workers_, &shed_}) {
+        {
+            std::lock_guard lock{lane->mutex};
+            lane->stopping = true;
+        }
+        lane->ready.notify_all();
+        for (auto& thread : lane->threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+}
+
+HttpWorkerPoolStats HttpWorkerPool::stats() const {
+    HttpWorkerPoolStats stats;
+    stats.threads = workers_.threads.size();
+    stats.active = active_.load(std::memory_order_relaxed);
+    {
+        std::lock_guard lock{workers_.mutex};
+        stats.queued = workers_.jobs.size();
+    }
+    stats.max_queued = max_queued_;
+    stats.accepted_total = accepted_.load(std::memory_order_relaxed);
+    stats.shed_total = shed_total_.load(std::memory_order_relaxed);
+    stats.dropped_total = dropped_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool HttpWorkerPool::shedding() noexcept {
+    return on_shed_thread;
+}
+
+bool HttpWorkerPool::push(Lane& lane, std::function<void()>& job, std::size_t max_queued) {
+    {
+        std::lock_guard lock{lane.mutex};
+        if (lane.stopping || (max_queued > 0 && lane.jobs.size() >= max_queued)) {
+            return false;
+        }
+        lane.jobs.push_back(std::move(job));
+    }
+    lane.ready.notify_one();
+    return true;
+}
+
+void HttpWorkerPool::run(Lane& lane, bool shed) {
+    on_shed_thread = shed;
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock lock{lane.mutex};
+            lane.ready.wait(lock, [&lane] { return lane.stopping || !lane.jobs.empty(); });
+            if (lane.jobs.empty()) {
+                return;
+            }
+            job = std::move(lane.jobs.front());
+            lane.jobs.pop_front();
+        }
+        if (!shed) {
+            active_.fetch_add(1, std::memory_order_relaxed);
+        }
+        try {
+            job();
+        } catch (const std::exception& ex) {
+            std::cerr << "HttpWorkerPool job failed: " << ex.what() << '\n';
+        }
+        if (!shed) {
+            active_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+}  // namespace georoute
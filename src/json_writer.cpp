@@ -0,0 +1,201 @@
+#include "georoute/json_writer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace georoute {
+
+namespace {
+
+// Longest to_chars output of a uint32_t.
+constexpr std::size_t max_uint32_digits = 10;
+
+template <typename Float>
+void append_float(std::string& out, Float number) {
+    if (!std::isfinite(number)) {
+        out += "null";
+        return;
+    }
+    char digits[32];
+    const auto end = std::to_chars(digits, digits + sizeof(digits), number).ptr;
+    out.append(digits, end);
+    // Keep integral values recognisable as floating point ("2.0", not "2").
+    if (std::string_view{digits, static_cast<std::size_t>(end - digits)}.find_first_of(".e") ==
+        std::string_view::npos) {
+        out += ".0";
+    }
+}
+
+}  // namespace
+
+JsonWriter& JsonWriter::begin_object() {
+    open('{');
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_object() {
+    close('}');
+    return *this;
+}
+
+JsonWriter& JsonWriter::begin_array() {
+    open('[');
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_array() {
+    close(']');
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separator();
+    write_string(name);
+    out_ += ':';
+    after_key_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view text) {
+    separator();
+    write_string(text);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separator();
+    out_ += flag ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double number) {
+    separator();
+    append_float(out_, number);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(float number) {
+    separator();
+    append_float(out_, number);
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separator();
+    out_ += "null";
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::span<const std::uint32_t> numbers) {
+    separator();
+    const auto start = out_.size();
+    out_.resize(start + 2 + numbers.size() * (max_uint32_digits + 1));
+    auto* cursor = out_.data() + start;
+    *cursor++ = '[';
+    for (std::size_t i = 0; i < numbers.size(); ++i) {
+        if (i > 0) {
+            *cursor++ = ',';
+        }
+        cursor = std::to_chars(cursor, cursor + max_uint32_digits, numbers[i]).ptr;
+    }
+    *cursor++ = ']';
+    out_.resize(static_cast<std::size_t>(cursor - out_.data()));
+    return *this;
+}
+
+void JsonWriter::separator() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    if (depth_ == 0) {
+        return;
+    }
+    const auto bit = std::uint64_t{1} << (depth_ - 1);
+    if ((has_items_ & bit) != 0) {
+        out_ += ',';
+    }
+    has_items_ |= bit;
+}
+
+void JsonWriter::open(char bracket) {
+    separator();
+    if (depth_ == max_depth) {
+        throw std::logic_error{"JsonWriter::open nesting deeper than max_depth"};
+    }
+    out_ += bracket;
+    ++depth_;
+    has_items_ &= ~(std::uint64_t{1} << (depth_ - 1));
+}
+
+void JsonWriter::close(char bracket) {
+    if (depth_ == 0) {
+        throw std::logic_error{"JsonWriter::close without an open container"};
+    }
+    --depth_;
+    out_ += bracket;
+}
+
+void JsonWriter::write_string(std::string_view text) {
+    out_ += '"';
+    write_escaped(text);
+    out_ += '"';
+}
+
+void JsonWriter::escape_from(std::size_t start) {
+    const auto needs_escape = [](char c) {
+        const auto byte = static_cast<unsigned char>(c);
+        return byte < 0x20 || byte == '"' || byte == '\\';
+    };
+    if (std::none_of(out_.begin() + static_cast<std::ptrdiff_t>(start), out_.end(), needs_escape)) {
+        return;
+    }
+    const std::string raw{out_, start};
+    out_.resize(start);
+    write_escaped(raw);
+}
+
+void JsonWriter::write_escaped(std::string_view text) {
+    static constexpr char hex[] = "0123456789abcdef";
+    std::size_t run = 0;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        const auto c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out_.append(text.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"':
+                out_ += "\\\"";
+                break;
+            case '\\':
+                out_ += "\\\\";
+                break;
+            case '\b':
+                out_ += "\\b";
+                break;
+            case '\f':
+                out_ += "\\f";
+                break;
+            case '\n':
+                out_ += "\\n";
+                break;
+            case '\r':
+                out_ += "\\r";
+                break;
+            case '\t':
+                out_ += "\\t";
+                break;
+            default:
+                out_ += "\\u00";
+                out_ += hex[c >> 4];
+                out_ += hex[c & 0xF];
+                break;
+        }
+    }
+    out_.append(text.data() + run, text.size() - run);
+}
+
+}  // namespace georoute
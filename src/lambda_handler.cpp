@@ -1,11 +1,274 @@
+#include "georoute/lambda_handler.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+
+#include "georoute/engine.hpp"
+#include "georoute/graph_snapshot.hpp"
+#include "georoute/json_writer.hpp"
+#include "georoute/request_arena.hpp"
+#include "georoute/response_json.hpp"
+#include "georoute/route_request.hpp"
 #include "georoute/router.hpp"
 
 namespace georoute {
 
+namespace {
+
+constexpr const char* runtime_prefix = "/2018-06-01/runtime";
+// /invocation/next is a long poll: it returns when the next event arrives.
+constexpr std::chrono::hours next_invocation_timeout{24};
+// Same status as the HTTP server for a search cut short by its budget.
+constexpr int budget_exceeded_status = 504;
+
+std::string env_or(const char* name, std::string fallback) {
+    const char* value = std::getenv(name);
+    return value != nullptr && *value != '\0' ? std::string{value} : std::move(fallback);
+}
+
+std::runtime_error runtime_error(const char* caller, const std::string& what) {
+    return std::runtime_error{std::string{"LambdaRuntimeClient::"} + caller + " " + what};
+}
+
+std::string error_payload(std::string_view error_type, std::string_view message) {
+    std::string payload;
+    JsonWriter out{payload};
+    out.begin_object().field("errorMessage", message).field("errorType", error_type).end_object();
+    return payload;
+}
+
+// Converts Lambda-Runtime-Deadline-Ms (Unix epoch milliseconds) to the
+// steady clock that search budgets use.
+std::chrono::steady_clock::time_point steady_deadline(const std::string& header) {
+    if (header.empty()) {
+        return std::chrono::steady_clock::time_point::max();
+    }
+    const std::chrono::milliseconds deadline{std::stoll(header)};
+    const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+    return std::chrono::steady_clock::now() + (deadline - now);
+}
+
+}  // namespace
+
+LambdaHandler::LambdaHandler(GeoRouteEngine& engine,
+                             std::chrono::milliseconds route_timeout,
+                             std::uint32_t max_settled_nodes)
+    : engine_(engine), route_timeout_(route_timeout), max_settled_nodes_(max_settled_nodes) {}
+
+std::string LambdaHandler::handle(const LambdaInvocation& invocation) {
+    auto deadline = invocation.deadline;
+    if (deadline != std::chrono::steady_clock::time_point::max()) {
+        deadline -= deadline_margin;
+    }
+
+    const auto event = nlohmann::json::parse(invocation.event, nullptr, false);
+    if (event.is_discarded() || !event.is_object()) {
+        throw std::invalid_argument{"event must be a JSON object"};
+    }
+    std::string body;
+    if (!event.contains("body")) {
+        // Direct invoke: the event is the route request.
+        route(invocation.event, deadline, body);
+        return body;
+    }
+
+    int status = 400;
+    const auto& request_body = event.at("body");
+    if (!request_body.is_string()) {
+        JsonWriter out{body};
+        write_error(out, "missing request body");
+    } else if (event.value("isBase64Encoded", false)) {
+        JsonWriter out{body};
+        write_error(out, "base64-encoded bodies are not supported");
+    } else {
+        try {
+            status = route(request_body.get_ref<const std::string&>(), deadline, body);
+        } catch (const std::exception& ex) {
+            // As the HTTP server does: bad fields, unknown node ids and
+            // epochs no longer retained are all the client's 400.
+            body.clear();
+            JsonWriter out{body};
+            write_error(out, ex.what());
+        }
+    }
+
+    std::string payload;
+    JsonWriter out{payload};
+    out.begin_object()
+        .field("statusCode", status)
+        .key("headers")
+        .begin_object()
+        .field("Content-Type", "application/json")
+        .end_object()
+        .field("body", body)
+        .field("isBase64Encoded", false)
+        .end_object();
+    return payload;
+}
+
+int LambdaHandler::route(std::string_view request_body,
+                         std::chrono::steady_clock::time_point deadline,
+                         std::string& body) {
+    const auto request = parse_route_request(request_body);
+    auto budget =
+        make_request_budget(route_timeout_, max_settled_nodes_, request.timeout_ms, request.max_settled_nodes);
+    budget.deadline = std::min(budget.deadline, deadline);
+
+    RequestArena::Scope arena{RequestArena::local()};
+    const auto response =
+        request.epoch ? engine_.route_at_epoch(*request.epoch, request.source, request.target, budget, arena.resource())
+                      : engine_.route(request.source, request.target, budget, arena.resource());
+
+    JsonWriter out{body};
+    if (response.status != RouteStatus::complete) {
+        out.begin_object()
+            .field("error", "route search budget exceeded")
+            .field("status", route_status_name(response.status))
+            .field("src", request.source)
+            .field("dst", request.target);
+        write_route_stats(out, response);
+        out.end_object();
+        return budget_exceeded_status;
+    }
+    out.begin_object();
+    write_route_fields(out, request.source, request.target, response, true, request.path_encoding);
+    out.end_object();
+    return 200;
+}
+
+LambdaRuntimeClient::LambdaRuntimeClient(const std::string& runtime_api)
+    : client_(std::make_unique<httplib::Client>("http://" + runtime_api)) {
+    client_->set_keep_alive(true);
+    // Each call is a small write followed by a wait for the answer; with
+    // Nagle's algorithm on, delayed ACKs add tens of milliseconds to each.
+    client_->set_tcp_nodelay(true);
+    client_->set_read_timeout(next_invocation_timeout);
+}
+
+LambdaRuntimeClient::~LambdaRuntimeClient() = default;
+
+LambdaInvocation LambdaRuntimeClient::next() {
+    const auto result = client_->Get(std::string{runtime_prefix} + "/invocation/next");
+    if (!result) {
+        throw runtime_error("next", "request failed: " + httplib::to_string(result.error()));
+    }
+    if (result->status != 200) {
+        throw runtime_error("next", "answered " + std::to_string(result->status));
+    }
+    LambdaInvocation invocation;
+    invocation.request_id = result->get_header_value("Lambda-Runtime-Aws-Request-Id");
+    if (invocation.request_id.empty()) {
+        throw runtime_error("next", "response has no Lambda-Runtime-Aws-Request-Id");
+    }
+    invocation.event = std::move(result->body);
+    invocation.deadline = steady_deadline(result->get_header_value("Lambda-Runtime-Deadline-Ms"));
+    return invocation;
+}
+
+void LambdaRuntimeClient::respond(const std::string& request_id, std::string_view payload) {
+    post(std::string{runtime_prefix} + "/invocation/" + request_id + "/response", payload, "respond");
+}
+
+void LambdaRuntimeClient::fail(const std::string& request_id, std::string_view error_type, std::string_view message) {
+    post(std::string{runtime_prefix} + "/invocation/" + request_id + "/error", error_payload(error_type, message),
+         "fail");
+}
+
+void LambdaRuntimeClient::fail_init(std::string_view error_type, std::string_view message) {
+    post(std::string{runtime_prefix} + "/init/error", error_payload(error_type, message), "fail_init");
+}
+
+void LambdaRuntimeClient::post(const std::string& path, std::string_view body, const char* caller) {
+    const auto result = client_->Post(path, body.data(), body.size(), "application/json");
+    if (!result) {
+        throw runtime_error(caller, "request failed: " + httplib::to_string(result.error()));
+    }
+    if (result->status != 202) {
+        throw runtime_error(caller, "answered " + std::to_string(result->status));
+    }
+}
+
+LambdaOptions lambda_options_from_env() {
+    LambdaOptions options;
+    options.runtime_api = env_or("AWS_LAMBDA_RUNTIME_API", "");
+    options.graph_snapshot =
+        env_or("GEOROUTE_GRAPH_SNAPSHOT", env_or("LAMBDA_TASK_ROOT", "/var/task") + "/graph.snapshot");
+    options.congestion_index = env_or("GEOROUTE_CONGESTION_INDEX", options.congestion_index);
+    options.route_timeout = std::chrono::milliseconds{std::stoll(env_or("GEOROUTE_ROUTE_TIMEOUT_MS", "0"))};
+    const auto max_settled_nodes = std::stoull(env_or("GEOROUTE_MAX_SETTLED_NODES", "0"));
+    if (max_settled_nodes > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::out_of_range{"lambda_options_from_env GEOROUTE_MAX_SETTLED_NODES exceeds 4294967295"};
+    }
+    options.max_settled_nodes = static_cast<std::uint32_t>(max_settled_nodes);
+    return options;
+}
+
+int run_lambda(const LambdaOptions& options) {
+    if (options.runtime_api.empty()) {
+        std::cerr << "AWS_LAMBDA_RUNTIME_API is not set\n";
+        return 1;
+    }
+    try {
+        LambdaRuntimeClient runtime{options.runtime_api};
+
+        // Cold start: everything up to the first /next call.
+        const auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<GeoRouteEngine> engine;
+        try {
+            auto graph = load_graph_snapshot(options.graph_snapshot);
+            auto congestion = CongestionIndex::make(options.congestion_index, graph.edge_count());
+            engine = std::make_unique<GeoRouteEngine>(Router{std::move(graph), std::move(congestion)});
+        } catch (const std::exception& ex) {
+            std::cerr << "Failed to load graph snapshot: " << ex.what() << '\n';
+            runtime.fail_init("GraphLoadError", ex.what());
+            return 1;
+        }
+        // An execution environment handles one invocation at a time, so
+        // there is never a concurrent identical search to share.
+        engine->set_route_coalescing(false);
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "GeoRoute Lambda initialized with graph snapshot " << options.graph_snapshot << ": "
+                  << engine->node_count() << " nodes, " << engine->edge_count() << " edges in " << elapsed.count()
+                  << " ms\n";
+
+        LambdaHandler handler{*engine, options.route_timeout, options.max_settled_nodes};
+        for (std::size_t handled = 0; options.max_invocations == 0 || handled < options.max_invocations; ++handled) {
+            const auto invocation = runtime.next();
+            std::string payload;
+            try {
+                payload = handler.handle(invocation);
+            } catch (const std::invalid_argument& ex) {
+                runtime.fail(invocation.request_id, "InvalidRequest", ex.what());
+                continue;
+            } catch (const std::exception& ex) {
+                runtime.fail(invocation.request_id, "RouteError", ex.what());
+                continue;
+            }
+            runtime.respond(invocation.request_id, payload);
+        }
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "Lambda runtime API error: " << ex.what() << '\n';
+        return 1;
+    }
+}
+
 int lambda_entry_point() {
-    // Placeholder for AWS Lambda handler logic to be implemented later.
-    return 0;
+    try {
+        return run_lambda(lambda_options_from_env());
+    } catch (const std::exception& ex) {
+        std::cerr << "Invalid Lambda environment: " << ex.what() << '\n';
+        return 1;
+    }
 }
 
 }  // namespace georoute
-
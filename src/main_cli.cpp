@@ -1,3 +1,4 @@
+#include <chrono>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
@@ -5,19 +6,24 @@
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include <nlohmann/json.hpp>
 
+#include "georoute/engine.hpp"
+#include "georoute/graph_snapshot.hpp"
+#include "georoute/query_stream.hpp"
 #include "georoute/router.hpp"
 
 namespace {
 
-struct CongestionUpdate {
-    std::size_t edge_start;
-    std::size_t edge_end;
-    float factor;
+using georoute::CongestionUpdate;
+
+struct CongestionBatch {
+    std::string path;
+    std::vector<CongestionUpdate> updates;
 };
 
 struct RouteQuery {
@@ -25,17 +31,56 @@ struct RouteQuery {
     georoute::node_id target;
 };
 
-using Operation = std::variant<CongestionUpdate, RouteQuery>;
+using Operation = std::variant<CongestionUpdate, CongestionBatch, RouteQuery>;
 
 struct CliArguments {
     std::string graph_path;
+    std::string snapshot_path;
     std::vector<Operation> operations;
+    // --queries-file batch mode; runs after the operations above.
+    std::string queries_file;
+    std::string queries_format;
+    std::string output_path;
+    std::string output_format;
+    std::size_t threads{0};
+    std::size_t batch_size{4096};
+    bool include_path{false};
 };
 
 void print_usage(const char* binary) {
     std::cout << "GeoRoute CLI\n"
               << "Usage: " << binary
-              << " --graph <path> [--congestion <edge_start> <edge_end> <factor>]... [--route <source> <target>]...\n";
+              << " --graph <path> [--congestion <edge_start> <edge_end> <factor>]... [--congestion-batch <path>]..."
+              << " [--route <source> <target>]... [--write-snapshot <path>]\n"
+              << "       " << binary << " --graph <path> --queries-file <path> [--queries-format json|csv|bin]"
+              << " [--output <path>] [--output-format csv|ndjson] [--threads <n>] [--batch-size <n>]"
+              << " [--include-path]\n";
+}
+
+// Reads a JSON array of {edge_start, edge_end, factor} objects, or an object
+// with such an array under "updates".
+std::optional<std::vector<CongestionUpdate>> load_congestion_batch(const std::string& path) {
+    std::ifstream input{path};
+    if (!input) {
+        std::cerr << "Failed to open congestion batch file: " << path << '\n';
+        return std::nullopt;
+    }
+    try {
+        nlohmann::json data;
+        input >> data;
+        const auto& items = data.is_object() ? data.at("updates") : data;
+        std::vector<CongestionUpdate> updates;
+        updates.reserve(items.size());
+        for (const auto& item : items) {
+            updates.push_back(CongestionUpdate{item.at("edge_start").get<std::size_t>(),
+                                               item.at("edge_end").get<std::size_t>(),
+                                               item.at("factor").get<float>()});
+        }
+        return updates;
+    } catch (const std::exception& ex) {
+        std::cerr << "Failed to parse congestion batch: " << ex.what() << '\n';
+        return std::nullopt;
+    }
 }
 
 bool parse_arguments(int argc, char** argv, CliArguments& out_args) {
@@ -61,6 +106,17 @@ bool parse_arguments(int argc, char** argv, CliArguments& out_args) {
                 std::cerr << "Invalid --congestion parameters: " << ex.what() << '\n';
                 return false;
             }
+        } else if (arg == "--congestion-batch") {
+            if (i + 1 >= argc) {
+                std::cerr << "--congestion-batch requires a path argument\n";
+                return false;
+            }
+            const std::string path{argv[++i]};
+            auto updates = load_congestion_batch(path);
+            if (!updates) {
+                return false;
+            }
+            out_args.operations.emplace_back(CongestionBatch{path, std::move(*updates)});
         } else if (arg == "--route") {
             if (i + 2 >= argc) {
                 std::cerr << "--route requires source target\n";
@@ -74,6 +130,36 @@ bool parse_arguments(int argc, char** argv, CliArguments& out_args) {
                 std::cerr << "Invalid --route parameters: " << ex.what() << '\n';
                 return false;
             }
+        } else if (arg == "--write-snapshot") {
+            if (i + 1 >= argc) {
+                std::cerr << "--write-snapshot requires a path argument\n";
+                return false;
+            }
+            out_args.snapshot_path = argv[++i];
+        } else if (arg == "--queries-file" || arg == "--queries-format" || arg == "--output" ||
+                   arg == "--output-format") {
+            if (i + 1 >= argc) {
+                std::cerr << arg << " requires an argument\n";
+                return false;
+            }
+            auto& value = arg == "--queries-file"     ? out_args.queries_file
+                          : arg == "--queries-format" ? out_args.queries_format
+                          : arg == "--output"         ? out_args.output_path
+                                                      : out_args.output_format;
+            value = argv[++i];
+        } else if (arg == "--threads" || arg == "--batch-size") {
+            if (i + 1 >= argc) {
+                std::cerr << arg << " requires a count\n";
+                return false;
+            }
+            try {
+                (arg == "--threads" ? out_args.threads : out_args.batch_size) = std::stoul(argv[++i]);
+            } catch (const std::exception& ex) {
+                std::cerr << "Invalid " << arg << " parameter: " << ex.what() << '\n';
+                return false;
+            }
+        } else if (arg == "--include-path") {
+            out_args.include_path = true;
         } else if (arg == "--help" || arg == "-h") {
             print_usage(argv[0]);
             return false;
@@ -91,20 +177,75 @@ bool parse_arguments(int argc, char** argv, CliArguments& out_args) {
     return true;
 }
 
-std::optional<nlohmann::json> load_graph_json(const std::string& path) {
-    std::ifstream input{path};
-    if (!input) {
-        std::cerr << "Failed to open graph file: " << path << '\n';
+// JSON, DIMACS .gr (with its .co) or a graph snapshot; see Router::from_file.
+std::optional<georoute::Router> load_router(const std::string& path) {
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        std::optional<georoute::Router> router{georoute::Router::from_file(path)};
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cerr << "Loaded graph " << path << ": " << router->node_count() << " nodes, " << router->edge_count()
+                  << " edges in " << elapsed.count() << " ms\n";
+        return router;
+    } catch (const std::exception& ex) {
+        std::cerr << "Failed to load graph: " << ex.what() << '\n';
         return std::nullopt;
     }
+}
+
+bool ends_with(std::string_view text, std::string_view suffix) {
+    return text.size() >= suffix.size() && text.substr(text.size() - suffix.size()) == suffix;
+}
+
+// Streams --queries-file through an engine over router: routes run on every
+// worker, results go to --output (or stdout) and the summary to stderr.
+int run_queries_file(georoute::Router router, const CliArguments& args) {
+    std::ifstream input{args.queries_file, std::ios::binary};
+    if (!input) {
+        std::cerr << "Failed to open queries file: " << args.queries_file << '\n';
+        return 1;
+    }
+    std::ofstream file_output;
+    if (!args.output_path.empty()) {
+        file_output.open(args.output_path, std::ios::binary | std::ios::trunc);
+        if (!file_output) {
+            std::cerr << "Failed to open output file: " << args.output_path << '\n';
+            return 1;
+        }
+    }
+    std::ostream& output = args.output_path.empty() ? std::cout : file_output;
+
     try {
-        nlohmann::json data;
-        input >> data;
-        return data;
+        georoute::GeoRouteEngine engine{std::move(router)};
+        if (args.threads > 0) {
+            engine.set_worker_threads(args.threads);
+        }
+        const auto format = args.queries_format.empty() ? georoute::query_file_format_for(args.queries_file)
+                                                        : georoute::parse_query_file_format(args.queries_format);
+        georoute::QueryStreamOptions options;
+        if (!args.output_format.empty()) {
+            options.output_format = georoute::parse_route_output_format(args.output_format);
+        } else if (ends_with(args.output_path, ".ndjson") || ends_with(args.output_path, ".jsonl")) {
+            options.output_format = georoute::RouteOutputFormat::ndjson;
+        }
+        options.chunk_size = args.batch_size;
+        options.include_path = args.include_path;
+
+        const auto summary = georoute::run_query_stream(engine, input, format, output, options);
+        output.flush();
+        if (!output) {
+            std::cerr << "Failed to write route results\n";
+            return 1;
+        }
+        std::cerr << "Routed " << summary.routes << " queries (" << summary.unreachable << " unreachable, "
+                  << summary.budget_exceeded << " over budget) with " << summary.updates << " congestion updates in "
+                  << summary.elapsed_ms << " ms: " << summary.routes_per_second() << " routes/s on "
+                  << engine.worker_threads() << " workers, " << summary.chunks << " chunks, "
+                  << summary.route_wait_ms << " ms waiting on routes\n";
     } catch (const std::exception& ex) {
-        std::cerr << "Failed to parse graph JSON: " << ex.what() << '\n';
-        return std::nullopt;
+        std::cerr << "Error during CLI execution: " << ex.what() << '\n';
+        return 1;
     }
+    return 0;
 }
 
 void print_route_result(const georoute::RouteResult& result) {
@@ -133,15 +274,28 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    const auto graph_json = load_graph_json(args.graph_path);
-    if (!graph_json) {
+    auto loaded = load_router(args.graph_path);
+    if (!loaded) {
         return 1;
     }
+    georoute::Router& router = *loaded;
 
-    georoute::Router router = georoute::Router::from_json(*graph_json);
+    if (!args.snapshot_path.empty()) {
+        try {
+            georoute::write_graph_snapshot(router.graph(), args.snapshot_path);
+        } catch (const std::exception& ex) {
+            std::cerr << "Failed to write graph snapshot: " << ex.what() << '\n';
+            return 1;
+        }
+        std::cout << "Wrote graph snapshot " << args.snapshot_path << " (" << router.node_count() << " nodes, "
+                  << router.edge_count() << " edges)\n";
+    }
 
-    if (args.operations.empty()) {
-        std::cout << "No operations supplied. Use --route and/or --congestion.\n";
+    if (args.operations.empty() && args.queries_file.empty()) {
+        if (args.snapshot_path.empty()) {
+            std::cout << "No operations supplied. Use --route, --congestion, --congestion-batch and/or"
+                      << " --queries-file.\n";
+        }
         return 0;
     }
 
@@ -154,6 +308,13 @@ int main(int argc, char** argv) {
                         router.apply_congestion_update(operation.edge_start, operation.edge_end, operation.factor);
                         std::cout << "Applied congestion factor " << operation.factor << " to edges ["
                                   << operation.edge_start << ", " << operation.edge_end << "]\n";
+                    } else if constexpr (std::is_same_v<T, CongestionBatch>) {
+                        const auto begin = std::chrono::steady_clock::now();
+                        const auto merged = router.apply_congestion_updates(operation.updates);
+                        const auto end = std::chrono::steady_clock::now();
+                        const std::chrono::duration<double, std::micro> elapsed = end - begin;
+                        std::cout << "Applied congestion batch " << operation.path << ": " << operation.updates.size()
+                                  << " updates merged into " << merged.ranges_written << " ranges in " << elapsed.count() << " us\n";
                     } else if constexpr (std::is_same_v<T, RouteQuery>) {
                         const auto computation = router.compute_route(operation.source, operation.target);
                         std::cout << "Route from " << operation.source << " to " << operation.target << ":\n";
@@ -167,6 +328,9 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    if (!args.queries_file.empty()) {
+        return run_queries_file(std::move(router), args);
+    }
     return 0;
 }
 
@@ -0,0 +1,253 @@
+#include "georoute/path_encoding.hpp"
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace georoute {
+
+namespace {
+
+constexpr std::string_view base64_alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+// A zigzag-mapped 32-bit delta needs at most 33 bits: five 7-bit groups.
+constexpr std::size_t max_varint_bytes = 5;
+constexpr double polyline_scale = 1e5;
+// A zigzag-mapped coordinate delta (at most 2 x 360e5) fits in six 5-bit groups.
+constexpr std::size_t max_polyline_chars = 6;
+constexpr int polyline_offset = 63;
+
+constexpr std::array<std::int8_t, 256> make_base64_values() {
+    std::array<std::int8_t, 256> values{};
+    values.fill(-1);
+    for (std::size_t i = 0; i < base64_alphabet.size(); ++i) {
+        values[static_cast<unsigned char>(base64_alphabet[i])] = static_cast<std::int8_t>(i);
+    }
+    return values;
+}
+
+constexpr auto base64_values = make_base64_values();
+
+std::uint64_t zigzag(std::int64_t value) noexcept {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t value) noexcept {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+// Packs bytes into base64 characters three at a time, writing at cursor.
+class Base64Sink {
+public:
+    explicit Base64Sink(char* cursor) noexcept : cursor_(cursor) {}
+
+    void put(std::uint8_t byte) noexcept {
+        bits_ = (bits_ << 8) | byte;
+        if (++pending_ == 3) {
+            emit(4);
+            bits_ = 0;
+            pending_ = 0;
+        }
+    }
+
+    // Flushes a partial group with '=' padding; returns the end of the output.
+    char* finish() noexcept {
+        if (pending_ > 0) {
+            const auto chars = pending_ + 1;
+            bits_ <<= 8 * (3 - pending_);
+            emit(chars);
+            for (auto i = chars; i < 4; ++i) {
+                *cursor_++ = '=';
+            }
+        }
+        return cursor_;
+    }
+
+private:
+    void emit(int chars) noexcept {
+        for (int i = 0; i < chars; ++i) {
+            *cursor_++ = base64_alphabet[(bits_ >> (18 - 6 * i)) & 0x3F];
+        }
+    }
+
+    char* cursor_;
+    std::uint32_t bits_{0};
+    int pending_{0};
+};
+
+char* put_polyline_value(char* cursor, std::int64_t delta) noexcept {
+    auto value = zigzag(delta);
+    while (value >= 0x20) {
+        *cursor++ = static_cast<char>((0x20 | (value & 0x1F)) + polyline_offset);
+        value >>= 5;
+    }
+    *cursor++ = static_cast<char>(value + polyline_offset);
+    return cursor;
+}
+
+std::int64_t polyline_units(double degrees) noexcept {
+    return std::llround(degrees * polyline_scale);
+}
+
+std::string base64_decode(std::string_view encoded) {
+    if (encoded.size() % 4 != 0) {
+        throw std::invalid_argument{"decode_varint_path base64 length must be a multiple of 4"};
+    }
+    std::string bytes;
+    bytes.reserve(encoded.size() / 4 * 3);
+    for (std::size_t i = 0; i < encoded.size(); i += 4) {
+        std::uint32_t bits = 0;
+        int chars = 0;
+        for (std::size_t j = 0; j < 4; ++j) {
+            const auto c = encoded[i + j];
+            if (c == '=' && i + 4 == encoded.size() && j >= 2) {
+                if (j == 2 && encoded[i + 3] != '=') {
+                    throw std::invalid_argument{"decode_varint_path invalid base64 padding"};
+                }
+                bits <<= 6;
+                continue;
+            }
+            const auto value = base64_values[static_cast<unsigned char>(c)];
+            if (value < 0 || chars != static_cast<int>(j)) {
+                throw std::invalid_argument{"decode_varint_path invalid base64 character"};
+            }
+            bits = (bits << 6) | static_cast<std::uint32_t>(value);
+            ++chars;
+        }
+        for (int k = 0; k < chars - 1; ++k) {
+            bytes += static_cast<char>((bits >> (16 - 8 * k)) & 0xFF);
+        }
+    }
+    return bytes;
+}
+
+}  // namespace
+
+PathEncoding parse_path_encoding(std::string_view name) {
+    if (name == "array") {
+        return PathEncoding::array;
+    }
+    if (name == "varint") {
+        return PathEncoding::varint;
+    }
+    if (name == "polyline") {
+        return PathEncoding::polyline;
+    }
+    throw std::invalid_argument{"path_encoding must be 'array', 'varint' or 'polyline'"};
+}
+
+const char* path_encoding_name(PathEncoding encoding) noexcept {
+    switch (encoding) {
+        case PathEncoding::varint:
+            return "varint";
+        case PathEncoding::polyline:
+            return "polyline";
+        case PathEncoding::array:
+            break;
+    }
+    return "array";
+}
+
+void append_varint_path(std::string& out, std::span<const node_id> nodes) {
+    const auto start = out.size();
+    const auto max_bytes = nodes.size() * max_varint_bytes;
+    out.resize(start + (max_bytes + 2) / 3 * 4);
+    Base64Sink sink{out.data() + start};
+    std::int64_t previous = 0;
+    for (const auto node : nodes) {
+        auto value = zigzag(static_cast<std::int64_t>(node) - previous);
+        previous = node;
+        while (value >= 0x80) {
+            sink.put(static_cast<std::uint8_t>(0x80 | (value & 0x7F)));
+            value >>= 7;
+        }
+        sink.put(static_cast<std::uint8_t>(value));
+    }
+    out.resize(static_cast<std::size_t>(sink.finish() - out.data()));
+}
+
+std::vector<node_id> decode_varint_path(std::string_view encoded) {
+    const auto bytes = base64_decode(encoded);
+    std::vector<node_id> nodes;
+    std::int64_t previous = 0;
+    std::uint64_t value = 0;
+    int shift = 0;
+    for (const char c : bytes) {
+        const auto byte = static_cast<std::uint8_t>(c);
+        if (shift >= static_cast<int>(7 * max_varint_bytes)) {
+            throw std::invalid_argument{"decode_varint_path varint too long"};
+        }
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) != 0) {
+            shift += 7;
+            continue;
+        }
+        const auto node = previous + unzigzag(value);
+        if (node < 0 || node > std::numeric_limits<node_id>::max()) {
+            throw std::invalid_argument{"decode_varint_path node id out of range"};
+        }
+        nodes.push_back(static_cast<node_id>(node));
+        previous = node;
+        value = 0;
+        shift = 0;
+    }
+    if (shift != 0) {
+        throw std::invalid_argument{"decode_varint_path truncated varint"};
+    }
+    return nodes;
+}
+
+void append_polyline(std::string& out, std::span<const node_id> nodes, std::span<const Coordinate> coordinates) {
+    const auto start = out.size();
+    out.resize(start + nodes.size() * 2 * max_polyline_chars);
+    auto* cursor = out.data() + start;
+    std::int64_t previous_lat = 0;
+    std::int64_t previous_lon = 0;
+    for (const auto node : nodes) {
+        if (node >= coordinates.size()) {
+            out.resize(start);
+            throw std::out_of_range{"append_polyline node has no coordinate"};
+        }
+        const auto lat = polyline_units(coordinates[node].lat);
+        const auto lon = polyline_units(coordinates[node].lon);
+        cursor = put_polyline_value(cursor, lat - previous_lat);
+        cursor = put_polyline_value(cursor, lon - previous_lon);
+        previous_lat = lat;
+        previous_lon = lon;
+    }
+    out.resize(static_cast<std::size_t>(cursor - out.data()));
+}
+
+std::vector<Coordinate> decode_polyline(std::string_view encoded) {
+    std::vector<Coordinate> points;
+    std::array<std::int64_t, 2> position{0, 0};
+    std::size_t axis = 0;
+    std::uint64_t value = 0;
+    int shift = 0;
+    for (const char c : encoded) {
+        const auto chunk = static_cast<int>(c) - polyline_offset;
+        if (chunk < 0 || chunk >= 64 || shift >= static_cast<int>(5 * max_polyline_chars)) {
+            throw std::invalid_argument{"decode_polyline invalid character"};
+        }
+        value |= static_cast<std::uint64_t>(chunk & 0x1F) << shift;
+        if ((chunk & 0x20) != 0) {
+            shift += 5;
+            continue;
+        }
+        position[axis] += unzigzag(value);
+        value = 0;
+        shift = 0;
+        if (++axis == 2) {
+            points.push_back(Coordinate{static_cast<double>(position[0]) / polyline_scale,
+                                        static_cast<double>(position[1]) / polyline_scale});
+            axis = 0;
+        }
+    }
+    if (shift != 0 || axis != 0) {
+        throw std::invalid_argument{"decode_polyline truncated input"};
+    }
+    return points;
+}
+
+}  // namespace georoute
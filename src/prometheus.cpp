@@ -0,0 +1,159 @@
+#include "georoute/prometheus.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+
+namespace georoute {
+
+namespace {
+
+constexpr std::array<std::uint64_t, 18> latency_bounds_ns{
+    50'000, 100'000, 250'000, 500'000, 1'000'000, 2'500'000, 5'000'000, 10'000'000, 25'000'000, 50'000'000,
+    100'000'000, 250'000'000, 500'000'000, 1'000'000'000, 2'500'000'000, 5'000'000'000, 10'000'000'000,
+    30'000'000'000};
+
+void append_label_value(std::string& out, std::string_view value) {
+    for (const char c : value) {
+        switch (c) {
+            case '\\':
+                out += "\\\\";
+                break;
+            case '"':
+                out += "\\\"";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            default:
+                out += c;
+                break;
+        }
+    }
+}
+
+}  // namespace
+
+PrometheusWriter& PrometheusWriter::family(std::string_view name, std::string_view type, std::string_view help) {
+    out_ += "# HELP ";
+    out_ += name;
+    out_ += ' ';
+    out_ += help;
+    out_ += "\n# TYPE ";
+    out_ += name;
+    out_ += ' ';
+    out_ += type;
+    out_ += '\n';
+    return *this;
+}
+
+PrometheusWriter& PrometheusWriter::sample(std::string_view name, double value, PrometheusLabels labels) {
+    write_name(name, {}, labels, {});
+    write_value(value);
+    return *this;
+}
+
+PrometheusWriter& PrometheusWriter::sample(std::string_view name, std::uint64_t value, PrometheusLabels labels) {
+    write_name(name, {}, labels, {});
+    write_value(value);
+    return *this;
+}
+
+PrometheusWriter& PrometheusWriter::histogram(std::string_view name,
+                                              const MetricHistogramSnapshot& histogram,
+                                              double unit,
+                                              PrometheusLabels labels) {
+    std::uint64_t cumulative = 0;
+    char le[32];
+    for (std::size_t i = 0; i < histogram.upper_bounds.size(); ++i) {
+        cumulative += histogram.counts[i];
+        const auto bound = static_cast<double>(histogram.upper_bounds[i]) / unit;
+        const auto end = std::to_chars(le, le + sizeof(le), bound, std::chars_format::fixed).ptr;
+        write_name(name, "_bucket", labels, std::string_view{le, static_cast<std::size_t>(end - le)});
+        write_value(cumulative);
+    }
+    write_name(name, "_bucket", labels, "+Inf");
+    write_value(histogram.total_count);
+    write_name(name, "_sum", labels, {});
+    write_value(static_cast<double>(histogram.sum) / unit);
+    write_name(name, "_count", labels, {});
+    write_value(histogram.total_count);
+    return *this;
+}
+
+void PrometheusWriter::write_name(std::string_view name,
+                                  std::string_view suffix,
+                                  PrometheusLabels labels,
+                                  std::string_view le) {
+    out_ += name;
+    out_ += suffix;
+    if (labels.size() == 0 && le.empty()) {
+        out_ += ' ';
+        return;
+    }
+    out_ += '{';
+    bool first = true;
+    for (const auto& [key, value] : labels) {
+        if (!first) {
+            out_ += ',';
+        }
+        first = false;
+        out_ += key;
+        out_ += "=\"";
+        append_label_value(out_, value);
+        out_ += '"';
+    }
+    if (!le.empty()) {
+        out_ += first ? "le=\"" : ",le=\"";
+        out_ += le;
+        out_ += '"';
+    }
+    out_ += "} ";
+}
+
+void PrometheusWriter::write_value(double value) {
+    if (std::isnan(value)) {
+        out_ += "NaN\n";
+        return;
+    }
+    if (std::isinf(value)) {
+        out_ += value > 0 ? "+Inf\n" : "-Inf\n";
+        return;
+    }
+    char digits[32];
+    const auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    out_.append(digits, end);
+    out_ += '\n';
+}
+
+void PrometheusWriter::write_value(std::uint64_t value) {
+    char digits[24];
+    const auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    out_.append(digits, end);
+    out_ += '\n';
+}
+
+MetricHistogramSnapshot fold_latency_histogram(const LatencyHistogramSnapshot& histogram,
+                                               std::span<const std::uint64_t> upper_bounds_ns) {
+    MetricHistogramSnapshot folded;
+    folded.upper_bounds.assign(upper_bounds_ns.begin(), upper_bounds_ns.end());
+    folded.counts.assign(upper_bounds_ns.size() + 1, 0);
+    for (std::size_t i = 0; i < histogram.counts.size(); ++i) {
+        if (histogram.counts[i] == 0) {
+            continue;
+        }
+        const auto edge = LatencyBuckets::upper_bound(i);
+        const auto target = std::lower_bound(upper_bounds_ns.begin(), upper_bounds_ns.end(), edge);
+        folded.counts[static_cast<std::size_t>(target - upper_bounds_ns.begin())] += histogram.counts[i];
+    }
+    folded.total_count = histogram.total_count;
+    folded.sum = histogram.total_ns;
+    return folded;
+}
+
+std::span<const std::uint64_t> prometheus_latency_bounds_ns() noexcept {
+    return latency_bounds_ns;
+}
+
+}  // namespace georoute
@@ -0,0 +1,119 @@
+#include "georoute/query_executor.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+namespace georoute {
+
+namespace {
+
+// Identifies the executor and worker slot of the current thread, so tasks
+// submitted from inside a task land on the submitting worker's own deque.
+thread_local const QueryExecutor* current_executor = nullptr;
+thread_local std::size_t current_worker = 0;
+
+}  // namespace
+
+QueryExecutor::QueryExecutor(std::size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers_[i]->thread = std::thread{[this, i] { run_worker(i); }};
+    }
+}
+
+QueryExecutor::~QueryExecutor() {
+    {
+        std::lock_guard lock{sleep_mutex_};
+        stopping_ = true;
+    }
+    wake_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker->thread.join();
+    }
+}
+
+void QueryExecutor::submit(std::unique_ptr<Task> task) {
+    const auto index = current_executor == this
+                           ? current_worker
+                           : next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    {
+        std::lock_guard lock{workers_[index]->mutex};
+        workers_[index]->tasks.push_back(std::move(task));
+    }
+    // Pairs with the sleepers_ increment in run_worker: either the sleeper
+    // sees the new pending count or we see the sleeper and wake it.
+    pending_.fetch_add(1);
+    if (sleepers_.load() > 0) {
+        std::lock_guard lock{sleep_mutex_};
+        wake_cv_.notify_one();
+    }
+}
+
+std::unique_ptr<QueryExecutor::Task> QueryExecutor::take(std::size_t index) {
+    {
+        auto& own = *workers_[index];
+        std::lock_guard lock{own.mutex};
+        if (!own.tasks.empty()) {
+            auto task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return task;
+        }
+    }
+    for (std::size_t offset = 1; offset < workers_.size(); ++offset) {
+        auto& victim = *workers_[(index + offset) % workers_.size()];
+        std::lock_guard lock{victim.mutex};
+        if (!victim.tasks.empty()) {
+            auto task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void QueryExecutor::run_worker(std::size_t index) {
+    current_executor = this;
+    current_worker = index;
+    auto& scratch = workers_[index]->scratch;
+    for (;;) {
+        if (auto task = take(index)) {
+            pending_.fetch_sub(1);
+            try {
+                task->run(scratch);
+            } catch (const std::exception& ex) {
+                std::cerr << "QueryExecutor task failed: " << ex.what() << '\n';
+            }
+            continue;
+        }
+
+        std::unique_lock lock{sleep_mutex_};
+        sleepers_.fetch_add(1);
+        wake_cv_.wait(lock, [this] { return pending_.load() > 0 || stopping_; });
+        sleepers_.fetch_sub(1);
+        if (stopping_ && pending_.load() == 0) {
+            return;
+        }
+    }
+}
+
+std::size_t QueryExecutor::thread_count() const noexcept {
+    return workers_.size();
+}
+
+std::uint64_t QueryExecutor::steals() const noexcept {
+    return steals_.load(std::memory_order_relaxed);
+}
+
+bool QueryExecutor::on_worker_thread() const noexcept {
+    return current_executor == this;
+}
+
+}  // namespace georoute
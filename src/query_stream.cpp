@@ -0,0 +1,488 @@
+#include "georoute/query_stream.hpp"
+
+#include <array>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "georoute/json_writer.hpp"
+#include "georoute/response_json.hpp"
+
+namespace georoute {
+
+namespace {
+
+using json = nlohmann::json;
+
+static_assert(std::endian::native == std::endian::little, "binary pair files are read in place");
+
+std::invalid_argument item_error(std::size_t item, const std::string& what) {
+    return std::invalid_argument{"queries item " + std::to_string(item) + ": " + what};
+}
+
+bool ends_with(std::string_view text, std::string_view suffix) noexcept {
+    return text.size() >= suffix.size() && text.substr(text.size() - suffix.size()) == suffix;
+}
+
+// Collects the flat objects of a top-level array, one item per object.
+// Unknown fields are skipped, including nested ones.
+class QueryArrayReader {
+public:
+    explicit QueryArrayReader(const std::function<void(const QueryStreamItem&)>& sink) : sink_(sink) {}
+
+    bool null() { return scalar(); }
+    bool boolean(bool) { return scalar(); }
+    bool number_integer(json::number_integer_t value) {
+        if (depth_ == 2 && field_ == Field::factor) {
+            return number_float(static_cast<json::number_float_t>(value), {});
+        }
+        if (value >= 0) {
+            return number_unsigned(static_cast<json::number_unsigned_t>(value));
+        }
+        // Negative values are only an error in the id fields.
+        return depth_ == 2 && field_ != Field::other ? field_error() : scalar();
+    }
+    bool number_unsigned(json::number_unsigned_t value) {
+        if (depth_ != 2) {
+            return scalar();
+        }
+        switch (field_) {
+            case Field::source:
+                return store(source_, value);
+            case Field::target:
+                return store(target_, value);
+            case Field::edge_start:
+                return store(edge_start_, value);
+            case Field::edge_end:
+                return store(edge_end_, value);
+            case Field::factor:
+                return number_float(static_cast<json::number_float_t>(value), {});
+            case Field::other:
+                return true;
+        }
+        return true;
+    }
+    bool number_float(json::number_float_t value, const json::string_t&) {
+        if (depth_ == 2 && field_ == Field::factor) {
+            factor_ = static_cast<float>(value);
+            return true;
+        }
+        return scalar();
+    }
+    bool string(json::string_t&) { return scalar(); }
+    bool binary(json::binary_t&) { return scalar(); }
+    bool start_object(std::size_t) {
+        if (depth_ == 0 || (depth_ == 2 && field_ != Field::other)) {
+            throw item_error(item_, "expected an array of flat objects");
+        }
+        if (depth_ == 1) {
+            source_.reset();
+            target_.reset();
+            edge_start_.reset();
+            edge_end_.reset();
+            factor_.reset();
+        }
+        ++depth_;
+        return true;
+    }
+    bool end_object() {
+        if (--depth_ == 1) {
+            emit();
+        }
+        return true;
+    }
+    bool start_array(std::size_t) {
+        if (depth_ == 1 || (depth_ == 2 && field_ != Field::other)) {
+            throw item_error(item_, "expected an array of flat objects");
+        }
+        ++depth_;
+        return true;
+    }
+    bool end_array() {
+        --depth_;
+        return true;
+    }
+    bool key(json::string_t& name) {
+        if (depth_ == 2) {
+            field_ = field_of(name);
+        }
+        return true;
+    }
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception&) {
+        throw std::invalid_argument{"queries file: invalid JSON at byte " + std::to_string(position)};
+    }
+
+private:
+    enum class Field { source, target, edge_start, edge_end, factor, other };
+
+    static Field field_of(const json::string_t& name) {
+        if (name == "source") {
+            return Field::source;
+        }
+        if (name == "target") {
+            return Field::target;
+        }
+        if (name == "edge_start") {
+            return Field::edge_start;
+        }
+        if (name == "edge_end") {
+            return Field::edge_end;
+        }
+        if (name == "factor") {
+            return Field::factor;
+        }
+        return Field::other;
+    }
+
+    bool scalar() {
+        if (depth_ < 2) {
+            throw item_error(item_, "expected an array of flat objects");
+        }
+        return depth_ != 2 || field_ == Field::other || field_error();
+    }
+
+    template <typename T>
+    bool store(std::optional<T>& out, json::number_unsigned_t value) {
+        if (value > std::numeric_limits<T>::max()) {
+            return field_error();
+        }
+        out = static_cast<T>(value);
+        return true;
+    }
+
+    bool field_error() const {
+        throw item_error(item_, "node ids and edge ids must be non-negative integers, factor a number");
+    }
+
+    void emit() {
+        if (source_ && target_ && !edge_start_ && !edge_end_ && !factor_) {
+            sink_(RouteQuery{*source_, *target_});
+        } else if (edge_start_ && edge_end_ && factor_ && !source_ && !target_) {
+            sink_(CongestionUpdate{*edge_start_, *edge_end_, *factor_});
+        } else {
+            throw item_error(item_, "needs source and target, or edge_start, edge_end and factor");
+        }
+        ++item_;
+    }
+
+    const std::function<void(const QueryStreamItem&)>& sink_;
+    Field field_{Field::other};
+    int depth_{0};
+    std::size_t item_{0};
+    std::optional<node_id> source_{};
+    std::optional<node_id> target_{};
+    std::optional<std::size_t> edge_start_{};
+    std::optional<std::size_t> edge_end_{};
+    std::optional<float> factor_{};
+};
+
+template <typename T>
+bool parse_field(std::string_view text, T& out) {
+    const auto* end = text.data() + text.size();
+    const auto [ptr, ec] = std::from_chars(text.data(), end, out);
+    return ec == std::errc{} && ptr == end;
+}
+
+std::string_view trim(std::string_view text) noexcept {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+void read_csv(std::istream& input, const std::function<void(const QueryStreamItem&)>& sink) {
+    std::string line;
+    std::size_t item = 0;
+    bool first_row = true;
+    std::array<std::string_view, 3> fields;
+    while (std::getline(input, line)) {
+        const auto row = trim(line);
+        if (row.empty() || row.front() == '#') {
+            continue;
+        }
+        std::size_t count = 0;
+        std::size_t start = 0;
+        while (true) {
+            const auto comma = row.find(',', start);
+            if (count < fields.size()) {
+                fields[count] = trim(row.substr(start, comma == std::string_view::npos ? comma : comma - start));
+            }
+            ++count;
+            if (comma == std::string_view::npos) {
+                break;
+            }
+            start = comma + 1;
+        }
+
+        const bool header = first_row && !fields[0].empty() && (fields[0].front() < '0' || fields[0].front() > '9');
+        first_row = false;
+        if (header) {
+            continue;
+        }
+        if (count == 2) {
+            RouteQuery query{};
+            if (!parse_field(fields[0], query.source) || !parse_field(fields[1], query.target)) {
+                throw item_error(item, "node ids must be non-negative integers");
+            }
+            sink(query);
+        } else if (count == 3) {
+            CongestionUpdate update{};
+            if (!parse_field(fields[0], update.edge_start) || !parse_field(fields[1], update.edge_end) ||
+                !parse_field(fields[2], update.factor)) {
+                throw item_error(item, "update rows are edge_start,edge_end,factor");
+            }
+            sink(update);
+        } else {
+            throw item_error(item, "expected source,target or edge_start,edge_end,factor");
+        }
+        ++item;
+    }
+}
+
+void read_binary(std::istream& input, const std::function<void(const QueryStreamItem&)>& sink) {
+    constexpr std::size_t pair_bytes = 2 * sizeof(node_id);
+    std::vector<char> buffer(8192 * pair_bytes);
+    std::size_t item = 0;
+    while (input) {
+        input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const auto bytes = static_cast<std::size_t>(input.gcount());
+        if (bytes % pair_bytes != 0) {
+            throw item_error(item + bytes / pair_bytes, "truncated pair at the end of the file");
+        }
+        for (std::size_t offset = 0; offset < bytes; offset += pair_bytes, ++item) {
+            RouteQuery query{};
+            std::memcpy(&query.source, buffer.data() + offset, sizeof(node_id));
+            std::memcpy(&query.target, buffer.data() + offset + sizeof(node_id), sizeof(node_id));
+            sink(query);
+        }
+    }
+}
+
+void append_number(std::string& out, auto value) {
+    std::array<char, 32> digits{};
+    const auto result = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+    out.append(digits.data(), result.ptr);
+}
+
+void write_csv_header(std::string& out, bool include_path) {
+    out += "source,target,status,reachable,travel_time,expanded_nodes";
+    out += include_path ? ",path\n" : "\n";
+}
+
+void write_csv_row(std::string& out, const RouteQuery& query, const RouteResponse& response, bool include_path) {
+    append_number(out, query.source);
+    out += ',';
+    append_number(out, query.target);
+    out += ',';
+    out += route_status_name(response.status);
+    out += response.result.reachable ? ",1," : ",0,";
+    if (response.result.reachable) {
+        append_number(out, response.result.total_travel_time);
+    }
+    out += ',';
+    append_number(out, response.expanded_nodes);
+    if (include_path) {
+        out += ',';
+        for (std::size_t i = 0; i < response.result.nodes.size(); ++i) {
+            if (i > 0) {
+                out += ' ';
+            }
+            append_number(out, response.result.nodes[i]);
+        }
+    }
+    out += '\n';
+}
+
+void write_ndjson_row(std::string& out, const RouteQuery& query, const RouteResponse& response, bool include_path) {
+    JsonWriter writer{out};
+    writer.begin_object()
+        .field("source", query.source)
+        .field("target", query.target)
+        .field("status", route_status_name(response.status))
+        .field("reachable", response.result.reachable);
+    writer.key("travel_time");
+    if (response.result.reachable) {
+        writer.value(response.result.total_travel_time);
+    } else {
+        writer.null();
+    }
+    writer.field("expanded_nodes", response.expanded_nodes);
+    if (include_path) {
+        writer.key("path").value(std::span<const node_id>{response.result.nodes});
+    }
+    writer.end_object();
+    out += '\n';
+}
+
+}  // namespace
+
+QueryFileFormat parse_query_file_format(std::string_view name) {
+    if (name == "json") {
+        return QueryFileFormat::json;
+    }
+    if (name == "csv") {
+        return QueryFileFormat::csv;
+    }
+    if (name == "bin") {
+        return QueryFileFormat::binary;
+    }
+    throw std::invalid_argument{"queries format must be 'json', 'csv' or 'bin'"};
+}
+
+QueryFileFormat query_file_format_for(std::string_view path) {
+    if (ends_with(path, ".json")) {
+        return QueryFileFormat::json;
+    }
+    if (ends_with(path, ".csv")) {
+        return QueryFileFormat::csv;
+    }
+    if (ends_with(path, ".bin")) {
+        return QueryFileFormat::binary;
+    }
+    throw std::invalid_argument{"cannot tell the queries format from the file name; pass it explicitly"};
+}
+
+RouteOutputFormat parse_route_output_format(std::string_view name) {
+    if (name == "csv") {
+        return RouteOutputFormat::csv;
+    }
+    if (name == "ndjson") {
+        return RouteOutputFormat::ndjson;
+    }
+    throw std::invalid_argument{"output format must be 'csv' or 'ndjson'"};
+}
+
+void read_query_stream(std::istream& input,
+                       QueryFileFormat format,
+                       const std::function<void(const QueryStreamItem&)>& sink) {
+    switch (format) {
+        case QueryFileFormat::json: {
+            QueryArrayReader reader{sink};
+            json::sax_parse(input, &reader);
+            return;
+        }
+        case QueryFileFormat::csv:
+            read_csv(input, sink);
+            return;
+        case QueryFileFormat::binary:
+            read_binary(input, sink);
+            return;
+    }
+}
+
+double QueryStreamSummary::routes_per_second() const noexcept {
+    return elapsed_ms > 0.0 ? static_cast<double>(routes) * 1000.0 / elapsed_ms : 0.0;
+}
+
+QueryStreamSummary run_query_stream(GeoRouteEngine& engine,
+                                    std::istream& input,
+                                    QueryFileFormat format,
+                                    std::ostream& output,
+                                    const QueryStreamOptions& options) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    const auto chunk_size = options.chunk_size > 0 ? options.chunk_size : 1;
+    QueryStreamSummary summary;
+
+    std::string buffer;
+    if (options.output_format == RouteOutputFormat::csv) {
+        write_csv_header(buffer, options.include_path);
+    }
+
+    // One chunk routes on the workers while the next one is read.
+    std::vector<RouteQuery> pending;
+    std::vector<RouteQuery> running;
+    std::future<std::vector<RouteResponse>> responses;
+    pending.reserve(chunk_size);
+    running.reserve(chunk_size);
+
+    const auto finish_running = [&] {
+        if (!responses.valid()) {
+            return;
+        }
+        const auto wait_start = Clock::now();
+        const auto results = responses.get();
+        summary.route_wait_ms += std::chrono::duration<double, std::milli>(Clock::now() - wait_start).count();
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto& response = results[i];
+            summary.unreachable += response.status == RouteStatus::complete && !response.result.reachable ? 1 : 0;
+            summary.budget_exceeded += response.status != RouteStatus::complete ? 1 : 0;
+            if (options.output_format == RouteOutputFormat::csv) {
+                write_csv_row(buffer, running[i], response, options.include_path);
+            } else {
+                write_ndjson_row(buffer, running[i], response, options.include_path);
+            }
+        }
+        output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+        running.clear();
+    };
+    const auto start_pending = [&] {
+        finish_running();
+        if (pending.empty()) {
+            return;
+        }
+        std::swap(pending, running);
+        ++summary.chunks;
+        responses = std::async(std::launch::async, [&engine, &running, &options] {
+            return engine.route_batch(running, options.budget);
+        });
+    };
+
+    std::size_t item = 0;
+    const auto node_count = engine.node_count();
+    try {
+        read_query_stream(input, format, [&](const QueryStreamItem& entry) {
+            if (const auto* query = std::get_if<RouteQuery>(&entry)) {
+                if (query->source >= node_count || query->target >= node_count) {
+                    throw std::out_of_range{"queries item " + std::to_string(item) + ": node id out of range"};
+                }
+                pending.push_back(*query);
+                ++summary.routes;
+                if (pending.size() == chunk_size) {
+                    start_pending();
+                }
+            } else {
+                const auto& update = std::get<CongestionUpdate>(entry);
+                start_pending();
+                finish_running();
+                try {
+                    engine.apply_congestion_update(update.edge_start, update.edge_end, update.factor);
+                } catch (const std::out_of_range& ex) {
+                    throw std::out_of_range{"queries item " + std::to_string(item) + ": " + ex.what()};
+                }
+                ++summary.updates;
+            }
+            ++item;
+        });
+        start_pending();
+        finish_running();
+    } catch (...) {
+        // Never leave a chunk routing against buffers about to be destroyed.
+        if (responses.valid()) {
+            responses.wait();
+        }
+        throw;
+    }
+    output.flush();
+    summary.elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return summary;
+}
+
+}  // namespace georoute
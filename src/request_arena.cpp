@@ -0,0 +1,70 @@
+#include "georoute/request_arena.hpp"
+
+#include <algorithm>
+
+namespace georoute {
+
+RequestArena::RequestArena(std::size_t capacity, std::size_t max_capacity)
+    : capacity_(capacity),
+      max_capacity_(std::max(capacity, max_capacity)),
+      buffer_(std::make_unique<std::byte[]>(capacity)) {
+    resource_.emplace(buffer_.get(), capacity_, &overflow_);
+}
+
+RequestArena::~RequestArena() = default;
+
+std::pmr::memory_resource* RequestArena::resource() noexcept {
+    return &*resource_;
+}
+
+void RequestArena::reset() {
+    resource_->release();
+    if (overflow_.bytes == 0) {
+        return;
+    }
+    // monotonic_buffer_resource grows its chunks geometrically, so the
+    // overflow total can exceed what the request needed; that only means a
+    // little headroom for the next one.
+    const auto grown = std::min(max_capacity_, capacity_ + overflow_.bytes);
+    overflow_.bytes = 0;
+    if (grown == capacity_) {
+        return;
+    }
+    capacity_ = grown;
+    resource_.reset();
+    buffer_ = std::make_unique<std::byte[]>(capacity_);
+    resource_.emplace(buffer_.get(), capacity_, &overflow_);
+}
+
+std::size_t RequestArena::capacity() const noexcept {
+    return capacity_;
+}
+
+std::size_t RequestArena::max_capacity() const noexcept {
+    return max_capacity_;
+}
+
+std::uint64_t RequestArena::overflow_allocations() const noexcept {
+    return overflow_.allocations;
+}
+
+RequestArena& RequestArena::local() {
+    thread_local RequestArena arena;
+    return arena;
+}
+
+void* RequestArena::Overflow::do_allocate(std::size_t bytes, std::size_t alignment) {
+    this->bytes += bytes;
+    ++allocations;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void RequestArena::Overflow::do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+}
+
+bool RequestArena::Overflow::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+}  // namespace georoute
@@ -0,0 +1,74 @@
+#include "georoute/response_json.hpp"
+
+#include <span>
+#include <stdexcept>
+
+namespace georoute {
+
+namespace {
+
+void write_path(JsonWriter& out, const RouteResponse& response, PathEncoding encoding) {
+    const std::span<const node_id> nodes{response.result.nodes};
+    switch (encoding) {
+        case PathEncoding::array:
+            out.field("path", nodes);
+            return;
+        case PathEncoding::varint:
+            out.key("path").string_from([nodes](std::string& text) { append_varint_path(text, nodes); });
+            break;
+        case PathEncoding::polyline:
+            if (!response.coordinates) {
+                throw std::invalid_argument{"path_encoding 'polyline' needs node coordinates in the graph"};
+            }
+            out.key("path").string_from([nodes, &response](std::string& text) {
+                append_polyline(text, nodes, *response.coordinates);
+            });
+            break;
+    }
+    out.field("path_encoding", path_encoding_name(encoding));
+}
+
+}  // namespace
+
+const char* route_status_name(RouteStatus status) noexcept {
+    switch (status) {
+        case RouteStatus::deadline_exceeded:
+            return "deadline_exceeded";
+        case RouteStatus::node_budget_exceeded:
+            return "node_budget_exceeded";
+        case RouteStatus::complete:
+            break;
+    }
+    return "complete";
+}
+
+void write_route_fields(JsonWriter& out,
+                        node_id source,
+                        node_id target,
+                        const RouteResponse& response,
+                        bool include_path,
+                        PathEncoding path_encoding) {
+    out.field("src", source)
+        .field("dst", target)
+        .field("distance", response.result.total_travel_time)
+        .field("eta_ms", static_cast<int>(response.result.total_travel_time * 1000));
+    if (include_path) {
+        write_path(out, response, path_encoding);
+    }
+    out.field("reachable", response.result.reachable).field("epoch", response.congestion_epoch);
+    write_route_stats(out, response);
+}
+
+void write_route_stats(JsonWriter& out, const RouteResponse& response) {
+    out.key("stats")
+        .begin_object()
+        .field("compute_us", response.compute_time_us)
+        .field("expanded_nodes", response.expanded_nodes)
+        .end_object();
+}
+
+void write_error(JsonWriter& out, std::string_view message) {
+    out.begin_object().field("error", message).end_object();
+}
+
+}  // namespace georoute
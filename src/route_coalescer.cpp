@@ -0,0 +1,142 @@
+#include "georoute/route_coalescer.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace georoute {
+
+namespace {
+
+struct RouteFlightKeyHash {
+    std::size_t operator()(const RouteFlightKey& key) const noexcept {
+        auto hash = std::hash<const void*>{}(key.graph);
+        const auto mix = [&hash](std::uint64_t value) {
+            hash ^= std::hash<std::uint64_t>{}(value) + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+        };
+        mix(key.epoch);
+        mix((static_cast<std::uint64_t>(key.source) << 32) | key.target);
+        mix(key.max_settled_nodes);
+        return hash;
+    }
+};
+
+}  // namespace
+
+struct RouteCoalescer::Flight {
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    bool done{false};
+    // Set by finish() if anyone joined and the result can be shared.
+    std::shared_ptr<const RouteResponse> result;
+    // Guarded by the shard mutex; final once the flight leaves the map.
+    std::size_t followers{0};
+};
+
+struct alignas(64) RouteCoalescer::Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<RouteFlightKey, std::shared_ptr<Flight>, RouteFlightKeyHash> flights;
+};
+
+RouteCoalescer::RouteCoalescer() : shards_(std::make_unique<Shard[]>(shard_count)) {}
+
+RouteCoalescer::~RouteCoalescer() = default;
+
+RouteCoalescer::Shard& RouteCoalescer::shard_for(const RouteFlightKey& key) const noexcept {
+    return shards_[RouteFlightKeyHash{}(key) % shard_count];
+}
+
+RouteCoalescer::Ticket RouteCoalescer::join(const RouteFlightKey& key) {
+    auto& shard = shard_for(key);
+    std::lock_guard lock{shard.mutex};
+    auto [it, inserted] = shard.flights.try_emplace(key);
+    if (inserted) {
+        it->second = std::make_shared<Flight>();
+        return Ticket{it->second, true};
+    }
+    ++it->second->followers;
+    return Ticket{it->second, false};
+}
+
+void RouteCoalescer::finish(const RouteFlightKey& key,
+                            const std::shared_ptr<Flight>& flight,
+                            const RouteResponse* response) {
+    std::size_t followers = 0;
+    {
+        auto& shard = shard_for(key);
+        std::lock_guard lock{shard.mutex};
+        shard.flights.erase(key);
+        followers = flight->followers;
+    }
+    if (followers == 0) {
+        return;
+    }
+
+    std::shared_ptr<const RouteResponse> shared;
+    if (response != nullptr && response->status == RouteStatus::complete) {
+        // Copied onto the heap: the leader's path may live in its request arena.
+        auto copy = std::make_shared<RouteResponse>();
+        copy->result.nodes.assign(response->result.nodes.begin(), response->result.nodes.end());
+        copy->result.total_travel_time = response->result.total_travel_time;
+        copy->result.reachable = response->result.reachable;
+        copy->expanded_nodes = response->expanded_nodes;
+        copy->compute_time_us = response->compute_time_us;
+        copy->congestion_epoch = response->congestion_epoch;
+        copy->coordinates = response->coordinates;
+        shared = std::move(copy);
+    }
+    {
+        std::lock_guard lock{flight->mutex};
+        flight->result = std::move(shared);
+        flight->done = true;
+    }
+    flight->done_cv.notify_all();
+}
+
+std::shared_ptr<const RouteResponse> RouteCoalescer::wait(Flight& flight,
+                                                          std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock lock{flight.mutex};
+    if (deadline == std::chrono::steady_clock::time_point::max()) {
+        flight.done_cv.wait(lock, [&flight] { return flight.done; });
+    } else if (!flight.done_cv.wait_until(lock, deadline, [&flight] { return flight.done; })) {
+        return nullptr;
+    }
+    return flight.result;
+}
+
+RouteResponse RouteCoalescer::copy_shared(const RouteResponse& shared, std::pmr::memory_resource* resource) {
+    RouteResponse response{RouteResult{std::pmr::vector<node_id>{shared.result.nodes, resource},
+                                       shared.result.total_travel_time,
+                                       shared.result.reachable},
+                           shared.status,
+                           shared.expanded_nodes,
+                           shared.compute_time_us,
+                           shared.congestion_epoch,
+                           shared.coordinates};
+    response.coalesced = true;
+    return response;
+}
+
+std::size_t RouteCoalescer::in_flight() const {
+    std::size_t flights = 0;
+    for (std::size_t s = 0; s < shard_count; ++s) {
+        std::lock_guard lock{shards_[s].mutex};
+        flights += shards_[s].flights.size();
+    }
+    return flights;
+}
+
+std::size_t RouteCoalescer::waiting() const {
+    std::size_t followers = 0;
+    for (std::size_t s = 0; s < shard_count; ++s) {
+        std::lock_guard lock{shards_[s].mutex};
+        for (const auto& [key, flight] : shards_[s].flights) {
+            followers += flight->followers;
+        }
+    }
+    return followers;
+}
+
+}  // namespace georoute
@@ -0,0 +1,210 @@
+#include "georoute/route_request.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+namespace georoute {
+
+namespace {
+
+using json = nlohmann::json;
+
+// A request limit only applies if it is tighter than the server default.
+template <typename Limit>
+Limit tighter_limit(Limit server_default, std::optional<Limit> requested) {
+    if (!requested || *requested <= Limit{0}) {
+        return server_default;
+    }
+    return server_default <= Limit{0} ? *requested : std::min(server_default, *requested);
+}
+
+// Collects the top-level integer fields of a route request, plus the
+// path_encoding string. Values inside nested objects or arrays are ignored.
+class RouteRequestReader {
+public:
+    explicit RouteRequestReader(RouteRequest& request) : request_(request) {}
+
+    bool null() { return scalar(); }
+    bool boolean(bool) { return scalar(); }
+    bool number_integer(json::number_integer_t value) {
+        if (value >= 0) {
+            return number_unsigned(static_cast<json::number_unsigned_t>(value));
+        }
+        if (depth_ != 1 || field_ == Field::other) {
+            return true;
+        }
+        if (field_ == Field::path_encoding) {
+            return path_encoding_error();
+        }
+        // A negative timeout, like a zero one, keeps the server default.
+        if (field_ == Field::timeout_ms) {
+            request_.timeout_ms = value;
+            return true;
+        }
+        return field_error();
+    }
+    bool number_unsigned(json::number_unsigned_t value) {
+        if (depth_ != 1) {
+            return true;
+        }
+        switch (field_) {
+            case Field::source:
+                has_source_ = true;
+                return store(request_.source, value);
+            case Field::target:
+                has_target_ = true;
+                return store(request_.target, value);
+            case Field::epoch:
+                request_.epoch = value;
+                return true;
+            case Field::timeout_ms:
+                if (value > static_cast<json::number_unsigned_t>(std::numeric_limits<std::int64_t>::max())) {
+                    return field_error();
+                }
+                request_.timeout_ms = static_cast<std::int64_t>(value);
+                return true;
+            case Field::max_settled_nodes: {
+                std::uint32_t nodes = 0;
+                if (!store(nodes, value)) {
+                    return false;
+                }
+                request_.max_settled_nodes = nodes;
+                return true;
+            }
+            case Field::path_encoding:
+                return path_encoding_error();
+            case Field::other:
+                return true;
+        }
+        return true;
+    }
+    bool number_float(json::number_float_t, const json::string_t&) { return scalar(); }
+    bool string(json::string_t& value) {
+        if (depth_ == 1 && field_ == Field::path_encoding) {
+            request_.path_encoding = parse_path_encoding(value);
+            return true;
+        }
+        return scalar();
+    }
+    bool binary(json::binary_t&) { return scalar(); }
+    bool start_object(std::size_t) {
+        if (depth_ == 1 && field_ != Field::other) {
+            return field_error();
+        }
+        ++depth_;
+        return true;
+    }
+    bool end_object() {
+        --depth_;
+        return true;
+    }
+    bool start_array(std::size_t) {
+        if (depth_ == 0 || (depth_ == 1 && field_ != Field::other)) {
+            return field_error();
+        }
+        ++depth_;
+        return true;
+    }
+    bool end_array() {
+        --depth_;
+        return true;
+    }
+    bool key(json::string_t& name) {
+        if (depth_ == 1) {
+            field_ = field_of(name);
+        }
+        return true;
+    }
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) {
+        throw std::invalid_argument{"invalid JSON payload"};
+    }
+
+    [[nodiscard]] bool complete() const noexcept { return has_source_ && has_target_; }
+
+private:
+    enum class Field { source, target, epoch, timeout_ms, max_settled_nodes, path_encoding, other };
+
+    static Field field_of(const json::string_t& name) {
+        if (name == "source") {
+            return Field::source;
+        }
+        if (name == "target") {
+            return Field::target;
+        }
+        if (name == "epoch") {
+            return Field::epoch;
+        }
+        if (name == "timeout_ms") {
+            return Field::timeout_ms;
+        }
+        if (name == "max_settled_nodes") {
+            return Field::max_settled_nodes;
+        }
+        if (name == "path_encoding") {
+            return Field::path_encoding;
+        }
+        return Field::other;
+    }
+
+    // Any non-integer value: fine for unknown fields, an error for known ones.
+    bool scalar() {
+        if (depth_ == 0) {
+            throw std::invalid_argument{"invalid JSON payload"};
+        }
+        if (depth_ == 1 && field_ == Field::path_encoding) {
+            return path_encoding_error();
+        }
+        return depth_ != 1 || field_ == Field::other || field_error();
+    }
+
+    template <typename T>
+    bool store(T& out, json::number_unsigned_t value) {
+        if (value > std::numeric_limits<T>::max()) {
+            return field_error();
+        }
+        out = static_cast<T>(value);
+        return true;
+    }
+
+    static bool field_error() {
+        throw std::invalid_argument{"route request fields must be non-negative integers"};
+    }
+
+    static bool path_encoding_error() {
+        throw std::invalid_argument{"path_encoding must be a string"};
+    }
+
+    RouteRequest& request_;
+    Field field_{Field::other};
+    int depth_{0};
+    bool has_source_{false};
+    bool has_target_{false};
+};
+
+}  // namespace
+
+RouteRequest parse_route_request(std::string_view body) {
+    RouteRequest request;
+    RouteRequestReader reader{request};
+    json::sax_parse(body.begin(), body.end(), &reader);
+    if (!reader.complete()) {
+        throw std::invalid_argument{"missing 'source' or 'target'"};
+    }
+    return request;
+}
+
+SearchBudget make_request_budget(std::chrono::milliseconds server_timeout,
+                                 std::uint32_t server_max_settled_nodes,
+                                 std::optional<std::int64_t> timeout_ms,
+                                 std::optional<std::uint32_t> max_settled_nodes) {
+    const auto timeout = tighter_limit(server_timeout,
+                                       timeout_ms ? std::optional{std::chrono::milliseconds{*timeout_ms}}
+                                                  : std::nullopt);
+    return SearchBudget::within(timeout, tighter_limit(server_max_settled_nodes, max_settled_nodes));
+}
+
+}  // namespace georoute
@@ -1,36 +1,261 @@
 #include "georoute/router.hpp"
 
-#include <shared_mutex>
+#include <algorithm>
+#include <fstream>
+#include <mutex>
 #include <stdexcept>
+#include <string>
 #include <utility>
 
 #include <nlohmann/json.hpp>
 
+#include "georoute/dimacs.hpp"
+#include "georoute/graph_snapshot.hpp"
+
 namespace georoute {
 
-Router::Router(Graph graph, SegmentTree segment_tree)
-    : graph_(std::move(graph)), congestion_tree_(std::move(segment_tree)) {}
+namespace {
+
+#if defined(__cpp_lib_atomic_shared_ptr)
+using SnapshotSlot = std::atomic<std::shared_ptr<const CongestionSnapshot>>;
+
+std::shared_ptr<const CongestionSnapshot> load_snapshot(const SnapshotSlot& slot) {
+    return slot.load(std::memory_order_acquire);
+}
+
+void store_snapshot(SnapshotSlot& slot, std::shared_ptr<const CongestionSnapshot> snapshot) {
+    slot.store(std::move(snapshot), std::memory_order_release);
+}
+#else
+using SnapshotSlot = std::shared_ptr<const CongestionSnapshot>;
+
+std::shared_ptr<const CongestionSnapshot> load_snapshot(const SnapshotSlot& slot) {
+    return std::atomic_load_explicit(&slot, std::memory_order_acquire);
+}
+
+void store_snapshot(SnapshotSlot& slot, std::shared_ptr<const CongestionSnapshot> snapshot) {
+    std::atomic_store_explicit(&slot, std::move(snapshot), std::memory_order_release);
+}
+#endif
+
+std::shared_ptr<const CongestionSnapshot> initial_snapshot(const Graph& graph, CongestionIndex& congestion) {
+    if (congestion.size() != graph.edge_count()) {
+        throw std::invalid_argument{"Router congestion index size does not match edge count"};
+    }
+    congestion.flush_overlay();
+    auto costs = graph.base_travel_times();
+    const auto factors = congestion.values();
+    for (std::size_t i = 0; i < costs.size(); ++i) {
+        costs[i] *= factors[i];
+    }
+    return std::make_shared<const CongestionSnapshot>(0, costs);
+}
+
+}  // namespace
+
+Router::Router(Graph graph, CongestionIndex congestion)
+    : graph_(std::move(graph)), congestion_(std::move(congestion)), current_(initial_snapshot(graph_, congestion_)) {
+    history_.push_back(load_snapshot(current_));
+}
+
+Router::Router(Router&& other) noexcept
+    : graph_(std::move(other.graph_)),
+      congestion_(std::move(other.congestion_)),
+      current_(load_snapshot(other.current_)),
+      history_(std::move(other.history_)),
+      history_limit_(other.history_limit_) {}
 
 Router::~Router() = default;
 
-void Router::apply_congestion_update(std::size_t edge_start, std::size_t edge_end, float factor) {
-    std::unique_lock lock{mutex_};
+std::uint64_t Router::apply_congestion_update(std::size_t edge_start, std::size_t edge_end, float factor) {
     if (edge_start > edge_end) {
         throw std::invalid_argument{"Router::apply_congestion_update invalid range"};
     }
-    if (edge_end >= congestion_tree_.size()) {
+    if (edge_end >= congestion_.size()) {
         throw std::out_of_range{"Router::apply_congestion_update range exceeds edge count"};
     }
-    congestion_tree_.range_multiply(edge_start, edge_end, factor);
+    if (!valid_congestion_factor(factor)) {
+        throw std::invalid_argument{"Router::apply_congestion_update factor must be finite and non-negative"};
+    }
+
+    std::lock_guard lock{writer_mutex_};
+    auto next = load_snapshot(current_)->next();
+    congestion_.range_multiply(edge_start, edge_end, factor);
+    next->multiply(edge_start, edge_end, factor);
+    const auto epoch = next->epoch();
+    publish(std::move(next));
+    return epoch;
+}
+
+CongestionPublish Router::apply_congestion_updates(std::span<const CongestionUpdate> updates) {
+    for (const auto& update : updates) {
+        if (update.edge_start > update.edge_end) {
+            throw std::invalid_argument{"Router::apply_congestion_updates invalid range"};
+        }
+        if (update.edge_end >= congestion_.size()) {
+            throw std::out_of_range{"Router::apply_congestion_updates range exceeds edge count"};
+        }
+        if (!valid_congestion_factor(update.factor)) {
+            throw std::invalid_argument{"Router::apply_congestion_updates factor must be finite and non-negative"};
+        }
+    }
+
+    const auto merged = merge_congestion_updates(updates);
+
+    std::lock_guard lock{writer_mutex_};
+    auto next = load_snapshot(current_)->next();
+    congestion_.range_multiply_batch(merged);
+    for (const auto& range : merged) {
+        next->multiply(range.edge_start, range.edge_end, range.factor);
+    }
+    const auto epoch = next->epoch();
+    publish(std::move(next));
+    return CongestionPublish{merged.size(), epoch};
+}
+
+CongestionPublish Router::apply_edge_updates(std::span<const EdgeFactorUpdate> updates) {
+    for (const auto& update : updates) {
+        if (update.edge >= congestion_.size()) {
+            throw std::out_of_range{"Router::apply_edge_updates edge id exceeds edge count"};
+        }
+        if (!valid_congestion_factor(update.factor)) {
+            throw std::invalid_argument{"Router::apply_edge_updates factor must be finite and non-negative"};
+        }
+    }
+
+    std::lock_guard lock{writer_mutex_};
+    auto next = load_snapshot(current_)->next();
+    for (const auto& update : updates) {
+        next->multiply(update.edge, update.edge, update.factor);
+    }
+    const auto flushed = congestion_.point_multiply(updates);
+    const auto epoch = next->epoch();
+    publish(std::move(next));
+    return CongestionPublish{flushed, epoch};
+}
+
+float Router::congestion_factor(edge_id edge) const {
+    std::lock_guard lock{writer_mutex_};
+    if (edge >= congestion_.size()) {
+        throw std::out_of_range{"Router::congestion_factor edge id exceeds edge count"};
+    }
+    return congestion_.point_query(edge);
+}
+
+std::vector<float> Router::congestion_factors() const {
+    std::lock_guard lock{writer_mutex_};
+    return congestion_.values();
 }
 
 RouteComputation Router::compute_route(node_id source, node_id target) const {
-    std::shared_lock lock{mutex_};
-    DijkstraRouter router{graph_, congestion_tree_};
-    return router.shortest_path(source, target);
+    SearchScratch scratch;
+    return compute_route(source, target, scratch);
 }
 
-Router Router::from_json(const nlohmann::json& config) {
+RouteComputation Router::compute_route(node_id source,
+                                       node_id target,
+                                       SearchScratch& scratch,
+                                       const SearchBudget& budget,
+                                       std::pmr::memory_resource* resource) const {
+    const auto pinned = load_snapshot(current_);
+    return compute_route_on(*pinned, source, target, scratch, budget, resource);
+}
+
+RouteComputation Router::compute_route_on(const CongestionSnapshot& snapshot,
+                                          node_id source,
+                                          node_id target,
+                                          SearchScratch& scratch,
+                                          const SearchBudget& budget,
+                                          std::pmr::memory_resource* resource) const {
+    DijkstraRouter router{graph_, snapshot};
+    auto computation = router.shortest_path(source, target, scratch, budget, resource);
+    computation.congestion_epoch = snapshot.epoch();
+    return computation;
+}
+
+RouteComputation Router::compute_route_at(std::uint64_t epoch, node_id source, node_id target) const {
+    SearchScratch scratch;
+    return compute_route_at(epoch, source, target, scratch);
+}
+
+RouteComputation Router::compute_route_at(std::uint64_t epoch,
+                                          node_id source,
+                                          node_id target,
+                                          SearchScratch& scratch,
+                                          const SearchBudget& budget,
+                                          std::pmr::memory_resource* resource) const {
+    const auto pinned = retained_snapshot(epoch);
+    DijkstraRouter router{graph_, *pinned};
+    auto computation = router.shortest_path(source, target, scratch, budget, resource);
+    computation.congestion_epoch = pinned->epoch();
+    return computation;
+}
+
+std::shared_ptr<const CongestionSnapshot> Router::retained_snapshot(std::uint64_t epoch) const {
+    std::lock_guard lock{history_mutex_};
+    const auto it = std::find_if(history_.begin(), history_.end(),
+                                 [epoch](const auto& snapshot) { return snapshot->epoch() == epoch; });
+    if (it == history_.end()) {
+        throw std::out_of_range{"Router::compute_route_at epoch " + std::to_string(epoch) + " is not retained"};
+    }
+    return *it;
+}
+
+std::uint64_t Router::current_epoch() const {
+    return load_snapshot(current_)->epoch();
+}
+
+std::size_t Router::node_count() const noexcept {
+    return graph_.node_count();
+}
+
+std::size_t Router::edge_count() const noexcept {
+    return graph_.edge_count();
+}
+
+std::shared_ptr<const CongestionSnapshot> Router::snapshot() const {
+    return load_snapshot(current_);
+}
+
+const Graph& Router::graph() const noexcept {
+    return graph_;
+}
+
+std::size_t Router::memory_bytes() const noexcept {
+    return graph_.memory_bytes() + graph_.edge_count() * sizeof(float);
+}
+
+void Router::set_snapshot_history(std::size_t epochs) {
+    std::lock_guard lock{history_mutex_};
+    history_limit_ = std::max<std::size_t>(1, epochs);
+    while (history_.size() > history_limit_) {
+        history_.pop_front();
+    }
+}
+
+RouterSettings Router::settings() const {
+    RouterSettings settings;
+    {
+        std::lock_guard lock{writer_mutex_};
+        settings.congestion_index = congestion_.kind();
+    }
+    std::lock_guard lock{history_mutex_};
+    settings.snapshot_history = history_limit_;
+    return settings;
+}
+
+void Router::publish(std::shared_ptr<const CongestionSnapshot> next) {
+    {
+        std::lock_guard lock{history_mutex_};
+        history_.push_back(next);
+        while (history_.size() > history_limit_) {
+            history_.pop_front();
+        }
+    }
+    store_snapshot(current_, std::move(next));
+}
+
+Router Router::from_json(const nlohmann::json& config, const RouterSettings& defaults) {
     if (!config.contains("nodes")) {
         throw std::invalid_argument{"Router::from_json missing 'nodes' field"};
     }
@@ -51,9 +276,45 @@ Router Router::from_json(const nlohmann::json& config) {
         const auto base_time = edge.at("base_travel_time").get<float>();
         graph.add_edge(from, to, base_time);
     }
+    if (config.contains("coordinates")) {
+        const auto& points = config.at("coordinates");
+        if (!points.is_array()) {
+            throw std::invalid_argument{"Router::from_json 'coordinates' must be an array"};
+        }
+        std::vector<Coordinate> coordinates;
+        coordinates.reserve(points.size());
+        for (const auto& point : points) {
+            if (!point.is_array() || point.size() != 2) {
+                throw std::invalid_argument{"Router::from_json coordinate must be [lat, lon]"};
+            }
+            coordinates.push_back(Coordinate{point[0].get<double>(), point[1].get<double>()});
+        }
+        graph.set_coordinates(std::move(coordinates));
+    }
+
+    const auto kind = config.value("congestion_index", defaults.congestion_index);
+    auto congestion = CongestionIndex::make(kind, graph.edge_count());
+    Router router{std::move(graph), std::move(congestion)};
+    router.set_snapshot_history(config.value("snapshot_history", defaults.snapshot_history));
+    return router;
+}
 
-    SegmentTree tree{graph.edge_count()};
-    return Router{std::move(graph), std::move(tree)};
+Router Router::from_file(const std::string& path, const RouterSettings& defaults) {
+    std::ifstream input{path};
+    if (!input) {
+        throw std::runtime_error{"Router::from_file failed to open graph file: " + path};
+    }
+    const bool snapshot = is_graph_snapshot(path);
+    const bool dimacs = path.size() > 3 && path.compare(path.size() - 3, 3, ".gr") == 0;
+    if (!snapshot && !dimacs) {
+        return from_json(nlohmann::json::parse(input), defaults);
+    }
+    auto graph =
+        snapshot ? load_graph_snapshot(path) : read_dimacs(path, DimacsImportOptions{dimacs_coordinates_path(path)});
+    auto congestion = CongestionIndex::make(defaults.congestion_index, graph.edge_count());
+    Router router{std::move(graph), std::move(congestion)};
+    router.set_snapshot_history(defaults.snapshot_history);
+    return router;
 }
 
 }  // namespace georoute
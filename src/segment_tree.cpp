@@ -21,6 +21,27 @@ void SegmentTree::range_multiply(std::size_t l, std::size_t r, float factor) {
     range_multiply_impl(1, 0, n_ - 1, l, r, factor);
 }
 
+void SegmentTree::range_multiply_batch(std::span<const CongestionUpdate> ranges) {
+    if (ranges.empty()) {
+        return;
+    }
+    if (n_ == 0) {
+        throw std::runtime_error{"SegmentTree::range_multiply_batch called on empty tree"};
+    }
+    for (std::size_t i = 0; i < ranges.size(); ++i) {
+        if (ranges[i].edge_start > ranges[i].edge_end) {
+            throw std::invalid_argument{"SegmentTree::range_multiply_batch invalid range"};
+        }
+        if (ranges[i].edge_end >= n_) {
+            throw std::out_of_range{"SegmentTree::range_multiply_batch index out of range"};
+        }
+        if (i > 0 && ranges[i].edge_start <= ranges[i - 1].edge_end) {
+            throw std::invalid_argument{"SegmentTree::range_multiply_batch ranges must be sorted and disjoint"};
+        }
+    }
+    range_multiply_batch_impl(1, 0, n_ - 1, ranges);
+}
+
 float SegmentTree::point_query(std::size_t idx) const {
     if (n_ == 0 || idx >= n_) {
         throw std::out_of_range{"SegmentTree::point_query index out of range"};
@@ -28,6 +49,15 @@ float SegmentTree::point_query(std::size_t idx) const {
     return point_query_impl(1, 0, n_ - 1, idx, 1.0F);
 }
 
+std::vector<float> SegmentTree::values() const {
+    std::vector<float> out;
+    out.reserve(n_);
+    if (n_ > 0) {
+        values_impl(1, 0, n_ - 1, 1.0F, out);
+    }
+    return out;
+}
+
 std::size_t SegmentTree::size() const noexcept {
     return n_;
 }
@@ -59,6 +89,44 @@ void SegmentTree::range_multiply_impl(std::size_t node,
     tree_[node] = tree_[left] * tree_[right];
 }
 
+void SegmentTree::range_multiply_batch_impl(std::size_t node,
+                                            std::size_t node_l,
+                                            std::size_t node_r,
+                                            std::span<const CongestionUpdate> ranges) {
+    // Every range here overlaps [node_l, node_r]; being disjoint, a range that
+    // covers the whole node is the only one.
+    if (ranges.size() == 1 && ranges.front().edge_start <= node_l && node_r <= ranges.front().edge_end) {
+        apply(node, ranges.front().factor, node_l, node_r);
+        return;
+    }
+
+    push(node, node_l, node_r);
+
+    const auto mid = node_l + (node_r - node_l) / 2;
+    const auto left = static_cast<std::size_t>(node * 2);
+    const auto right = left + 1;
+
+    // Ranges starting at or before mid reach the left child; ranges ending
+    // after mid reach the right child. At most one range straddles mid.
+    std::size_t left_count = 0;
+    while (left_count < ranges.size() && ranges[left_count].edge_start <= mid) {
+        ++left_count;
+    }
+    std::size_t right_begin = left_count;
+    if (left_count > 0 && ranges[left_count - 1].edge_end > mid) {
+        right_begin = left_count - 1;
+    }
+
+    if (left_count > 0) {
+        range_multiply_batch_impl(left, node_l, mid, ranges.first(left_count));
+    }
+    if (right_begin < ranges.size()) {
+        range_multiply_batch_impl(right, mid + 1, node_r, ranges.subspan(right_begin));
+    }
+
+    tree_[node] = tree_[left] * tree_[right];
+}
+
 float SegmentTree::point_query_impl(std::size_t node,
                                     std::size_t node_l,
                                     std::size_t node_r,
@@ -81,6 +149,24 @@ float SegmentTree::point_query_impl(std::size_t node,
     return point_query_impl(right, mid + 1, node_r, idx, accumulated_factor);
 }
 
+void SegmentTree::values_impl(std::size_t node,
+                              std::size_t node_l,
+                              std::size_t node_r,
+                              float accumulated_factor,
+                              std::vector<float>& out) const {
+    accumulated_factor *= lazy_[node];
+
+    if (node_l == node_r) {
+        out.push_back(tree_[node] * accumulated_factor);
+        return;
+    }
+
+    const auto mid = node_l + (node_r - node_l) / 2;
+    const auto left = static_cast<std::size_t>(node * 2);
+    values_impl(left, node_l, mid, accumulated_factor, out);
+    values_impl(left + 1, mid + 1, node_r, accumulated_factor, out);
+}
+
 void SegmentTree::apply(std::size_t node, float factor, std::size_t node_l, std::size_t node_r) {
     tree_[node] *= factor;
     if (node_l != node_r) {
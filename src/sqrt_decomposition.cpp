@@ -0,0 +1,116 @@
+#include "georoute/sqrt_decomposition.hpp"
+
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace georoute {
+
+namespace {
+
+// Smallest power of two >= sqrt(n), never below one AVX2 register of floats.
+std::size_t choose_block_shift(std::size_t n) {
+    std::size_t shift = 3;
+    while ((std::size_t{1} << (2 * shift)) < n) {
+        ++shift;
+    }
+    return shift;
+}
+
+void multiply_span(float* values, std::size_t count, float factor) {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    const __m256 scale = _mm256_set1_ps(factor);
+    for (; i + 8 <= count; i += 8) {
+        const __m256 v = _mm256_loadu_ps(values + i);
+        _mm256_storeu_ps(values + i, _mm256_mul_ps(v, scale));
+    }
+#endif
+    for (; i < count; ++i) {
+        values[i] *= factor;
+    }
+}
+
+}  // namespace
+
+SqrtDecomposition::SqrtDecomposition(std::size_t size)
+    : n_(size),
+      block_shift_(choose_block_shift(size)),
+      values_(size, 1.0F),
+      block_factors_(size ? ((size - 1) >> block_shift_) + 1 : 0, 1.0F) {}
+
+void SqrtDecomposition::range_multiply(std::size_t l, std::size_t r, float factor) {
+    if (n_ == 0) {
+        throw std::runtime_error{"SqrtDecomposition::range_multiply called on empty structure"};
+    }
+    if (l > r) {
+        throw std::invalid_argument{"SqrtDecomposition::range_multiply invalid range"};
+    }
+    if (r >= n_) {
+        throw std::out_of_range{"SqrtDecomposition::range_multiply index out of range"};
+    }
+
+    const auto first_block = l >> block_shift_;
+    const auto last_block = r >> block_shift_;
+    if (first_block == last_block) {
+        multiply_span(values_.data() + l, r - l + 1, factor);
+        return;
+    }
+
+    // Partial blocks are multiplied element-wise; blocks fully inside the range
+    // (including aligned edges) only touch their shared factor.
+    auto full_begin = first_block;
+    if ((l & (block_size() - 1)) != 0) {
+        const auto block_end = (first_block + 1) << block_shift_;
+        multiply_span(values_.data() + l, block_end - l, factor);
+        ++full_begin;
+    }
+    auto full_end = last_block + 1;
+    if (((r + 1) & (block_size() - 1)) != 0 && r + 1 != n_) {
+        const auto block_begin = last_block << block_shift_;
+        multiply_span(values_.data() + block_begin, r - block_begin + 1, factor);
+        --full_end;
+    }
+    multiply_span(block_factors_.data() + full_begin, full_end - full_begin, factor);
+}
+
+void SqrtDecomposition::range_multiply_batch(std::span<const CongestionUpdate> ranges) {
+    for (const auto& range : ranges) {
+        range_multiply(range.edge_start, range.edge_end, range.factor);
+    }
+}
+
+float SqrtDecomposition::point_query(std::size_t idx) const {
+    if (idx >= n_) {
+        throw std::out_of_range{"SqrtDecomposition::point_query index out of range"};
+    }
+    return values_[idx] * block_factors_[idx >> block_shift_];
+}
+
+std::vector<float> SqrtDecomposition::values() const {
+    std::vector<float> out(n_);
+    for (std::size_t i = 0; i < n_; ++i) {
+        out[i] = values_[i] * block_factors_[i >> block_shift_];
+    }
+    return out;
+}
+
+std::size_t SqrtDecomposition::size() const noexcept {
+    return n_;
+}
+
+std::size_t SqrtDecomposition::block_size() const noexcept {
+    return std::size_t{1} << block_shift_;
+}
+
+bool SqrtDecomposition::uses_avx2() noexcept {
+#if defined(__AVX2__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+}  // namespace georoute
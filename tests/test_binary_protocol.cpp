@@ -0,0 +1,187 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "georoute/binary_client.hpp"
+#include "georoute/binary_protocol.hpp"
+#include "georoute/binary_server.hpp"
+#include "georoute/congestion_writer.hpp"
+#include "georoute/engine.hpp"
+
+#include "test_graphs.hpp"
+
+namespace {
+
+georoute::BinaryServerOptions loopback_options() {
+    georoute::BinaryServerOptions options;
+    options.host = "127.0.0.1";
+    options.max_batch_size = 8;
+    return options;
+}
+
+}  // namespace
+
+TEST_CASE("Wire frames round-trip through the writer and decoders", "[binary_protocol]") {
+    std::vector<std::byte> frame;
+    georoute::WireWriter out{frame};
+    const auto start = out.begin_frame(georoute::WireType::route, georoute::wire_flag_include_path, 42);
+    out.write(std::uint32_t{3});
+    out.write(std::uint32_t{7});
+    out.write(std::uint32_t{50});
+    out.write(std::uint32_t{0});
+    out.end_frame(start);
+    REQUIRE(frame.size() == georoute::wire_header_size + 16);
+
+    const auto header = georoute::decode_wire_header(frame);
+    REQUIRE(header.type == georoute::WireType::route);
+    REQUIRE(header.flags == georoute::wire_flag_include_path);
+    REQUIRE(header.request_id == 42);
+    REQUIRE(header.frame_size() == frame.size());
+    REQUIRE(header.payload_size() == 16);
+
+    const auto payload = std::span<const std::byte>{frame}.subspan(georoute::wire_header_size);
+    const auto request = georoute::decode_route_request(payload);
+    REQUIRE(request.source == 3);
+    REQUIRE(request.target == 7);
+    REQUIRE(request.limits.timeout_ms == 50);
+    REQUIRE(request.limits.max_settled_nodes == 0);
+
+    REQUIRE_THROWS_AS(georoute::decode_route_request(payload.first(12)), std::invalid_argument);
+    std::vector<std::byte> padded{payload.begin(), payload.end()};
+    padded.push_back(std::byte{0});
+    REQUIRE_THROWS_AS(georoute::decode_route_request(padded), std::invalid_argument);
+}
+
+TEST_CASE("Wire decoders reject impossible lengths and counts", "[binary_protocol]") {
+    std::vector<std::byte> frame;
+    georoute::WireWriter out{frame};
+    out.write(std::uint32_t{4});  // shorter than the rest of the header
+    out.write(std::uint32_t{1});
+    out.write(std::uint32_t{0});
+    REQUIRE_THROWS_AS(georoute::decode_wire_header(frame), std::invalid_argument);
+
+    frame.clear();
+    out.write(static_cast<std::uint32_t>(georoute::wire_max_frame_size));
+    out.write(std::uint32_t{1});
+    out.write(std::uint32_t{0});
+    REQUIRE_THROWS_AS(georoute::decode_wire_header(frame), std::invalid_argument);
+
+    // A batch claiming far more pairs than it carries.
+    std::vector<std::byte> batch;
+    georoute::WireWriter batch_out{batch};
+    batch_out.write(std::uint32_t{0});
+    batch_out.write(std::uint32_t{0});
+    batch_out.write(std::uint32_t{0xFFFFFFFF});
+    batch_out.write(std::uint32_t{1});
+    batch_out.write(std::uint32_t{2});
+    REQUIRE_THROWS_AS(georoute::decode_batch_request(batch), std::invalid_argument);
+}
+
+TEST_CASE("BinaryProtocolServer answers routes, batches and matrices", "[binary_protocol]") {
+    // Node 4 is unreachable.
+    auto engine = build_sample_engine(1);
+    georoute::CongestionWriter writer{engine, georoute::CongestionWriterOptions{std::chrono::microseconds{0}}};
+    georoute::BinaryProtocolServer server{engine, writer, loopback_options()};
+    georoute::BinaryClient client{"127.0.0.1", server.port()};
+
+    const auto route = client.route(0, 3);
+    REQUIRE(route.status == georoute::RouteStatus::complete);
+    REQUIRE(route.reachable);
+    REQUIRE(route.travel_time == Catch::Approx(2.0F));
+    REQUIRE(route.path == std::vector<georoute::node_id>{0, 1, 3});
+
+    const auto without_path = client.route(0, 3, georoute::WireRouteOptions{false});
+    REQUIRE(without_path.reachable);
+    REQUIRE(without_path.path.empty());
+
+    const std::vector<georoute::RouteQuery> queries{{0, 3}, {0, 4}, {2, 3}};
+    const auto routes = client.route_batch(queries);
+    REQUIRE(routes.size() == 3);
+    REQUIRE(routes[0].travel_time == Catch::Approx(2.0F));
+    REQUIRE_FALSE(routes[1].reachable);
+    REQUIRE(routes[2].path == std::vector<georoute::node_id>{2, 3});
+
+    const std::vector<georoute::node_id> sources{0, 2};
+    const std::vector<georoute::node_id> targets{3, 4};
+    const auto matrix = client.matrix(sources, targets);
+    REQUIRE(matrix.source_count == 2);
+    REQUIRE(matrix.target_count == 2);
+    REQUIRE(matrix.at(0, 0) == Catch::Approx(2.0F));
+    REQUIRE(std::isinf(matrix.at(0, 1)));
+    REQUIRE(matrix.at(1, 0) == Catch::Approx(1.0F));
+
+    georoute::WireRouteOptions tight;
+    tight.max_settled_nodes = 1;
+    const auto cut_off = client.matrix(std::span{sources}.first(1), std::span{targets}.first(1), tight);
+    REQUIRE(std::isnan(cut_off.at(0, 0)));
+
+    const auto stats = server.stats();
+    REQUIRE(stats.connections == 1);
+    REQUIRE(stats.requests == 5);
+    REQUIRE(stats.errors == 0);
+    REQUIRE(stats.bytes_in > 0);
+    REQUIRE(stats.bytes_out > 0);
+}
+
+TEST_CASE("BinaryProtocolServer frees the threads of closed connections", "[binary_protocol]") {
+    auto engine = build_sample_engine(1);
+    georoute::CongestionWriter writer{engine};
+    georoute::BinaryProtocolServer server{engine, writer, loopback_options()};
+
+    for (int i = 0; i < 20; ++i) {
+        georoute::BinaryClient client{"127.0.0.1", server.port()};
+        REQUIRE(client.route(0, 3).reachable);
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (server.stats().open_connections > 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    REQUIRE(server.stats().connections == 20);
+    REQUIRE(server.stats().open_connections == 0);
+}
+
+TEST_CASE("BinaryProtocolServer applies congestion updates", "[binary_protocol]") {
+    auto engine = build_sample_engine(1);
+    georoute::CongestionWriter writer{engine, georoute::CongestionWriterOptions{std::chrono::microseconds{0}}};
+    georoute::BinaryProtocolServer server{engine, writer, loopback_options()};
+    georoute::BinaryClient client{"127.0.0.1", server.port()};
+
+    const std::vector<georoute::CongestionUpdate> updates{{0, 1, 3.0F}};
+    const auto result = client.update_congestion(updates, true);
+    REQUIRE(result.sequence == 1);
+    REQUIRE(result.visible);
+
+    const auto route = client.route(0, 3);
+    REQUIRE(route.travel_time == Catch::Approx(3.0F));
+    REQUIRE(route.path == std::vector<georoute::node_id>{0, 2, 3});
+}
+
+TEST_CASE("BinaryProtocolServer reports bad requests without closing", "[binary_protocol]") {
+    auto engine = build_sample_engine(1);
+    georoute::CongestionWriter writer{engine, georoute::CongestionWriterOptions{std::chrono::microseconds{0}}};
+    georoute::BinaryProtocolServer server{engine, writer, loopback_options()};
+    georoute::BinaryClient client{"127.0.0.1", server.port()};
+
+    REQUIRE_THROWS_AS(client.route(0, 99), std::invalid_argument);
+
+    const std::vector<georoute::RouteQuery> too_many(9, georoute::RouteQuery{0, 3});
+    REQUIRE_THROWS_AS(client.route_batch(too_many), std::invalid_argument);
+
+    const std::vector<georoute::node_id> nodes{0, 1, 2};
+    REQUIRE_THROWS_AS(client.matrix(nodes, nodes), std::invalid_argument);
+
+    const std::vector<georoute::CongestionUpdate> out_of_range{{0, 50, 2.0F}};
+    REQUIRE_THROWS_AS(client.update_congestion(out_of_range), std::invalid_argument);
+
+    // The connection survives every rejected request.
+    REQUIRE(client.route(0, 3).reachable);
+    REQUIRE(server.stats().errors == 4);
+}
@@ -20,7 +20,7 @@ TEST_CASE("Congestion update changes route cost deterministically", "[congestion
     const auto baseline = router.compute_route(0, 2);
     REQUIRE(baseline.result.reachable);
     REQUIRE(baseline.result.total_travel_time == Catch::Approx(2.0F));
-    REQUIRE(baseline.result.nodes == std::vector<georoute::node_id>{0, 1, 2});
+    REQUIRE(baseline.result.nodes == std::pmr::vector<georoute::node_id>{0, 1, 2});
 
     // Apply congestion to edge 0 (0->1), doubling its cost
     router.apply_congestion_update(0, 0, 2.0F);
@@ -39,7 +39,7 @@ TEST_CASE("Congestion update changes route cost deterministically", "[congestion
     const auto after_more_congestion = router.compute_route(0, 2);
     REQUIRE(after_more_congestion.result.reachable);
     REQUIRE(after_more_congestion.result.total_travel_time == Catch::Approx(3.0F));
-    REQUIRE(after_more_congestion.result.nodes == std::vector<georoute::node_id>{0, 2});
+    REQUIRE(after_more_congestion.result.nodes == std::pmr::vector<georoute::node_id>{0, 2});
 }
 
 TEST_CASE("Congestion update affects multiple edges in range", "[congestion]") {
@@ -63,6 +63,6 @@ TEST_CASE("Congestion update affects multiple edges in range", "[congestion]") {
     // Direct path 0->3 still costs 5.0, so should switch
     const auto after_congestion = router.compute_route(0, 3);
     REQUIRE(after_congestion.result.total_travel_time == Catch::Approx(5.0F));
-    REQUIRE(after_congestion.result.nodes == std::vector<georoute::node_id>{0, 3});
+    REQUIRE(after_congestion.result.nodes == std::pmr::vector<georoute::node_id>{0, 3});
 }
 
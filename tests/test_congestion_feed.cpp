@@ -0,0 +1,195 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "georoute/congestion_feed.hpp"
+#include "georoute/congestion_writer.hpp"
+#include "georoute/engine.hpp"
+
+#include "test_graphs.hpp"
+
+namespace {
+
+std::span<const char> bytes_of(std::string_view text) {
+    return std::span<const char>{text.data(), text.size()};
+}
+
+std::string binary_record(std::uint32_t edge_start, std::uint32_t edge_end, float factor) {
+    std::string record(georoute::CongestionFeedParser::binary_record_size, '\0');
+    std::memcpy(record.data(), &edge_start, 4);
+    std::memcpy(record.data() + 4, &edge_end, 4);
+    std::memcpy(record.data() + 8, &factor, 4);
+    return record;
+}
+
+// Polls until the writer has applied `count` updates or the deadline passes.
+bool wait_for_updates(const georoute::CongestionWriter& writer, std::uint64_t count) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (writer.stats().coalesced_updates < count) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE("CongestionFeedParser decodes NDJSON split across reads", "[congestion_feed]") {
+    georoute::CongestionFeedParser parser{georoute::FeedFormat::ndjson, 10};
+    std::vector<georoute::CongestionUpdate> updates;
+
+    parser.consume(bytes_of("{\"edge_start\": 1, \"edge_end\": 3, \"fac"), updates);
+    REQUIRE(updates.empty());
+    parser.consume(bytes_of("tor\": 1.5}\n\n{\"source\":\"probe \\\"7\\\"\",\"factor\":2,\"edge_end\":9,\"edge_start\":9}\n"),
+                   updates);
+
+    REQUIRE(updates.size() == 2);
+    REQUIRE(updates[0].edge_start == 1);
+    REQUIRE(updates[0].edge_end == 3);
+    REQUIRE(updates[0].factor == Catch::Approx(1.5F));
+    REQUIRE(updates[1].edge_start == 9);
+    REQUIRE(updates[1].factor == Catch::Approx(2.0F));
+    REQUIRE(parser.stats().records == 2);
+    REQUIRE(parser.stats().rejected == 0);
+}
+
+TEST_CASE("CongestionFeedParser rejects malformed and out-of-range records", "[congestion_feed]") {
+    georoute::CongestionFeedParser parser{georoute::FeedFormat::ndjson, 10};
+    std::vector<georoute::CongestionUpdate> updates;
+
+    parser.consume(bytes_of("not json\n"
+                            "{\"edge_start\": 1, \"edge_end\": 2}\n"
+                            "{\"edge_start\": 4, \"edge_end\": 2, \"factor\": 1.0}\n"
+                            "{\"edge_start\": 4, \"edge_end\": 10, \"factor\": 1.0}\n"
+                            "{\"edge_start\": 0, \"edge_end\": 0, \"factor\": 1.0, \"tags\": [1]}\n"
+                            "{\"edge_start\": 0, \"edge_end\": 0, \"factor\": -2.0}\n"
+                            "{\"edge_start\": 0, \"edge_end\": 0, \"factor\": nan}\n"
+                            "{\"edge_start\": 0, \"edge_end\": 0, \"factor\": inf}\n"
+                            "{\"edge_start\": 0, \"edge_end\": 0, \"factor\": 3.0}\n"),
+                   updates);
+    REQUIRE(updates.size() == 1);
+    REQUIRE(updates[0].factor == Catch::Approx(3.0F));
+    REQUIRE(parser.stats().rejected == 8);
+
+    // An unterminated line longer than the limit is dropped up to its newline.
+    const std::string long_line(2000, ' ');
+    parser.consume(bytes_of(long_line), updates);
+    parser.consume(bytes_of(long_line), updates);
+    parser.consume(bytes_of("}\n{\"edge_start\": 2, \"edge_end\": 2, \"factor\": 2.0}\n"), updates);
+    REQUIRE(updates.size() == 2);
+    REQUIRE(parser.stats().rejected == 9);
+}
+
+TEST_CASE("CongestionFeedParser decodes binary records split across reads", "[congestion_feed]") {
+    georoute::CongestionFeedParser parser{georoute::FeedFormat::binary, 10};
+    std::vector<georoute::CongestionUpdate> updates;
+
+    const auto stream = binary_record(0, 4, 1.25F) + binary_record(5, 12, 2.0F) + binary_record(7, 9, 0.5F);
+    parser.consume(bytes_of(std::string_view{stream}.substr(0, 5)), updates);
+    REQUIRE(updates.empty());
+    parser.consume(bytes_of(std::string_view{stream}.substr(5, 20)), updates);
+    REQUIRE(updates.size() == 1);
+    parser.consume(bytes_of(std::string_view{stream}.substr(25)), updates);
+
+    REQUIRE(updates.size() == 2);
+    REQUIRE(updates[0].edge_end == 4);
+    REQUIRE(updates[0].factor == Catch::Approx(1.25F));
+    REQUIRE(updates[1].edge_start == 7);
+    REQUIRE(updates[1].factor == Catch::Approx(0.5F));
+    REQUIRE(parser.stats().rejected == 1);
+    REQUIRE(parser.stats().bytes == stream.size());
+
+    const auto bad_factors = binary_record(1, 1, -1.0F) + binary_record(1, 1, std::numeric_limits<float>::quiet_NaN()) +
+                             binary_record(1, 1, std::numeric_limits<float>::infinity());
+    parser.consume(bytes_of(bad_factors), updates);
+    REQUIRE(updates.size() == 2);
+    REQUIRE(parser.stats().rejected == 4);
+}
+
+TEST_CASE("FeedSource parses source specs", "[congestion_feed]") {
+    const auto unix_source = georoute::FeedSource::parse("unix:/tmp/feed.sock", georoute::FeedFormat::binary);
+    REQUIRE(unix_source.kind == georoute::FeedSource::Kind::unix_socket);
+    REQUIRE(unix_source.path == "/tmp/feed.sock");
+    REQUIRE(unix_source.format == georoute::FeedFormat::binary);
+
+    const auto tcp_source = georoute::FeedSource::parse("tcp:9100", georoute::FeedFormat::ndjson);
+    REQUIRE(tcp_source.kind == georoute::FeedSource::Kind::tcp);
+    REQUIRE(tcp_source.path == "127.0.0.1");
+    REQUIRE(tcp_source.port == 9100);
+
+    const auto bound = georoute::FeedSource::parse("tcp:0.0.0.0:9101", georoute::FeedFormat::ndjson);
+    REQUIRE(bound.path == "0.0.0.0");
+    REQUIRE(bound.port == 9101);
+
+    REQUIRE(georoute::FeedSource::parse("file:/var/feed.ndjson", georoute::FeedFormat::ndjson).kind ==
+            georoute::FeedSource::Kind::file);
+    REQUIRE_THROWS_AS(georoute::FeedSource::parse("udp:9000", georoute::FeedFormat::ndjson), std::invalid_argument);
+    REQUIRE_THROWS_AS(georoute::FeedSource::parse("tcp:99999", georoute::FeedFormat::ndjson), std::invalid_argument);
+    REQUIRE_THROWS_AS(georoute::parse_feed_format("csv"), std::invalid_argument);
+}
+
+TEST_CASE("CongestionFeed ingests a Unix socket stream", "[congestion_feed]") {
+    auto engine = build_sample_engine();
+    georoute::CongestionWriter writer{engine, georoute::CongestionWriterOptions{std::chrono::microseconds{0}}};
+    const std::string path = "/tmp/georoute_test_feed_" + std::to_string(::getpid()) + ".sock";
+    {
+        georoute::CongestionFeed feed{writer, engine.edge_count(),
+                                      georoute::FeedSource::parse("unix:" + path, georoute::FeedFormat::binary)};
+
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        REQUIRE(fd >= 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        REQUIRE(::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+        const auto stream = binary_record(0, 1, 2.5F) + binary_record(2, 2, 1.0F);
+        REQUIRE(::write(fd, stream.data(), stream.size()) == static_cast<ssize_t>(stream.size()));
+        ::close(fd);
+
+        REQUIRE(wait_for_updates(writer, 2));
+        REQUIRE(feed.stats().records == 2);
+    }
+    REQUIRE(engine.route(0, 3).result.total_travel_time == Catch::Approx(3.0F));
+}
+
+TEST_CASE("CongestionFeed follows an appended file", "[congestion_feed]") {
+    auto engine = build_sample_engine();
+    georoute::CongestionWriter writer{engine, georoute::CongestionWriterOptions{std::chrono::microseconds{0}}};
+    const std::string path = "/tmp/georoute_test_feed_" + std::to_string(::getpid()) + ".ndjson";
+    std::remove(path.c_str());
+    {
+        std::ofstream output{path};
+        output << "{\"edge_start\": 0, \"edge_end\": 0, \"factor\": 2.0}\n";
+    }
+
+    georoute::CongestionFeed feed{writer, engine.edge_count(),
+                                  georoute::FeedSource::parse("file:" + path, georoute::FeedFormat::ndjson)};
+    REQUIRE(wait_for_updates(writer, 1));
+
+    {
+        std::ofstream output{path, std::ios::app};
+        output << "{\"edge_start\": 1, \"edge_end\": 1, \"factor\": 2.0}\n";
+    }
+    REQUIRE(wait_for_updates(writer, 2));
+    REQUIRE(feed.stats().records == 2);
+    REQUIRE(engine.route(0, 3).result.total_travel_time == Catch::Approx(3.0F));
+    std::remove(path.c_str());
+}
@@ -0,0 +1,114 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+#include "georoute/congestion_index.hpp"
+
+TEST_CASE("CongestionIndex dispatches to the selected backend", "[congestion_index]") {
+    auto tree = georoute::CongestionIndex::make("segment_tree", 10);
+    auto blocks = georoute::CongestionIndex::make("blocked", 10);
+    REQUIRE(tree.kind() == "segment_tree");
+    REQUIRE(blocks.kind() == "blocked");
+
+    tree.range_multiply(2, 7, 3.0F);
+    blocks.range_multiply(2, 7, 3.0F);
+    REQUIRE(tree.point_query(5) == Catch::Approx(3.0F));
+    REQUIRE(blocks.point_query(5) == Catch::Approx(3.0F));
+    REQUIRE(blocks.size() == 10);
+
+    REQUIRE_THROWS_AS(georoute::CongestionIndex::make("fenwick", 10), std::invalid_argument);
+}
+
+TEST_CASE("merge_congestion_updates splits overlaps into disjoint ranges", "[congestion_index]") {
+    const std::vector<georoute::CongestionUpdate> updates{
+        {5, 9, 2.0F},
+        {0, 6, 1.5F},
+        {20, 20, 3.0F},
+    };
+
+    const auto merged = georoute::merge_congestion_updates(updates);
+
+    REQUIRE(merged.size() == 4);
+    REQUIRE(merged[0].edge_start == 0);
+    REQUIRE(merged[0].edge_end == 4);
+    REQUIRE(merged[0].factor == Catch::Approx(1.5F));
+    REQUIRE(merged[1].edge_start == 5);
+    REQUIRE(merged[1].edge_end == 6);
+    REQUIRE(merged[1].factor == Catch::Approx(3.0F));
+    REQUIRE(merged[2].edge_start == 7);
+    REQUIRE(merged[2].edge_end == 9);
+    REQUIRE(merged[2].factor == Catch::Approx(2.0F));
+    REQUIRE(merged[3].edge_start == 20);
+    REQUIRE(merged[3].edge_end == 20);
+}
+
+TEST_CASE("merge_congestion_updates joins adjacent equal factors", "[congestion_index]") {
+    const std::vector<georoute::CongestionUpdate> updates{
+        {4, 7, 2.0F},
+        {0, 3, 2.0F},
+        {0, 3, 2.0F},
+    };
+
+    const auto merged = georoute::merge_congestion_updates(updates);
+
+    REQUIRE(merged.size() == 2);
+    REQUIRE(merged[0].edge_end == 3);
+    REQUIRE(merged[0].factor == Catch::Approx(4.0F));
+    REQUIRE(merged[1].edge_start == 4);
+    REQUIRE(merged[1].factor == Catch::Approx(2.0F));
+}
+
+TEST_CASE("CongestionIndex batch matches individual updates", "[congestion_index]") {
+    const std::vector<georoute::CongestionUpdate> updates{
+        {0, 40, 1.2F},
+        {10, 90, 0.9F},
+        {35, 35, 2.0F},
+        {60, 99, 1.1F},
+    };
+    const auto merged = georoute::merge_congestion_updates(updates);
+
+    for (const auto* kind : {"segment_tree", "blocked"}) {
+        auto single = georoute::CongestionIndex::make(kind, 100);
+        auto batched = georoute::CongestionIndex::make(kind, 100);
+        for (const auto& update : updates) {
+            single.range_multiply(update.edge_start, update.edge_end, update.factor);
+        }
+        batched.range_multiply_batch(merged);
+
+        for (std::size_t i = 0; i < 100; ++i) {
+            REQUIRE(batched.point_query(i) == Catch::Approx(single.point_query(i)));
+        }
+    }
+}
+
+TEST_CASE("CongestionIndex overlay is visible before and after flush", "[congestion_index]") {
+    for (const auto* kind : {"segment_tree", "blocked"}) {
+        auto index = georoute::CongestionIndex::make(kind, 50);
+        index.set_overlay_flush_threshold(4);
+        index.range_multiply(0, 49, 2.0F);
+
+        const std::vector<georoute::EdgeFactorUpdate> first{{7, 1.5F}, {30, 0.5F}, {7, 2.0F}};
+        REQUIRE(index.point_multiply(first) == 0);
+        REQUIRE(index.overlay_size() == 3);
+        REQUIRE(index.point_query(7) == Catch::Approx(6.0F));
+        REQUIRE(index.point_query(30) == Catch::Approx(1.0F));
+        REQUIRE(index.point_query(8) == Catch::Approx(2.0F));
+        const auto values = index.values();
+        REQUIRE(values.size() == 50);
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            REQUIRE(values[i] == Catch::Approx(index.point_query(i)));
+        }
+
+        const std::vector<georoute::EdgeFactorUpdate> second{{49, 3.0F}};
+        REQUIRE(index.point_multiply(second) > 0);
+        REQUIRE(index.overlay_size() == 0);
+        REQUIRE(index.point_query(7) == Catch::Approx(6.0F));
+        REQUIRE(index.point_query(30) == Catch::Approx(1.0F));
+        REQUIRE(index.point_query(49) == Catch::Approx(6.0F));
+
+        const std::vector<georoute::EdgeFactorUpdate> invalid{{50, 2.0F}};
+        REQUIRE_THROWS_AS(index.point_multiply(invalid), std::out_of_range);
+    }
+}
@@ -0,0 +1,178 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "georoute/congestion_journal.hpp"
+#include "georoute/engine.hpp"
+
+#include "test_graphs.hpp"
+
+namespace {
+
+// Fresh, empty state directory per test case.
+std::string make_state_dir(const std::string& name) {
+    const auto path = std::filesystem::temp_directory_path() /
+                      ("georoute_journal_" + std::to_string(::getpid()) + "_" + name);
+    std::filesystem::remove_all(path);
+    return path.string();
+}
+
+georoute::CongestionJournalOptions journal_options(const std::string& directory) {
+    return georoute::CongestionJournalOptions{directory, std::chrono::hours{1}, false};
+}
+
+}  // namespace
+
+TEST_CASE("CongestionJournal replays the log and writes a snapshot on shutdown", "[congestion_journal]") {
+    const auto directory = make_state_dir("replay");
+    const std::vector<georoute::CongestionUpdate> first{{0, 2, 2.0F}};
+    const std::vector<georoute::CongestionUpdate> second{{2, 3, 1.5F}, {5, 5, 0.5F}};
+    {
+        auto recovered = georoute::CongestionJournal::recover(directory, 6);
+        REQUIRE_FALSE(recovered.from_snapshot);
+        REQUIRE(recovered.factors == std::vector<float>(6, 1.0F));
+
+        georoute::CongestionJournal journal{journal_options(directory), std::move(recovered)};
+        journal.record(first);
+        journal.record(second);
+        journal.flush();
+        REQUIRE(journal.stats().sequence == 2);
+        REQUIRE(journal.stats().log_bytes > 0);
+
+        // The log alone is enough to rebuild the state.
+        const auto from_log = georoute::CongestionJournal::recover(directory, 6);
+        REQUIRE_FALSE(from_log.from_snapshot);
+        REQUIRE(from_log.replayed_batches == 2);
+        REQUIRE(from_log.replayed_updates == 3);
+        REQUIRE(from_log.last_sequence == 2);
+        REQUIRE(from_log.factors[2] == Catch::Approx(3.0F));
+        REQUIRE(from_log.factors[5] == Catch::Approx(0.5F));
+    }
+
+    const auto from_snapshot = georoute::CongestionJournal::recover(directory, 6);
+    REQUIRE(from_snapshot.from_snapshot);
+    REQUIRE(from_snapshot.snapshot_sequence == 2);
+    REQUIRE(from_snapshot.replayed_batches == 0);
+    REQUIRE(from_snapshot.factors ==
+            std::vector<float>{2.0F, 2.0F, 2.0F * 1.5F, 1.5F, 1.0F, 0.5F});
+
+    // Sequence numbers continue after a restart.
+    {
+        georoute::CongestionJournal journal{journal_options(directory),
+                                            georoute::CongestionJournal::recover(directory, 6)};
+        journal.record(first);
+        journal.flush();
+        REQUIRE(journal.stats().sequence == 3);
+        const auto recovered = georoute::CongestionJournal::recover(directory, 6);
+        REQUIRE(recovered.replayed_batches == 1);
+        REQUIRE(recovered.factors[0] == Catch::Approx(4.0F));
+    }
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("CongestionJournal drops a torn log tail", "[congestion_journal]") {
+    const auto directory = make_state_dir("torn");
+    {
+        georoute::CongestionJournal journal{journal_options(directory),
+                                            georoute::CongestionJournal::recover(directory, 4)};
+        journal.record(std::vector<georoute::CongestionUpdate>{{1, 1, 2.0F}});
+        journal.flush();
+
+        std::ofstream log{std::filesystem::path{directory} / georoute::CongestionJournal::log_file,
+                          std::ios::binary | std::ios::app};
+        log << "partial entry";
+        log.close();
+
+        const auto recovered = georoute::CongestionJournal::recover(directory, 4);
+        REQUIRE(recovered.replayed_batches == 1);
+        REQUIRE(recovered.log_bytes == journal.stats().log_bytes);
+        REQUIRE(recovered.factors[1] == Catch::Approx(2.0F));
+    }
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("CongestionJournal rejects a snapshot for a different graph", "[congestion_journal]") {
+    const auto directory = make_state_dir("mismatch");
+    {
+        georoute::CongestionJournal journal{journal_options(directory),
+                                            georoute::CongestionJournal::recover(directory, 4)};
+        journal.record(std::vector<georoute::CongestionUpdate>{{0, 3, 2.0F}});
+    }
+    REQUIRE_THROWS_AS(georoute::CongestionJournal::recover(directory, 5), std::runtime_error);
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("factor_runs groups equal factors and skips 1.0", "[congestion_journal]") {
+    const std::vector<float> factors{1.0F, 2.0F, 2.0F, 1.0F, 0.5F, 1.0F, 1.0F, 3.0F};
+    const auto runs = georoute::factor_runs(factors);
+    REQUIRE(runs.size() == 3);
+    REQUIRE(runs[0].edge_start == 1);
+    REQUIRE(runs[0].edge_end == 2);
+    REQUIRE(runs[0].factor == Catch::Approx(2.0F));
+    REQUIRE(runs[1].edge_start == 4);
+    REQUIRE(runs[1].edge_end == 4);
+    REQUIRE(runs[2].edge_start == 7);
+    REQUIRE(runs[2].edge_end == 7);
+}
+
+TEST_CASE("GeoRouteEngine updates survive a restart through the journal", "[congestion_journal]") {
+    const auto directory = make_state_dir("engine");
+    {
+        auto engine = build_sample_engine();
+        georoute::CongestionJournal journal{journal_options(directory),
+                                            georoute::CongestionJournal::recover(directory, engine.edge_count())};
+        engine.set_congestion_journal(&journal);
+
+        engine.apply_congestion_update(0, 0, 2.5F);
+        const std::vector<georoute::EdgeFactorUpdate> edges{{1, 2.0F}};
+        engine.apply_edge_updates(edges);
+        engine.set_congestion_journal(nullptr);
+    }
+
+    auto restarted = build_sample_engine();
+    const auto recovered = georoute::CongestionJournal::recover(directory, restarted.edge_count());
+    restarted.apply_congestion_updates(georoute::factor_runs(recovered.factors));
+
+    const auto route = restarted.route(0, 3);
+    REQUIRE(route.result.total_travel_time == Catch::Approx(3.0F));
+    REQUIRE(route.result.nodes == std::pmr::vector<georoute::node_id>{0, 2, 3});
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("CongestionJournal restarts when the engine swaps to a different graph", "[congestion_journal]") {
+    const auto directory = make_state_dir("swap");
+    {
+        auto engine = build_sample_engine();
+        georoute::CongestionJournal journal{journal_options(directory),
+                                            georoute::CongestionJournal::recover(directory, engine.edge_count())};
+        engine.set_congestion_journal(&journal);
+        engine.apply_congestion_update(0, 3, 2.0F);
+
+        georoute::Graph larger{5};
+        for (georoute::node_id u = 0; u < 4; ++u) {
+            larger.add_edge(u, u + 1, 1.0F);
+        }
+        larger.add_edge(0, 4, 10.0F);
+        georoute::SegmentTree tree{larger.edge_count()};
+        const auto swapped = engine.swap_router(georoute::Router{std::move(larger), std::move(tree)}, true);
+        REQUIRE_FALSE(swapped.congestion_carried);
+
+        engine.apply_congestion_update(4, 4, 0.5F);
+        journal.flush();
+        engine.set_congestion_journal(nullptr);
+    }
+
+    REQUIRE_THROWS_AS(georoute::CongestionJournal::recover(directory, 4), std::runtime_error);
+    const auto recovered = georoute::CongestionJournal::recover(directory, 5);
+    REQUIRE(recovered.factors == std::vector<float>{1.0F, 1.0F, 1.0F, 1.0F, 0.5F});
+    std::filesystem::remove_all(directory);
+}
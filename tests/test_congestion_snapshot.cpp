@@ -0,0 +1,46 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+#include "georoute/congestion_snapshot.hpp"
+
+TEST_CASE("CongestionSnapshot next version copies only written chunks", "[congestion_snapshot]") {
+    const std::size_t edge_count = georoute::CongestionSnapshot::chunk_size * 3 + 5;
+    const std::vector<float> costs(edge_count, 1.0F);
+    const georoute::CongestionSnapshot base{0, costs};
+
+    const auto next = base.next();
+    REQUIRE(next->epoch() == 1);
+    REQUIRE(next->edge_count() == edge_count);
+
+    const std::size_t last = edge_count - 1;
+    next->multiply(last - 2, last, 2.0F);
+    next->multiply(0, 0, 3.0F);
+
+    REQUIRE(next->cost(0) == Catch::Approx(3.0F));
+    REQUIRE(next->cost(1) == Catch::Approx(1.0F));
+    REQUIRE(next->cost(last) == Catch::Approx(2.0F));
+    REQUIRE(next->cost(last - 3) == Catch::Approx(1.0F));
+
+    // The published version is untouched by writes to its successor.
+    REQUIRE(base.cost(0) == Catch::Approx(1.0F));
+    REQUIRE(base.cost(last) == Catch::Approx(1.0F));
+}
+
+TEST_CASE("CongestionSnapshot multiply spans chunk boundaries", "[congestion_snapshot]") {
+    const std::size_t chunk = georoute::CongestionSnapshot::chunk_size;
+    const std::vector<float> costs(chunk * 2, 2.0F);
+    const georoute::CongestionSnapshot base{7, costs};
+
+    auto next = base.next();
+    next->multiply(chunk - 1, chunk, 1.5F);
+    REQUIRE(next->epoch() == 8);
+    REQUIRE(next->cost(chunk - 2) == Catch::Approx(2.0F));
+    REQUIRE(next->cost(chunk - 1) == Catch::Approx(3.0F));
+    REQUIRE(next->cost(chunk) == Catch::Approx(3.0F));
+    REQUIRE(next->cost(chunk + 1) == Catch::Approx(2.0F));
+
+    REQUIRE_THROWS_AS(next->multiply(0, chunk * 2, 1.0F), std::out_of_range);
+}
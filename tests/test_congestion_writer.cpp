@@ -0,0 +1,110 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "georoute/congestion_writer.hpp"
+#include "georoute/engine.hpp"
+
+#include "test_graphs.hpp"
+
+TEST_CASE("CongestionWriter applies queued updates and acks sequences", "[congestion_writer]") {
+    auto engine = build_sample_engine();
+    georoute::CongestionWriter writer{engine, georoute::CongestionWriterOptions{std::chrono::microseconds{0}}};
+
+    const auto first = writer.enqueue(georoute::CongestionUpdate{0, 1, 2.5F});
+    const std::vector<georoute::CongestionUpdate> batch{{2, 2, 1.5F}, {3, 3, 1.5F}};
+    const auto second = writer.enqueue(batch);
+    REQUIRE(first == 1);
+    REQUIRE(second == 2);
+
+    REQUIRE(writer.wait_for(second, std::chrono::seconds{5}));
+    REQUIRE(writer.applied_sequence() >= second);
+
+    const auto route = engine.route(0, 3);
+    REQUIRE(route.result.total_travel_time == Catch::Approx(4.5F));
+
+    const auto stats = writer.stats();
+    REQUIRE(stats.enqueued_sequence == 2);
+    REQUIRE(stats.applied_sequence == 2);
+    REQUIRE(stats.queue_depth == 0);
+    REQUIRE(stats.coalesced_updates == 3);
+    REQUIRE(stats.batches >= 1);
+    REQUIRE(stats.max_apply_lag_us >= stats.last_apply_lag_us);
+}
+
+TEST_CASE("CongestionWriter rejects invalid ranges at enqueue", "[congestion_writer]") {
+    auto engine = build_sample_engine();
+    georoute::CongestionWriter writer{engine};
+
+    REQUIRE_THROWS_AS(writer.enqueue(georoute::CongestionUpdate{2, 1, 2.0F}), std::invalid_argument);
+    REQUIRE_THROWS_AS(writer.enqueue(georoute::CongestionUpdate{0, 4, 2.0F}), std::out_of_range);
+    REQUIRE_THROWS_AS(writer.enqueue(georoute::CongestionUpdate{0, 1, -2.0F}), std::invalid_argument);
+    REQUIRE(writer.stats().enqueued_sequence == 0);
+    REQUIRE_FALSE(writer.wait_for(1, std::chrono::milliseconds{1}));
+}
+
+TEST_CASE("CongestionWriter coalesces concurrent producers", "[congestion_writer]") {
+    auto engine = build_sample_engine();
+    constexpr std::size_t producers = 4;
+    constexpr std::size_t updates_per_producer = 250;
+    {
+        georoute::CongestionWriter writer{engine, georoute::CongestionWriterOptions{std::chrono::microseconds{200}}};
+        std::vector<std::thread> threads;
+        for (std::size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&writer, p] {
+                for (std::size_t i = 0; i < updates_per_producer; ++i) {
+                    // Factors cancel out in pairs so the final cost is order independent.
+                    const float factor = i % 2 == 0 ? 2.0F : 0.5F;
+                    writer.enqueue(georoute::CongestionUpdate{p % 4, p % 4, factor});
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        const std::uint64_t last = producers * updates_per_producer;
+        REQUIRE(writer.wait_for(last, std::chrono::seconds{10}));
+        const auto stats = writer.stats();
+        REQUIRE(stats.coalesced_updates == last);
+        REQUIRE(stats.batches <= last);
+    }
+
+    const auto route = engine.route(0, 3);
+    REQUIRE(route.result.total_travel_time == Catch::Approx(2.0F));
+    REQUIRE(engine.get_stats().total_updates == producers * updates_per_producer);
+}
+
+TEST_CASE("CongestionWriter drains the queue on destruction", "[congestion_writer]") {
+    auto engine = build_sample_engine();
+    {
+        georoute::CongestionWriter writer{engine, georoute::CongestionWriterOptions{std::chrono::milliseconds{50}}};
+        writer.enqueue(georoute::CongestionUpdate{0, 0, 3.0F});
+    }
+    REQUIRE(engine.route(0, 3).result.total_travel_time == Catch::Approx(3.0F));
+}
+
+TEST_CASE("CongestionWriter drops queued updates the graph no longer fits", "[congestion_writer]") {
+    auto engine = build_sample_engine();
+    georoute::CongestionWriter writer{engine, georoute::CongestionWriterOptions{std::chrono::milliseconds{200}}};
+    const auto stale = writer.enqueue(georoute::CongestionUpdate{3, 3, 2.0F});
+
+    // Swapped in while the update waits out the coalesce window: edge 3 is gone.
+    georoute::Graph smaller{2};
+    smaller.add_edge(0, 1, 1.0F);
+    REQUIRE(engine.swap_router(georoute::Router{std::move(smaller), georoute::SegmentTree{1}}).edge_count == 1);
+
+    REQUIRE(writer.wait_for(stale, std::chrono::seconds{5}));
+    REQUIRE(writer.stats().dropped_updates == 1);
+    REQUIRE(writer.stats().coalesced_updates == 0);
+
+    // The writer thread is still alive and applies the next update.
+    const auto next = writer.enqueue(georoute::CongestionUpdate{0, 0, 3.0F});
+    REQUIRE(writer.wait_for(next, std::chrono::seconds{5}));
+    REQUIRE(engine.route(0, 1).result.total_travel_time == Catch::Approx(3.0F));
+}
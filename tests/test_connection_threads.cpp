@@ -0,0 +1,49 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "georoute/connection_threads.hpp"
+
+namespace {
+
+bool wait_until_idle(const georoute::ConnectionThreads& threads) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (threads.active() > 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    return threads.active() == 0;
+}
+
+}  // namespace
+
+TEST_CASE("ConnectionThreads reaps finished threads while others keep running", "[connection_threads]") {
+    std::atomic<int> served{0};
+    std::atomic<bool> release{false};
+    georoute::ConnectionThreads threads;
+
+    threads.spawn([&release] {
+        while (!release.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+    });
+    for (int i = 0; i < 200; ++i) {
+        threads.spawn([&served] { served.fetch_add(1); });
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (threads.active() > 1 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    threads.reap();
+    REQUIRE(served.load() == 200);
+    REQUIRE(threads.active() == 1);
+
+    release.store(true);
+    REQUIRE(wait_until_idle(threads));
+    threads.reap();
+    threads.spawn([&served] { served.fetch_add(1); });
+    threads.join_all();
+    REQUIRE(served.load() == 201);
+    REQUIRE(threads.active() == 0);
+}
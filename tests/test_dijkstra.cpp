@@ -1,6 +1,7 @@
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 
+#include <chrono>
 #include <vector>
 
 #include "georoute/dijkstra.hpp"
@@ -21,7 +22,7 @@ TEST_CASE("Dijkstra finds shortest path in simple graph", "[dijkstra]") {
 
     REQUIRE(computation.result.reachable);
     REQUIRE(computation.result.total_travel_time == Catch::Approx(4.0F));
-    REQUIRE(computation.result.nodes == std::vector<georoute::node_id>{0, 1, 2, 3});
+    REQUIRE(computation.result.nodes == std::pmr::vector<georoute::node_id>{0, 1, 2, 3});
     REQUIRE(computation.stats.expanded_nodes > 0);
 }
 
@@ -49,7 +50,7 @@ TEST_CASE("Dijkstra zero-cost when source equals target", "[dijkstra]") {
     const auto computation = router.shortest_path(1, 1);
     REQUIRE(computation.result.reachable);
     REQUIRE(computation.result.total_travel_time == Catch::Approx(0.0F));
-    REQUIRE(computation.result.nodes == std::vector<georoute::node_id>{1});
+    REQUIRE(computation.result.nodes == std::pmr::vector<georoute::node_id>{1});
     REQUIRE(computation.stats.expanded_nodes == 1);
 }
 
@@ -59,7 +60,7 @@ TEST_CASE("Dijkstra stats are non-zero on non-trivial graphs", "[dijkstra]") {
     // Create a grid-like structure
     for (georoute::node_id i = 0; i < 9; ++i) {
         graph.add_edge(i, i + 1, 1.0F);
-        if (i % 3 != 2) {
+        if (i % 3 != 2 && i + 3 < 10) {
             graph.add_edge(i, i + 3, 1.0F);
         }
     }
@@ -80,3 +81,45 @@ TEST_CASE("Dijkstra stats are non-zero on non-trivial graphs", "[dijkstra]") {
 }
 
 
+
+TEST_CASE("Dijkstra stops when the search budget runs out", "[dijkstra]") {
+    // A 2000-node chain with an unreachable island: the search to node 2000
+    // has to settle the whole chain before giving up.
+    georoute::Graph graph{2001};
+    for (georoute::node_id i = 0; i + 1 < 2000; ++i) {
+        graph.add_edge(i, i + 1, 1.0F);
+    }
+
+    georoute::SegmentTree congestion{graph.edge_count()};
+    georoute::DijkstraRouter router{graph, congestion};
+    georoute::SearchScratch scratch;
+
+    const auto unlimited = router.shortest_path(0, 2000, scratch);
+    REQUIRE(unlimited.status == georoute::RouteStatus::complete);
+    REQUIRE_FALSE(unlimited.result.reachable);
+    REQUIRE(unlimited.stats.expanded_nodes == 2000);
+
+    georoute::SearchBudget node_budget;
+    node_budget.max_settled_nodes = 100;
+    const auto capped = router.shortest_path(0, 2000, scratch, node_budget);
+    REQUIRE(capped.status == georoute::RouteStatus::node_budget_exceeded);
+    REQUIRE(capped.stats.expanded_nodes == 100);
+    REQUIRE_FALSE(capped.result.reachable);
+    REQUIRE(capped.result.nodes.empty());
+
+    // Reaching the target within the budget is a normal result.
+    const auto near = router.shortest_path(0, 50, scratch, node_budget);
+    REQUIRE(near.status == georoute::RouteStatus::complete);
+    REQUIRE(near.result.reachable);
+
+    georoute::SearchBudget expired;
+    expired.deadline = std::chrono::steady_clock::now() - std::chrono::milliseconds{1};
+    const auto late = router.shortest_path(0, 2000, scratch, expired);
+    REQUIRE(late.status == georoute::RouteStatus::deadline_exceeded);
+    REQUIRE(late.stats.expanded_nodes == georoute::SearchBudget::clock_check_interval);
+
+    // Scratch reused after an aborted search still gives exact answers.
+    const auto again = router.shortest_path(0, 1999, scratch);
+    REQUIRE(again.result.reachable);
+    REQUIRE(again.result.total_travel_time == Catch::Approx(1999.0F));
+}
@@ -0,0 +1,144 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "georoute/dimacs.hpp"
+#include "georoute/graph_generator.hpp"
+#include "georoute/graph_snapshot.hpp"
+#include "georoute/router.hpp"
+
+namespace {
+
+std::string temp_path(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("georoute_dimacs_" + std::to_string(::getpid()) + "_" + name))
+        .string();
+}
+
+void write_text(const std::string& path, const std::string& text) {
+    std::ofstream output{path, std::ios::binary | std::ios::trunc};
+    output << text;
+}
+
+}  // namespace
+
+TEST_CASE("read_dimacs reads arcs in file order and coordinates", "[dimacs]") {
+    const auto gr = temp_path("small.gr");
+    const auto co = temp_path("small.co");
+    write_text(gr,
+               "c 9th DIMACS Implementation Challenge\n"
+               "c\n"
+               "p sp 3 4\n"
+               "a 2 3 40\n"
+               "a 1 2 10\r\n"
+               "\n"
+               "a 1 3 70\n"
+               "a 3 1 5");
+    write_text(co,
+               "p aux sp co 3\n"
+               "v 3 -73250000 40500000\n"
+               "v 1 13400000 52520000\n"
+               "v 2 -122419416 37774929\n");
+
+    auto graph = georoute::read_dimacs(gr);
+    REQUIRE(graph.node_count() == 3);
+    REQUIRE(graph.edge_count() == 4);
+    REQUIRE(graph.base_travel_times() == std::vector<float>{40.0F, 10.0F, 70.0F, 5.0F});
+    REQUIRE(graph.neighbors(0).size() == 2);
+    REQUIRE(graph.neighbors(0)[0].to == 1);
+    REQUIRE(graph.neighbors(0)[0].id == 1);
+    REQUIRE(graph.neighbors(1)[0].id == 0);
+    REQUIRE_FALSE(graph.coordinates());
+
+    georoute::DimacsImportOptions options;
+    options.coordinates_path = georoute::dimacs_coordinates_path(gr);
+    options.weight_scale = 0.1;
+    REQUIRE(options.coordinates_path == co);
+    graph = georoute::read_dimacs(gr, options);
+    REQUIRE(graph.base_travel_times()[1] == 1.0F);
+    const auto& coordinates = *graph.coordinates();
+    REQUIRE(coordinates[0].lat == 52.52);
+    REQUIRE(coordinates[0].lon == 13.4);
+    REQUIRE(coordinates[2].lat == 40.5);
+    REQUIRE(coordinates[2].lon == -73.25);
+
+    // Any format the server loads goes through Router::from_file.
+    const auto router = georoute::Router::from_file(gr);
+    REQUIRE(router.node_count() == 3);
+    REQUIRE(router.graph().coordinates());
+    REQUIRE(router.compute_route(0, 2).result.total_travel_time == 50.0F);
+
+    std::filesystem::remove(gr);
+    std::filesystem::remove(co);
+    REQUIRE(georoute::dimacs_coordinates_path(gr).empty());
+}
+
+TEST_CASE("write_dimacs round-trips generated graphs", "[dimacs]") {
+    const auto gr = temp_path("round_trip.gr");
+    const auto co = temp_path("round_trip.co");
+    const auto snapshot = temp_path("round_trip.snapshot");
+    const auto graph = georoute::make_geometric_graph(300, 5);
+    georoute::write_dimacs(graph, gr, co);
+
+    const auto loaded = georoute::read_dimacs(gr, {co});
+    REQUIRE(loaded.same_edge_ids(graph));
+    REQUIRE(loaded.base_travel_times() == graph.base_travel_times());
+    for (std::size_t u = 0; u < graph.node_count(); ++u) {
+        REQUIRE(std::abs((*loaded.coordinates())[u].lat - (*graph.coordinates())[u].lat) < 1e-6);
+        REQUIRE(std::abs((*loaded.coordinates())[u].lon - (*graph.coordinates())[u].lon) < 1e-6);
+    }
+
+    // A converted snapshot loads back with the same edges.
+    georoute::write_graph_snapshot(loaded, snapshot);
+    REQUIRE(georoute::is_graph_snapshot(snapshot));
+    REQUIRE_FALSE(georoute::is_graph_snapshot(gr));
+    REQUIRE(georoute::Router::from_file(snapshot).graph().same_edge_ids(graph));
+
+    std::filesystem::remove(gr);
+    std::filesystem::remove(co);
+    std::filesystem::remove(snapshot);
+}
+
+TEST_CASE("read_dimacs rejects malformed files", "[dimacs]") {
+    const auto gr = temp_path("bad.gr");
+    const auto co = temp_path("bad.co");
+    REQUIRE_THROWS_AS(georoute::read_dimacs(gr), std::runtime_error);
+    REQUIRE_THROWS_AS(georoute::Router::from_file(gr), std::runtime_error);
+
+    const auto rejects = [&gr](const std::string& text) {
+        write_text(gr, text);
+        REQUIRE_THROWS_AS(georoute::read_dimacs(gr), std::runtime_error);
+    };
+    rejects("");
+    rejects("a 1 2 3\np sp 2 1\n");
+    rejects("p sp 2 1\na 1 3 3\n");
+    rejects("p sp 2 1\na 0 1 3\n");
+    rejects("p sp 2 1\na 1 2 -3\n");
+    rejects("p sp 2 1\na 1 2\n");
+    rejects("p sp 2 2\na 1 2 3\n");
+    rejects("p sp 2 1\na 1 2 3\na 2 1 3\n");
+    rejects("p sp 2 1\np sp 2 1\n");
+    rejects("p max 2 1\na 1 2 3\n");
+
+    write_text(gr, "p sp 2 1\na 1 2 3\n");
+    const auto rejects_coordinates = [&](const std::string& text) {
+        write_text(co, text);
+        REQUIRE_THROWS_AS(georoute::read_dimacs(gr, {co}), std::runtime_error);
+    };
+    rejects_coordinates("p aux sp co 3\nv 1 0 0\nv 2 0 0\n");
+    rejects_coordinates("p aux sp co 2\nv 1 0 0\n");
+    rejects_coordinates("p aux sp co 2\nv 1 0 0\nv 1 0 0\n");
+    rejects_coordinates("p aux sp co 2\nv 1 0 0\nv 2 0\n");
+    // 95 degrees north.
+    write_text(co, "p aux sp co 2\nv 1 0 95000000\nv 2 0 0\n");
+    REQUIRE_THROWS_AS(georoute::read_dimacs(gr, {co}), std::invalid_argument);
+
+    std::filesystem::remove(gr);
+    std::filesystem::remove(co);
+}
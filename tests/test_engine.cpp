@@ -3,6 +3,14 @@
 
 #include <nlohmann/json.hpp>
 
+#include <chrono>
+#include <exception>
+#include <future>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
 #include "georoute/engine.hpp"
 #include "georoute/graph.hpp"
 #include "georoute/router.hpp"
@@ -23,7 +31,7 @@ TEST_CASE("GeoRouteEngine computes routes with stats", "[engine]") {
     
     REQUIRE(response.result.reachable);
     REQUIRE(response.result.total_travel_time == Catch::Approx(2.0F));
-    REQUIRE(response.result.nodes == std::vector<georoute::node_id>{0, 1, 3});
+    REQUIRE(response.result.nodes == std::pmr::vector<georoute::node_id>{0, 1, 3});
     REQUIRE(response.compute_time_us >= 0.0);
     REQUIRE(response.expanded_nodes > 0);
     
@@ -31,6 +39,10 @@ TEST_CASE("GeoRouteEngine computes routes with stats", "[engine]") {
     REQUIRE(stats.total_queries == 1);
     REQUIRE(stats.total_updates == 0);
     REQUIRE(stats.total_compute_time_us >= 0.0);
+    REQUIRE(stats.total_expanded_nodes == response.expanded_nodes);
+    REQUIRE(stats.total_relaxed_edges > 0);
+    REQUIRE(stats.p50_compute_time_us <= stats.max_compute_time_us);
+    REQUIRE(engine.compute_time_histogram().total_count == 1);
 }
 
 TEST_CASE("GeoRouteEngine applies congestion updates", "[engine]") {
@@ -46,13 +58,13 @@ TEST_CASE("GeoRouteEngine applies congestion updates", "[engine]") {
 
     const auto baseline = engine.route(0, 3);
     REQUIRE(baseline.result.total_travel_time == Catch::Approx(2.0F));
-    REQUIRE(baseline.result.nodes == std::vector<georoute::node_id>{0, 1, 3});
+    REQUIRE(baseline.result.nodes == std::pmr::vector<georoute::node_id>{0, 1, 3});
 
     engine.apply_congestion_update(0, 1, 2.5F);
 
     const auto congested = engine.route(0, 3);
     REQUIRE(congested.result.total_travel_time == Catch::Approx(3.0F));
-    REQUIRE(congested.result.nodes == std::vector<georoute::node_id>{0, 2, 3});
+    REQUIRE(congested.result.nodes == std::pmr::vector<georoute::node_id>{0, 2, 3});
 
     const auto stats = engine.get_stats();
     REQUIRE(stats.total_queries == 2);
@@ -75,7 +87,7 @@ TEST_CASE("GeoRouteEngine loads from JSON", "[engine]") {
 
     REQUIRE(response.result.reachable);
     REQUIRE(response.result.total_travel_time == Catch::Approx(2.0F));
-    REQUIRE(response.result.nodes == std::vector<georoute::node_id>{0, 1, 3});
+    REQUIRE(response.result.nodes == std::pmr::vector<georoute::node_id>{0, 1, 3});
     REQUIRE(response.expanded_nodes > 0);
 }
 
@@ -102,3 +114,196 @@ TEST_CASE("GeoRouteEngine tracks stats across multiple queries", "[engine]") {
     REQUIRE(reset_stats.total_compute_time_us == 0.0);
 }
 
+TEST_CASE("GeoRouteEngine applies congestion batches", "[engine]") {
+    georoute::Graph graph{4};
+    graph.add_edge(0, 1, 1.0F);  // edge 0
+    graph.add_edge(1, 3, 1.0F);  // edge 1
+    graph.add_edge(0, 2, 2.0F);  // edge 2
+    graph.add_edge(2, 3, 1.0F);  // edge 3
+
+    georoute::SegmentTree tree{graph.edge_count()};
+    georoute::Router router{std::move(graph), std::move(tree)};
+    georoute::GeoRouteEngine engine{std::move(router)};
+
+    const std::vector<georoute::CongestionUpdate> updates{{0, 0, 2.5F}, {1, 1, 2.5F}, {0, 1, 1.0F}};
+    const auto batch = engine.apply_congestion_updates(updates);
+    REQUIRE(batch.updates == 3);
+    REQUIRE(batch.merged_ranges == 1);
+    REQUIRE(batch.apply_time_us >= 0.0);
+    REQUIRE(batch.epoch == 1);
+
+    const auto congested = engine.route(0, 3);
+    REQUIRE(congested.result.total_travel_time == Catch::Approx(3.0F));
+    REQUIRE(congested.result.nodes == std::pmr::vector<georoute::node_id>{0, 2, 3});
+    REQUIRE(congested.congestion_epoch == 1);
+
+    const auto before = engine.route_at_epoch(0, 0, 3);
+    REQUIRE(before.result.total_travel_time == Catch::Approx(2.0F));
+    REQUIRE(before.congestion_epoch == 0);
+
+    const std::vector<georoute::CongestionUpdate> invalid{{0, 0, 2.0F}, {2, 4, 2.0F}};
+    REQUIRE_THROWS_AS(engine.apply_congestion_updates(invalid), std::out_of_range);
+    REQUIRE(engine.current_epoch() == 1);
+
+    const auto stats = engine.get_stats();
+    REQUIRE(stats.total_updates == 3);
+    REQUIRE(stats.total_update_batches == 1);
+}
+
+TEST_CASE("GeoRouteEngine routes asynchronously and in batches on its worker pool", "[engine]") {
+    georoute::Graph graph{4};
+    graph.add_edge(0, 1, 1.0F);  // edge 0
+    graph.add_edge(1, 3, 1.0F);  // edge 1
+    graph.add_edge(0, 2, 2.0F);  // edge 2
+    graph.add_edge(2, 3, 1.0F);  // edge 3
+
+    georoute::SegmentTree tree{graph.edge_count()};
+    georoute::Router router{std::move(graph), std::move(tree)};
+    georoute::GeoRouteEngine engine{std::move(router)};
+    engine.set_worker_threads(2);
+
+    auto future = engine.route_async(0, 3);
+    const auto response = future.get();
+    REQUIRE(response.result.nodes == std::pmr::vector<georoute::node_id>{0, 1, 3});
+    REQUIRE(engine.worker_threads() == 2);
+    REQUIRE_THROWS_AS(engine.set_worker_threads(4), std::logic_error);
+    REQUIRE_THROWS_AS(engine.route_async(0, 9), std::out_of_range);
+
+    std::promise<float> callback_result;
+    engine.route_async(0, 2, [&callback_result](georoute::RouteResponse routed, std::exception_ptr error) {
+        REQUIRE_FALSE(error);
+        callback_result.set_value(routed.result.total_travel_time);
+    });
+    REQUIRE(callback_result.get_future().get() == Catch::Approx(2.0F));
+
+    std::vector<georoute::RouteQuery> queries;
+    for (georoute::node_id source = 0; source < 4; ++source) {
+        for (georoute::node_id target = 0; target < 4; ++target) {
+            queries.push_back(georoute::RouteQuery{source, target});
+        }
+    }
+    const auto batch = engine.route_batch(queries);
+    REQUIRE(batch.size() == queries.size());
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        const auto expected = engine.route(queries[i].source, queries[i].target);
+        REQUIRE(batch[i].result.nodes == expected.result.nodes);
+        REQUIRE(batch[i].result.reachable == expected.result.reachable);
+    }
+
+    const std::vector<georoute::RouteQuery> invalid{{0, 3}, {4, 0}};
+    REQUIRE_THROWS_AS(engine.route_batch(invalid), std::out_of_range);
+    REQUIRE(engine.get_stats().total_queries == 2 + 2 * queries.size());
+}
+
+TEST_CASE("GeoRouteEngine passes route_async failures to the callback", "[engine]") {
+    georoute::Graph graph{4};
+    graph.add_edge(0, 1, 1.0F);
+    graph.add_edge(1, 3, 1.0F);
+    georoute::GeoRouteEngine engine{georoute::Router{std::move(graph), georoute::SegmentTree{2}}};
+    engine.set_worker_threads(1);
+
+    // Hold the only worker so the graph can shrink after node 3 was checked.
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::promise<void> holding;
+    engine.route_async(0, 1, [&holding, released](georoute::RouteResponse, std::exception_ptr) {
+        holding.set_value();
+        released.wait();
+    });
+    holding.get_future().wait();
+
+    std::promise<std::exception_ptr> outcome;
+    engine.route_async(0, 3, [&outcome](georoute::RouteResponse, std::exception_ptr error) {
+        outcome.set_value(error);
+    });
+    georoute::Graph smaller{2};
+    smaller.add_edge(0, 1, 1.0F);
+    engine.swap_router(georoute::Router{std::move(smaller), georoute::SegmentTree{1}});
+    release.set_value();
+
+    const auto error = outcome.get_future().get();
+    REQUIRE(error);
+    REQUIRE_THROWS_AS(std::rethrow_exception(error), std::out_of_range);
+}
+
+TEST_CASE("GeoRouteEngine reports and counts budget-limited searches", "[engine]") {
+    georoute::Graph graph{600};
+    for (georoute::node_id i = 0; i + 1 < 600; ++i) {
+        graph.add_edge(i, i + 1, 1.0F);
+    }
+
+    georoute::SegmentTree tree{graph.edge_count()};
+    georoute::Router router{std::move(graph), std::move(tree)};
+    georoute::GeoRouteEngine engine{std::move(router)};
+
+    const auto capped = engine.route(0, 599, georoute::SearchBudget::within(std::chrono::milliseconds{0}, 10));
+    REQUIRE(capped.status == georoute::RouteStatus::node_budget_exceeded);
+    REQUIRE(capped.expanded_nodes == 10);
+
+    georoute::SearchBudget expired;
+    expired.deadline = std::chrono::steady_clock::now();
+    const std::vector<georoute::RouteQuery> queries{{0, 599}, {0, 1}};
+    const auto batch = engine.route_batch(queries, expired);
+    REQUIRE(batch[0].status == georoute::RouteStatus::deadline_exceeded);
+    REQUIRE(batch[1].status == georoute::RouteStatus::complete);
+    REQUIRE(batch[1].result.reachable);
+
+    const auto stats = engine.get_stats();
+    REQUIRE(stats.total_queries == 3);
+    REQUIRE(stats.total_node_budget_exceeded == 1);
+    REQUIRE(stats.total_deadline_exceeded == 1);
+}
+
+TEST_CASE("GeoRouteEngine hot-swaps its router while queries run", "[engine]") {
+    const auto diamond = [](float via_one) {
+        georoute::Graph graph{4};
+        graph.add_edge(0, 1, via_one);  // edge 0
+        graph.add_edge(1, 3, 1.0F);     // edge 1
+        graph.add_edge(0, 2, 2.0F);     // edge 2
+        graph.add_edge(2, 3, 1.0F);     // edge 3
+        georoute::SegmentTree tree{graph.edge_count()};
+        return georoute::Router{std::move(graph), std::move(tree)};
+    };
+
+    georoute::GeoRouteEngine engine{diamond(1.0F)};
+    engine.apply_congestion_update(0, 0, 4.0F);
+    REQUIRE(engine.route(0, 3).result.nodes == std::pmr::vector<georoute::node_id>{0, 2, 3});
+
+    std::atomic<bool> stop{false};
+    std::atomic<std::size_t> unreachable{0};
+    std::thread reader{[&] {
+        while (!stop.load()) {
+            if (!engine.route(0, 3).result.reachable) {
+                unreachable.fetch_add(1);
+            }
+        }
+    }};
+
+    // Same edge ids, new base times: factors carry over.
+    auto carried = engine.swap_router(diamond(0.5F), true);
+    REQUIRE(carried.congestion_carried);
+    REQUIRE(carried.edge_count == 4);
+    REQUIRE(carried.next_memory_bytes > 0);
+    REQUIRE(engine.route(0, 3).result.total_travel_time == Catch::Approx(3.0F));
+
+    auto reset = engine.swap_router(diamond(0.5F), false);
+    REQUIRE_FALSE(reset.congestion_carried);
+    REQUIRE(reset.epoch == 0);
+    REQUIRE(engine.route(0, 3).result.total_travel_time == Catch::Approx(1.5F));
+
+    // A larger graph: edge ids differ, so nothing is carried.
+    georoute::Graph larger{5};
+    larger.add_edge(0, 4, 1.0F);
+    larger.add_edge(4, 3, 1.0F);
+    georoute::SegmentTree tree{larger.edge_count()};
+    const auto grown = engine.swap_router(georoute::Router{std::move(larger), std::move(tree)}, true);
+    REQUIRE_FALSE(grown.congestion_carried);
+    REQUIRE(engine.node_count() == 5);
+    REQUIRE(engine.route(0, 3).result.nodes == std::pmr::vector<georoute::node_id>{0, 4, 3});
+
+    stop.store(true);
+    reader.join();
+    REQUIRE(unreachable.load() == 0);
+    REQUIRE(carried.previous.expired());
+    REQUIRE(grown.previous.expired());
+}
@@ -0,0 +1,144 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "georoute/engine_stats.hpp"
+
+TEST_CASE("LatencyBuckets map values into contiguous log-linear buckets", "[engine_stats]") {
+    using georoute::LatencyBuckets;
+
+    for (std::uint64_t value = 0; value < 64; ++value) {
+        REQUIRE(LatencyBuckets::index(value) == value);
+    }
+    REQUIRE(LatencyBuckets::index(64) == 64);
+    REQUIRE(LatencyBuckets::index(65) == 64);
+    REQUIRE(LatencyBuckets::index(127) == 95);
+    REQUIRE(LatencyBuckets::index(128) == 96);
+    REQUIRE(LatencyBuckets::index(std::uint64_t{1} << 50) == LatencyBuckets::count - 1);
+
+    // Buckets tile the value range without gaps and bound the relative error.
+    for (std::size_t i = 1; i < LatencyBuckets::count; ++i) {
+        REQUIRE(LatencyBuckets::lower_bound(i) == LatencyBuckets::upper_bound(i - 1) + 1);
+        REQUIRE(LatencyBuckets::index(LatencyBuckets::lower_bound(i)) == i);
+        REQUIRE(LatencyBuckets::index(LatencyBuckets::upper_bound(i)) == i);
+        const auto width = LatencyBuckets::upper_bound(i) - LatencyBuckets::lower_bound(i) + 1;
+        REQUIRE(static_cast<double>(width) <= static_cast<double>(LatencyBuckets::lower_bound(i)) / 32.0 + 1.0);
+    }
+}
+
+TEST_CASE("EngineStatsRecorder aggregates counters and percentiles", "[engine_stats]") {
+    georoute::EngineStatsRecorder recorder;
+    for (std::uint64_t us = 1; us <= 1000; ++us) {
+        recorder.record_route(us * 1000, 10, 40);
+    }
+    recorder.record_updates(5, 1);
+    recorder.record_updates(1, 0);
+
+    const auto stats = recorder.aggregate();
+    REQUIRE(stats.total_queries == 1000);
+    REQUIRE(stats.total_updates == 6);
+    REQUIRE(stats.total_update_batches == 1);
+    REQUIRE(stats.total_expanded_nodes == 10000);
+    REQUIRE(stats.total_relaxed_edges == 40000);
+    REQUIRE(stats.total_compute_time_us == Catch::Approx(500500.0));
+    REQUIRE(stats.max_compute_time_us == Catch::Approx(1000.0));
+    REQUIRE(stats.p50_compute_time_us == Catch::Approx(500.0).epsilon(0.035));
+    REQUIRE(stats.p90_compute_time_us == Catch::Approx(900.0).epsilon(0.035));
+    REQUIRE(stats.p99_compute_time_us == Catch::Approx(990.0).epsilon(0.035));
+    REQUIRE(stats.p999_compute_time_us <= stats.max_compute_time_us);
+
+    const auto histogram = recorder.compute_time_histogram();
+    REQUIRE(histogram.total_count == 1000);
+    REQUIRE(histogram.percentile_ns(1.0) == 1000000);
+
+    recorder.reset();
+    const auto reset = recorder.aggregate();
+    REQUIRE(reset.total_queries == 0);
+    REQUIRE(reset.total_compute_time_us == 0.0);
+    REQUIRE(reset.p99_compute_time_us == 0.0);
+}
+
+TEST_CASE("EngineStatsRecorder counts every record from concurrent threads", "[engine_stats]") {
+    georoute::EngineStatsRecorder recorder;
+    constexpr std::size_t threads = 8;
+    constexpr std::uint64_t per_thread = 20000;
+
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&recorder, t] {
+            for (std::uint64_t i = 0; i < per_thread; ++i) {
+                recorder.record_route(1000 + t, 2, 3);
+                recorder.record_updates(1, 1);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    const auto stats = recorder.aggregate();
+    REQUIRE(stats.total_queries == threads * per_thread);
+    REQUIRE(stats.total_expanded_nodes == 2 * threads * per_thread);
+    REQUIRE(stats.total_relaxed_edges == 3 * threads * per_thread);
+    REQUIRE(stats.total_updates == threads * per_thread);
+    REQUIRE(recorder.compute_time_histogram().total_count == threads * per_thread);
+    REQUIRE(stats.max_compute_time_us == Catch::Approx(1.007));
+}
+
+TEST_CASE("MetricHistogram counts values into fixed buckets", "[engine_stats]") {
+    const std::array<std::uint64_t, 2> bounds{10, 100};
+    georoute::MetricHistogram histogram{bounds};
+    for (const std::uint64_t value : {0, 10, 11, 100, 101, 5000}) {
+        histogram.observe(value);
+    }
+    auto snapshot = histogram.snapshot();
+    REQUIRE(snapshot.upper_bounds == std::vector<std::uint64_t>{10, 100});
+    REQUIRE(snapshot.counts == std::vector<std::uint64_t>{2, 2, 2});
+    REQUIRE(snapshot.total_count == 6);
+    REQUIRE(snapshot.sum == 5222);
+
+    histogram.reset();
+    snapshot = histogram.snapshot();
+    REQUIRE(snapshot.total_count == 0);
+    REQUIRE(snapshot.counts == std::vector<std::uint64_t>{0, 0, 0});
+
+    const std::array<std::uint64_t, 2> descending{100, 10};
+    REQUIRE_THROWS_AS(georoute::MetricHistogram{descending}, std::invalid_argument);
+    const std::vector<std::uint64_t> too_many(georoute::MetricHistogram::max_bounds + 1, 1);
+    REQUIRE_THROWS_AS(georoute::MetricHistogram{too_many}, std::invalid_argument);
+}
+
+TEST_CASE("EngineStatsRecorder buckets search work and update apply time", "[engine_stats]") {
+    georoute::EngineStatsRecorder recorder;
+    recorder.record_route(1000, 1, 2);
+    recorder.record_route(1000, 500, 2000);
+    recorder.record_updates(10, 1, 25'000, 3'000);
+    recorder.record_updates(1, 0);
+
+    const auto expanded = recorder.expanded_nodes_histogram();
+    REQUIRE(expanded.total_count == 2);
+    REQUIRE(expanded.sum == 501);
+    REQUIRE(expanded.counts.front() == 1);
+    REQUIRE(expanded.counts.size() == expanded.upper_bounds.size() + 1);
+
+    const auto relaxed = recorder.relaxed_edges_histogram();
+    REQUIRE(relaxed.total_count == 2);
+    REQUIRE(relaxed.sum == 2002);
+
+    const auto apply = recorder.update_apply_histogram();
+    REQUIRE(apply.total_count == 1);
+    REQUIRE(apply.sum == 25'000);
+    const auto lock_wait = recorder.update_lock_wait_histogram();
+    REQUIRE(lock_wait.total_count == 1);
+    REQUIRE(lock_wait.sum == 3'000);
+
+    recorder.reset();
+    REQUIRE(recorder.expanded_nodes_histogram().total_count == 0);
+    REQUIRE(recorder.update_apply_histogram().total_count == 0);
+    REQUIRE(recorder.update_lock_wait_histogram().total_count == 0);
+}
@@ -0,0 +1,153 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "georoute/graph_generator.hpp"
+
+namespace {
+
+std::size_t reachable_from(const georoute::Graph& graph, georoute::node_id source) {
+    std::vector<bool> seen(graph.node_count(), false);
+    std::deque<georoute::node_id> frontier{source};
+    seen[source] = true;
+    std::size_t count = 1;
+    while (!frontier.empty()) {
+        const auto u = frontier.front();
+        frontier.pop_front();
+        for (const auto& edge : graph.neighbors(u)) {
+            if (!seen[edge.to]) {
+                seen[edge.to] = true;
+                ++count;
+                frontier.push_back(edge.to);
+            }
+        }
+    }
+    return count;
+}
+
+std::set<std::pair<georoute::node_id, georoute::node_id>> arcs(const georoute::Graph& graph) {
+    std::set<std::pair<georoute::node_id, georoute::node_id>> out;
+    for (georoute::node_id u = 0; u < graph.node_count(); ++u) {
+        for (const auto& edge : graph.neighbors(u)) {
+            out.emplace(u, edge.to);
+        }
+    }
+    return out;
+}
+
+}  // namespace
+
+TEST_CASE("Graph generators are deterministic for a seed", "[graph_generator]") {
+    for (const auto type : {georoute::GraphType::geometric, georoute::GraphType::highway, georoute::GraphType::city}) {
+        const auto first = georoute::generate_graph(type, 24, 7);
+        const auto again = georoute::generate_graph(type, 24, 7);
+        const auto other = georoute::generate_graph(type, 24, 8);
+        REQUIRE(first.node_count() == 24 * 24);
+        REQUIRE(first.same_edge_ids(again));
+        REQUIRE(first.base_travel_times() == again.base_travel_times());
+        REQUIRE(first.base_travel_times() != other.base_travel_times());
+        REQUIRE(first.coordinates());
+        REQUIRE(first.coordinates()->size() == first.node_count());
+    }
+
+    // The baseline grid ignores the seed and carries no coordinates.
+    const auto grid = georoute::generate_graph(georoute::GraphType::grid, 4, 1);
+    REQUIRE(grid.node_count() == 16);
+    REQUIRE(grid.edge_count() == 48);
+    REQUIRE(grid.base_travel_times() == georoute::make_grid_graph(4, 4).base_travel_times());
+    REQUIRE_FALSE(grid.coordinates());
+
+    for (const auto name : {"grid", "geometric", "highway", "city"}) {
+        REQUIRE(georoute::graph_type_name(georoute::parse_graph_type(name)) == name);
+    }
+    REQUIRE_THROWS_AS(georoute::parse_graph_type("osm"), std::invalid_argument);
+    REQUIRE(georoute::make_geometric_graph(0, 1).node_count() == 0);
+}
+
+TEST_CASE("Geometric graphs are planar, connected and road-like", "[graph_generator]") {
+    const auto graph = georoute::make_geometric_graph(400, 42);
+    REQUIRE(graph.node_count() == 400);
+    REQUIRE(reachable_from(graph, 0) == graph.node_count());
+
+    const auto& coordinates = *graph.coordinates();
+    std::vector<std::pair<georoute::node_id, georoute::node_id>> streets;
+    std::size_t dead_ends = 0;
+    for (georoute::node_id u = 0; u < graph.node_count(); ++u) {
+        const auto degree = graph.neighbors(u).size();
+        REQUIRE(degree >= 1);
+        REQUIRE(degree <= 8);
+        dead_ends += degree == 1 ? 1 : 0;
+        for (const auto& edge : graph.neighbors(u)) {
+            REQUIRE(edge.base_travel_time > 0.0F);
+            if (u < edge.to) {
+                streets.emplace_back(u, edge.to);
+            }
+        }
+    }
+    // Every street is two-way.
+    REQUIRE(streets.size() * 2 == graph.edge_count());
+    const double mean_degree = static_cast<double>(graph.edge_count()) / static_cast<double>(graph.node_count());
+    REQUIRE(mean_degree > 2.4);
+    REQUIRE(mean_degree < 3.6);
+    REQUIRE(dead_ends > 0);
+
+    const auto turn = [&coordinates](georoute::node_id a, georoute::node_id b, georoute::node_id c) {
+        const double cross = (coordinates[b].lon - coordinates[a].lon) * (coordinates[c].lat - coordinates[a].lat) -
+                             (coordinates[b].lat - coordinates[a].lat) * (coordinates[c].lon - coordinates[a].lon);
+        return (cross > 0.0) - (cross < 0.0);
+    };
+    std::size_t crossings = 0;
+    for (std::size_t i = 0; i < streets.size(); ++i) {
+        for (std::size_t j = i + 1; j < streets.size(); ++j) {
+            const auto [a, b] = streets[i];
+            const auto [c, d] = streets[j];
+            if (turn(a, b, c) * turn(a, b, d) < 0 && turn(c, d, a) * turn(c, d, b) < 0) {
+                ++crossings;
+            }
+        }
+    }
+    REQUIRE(crossings == 0);
+}
+
+TEST_CASE("Highway grids add fast long-range edges", "[graph_generator]") {
+    const auto graph = georoute::make_highway_grid(40, 40, 3);
+    REQUIRE(reachable_from(graph, 0) == graph.node_count());
+
+    // Row 16 is a highway: interchange (16, 0) links straight to (16, 8).
+    const georoute::node_id interchange = 16 * 40;
+    const auto& edges = graph.neighbors(interchange);
+    const auto highway = std::find_if(edges.begin(), edges.end(), [](const georoute::Edge& edge) {
+        return edge.to == 16 * 40 + 8;
+    });
+    REQUIRE(highway != edges.end());
+
+    // Eight local blocks take longer than one highway hop.
+    float slowest_local = 0.0F;
+    for (const auto& edge : graph.neighbors(1 * 40 + 1)) {
+        slowest_local = std::max(slowest_local, edge.base_travel_time);
+    }
+    REQUIRE(highway->base_travel_time < 8 * slowest_local);
+    REQUIRE(graph.edge_count() > georoute::make_grid_graph(40, 40).edge_count());
+}
+
+TEST_CASE("City grids are mostly one-way with unreachable pockets", "[graph_generator]") {
+    const auto graph = georoute::make_city_grid(60, 60, 11);
+    const auto all = arcs(graph);
+    std::size_t one_way = 0;
+    for (const auto& [u, v] : all) {
+        one_way += all.count({v, u}) == 0 ? 1 : 0;
+    }
+    REQUIRE(one_way * 2 > all.size());
+
+    std::size_t unreachable_sources = 0;
+    for (georoute::node_id u = 0; u < graph.node_count(); u += 97) {
+        unreachable_sources += reachable_from(graph, u) < graph.node_count() ? 1 : 0;
+    }
+    REQUIRE(unreachable_sources > 0);
+}
@@ -0,0 +1,130 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+#include "georoute/engine.hpp"
+#include "georoute/graph_reloader.hpp"
+#include "georoute/router.hpp"
+
+namespace {
+
+std::filesystem::path temp_directory(const std::string& name) {
+    const auto path = std::filesystem::temp_directory_path() /
+                      ("georoute_reload_" + std::to_string(::getpid()) + "_" + name);
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path / "graphs");
+    return path;
+}
+
+void write_text(const std::filesystem::path& path, const std::string& text) {
+    std::ofstream output{path, std::ios::binary | std::ios::trunc};
+    output << text;
+}
+
+georoute::GraphReloadStatus wait_for_reload(const georoute::GraphReloader& reloader) {
+    const auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    auto status = reloader.status();
+    while (status.state == georoute::GraphReloadState::running && std::chrono::steady_clock::now() < give_up) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        status = reloader.status();
+    }
+    return status;
+}
+
+}  // namespace
+
+TEST_CASE("GraphReloader loads on its own thread and reports the outcome", "[graph_reloader]") {
+    const auto dir = temp_directory("async");
+    const auto first = dir / "graphs" / "first.gr";
+    const auto second = dir / "graphs" / "second.gr";
+    write_text(first, "p sp 2 1\na 1 2 10\n");
+    write_text(second, "p sp 3 2\na 1 2 10\na 2 3 10\n");
+
+    georoute::GeoRouteEngine engine{georoute::Router::from_file(first.string())};
+    georoute::GraphReloader reloader{engine, first.string()};
+    REQUIRE(reloader.status().state == georoute::GraphReloadState::idle);
+
+    REQUIRE(reloader.start(second.string()));
+    auto status = wait_for_reload(reloader);
+    REQUIRE(status.state == georoute::GraphReloadState::succeeded);
+    REQUIRE(status.path == std::filesystem::canonical(second).string());
+    REQUIRE(status.report);
+    REQUIRE(status.report->swap.node_count == 3);
+    REQUIRE(engine.node_count() == 3);
+    REQUIRE(reloader.graph_path() == std::filesystem::canonical(second).string());
+    REQUIRE(reloader.reloads() == 1);
+
+    // A file that fails to load leaves the current graph in place.
+    REQUIRE(reloader.start((dir / "graphs" / "missing.gr").string()));
+    status = wait_for_reload(reloader);
+    REQUIRE(status.state == georoute::GraphReloadState::failed);
+    REQUIRE_FALSE(status.error.empty());
+    REQUIRE_FALSE(status.report);
+    REQUIRE(engine.node_count() == 3);
+    REQUIRE(reloader.graph_path() == std::filesystem::canonical(second).string());
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("GraphReloader refuses files outside the graph directory", "[graph_reloader]") {
+    const auto dir = temp_directory("outside");
+    const auto graph = dir / "graphs" / "graph.gr";
+    const auto outside = dir / "outside.gr";
+    write_text(graph, "p sp 2 1\na 1 2 10\n");
+    write_text(outside, "p sp 3 2\na 1 2 10\na 2 3 10\n");
+    std::filesystem::create_symlink(outside, dir / "graphs" / "link.gr");
+
+    georoute::GeoRouteEngine engine{georoute::Router::from_file(graph.string())};
+    georoute::GraphReloader reloader{engine, graph.string()};
+    REQUIRE(reloader.graph_directory() == std::filesystem::canonical(dir / "graphs"));
+
+    REQUIRE_THROWS_AS(reloader.reload(outside.string()), std::invalid_argument);
+    REQUIRE_THROWS_AS(reloader.reload((dir / "graphs" / ".." / "outside.gr").string()), std::invalid_argument);
+    REQUIRE_THROWS_AS(reloader.reload((dir / "graphs" / "link.gr").string()), std::invalid_argument);
+    REQUIRE_THROWS_AS(reloader.start("/etc/passwd"), std::invalid_argument);
+    REQUIRE(reloader.status().state == georoute::GraphReloadState::idle);
+    REQUIRE(engine.node_count() == 2);
+    REQUIRE(reloader.reloads() == 0);
+
+    // A link to a file inside the directory loads that file, and keeps
+    // loading it after the link is re-pointed outside.
+    const auto inside = dir / "graphs" / "inside.gr";
+    write_text(inside, "p sp 4 1\na 1 2 10\n");
+    std::filesystem::create_symlink(inside, dir / "graphs" / "current.gr");
+    const auto report = reloader.reload((dir / "graphs" / "current.gr").string());
+    REQUIRE(report);
+    REQUIRE(report->path == std::filesystem::canonical(inside).string());
+    REQUIRE(reloader.graph_path() == report->path);
+    std::filesystem::remove(dir / "graphs" / "current.gr");
+    std::filesystem::create_symlink(outside, dir / "graphs" / "current.gr");
+    REQUIRE(reloader.reload());
+    REQUIRE(engine.node_count() == 4);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("GraphReloader keeps the router settings for files without them", "[graph_reloader]") {
+    const auto dir = temp_directory("settings");
+    const auto json = dir / "graphs" / "graph.json";
+    const auto gr = dir / "graphs" / "graph.gr";
+    write_text(json, R"({"nodes": 2, "congestion_index": "blocked", "snapshot_history": 256,
+                         "edges": [{"from": 0, "to": 1, "base_travel_time": 10.0}]})");
+    write_text(gr, "p sp 2 1\na 1 2 10\n");
+
+    georoute::GeoRouteEngine engine{georoute::Router::from_file(json.string())};
+    georoute::GraphReloader reloader{engine, json.string()};
+    REQUIRE(reloader.reload(gr.string()));
+
+    const auto settings = engine.router_settings();
+    REQUIRE(settings.congestion_index == "blocked");
+    REQUIRE(settings.snapshot_history == 256);
+
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,100 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "georoute/graph_snapshot.hpp"
+
+namespace {
+
+std::string snapshot_path(const std::string& name) {
+    return (std::filesystem::temp_directory_path() /
+            ("georoute_graph_" + std::to_string(::getpid()) + "_" + name + ".snapshot"))
+        .string();
+}
+
+std::string read_bytes(const std::string& path) {
+    std::ifstream input{path, std::ios::binary};
+    return std::string{std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{}};
+}
+
+void write_bytes(const std::string& path, const std::string& bytes) {
+    std::ofstream output{path, std::ios::binary | std::ios::trunc};
+    output << bytes;
+}
+
+georoute::Graph build_graph() {
+    // Edge ids follow insertion order, not source node order.
+    georoute::Graph graph{4};
+    graph.add_edge(2, 3, 1.5F);  // edge 0
+    graph.add_edge(0, 1, 1.0F);  // edge 1
+    graph.add_edge(1, 3, 4.0F);  // edge 2
+    graph.add_edge(0, 2, 2.0F);  // edge 3
+    return graph;
+}
+
+}  // namespace
+
+TEST_CASE("Graph snapshots round-trip edges, ids and coordinates", "[graph_snapshot]") {
+    const auto path = snapshot_path("round_trip");
+    auto graph = build_graph();
+    georoute::write_graph_snapshot(graph, path);
+
+    auto loaded = georoute::load_graph_snapshot(path);
+    REQUIRE(loaded.node_count() == 4);
+    REQUIRE(loaded.edge_count() == 4);
+    REQUIRE(loaded.same_edge_ids(graph));
+    REQUIRE(loaded.base_travel_times() == graph.base_travel_times());
+    REQUIRE(loaded.neighbors(0).size() == 2);
+    REQUIRE(loaded.neighbors(0)[1].base_travel_time == 2.0F);
+    REQUIRE_FALSE(loaded.coordinates());
+
+    graph.set_coordinates({{52.5, 13.4}, {52.6, 13.5}, {-33.9, 151.2}, {0.0, 0.0}});
+    georoute::write_graph_snapshot(graph, path);
+    loaded = georoute::load_graph_snapshot(path);
+    REQUIRE(loaded.same_edge_ids(graph));
+    REQUIRE(loaded.coordinates());
+    REQUIRE(loaded.coordinates()->size() == 4);
+    REQUIRE((*loaded.coordinates())[2].lat == -33.9);
+    REQUIRE((*loaded.coordinates())[2].lon == 151.2);
+
+    const georoute::Graph empty{0};
+    georoute::write_graph_snapshot(empty, path);
+    REQUIRE(georoute::load_graph_snapshot(path).node_count() == 0);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Graph snapshots reject damaged files", "[graph_snapshot]") {
+    const auto path = snapshot_path("damaged");
+    REQUIRE_THROWS_AS(georoute::load_graph_snapshot(path), std::runtime_error);
+
+    georoute::write_graph_snapshot(build_graph(), path);
+    const auto bytes = read_bytes(path);
+
+    write_bytes(path, bytes.substr(0, bytes.size() - 1));
+    REQUIRE_THROWS_AS(georoute::load_graph_snapshot(path), std::runtime_error);
+
+    write_bytes(path, "GRCS" + bytes.substr(4));
+    REQUIRE_THROWS_AS(georoute::load_graph_snapshot(path), std::runtime_error);
+
+    // Header (32 bytes) and five offsets precede the first edge record, whose
+    // target comes first.
+    auto corrupt = bytes;
+    corrupt[32 + 5 * 8] = 9;
+    write_bytes(path, corrupt);
+    REQUIRE_THROWS_AS(georoute::load_graph_snapshot(path), std::invalid_argument);
+
+    // Two edges claiming the same id.
+    corrupt = bytes;
+    corrupt[32 + 5 * 8 + 8] = corrupt[32 + 5 * 8 + 12 + 8];
+    write_bytes(path, corrupt);
+    REQUIRE_THROWS_AS(georoute::load_graph_snapshot(path), std::invalid_argument);
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include "georoute/congestion_index.hpp"
+#include "georoute/engine.hpp"
+#include "georoute/graph.hpp"
+#include "georoute/router.hpp"
+
+// Graphs shared by the test files. Header-only; every function is inline.
+
+// Diamond with two routes from 0 to 3: 0 -> 1 -> 3 (cost 2) and 0 -> 2 -> 3
+// (cost 3). Edge ids follow the comments. Nodes past 3 (extra_nodes) have no
+// edges, so they are unreachable.
+inline georoute::Graph build_sample_graph(std::size_t extra_nodes = 0) {
+    georoute::Graph graph{4 + extra_nodes};
+    graph.add_edge(0, 1, 1.0F);  // edge 0
+    graph.add_edge(1, 3, 1.0F);  // edge 1
+    graph.add_edge(0, 2, 2.0F);  // edge 2
+    graph.add_edge(2, 3, 1.0F);  // edge 3
+    return graph;
+}
+
+inline georoute::GeoRouteEngine build_sample_engine(std::size_t extra_nodes = 0) {
+    auto graph = build_sample_graph(extra_nodes);
+    georoute::SegmentTree tree{graph.edge_count()};
+    return georoute::GeoRouteEngine{georoute::Router{std::move(graph), std::move(tree)}};
+}
+
+// Path 0 -> 1 -> ... -> nodes - 1; edge u joins u and u + 1.
+inline georoute::Graph build_line_graph(std::size_t nodes, float travel_time = 1.0F) {
+    georoute::Graph graph{nodes};
+    for (georoute::node_id u = 0; u + 1 < nodes; ++u) {
+        graph.add_edge(u, u + 1, travel_time);
+    }
+    return graph;
+}
+
+inline georoute::GeoRouteEngine build_line_engine(std::size_t nodes, float travel_time = 1.0F) {
+    auto graph = build_line_graph(nodes, travel_time);
+    auto congestion = georoute::CongestionIndex::make("segment_tree", graph.edge_count());
+    return georoute::GeoRouteEngine{georoute::Router{std::move(graph), std::move(congestion)}};
+}
@@ -0,0 +1,134 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <stop_token>
+#include <string>
+#include <thread>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "georoute/congestion_writer.hpp"
+#include "georoute/engine.hpp"
+#include "georoute/graph_reloader.hpp"
+#include "georoute/http_server.hpp"
+
+#include "test_graphs.hpp"
+
+namespace {
+
+// run_http_server does not report the port it bound, so pick one the kernel
+// just handed out.
+std::uint16_t free_loopback_port() {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    socklen_t length = sizeof(address);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+    ::close(fd);
+    return ntohs(address.sin_port);
+}
+
+// Serves engine on a loopback port until destroyed.
+class TestServer {
+public:
+    explicit TestServer(georoute::GeoRouteEngine& engine)
+        : writer_(engine), reloader_(engine, "graph.json"), port_(free_loopback_port()) {
+        georoute::HttpServerOptions options;
+        options.host = "127.0.0.1";
+        options.port = port_;
+        options.stop_token = stop_.get_token();
+        thread_ = std::jthread{[this, &engine, options] {
+            georoute::run_http_server(engine, writer_, reloader_, options);
+        }};
+
+        const auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+        while (!client().Get("/health") && std::chrono::steady_clock::now() < give_up) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        }
+    }
+
+    ~TestServer() {
+        stop_.request_stop();
+    }
+
+    [[nodiscard]] httplib::Client client() const {
+        return httplib::Client{"127.0.0.1", port_};
+    }
+
+    httplib::Result post(const std::string& path, const nlohmann::json& body) const {
+        return client().Post(path, body.dump(), "application/json");
+    }
+
+private:
+    georoute::CongestionWriter writer_;
+    georoute::GraphReloader reloader_;
+    std::uint16_t port_;
+    std::stop_source stop_;
+    std::jthread thread_;
+};
+
+}  // namespace
+
+TEST_CASE("Route batches reject node ids and limits outside uint32", "[http_server]") {
+    auto engine = build_sample_engine();
+    TestServer server{engine};
+
+    auto result = server.post("/api/v1/route/batch", {{"queries", {{{"source", 0}, {"target", 3}}}}});
+    REQUIRE(result);
+    REQUIRE(result->status == 200);
+
+    result = server.post("/api/v1/route/batch",
+                         {{"queries", {{{"source", 0}, {"target", 3}}, {{"source", 4294967296ULL}, {"target", -1}}}}});
+    REQUIRE(result);
+    REQUIRE(result->status == 400);
+    REQUIRE(nlohmann::json::parse(result->body).at("error").get<std::string>().find("queries[1].source") !=
+            std::string::npos);
+
+    result = server.post("/api/v1/route/batch", {{"queries", {{{"source", 0}, {"target", -1}}}}});
+    REQUIRE(result);
+    REQUIRE(result->status == 400);
+
+    result = server.post("/api/v1/route/batch",
+                         {{"queries", {{{"source", 0}, {"target", 3}}}}, {"max_settled_nodes", 4294967296ULL}});
+    REQUIRE(result);
+    REQUIRE(result->status == 400);
+    result = server.post("/api/v1/route/batch",
+                         {{"queries", {{{"source", 0}, {"target", 3}}}}, {"max_settled_nodes", -1}});
+    REQUIRE(result);
+    REQUIRE(result->status == 400);
+    result = server.post("/api/v1/route/batch",
+                         {{"queries", {{{"source", 0}, {"target", 3}}}}, {"timeout_ms", 18446744073709551615ULL}});
+    REQUIRE(result);
+    REQUIRE(result->status == 400);
+}
+
+TEST_CASE("Edge updates reject edge ids outside uint32", "[http_server]") {
+    auto engine = build_sample_engine();
+    TestServer server{engine};
+
+    const nlohmann::json wrapped{{"edge_id", 4294967296ULL}, {"factor", 3.0}};
+    auto result = server.post("/api/v1/congestion/edges", {{"edges", {{{"edge_id", 1}, {"factor", 2.0}}, wrapped}}});
+    REQUIRE(result);
+    REQUIRE(result->status == 400);
+    REQUIRE(nlohmann::json::parse(result->body).at("error").get<std::string>().find("edges[1].edge_id") !=
+            std::string::npos);
+    result = server.post("/api/v1/congestion/edges", {{"edges", {{{"edge_id", -1}, {"factor", 2.0}}}}});
+    REQUIRE(result);
+    REQUIRE(result->status == 400);
+    // Nothing was applied, edge 0 included.
+    REQUIRE(engine.route(0, 3).result.total_travel_time == Catch::Approx(2.0F));
+
+    result = server.post("/api/v1/congestion/edges", {{"edges", {{{"edge_id", 0}, {"factor", 3.0}}}}});
+    REQUIRE(result);
+    REQUIRE(result->status == 200);
+    REQUIRE(engine.route(0, 3).result.total_travel_time == Catch::Approx(3.0F));
+}
@@ -0,0 +1,108 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+#include "georoute/http_worker_pool.hpp"
+
+namespace {
+
+// Spins until predicate holds, for state changed on pool threads.
+template <typename Predicate>
+bool eventually(Predicate predicate) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE("HttpWorkerPool runs submitted jobs on its workers", "[http_worker_pool]") {
+    georoute::HttpWorkerPool pool{2, 4};
+    std::atomic<int> done{0};
+    std::atomic<bool> shed_seen{false};
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(pool.submit([&] {
+            shed_seen = shed_seen || georoute::HttpWorkerPool::shedding();
+            ++done;
+        }));
+    }
+    REQUIRE(eventually([&] { return done == 4; }));
+    REQUIRE_FALSE(shed_seen);
+    REQUIRE_FALSE(georoute::HttpWorkerPool::shedding());
+
+    const auto stats = pool.stats();
+    REQUIRE(stats.threads == 2);
+    REQUIRE(stats.max_queued == 4);
+    REQUIRE(stats.accepted_total == 4);
+    REQUIRE(stats.shed_total == 0);
+}
+
+TEST_CASE("HttpWorkerPool sheds jobs past a full queue", "[http_worker_pool]") {
+    georoute::HttpWorkerPool pool{1, 1};
+    std::promise<void> release_worker;
+    auto worker_released = release_worker.get_future().share();
+    std::promise<void> release_shed;
+    auto shed_released = release_shed.get_future().share();
+
+    std::atomic<int> ran{0};
+    REQUIRE(pool.submit([&] {
+        worker_released.wait();
+        ++ran;
+    }));
+    REQUIRE(eventually([&] { return pool.stats().active == 1; }));
+    REQUIRE(pool.submit([&] { ++ran; }));  // waits in the queue
+
+    std::atomic<bool> shed_flag{false};
+    REQUIRE(pool.submit([&] {
+        shed_flag = georoute::HttpWorkerPool::shedding();
+        shed_released.wait();
+    }));
+    REQUIRE(eventually([&] { return shed_flag.load(); }));
+    // The shed queue holds 16 x max_queued jobs.
+    for (int i = 0; i < 16; ++i) {
+        REQUIRE(pool.submit([] {}));
+    }
+    REQUIRE_FALSE(pool.submit([] {}));
+
+    auto stats = pool.stats();
+    REQUIRE(stats.queued == 1);
+    REQUIRE(stats.accepted_total == 2);
+    REQUIRE(stats.shed_total == 17);
+    REQUIRE(stats.dropped_total == 1);
+
+    release_shed.set_value();
+    release_worker.set_value();
+    REQUIRE(eventually([&] { return ran == 2; }));
+    stats = pool.stats();
+    REQUIRE(stats.queued == 0);
+    REQUIRE(eventually([&] { return pool.stats().active == 0; }));
+}
+
+TEST_CASE("HttpWorkerPool without a bound never sheds", "[http_worker_pool]") {
+    georoute::HttpWorkerPool pool{1, 0};
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::atomic<int> ran{0};
+    REQUIRE(pool.submit([&] { released.wait(); }));
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(pool.submit([&] { ++ran; }));
+    }
+    REQUIRE(pool.stats().shed_total == 0);
+    release.set_value();
+    pool.shutdown();
+    REQUIRE(ran == 100);
+    REQUIRE_FALSE(pool.submit([] {}));
+}
+
+TEST_CASE("HttpWorkerPool needs a worker thread", "[http_worker_pool]") {
+    REQUIRE_THROWS_AS(georoute::HttpWorkerPool(0, 8), std::invalid_argument);
+}
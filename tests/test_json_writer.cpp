@@ -0,0 +1,116 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "georoute/json_writer.hpp"
+#include "georoute/response_json.hpp"
+
+TEST_CASE("JsonWriter separates nested members and elements", "[json_writer]") {
+    std::string out;
+    georoute::JsonWriter writer{out};
+    writer.begin_object()
+        .field("a", 1)
+        .key("b")
+        .begin_array()
+        .value(true)
+        .null()
+        .begin_object()
+        .end_object()
+        .begin_array()
+        .end_array()
+        .end_array()
+        .field("c", "x")
+        .end_object();
+    REQUIRE(out == R"({"a":1,"b":[true,null,{},[]],"c":"x"})");
+}
+
+TEST_CASE("JsonWriter formats numbers with to_chars", "[json_writer]") {
+    std::string out;
+    georoute::JsonWriter writer{out};
+    writer.begin_array()
+        .value(std::numeric_limits<std::uint64_t>::max())
+        .value(std::int64_t{-42})
+        .value(22.5F)
+        .value(0.1F)
+        .value(2.0)
+        .value(1e21)
+        .value(std::numeric_limits<double>::infinity())
+        .end_array();
+    REQUIRE(out == "[18446744073709551615,-42,22.5,0.1,2.0,1e+21,null]");
+
+    const auto parsed = nlohmann::json::parse(out);
+    REQUIRE(parsed[2].get<double>() == 22.5);
+    REQUIRE(parsed[4].is_number_float());
+}
+
+TEST_CASE("JsonWriter writes integer arrays in place", "[json_writer]") {
+    const std::vector<std::uint32_t> empty;
+    const std::vector<std::uint32_t> ids{0, 7, 4294967295U};
+    std::string out;
+    georoute::JsonWriter writer{out};
+    writer.begin_object().field("empty", std::span{empty}).field("ids", std::span{ids}).end_object();
+    REQUIRE(out == R"({"empty":[],"ids":[0,7,4294967295]})");
+}
+
+TEST_CASE("JsonWriter escapes strings", "[json_writer]") {
+    std::string out;
+    georoute::JsonWriter writer{out};
+    writer.value(std::string_view{"q\"b\\n\n\t\x01\xc3\xa9", 10});
+    REQUIRE(out == "\"q\\\"b\\\\n\\n\\t\\u0001\xc3\xa9\"");
+    REQUIRE(nlohmann::json::parse(out).get<std::string>() == std::string{"q\"b\\n\n\t\x01\xc3\xa9"});
+}
+
+TEST_CASE("JsonWriter rejects unbalanced and over-deep nesting", "[json_writer]") {
+    std::string out;
+    georoute::JsonWriter writer{out};
+    REQUIRE_THROWS_AS(writer.end_array(), std::logic_error);
+    for (std::size_t i = 0; i < georoute::JsonWriter::max_depth; ++i) {
+        writer.begin_array();
+    }
+    REQUIRE_THROWS_AS(writer.begin_array(), std::logic_error);
+}
+
+TEST_CASE("Route response fields parse back to the result", "[json_writer]") {
+    georoute::RouteResponse response;
+    response.result.nodes = {3, 1, 4};
+    response.result.total_travel_time = 12.25F;
+    response.result.reachable = true;
+    response.expanded_nodes = 9;
+    response.compute_time_us = 1.5;
+    response.congestion_epoch = 6;
+
+    std::string out;
+    georoute::JsonWriter writer{out};
+    writer.begin_object();
+    georoute::write_route_fields(writer, 3, 4, response);
+    writer.end_object();
+
+    const auto parsed = nlohmann::json::parse(out);
+    REQUIRE(parsed.at("src") == 3);
+    REQUIRE(parsed.at("dst") == 4);
+    REQUIRE(parsed.at("distance").get<double>() == 12.25);
+    REQUIRE(parsed.at("eta_ms") == 12250);
+    REQUIRE(parsed.at("path") == nlohmann::json::array({3, 1, 4}));
+    REQUIRE(parsed.at("reachable") == true);
+    REQUIRE(parsed.at("epoch") == 6);
+    REQUIRE(parsed.at("stats").at("expanded_nodes") == 9);
+    REQUIRE(parsed.at("stats").at("compute_us").get<double>() == 1.5);
+
+    out.clear();
+    georoute::JsonWriter without_path{out};
+    without_path.begin_object();
+    georoute::write_route_fields(without_path, 3, 4, response, false);
+    without_path.end_object();
+    REQUIRE_FALSE(nlohmann::json::parse(out).contains("path"));
+
+    out.clear();
+    georoute::JsonWriter error{out};
+    georoute::write_error(error, "bad \"id\"");
+    REQUIRE(out == R"({"error":"bad \"id\""})");
+}
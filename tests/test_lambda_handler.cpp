@@ -0,0 +1,197 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "georoute/engine.hpp"
+#include "georoute/graph_snapshot.hpp"
+#include "georoute/lambda_handler.hpp"
+
+#include "test_graphs.hpp"
+
+namespace {
+
+// Edge travel time of the line graphs; route distances below are multiples of it.
+constexpr float line_travel_time = 1.5F;
+
+georoute::LambdaInvocation invocation(std::string event) {
+    return georoute::LambdaInvocation{"request-1", std::move(event)};
+}
+
+// Local stand-in for the Lambda Runtime API: hands out events in order and
+// records what the runtime posts back, keyed by request id.
+class FakeRuntimeApi {
+public:
+    struct Outcome {
+        std::string kind;
+        std::string body;
+    };
+
+    explicit FakeRuntimeApi(std::vector<std::string> events) : events_(std::move(events)) {
+        server_.Get("/2018-06-01/runtime/invocation/next", [this](const httplib::Request&, httplib::Response& res) {
+            std::lock_guard lock{mutex_};
+            if (next_ == events_.size()) {
+                res.status = 500;
+                return;
+            }
+            const auto deadline = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch() + std::chrono::seconds{30});
+            res.set_header("Lambda-Runtime-Aws-Request-Id", "request-" + std::to_string(next_));
+            res.set_header("Lambda-Runtime-Deadline-Ms", std::to_string(deadline.count()));
+            res.set_content(events_[next_++], "application/json");
+        });
+        server_.Post(R"(/2018-06-01/runtime/invocation/([^/]+)/(response|error))",
+                     [this](const httplib::Request& req, httplib::Response& res) {
+                         std::lock_guard lock{mutex_};
+                         outcomes_[req.matches[1]] = Outcome{req.matches[2], req.body};
+                         res.status = 202;
+                     });
+        server_.Post("/2018-06-01/runtime/init/error", [this](const httplib::Request& req, httplib::Response& res) {
+            std::lock_guard lock{mutex_};
+            outcomes_["init"] = Outcome{"error", req.body};
+            res.status = 202;
+        });
+        port_ = server_.bind_to_any_port("127.0.0.1");
+        thread_ = std::thread{[this] { server_.listen_after_bind(); }};
+        server_.wait_until_ready();
+    }
+
+    FakeRuntimeApi(const FakeRuntimeApi&) = delete;
+    FakeRuntimeApi& operator=(const FakeRuntimeApi&) = delete;
+
+    ~FakeRuntimeApi() {
+        server_.stop();
+        thread_.join();
+    }
+
+    [[nodiscard]] std::string address() const { return "127.0.0.1:" + std::to_string(port_); }
+
+    [[nodiscard]] std::map<std::string, Outcome> outcomes() {
+        std::lock_guard lock{mutex_};
+        return outcomes_;
+    }
+
+private:
+    httplib::Server server_;
+    std::thread thread_;
+    int port_{0};
+    std::mutex mutex_;
+    std::vector<std::string> events_;
+    std::size_t next_{0};
+    std::map<std::string, Outcome> outcomes_;
+};
+
+}  // namespace
+
+TEST_CASE("LambdaHandler answers direct route events", "[lambda_handler]") {
+    auto engine = build_line_engine(5, line_travel_time);
+    georoute::LambdaHandler handler{engine, std::chrono::milliseconds{0}, 0};
+
+    const auto body = nlohmann::json::parse(handler.handle(invocation(R"({"source": 0, "target": 4})")));
+    REQUIRE(body.at("reachable") == true);
+    REQUIRE(body.at("distance") == 6.0);
+    REQUIRE(body.at("path") == nlohmann::json::array({0, 1, 2, 3, 4}));
+
+    const auto capped =
+        nlohmann::json::parse(handler.handle(invocation(R"({"source": 0, "target": 4, "max_settled_nodes": 2})")));
+    REQUIRE(capped.at("status") == "node_budget_exceeded");
+
+    REQUIRE_THROWS_AS(handler.handle(invocation(R"({"source": 0})")), std::invalid_argument);
+    REQUIRE_THROWS_AS(handler.handle(invocation("[1, 2]")), std::invalid_argument);
+    REQUIRE_THROWS_AS(handler.handle(invocation("{")), std::invalid_argument);
+}
+
+TEST_CASE("LambdaHandler wraps API Gateway events in proxy responses", "[lambda_handler]") {
+    auto engine = build_line_engine(5, line_travel_time);
+    georoute::LambdaHandler handler{engine, std::chrono::milliseconds{0}, 0};
+
+    const auto proxy = [&handler](nlohmann::json event) {
+        return nlohmann::json::parse(handler.handle(invocation(event.dump())));
+    };
+
+    const auto ok = proxy({{"rawPath", "/route"}, {"body", R"({"source": 1, "target": 3})"}});
+    REQUIRE(ok.at("statusCode") == 200);
+    REQUIRE(ok.at("headers").at("Content-Type") == "application/json");
+    REQUIRE(nlohmann::json::parse(ok.at("body").get<std::string>()).at("path") == nlohmann::json::array({1, 2, 3}));
+
+    const auto invalid = proxy({{"body", R"({"target": 3})"}});
+    REQUIRE(invalid.at("statusCode") == 400);
+    REQUIRE(nlohmann::json::parse(invalid.at("body").get<std::string>()).contains("error"));
+
+    REQUIRE(proxy({{"body", nullptr}}).at("statusCode") == 400);
+    // std::out_of_range from the engine is a 400 too, not an invocation error.
+    const auto unknown_node = proxy({{"body", R"({"source": 1, "target": 99})"}});
+    REQUIRE(unknown_node.at("statusCode") == 400);
+    REQUIRE(nlohmann::json::parse(unknown_node.at("body").get<std::string>()).contains("error"));
+    REQUIRE(proxy({{"body", R"({"source": 1, "target": 3, "epoch": 1000})"}}).at("statusCode") == 400);
+    REQUIRE_THROWS_AS(handler.handle(invocation(R"({"source": 1, "target": 99})")), std::out_of_range);
+    REQUIRE(proxy({{"body", "eyJ9"}, {"isBase64Encoded", true}}).at("statusCode") == 400);
+
+    // The invocation deadline (less the margin) bounds the search.
+    auto large = build_line_engine(20000, line_travel_time);
+    georoute::LambdaHandler bounded{large, std::chrono::milliseconds{0}, 0};
+    georoute::LambdaInvocation late{"request-2", nlohmann::json{{"body", R"({"source": 0, "target": 19999})"}}.dump(),
+                                    std::chrono::steady_clock::now() + georoute::LambdaHandler::deadline_margin};
+    REQUIRE(nlohmann::json::parse(bounded.handle(late)).at("statusCode") == 504);
+}
+
+TEST_CASE("run_lambda serves invocations from a graph snapshot", "[lambda_handler]") {
+    const auto snapshot = (std::filesystem::temp_directory_path() /
+                           ("georoute_lambda_" + std::to_string(::getpid()) + ".snapshot"))
+                              .string();
+    georoute::write_graph_snapshot(build_line_graph(5, line_travel_time), snapshot);
+
+    FakeRuntimeApi api{{
+        R"({"source": 0, "target": 2})",
+        R"({"body": "{\"source\": 4, \"target\": 0}"})",
+        R"({"target": 2})",
+    }};
+    georoute::LambdaOptions options;
+    options.runtime_api = api.address();
+    options.graph_snapshot = snapshot;
+    options.max_invocations = 3;
+    REQUIRE(georoute::run_lambda(options) == 0);
+
+    auto outcomes = api.outcomes();
+    REQUIRE(outcomes.size() == 3);
+    REQUIRE(outcomes["request-0"].kind == "response");
+    REQUIRE(nlohmann::json::parse(outcomes["request-0"].body).at("distance") == 3.0);
+    REQUIRE(outcomes["request-1"].kind == "response");
+    const auto unreachable = nlohmann::json::parse(outcomes["request-1"].body);
+    REQUIRE(unreachable.at("statusCode") == 200);
+    REQUIRE(nlohmann::json::parse(unreachable.at("body").get<std::string>()).at("reachable") == false);
+    REQUIRE(outcomes["request-2"].kind == "error");
+    REQUIRE(nlohmann::json::parse(outcomes["request-2"].body).at("errorType") == "InvalidRequest");
+
+    std::filesystem::remove(snapshot);
+    FakeRuntimeApi failing{{}};
+    options.runtime_api = failing.address();
+    REQUIRE(georoute::run_lambda(options) == 1);
+    outcomes = failing.outcomes();
+    REQUIRE(outcomes.count("init") == 1);
+    REQUIRE(nlohmann::json::parse(outcomes["init"].body).at("errorType") == "GraphLoadError");
+
+    options.runtime_api.clear();
+    REQUIRE(georoute::run_lambda(options) == 1);
+}
+
+TEST_CASE("lambda_options_from_env rejects a node cap past uint32", "[lambda_handler]") {
+    ::setenv("GEOROUTE_MAX_SETTLED_NODES", "4294967296", 1);
+    REQUIRE_THROWS_AS(georoute::lambda_options_from_env(), std::out_of_range);
+    ::setenv("GEOROUTE_MAX_SETTLED_NODES", "4294967295", 1);
+    REQUIRE(georoute::lambda_options_from_env().max_settled_nodes == 4294967295U);
+    ::unsetenv("GEOROUTE_MAX_SETTLED_NODES");
+}
@@ -0,0 +1,132 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "georoute/engine.hpp"
+#include "georoute/json_writer.hpp"
+#include "georoute/path_encoding.hpp"
+#include "georoute/response_json.hpp"
+
+TEST_CASE("Varint paths encode id deltas and round-trip", "[path_encoding]") {
+    std::string out{"x"};
+    georoute::append_varint_path(out, std::vector<georoute::node_id>{0, 1, 2});
+    // Zigzag deltas 0, 2, 2 -> bytes 00 02 02.
+    REQUIRE(out == "xAAIC");
+
+    const std::vector<georoute::node_id> path{
+        1000, 1001, 1161, 1160, 0, std::numeric_limits<georoute::node_id>::max(), 7, 7};
+    std::string encoded;
+    georoute::append_varint_path(encoded, path);
+    REQUIRE(georoute::decode_varint_path(encoded) == path);
+
+    for (std::size_t length = 0; length < 8; ++length) {
+        const std::vector<georoute::node_id> prefix(path.begin(), path.begin() + static_cast<std::ptrdiff_t>(length));
+        encoded.clear();
+        georoute::append_varint_path(encoded, prefix);
+        REQUIRE(encoded.size() % 4 == 0);
+        REQUIRE(georoute::decode_varint_path(encoded) == prefix);
+    }
+}
+
+TEST_CASE("Varint path decoding rejects malformed input", "[path_encoding]") {
+    REQUIRE_THROWS_AS(georoute::decode_varint_path("AAI"), std::invalid_argument);
+    REQUIRE_THROWS_AS(georoute::decode_varint_path("AA*C"), std::invalid_argument);
+    REQUIRE_THROWS_AS(georoute::decode_varint_path("A=AA"), std::invalid_argument);
+    // 0x80 continues into nothing.
+    REQUIRE_THROWS_AS(georoute::decode_varint_path("gA=="), std::invalid_argument);
+    // Zigzag 1 is -1: below node 0.
+    REQUIRE_THROWS_AS(georoute::decode_varint_path("AQ=="), std::invalid_argument);
+}
+
+TEST_CASE("Polylines match the reference encoding", "[path_encoding]") {
+    const std::vector<georoute::Coordinate> coordinates{{38.5, -120.2}, {40.7, -120.95}, {43.252, -126.453}};
+    std::string out;
+    georoute::append_polyline(out, std::vector<georoute::node_id>{0, 1, 2}, coordinates);
+    REQUIRE(out == "_p~iF~ps|U_ulLnnqC_mqNvxq`@");
+
+    const auto decoded = georoute::decode_polyline(out);
+    REQUIRE(decoded.size() == 3);
+    REQUIRE(decoded[2].lat == Catch::Approx(43.252));
+    REQUIRE(decoded[2].lon == Catch::Approx(-126.453));
+
+    REQUIRE_THROWS_AS(georoute::append_polyline(out, std::vector<georoute::node_id>{3}, coordinates),
+                      std::out_of_range);
+    REQUIRE_THROWS_AS(georoute::decode_polyline("_p~iF"), std::invalid_argument);
+    REQUIRE_THROWS_AS(georoute::decode_polyline("_p~iF~ps|"), std::invalid_argument);
+}
+
+TEST_CASE("Path encodings are named in requests and responses", "[path_encoding]") {
+    using georoute::PathEncoding;
+    for (const auto encoding : {PathEncoding::array, PathEncoding::varint, PathEncoding::polyline}) {
+        REQUIRE(georoute::parse_path_encoding(georoute::path_encoding_name(encoding)) == encoding);
+    }
+    REQUIRE_THROWS_AS(georoute::parse_path_encoding("protobuf"), std::invalid_argument);
+}
+
+TEST_CASE("Route responses carry encoded paths", "[path_encoding]") {
+    georoute::RouteResponse response;
+    response.result.nodes = {0, 1, 2};
+    response.result.reachable = true;
+
+    const auto write = [&response](georoute::PathEncoding encoding) {
+        std::string out;
+        georoute::JsonWriter writer{out};
+        writer.begin_object();
+        georoute::write_route_fields(writer, 0, 2, response, true, encoding);
+        writer.end_object();
+        return nlohmann::json::parse(out);
+    };
+
+    const auto array = write(georoute::PathEncoding::array);
+    REQUIRE(array.at("path") == nlohmann::json::array({0, 1, 2}));
+    REQUIRE_FALSE(array.contains("path_encoding"));
+
+    const auto varint = write(georoute::PathEncoding::varint);
+    REQUIRE(varint.at("path") == "AAIC");
+    REQUIRE(varint.at("path_encoding") == "varint");
+
+    REQUIRE_THROWS_AS(write(georoute::PathEncoding::polyline), std::invalid_argument);
+    // A latitude step of -0.00015 degrees encodes to a backslash, which must be escaped.
+    response.coordinates = std::make_shared<const std::vector<georoute::Coordinate>>(
+        std::vector<georoute::Coordinate>{{0.0, 0.0}, {-0.00015, 0.0}, {-0.0003, 0.0}});
+    const auto polyline = write(georoute::PathEncoding::polyline);
+    REQUIRE(polyline.at("path") == "??\\?\\?");
+    REQUIRE(polyline.at("path_encoding") == "polyline");
+    REQUIRE(georoute::decode_polyline(polyline.at("path").get<std::string>()).size() == 3);
+}
+
+TEST_CASE("Engine responses keep the coordinates of their graph", "[path_encoding]") {
+    auto engine = georoute::GeoRouteEngine::from_json(R"({
+        "nodes": 3,
+        "edges": [
+            { "from": 0, "to": 1, "base_travel_time": 1.0 },
+            { "from": 1, "to": 2, "base_travel_time": 1.0 }
+        ],
+        "coordinates": [[52.52, 13.405], [52.521, 13.406], [52.522, 13.407]]
+    })"_json);
+    const auto response = engine.route(0, 2);
+    REQUIRE(response.coordinates);
+    REQUIRE(response.coordinates->size() == 3);
+
+    std::string encoded;
+    georoute::append_polyline(encoded, response.result.nodes, *response.coordinates);
+    const auto points = georoute::decode_polyline(encoded);
+    REQUIRE(points.size() == 3);
+    REQUIRE(points[1].lat == Catch::Approx(52.521));
+    REQUIRE(points[1].lon == Catch::Approx(13.406));
+
+    REQUIRE_THROWS_AS(georoute::GeoRouteEngine::from_json(
+                          R"({"nodes": 2, "edges": [], "coordinates": [[52.52, 13.405]]})"_json),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(georoute::GeoRouteEngine::from_json(
+                          R"({"nodes": 1, "edges": [], "coordinates": [[95.0, 13.405]]})"_json),
+                      std::invalid_argument);
+}
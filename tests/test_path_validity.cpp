@@ -1,7 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <set>
-#include <vector>
+#include <span>
 
 #include "georoute/graph.hpp"
 #include "georoute/router.hpp"
@@ -10,7 +10,7 @@
 namespace {
 
 // Helper to verify path validity using public Graph API
-bool verify_path_validity(const georoute::Graph& graph, const std::vector<georoute::node_id>& path,
+bool verify_path_validity(const georoute::Graph& graph, std::span<const georoute::node_id> path,
                           georoute::node_id source, georoute::node_id target) {
     if (path.empty()) {
         return false;
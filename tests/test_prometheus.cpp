@@ -0,0 +1,61 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "georoute/engine_stats.hpp"
+#include "georoute/prometheus.hpp"
+
+TEST_CASE("PrometheusWriter writes families, labels and samples", "[prometheus]") {
+    std::string text;
+    georoute::PrometheusWriter out{text};
+    out.family("georoute_graph_nodes", "gauge", "Nodes in the graph.")
+        .sample("georoute_graph_nodes", std::uint64_t{25600});
+    out.sample("georoute_ratio", 0.25, {{"endpoint", "/route"}, {"note", "a\"b\\c\nd"}});
+
+    REQUIRE(text ==
+            "# HELP georoute_graph_nodes Nodes in the graph.\n"
+            "# TYPE georoute_graph_nodes gauge\n"
+            "georoute_graph_nodes 25600\n"
+            "georoute_ratio{endpoint=\"/route\",note=\"a\\\"b\\\\c\\nd\"} 0.25\n");
+}
+
+TEST_CASE("PrometheusWriter writes cumulative histogram buckets", "[prometheus]") {
+    const std::array<std::uint64_t, 3> bounds{50'000, 1'000'000, 2'500'000};
+    georoute::MetricHistogram histogram{bounds};
+    histogram.observe(10'000);
+    histogram.observe(50'000);     // on a bound: counted in that bucket
+    histogram.observe(2'000'000);
+    histogram.observe(9'000'000);  // above every bound
+
+    std::string text;
+    georoute::PrometheusWriter out{text};
+    out.histogram("latency_seconds", histogram.snapshot(), 1e9, {{"endpoint", "/route"}});
+
+    REQUIRE(text ==
+            "latency_seconds_bucket{endpoint=\"/route\",le=\"0.00005\"} 2\n"
+            "latency_seconds_bucket{endpoint=\"/route\",le=\"0.001\"} 2\n"
+            "latency_seconds_bucket{endpoint=\"/route\",le=\"0.0025\"} 3\n"
+            "latency_seconds_bucket{endpoint=\"/route\",le=\"+Inf\"} 4\n"
+            "latency_seconds_sum{endpoint=\"/route\"} 0.01106\n"
+            "latency_seconds_count{endpoint=\"/route\"} 4\n");
+}
+
+TEST_CASE("fold_latency_histogram maps fine buckets onto coarse bounds", "[prometheus]") {
+    georoute::EngineStatsRecorder recorder;
+    recorder.record_route(40'000, 1, 1);
+    recorder.record_route(900'000, 1, 1);
+    recorder.record_route(3'000'000, 1, 1);
+
+    const std::array<std::uint64_t, 2> bounds{100'000, 1'000'000};
+    const auto folded = georoute::fold_latency_histogram(recorder.compute_time_histogram(), bounds);
+    REQUIRE(folded.upper_bounds == std::vector<std::uint64_t>{100'000, 1'000'000});
+    REQUIRE(folded.counts == std::vector<std::uint64_t>{1, 1, 1});
+    REQUIRE(folded.total_count == 3);
+    REQUIRE(folded.sum == 3'940'000);
+
+    const auto standard = georoute::prometheus_latency_bounds_ns();
+    REQUIRE(standard.size() <= georoute::MetricHistogram::max_bounds);
+    REQUIRE(standard.front() == 50'000);
+}
@@ -0,0 +1,72 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <latch>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include "georoute/query_executor.hpp"
+
+TEST_CASE("QueryExecutor runs every submitted task", "[query_executor]") {
+    std::atomic<int> ran{0};
+    {
+        georoute::QueryExecutor executor{3};
+        REQUIRE(executor.thread_count() == 3);
+        REQUIRE_FALSE(executor.on_worker_thread());
+        for (int i = 0; i < 1000; ++i) {
+            executor.submit([&ran](georoute::SearchScratch&) { ran.fetch_add(1); });
+        }
+    }
+    // The destructor drains the deques before joining.
+    REQUIRE(ran.load() == 1000);
+}
+
+TEST_CASE("QueryExecutor gives each worker its own scratch", "[query_executor]") {
+    georoute::QueryExecutor executor{2};
+    std::latch started{2};
+    std::latch release{1};
+    std::set<const georoute::SearchScratch*> seen;
+    std::mutex seen_mutex;
+    for (int i = 0; i < 2; ++i) {
+        executor.submit([&](georoute::SearchScratch& scratch) {
+            {
+                std::lock_guard lock{seen_mutex};
+                seen.insert(&scratch);
+            }
+            started.count_down();
+            release.wait();
+        });
+    }
+    started.wait();
+    release.count_down();
+    REQUIRE(seen.size() == 2);
+}
+
+TEST_CASE("QueryExecutor keeps nested tasks local and lets idle workers steal", "[query_executor]") {
+    georoute::QueryExecutor executor{2};
+    std::atomic<bool> nested_on_worker{false};
+    std::latch done{1 + 64};
+    executor.submit([&](georoute::SearchScratch&) {
+        nested_on_worker.store(executor.on_worker_thread());
+        // Queued on this worker's own deque; the other worker can only get
+        // them by stealing while this one is busy.
+        for (int i = 0; i < 64; ++i) {
+            executor.submit([&done](georoute::SearchScratch&) { done.count_down(); });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        done.count_down();
+    });
+    done.wait();
+    REQUIRE(nested_on_worker.load());
+    REQUIRE(executor.steals() > 0);
+}
+
+TEST_CASE("QueryExecutor survives a throwing task", "[query_executor]") {
+    georoute::QueryExecutor executor{1};
+    std::latch done{1};
+    executor.submit([](georoute::SearchScratch&) { throw std::runtime_error{"boom"}; });
+    executor.submit([&done](georoute::SearchScratch&) { done.count_down(); });
+    done.wait();
+}
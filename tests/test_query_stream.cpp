@@ -0,0 +1,136 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "georoute/engine.hpp"
+#include "georoute/query_stream.hpp"
+
+#include "test_graphs.hpp"
+
+namespace {
+
+std::vector<georoute::QueryStreamItem> read_all(const std::string& text, georoute::QueryFileFormat format) {
+    std::istringstream input{text};
+    std::vector<georoute::QueryStreamItem> items;
+    georoute::read_query_stream(input, format, [&items](const georoute::QueryStreamItem& item) {
+        items.push_back(item);
+    });
+    return items;
+}
+
+std::vector<std::string> lines(const std::string& text) {
+    std::vector<std::string> out;
+    std::istringstream input{text};
+    for (std::string line; std::getline(input, line);) {
+        out.push_back(line);
+    }
+    return out;
+}
+
+}  // namespace
+
+TEST_CASE("read_query_stream parses JSON, CSV and binary pair files", "[query_stream]") {
+    const auto json = read_all(
+        R"([{"source": 0, "target": 3}, {"edge_start": 1, "edge_end": 2, "factor": 2.5}, {"target": 1, "source": 2}])",
+        georoute::QueryFileFormat::json);
+    REQUIRE(json.size() == 3);
+    REQUIRE(std::get<georoute::RouteQuery>(json[0]).target == 3);
+    REQUIRE(std::get<georoute::CongestionUpdate>(json[1]).edge_end == 2);
+    REQUIRE(std::get<georoute::CongestionUpdate>(json[1]).factor == 2.5F);
+    REQUIRE(std::get<georoute::RouteQuery>(json[2]).source == 2);
+    REQUIRE(read_all("[]", georoute::QueryFileFormat::json).empty());
+
+    // Unknown fields are skipped whatever their sign or nesting.
+    const auto negative = read_all(R"([{"source": 1, "target": 2, "offset": -5, "meta": {"x": -1, "tags": [-2]}}])",
+                                   georoute::QueryFileFormat::json);
+    REQUIRE(negative.size() == 1);
+    REQUIRE(std::get<georoute::RouteQuery>(negative[0]).target == 2);
+
+    const auto csv = read_all("source,target\n\n0,3\r\n# rush hour\n1, 2, 3.0\n2,1", georoute::QueryFileFormat::csv);
+    REQUIRE(csv.size() == 3);
+    REQUIRE(std::get<georoute::RouteQuery>(csv[0]).target == 3);
+    REQUIRE(std::get<georoute::CongestionUpdate>(csv[1]).factor == 3.0F);
+    REQUIRE(std::get<georoute::RouteQuery>(csv[2]).source == 2);
+
+    std::string binary;
+    for (const std::uint32_t id : {0U, 3U, 2U, 1U}) {
+        binary.append(reinterpret_cast<const char*>(&id), sizeof(id));
+    }
+    const auto pairs = read_all(binary, georoute::QueryFileFormat::binary);
+    REQUIRE(pairs.size() == 2);
+    REQUIRE(std::get<georoute::RouteQuery>(pairs[1]).source == 2);
+    REQUIRE(std::get<georoute::RouteQuery>(pairs[1]).target == 1);
+
+    REQUIRE(georoute::query_file_format_for("data/sample_queries.json") == georoute::QueryFileFormat::json);
+    REQUIRE(georoute::query_file_format_for("pairs.bin") == georoute::QueryFileFormat::binary);
+    REQUIRE_THROWS_AS(georoute::query_file_format_for("queries.txt"), std::invalid_argument);
+    REQUIRE(georoute::parse_route_output_format("ndjson") == georoute::RouteOutputFormat::ndjson);
+    REQUIRE_THROWS_AS(georoute::parse_query_file_format("xml"), std::invalid_argument);
+}
+
+TEST_CASE("read_query_stream rejects malformed input", "[query_stream]") {
+    using georoute::QueryFileFormat;
+    REQUIRE_THROWS_AS(read_all(R"({"source": 0, "target": 1})", QueryFileFormat::json), std::invalid_argument);
+    REQUIRE_THROWS_AS(read_all(R"([{"source": 0}])", QueryFileFormat::json), std::invalid_argument);
+    REQUIRE_THROWS_AS(read_all(R"([{"source": -1, "target": 1}])", QueryFileFormat::json), std::invalid_argument);
+    REQUIRE_THROWS_AS(read_all("[-1]", QueryFileFormat::json), std::invalid_argument);
+    REQUIRE_THROWS_AS(read_all(R"([{"source": 0, "target": 1}, )", QueryFileFormat::json), std::invalid_argument);
+    REQUIRE_THROWS_AS(read_all("0,1\n0,x\n", QueryFileFormat::csv), std::invalid_argument);
+    REQUIRE_THROWS_AS(read_all("0,1,2,3\n", QueryFileFormat::csv), std::invalid_argument);
+    REQUIRE_THROWS_AS(read_all(std::string(7, '\0'), QueryFileFormat::binary), std::invalid_argument);
+}
+
+TEST_CASE("run_query_stream applies updates between the routes around them", "[query_stream]") {
+    auto engine = build_line_engine(4);
+    std::istringstream input{"0,3\n1,3\n0,2,3.0\n0,3\n3,0\n"};
+    std::ostringstream output;
+    georoute::QueryStreamOptions options;
+    options.chunk_size = 1;
+    options.include_path = true;
+    const auto summary = georoute::run_query_stream(engine, input, georoute::QueryFileFormat::csv, output, options);
+
+    REQUIRE(summary.routes == 4);
+    REQUIRE(summary.updates == 1);
+    REQUIRE(summary.unreachable == 1);
+    REQUIRE(lines(output.str()) == std::vector<std::string>{
+                                       "source,target,status,reachable,travel_time,expanded_nodes,path",
+                                       "0,3,complete,1,3,4,0 1 2 3",
+                                       "1,3,complete,1,2,3,1 2 3",
+                                       "0,3,complete,1,9,4,0 1 2 3",
+                                       "3,0,complete,0,,1,",
+                                   });
+}
+
+TEST_CASE("run_query_stream writes NDJSON and checks node ids", "[query_stream]") {
+    auto engine = build_line_engine(4);
+    std::istringstream input{R"([{"source": 0, "target": 2}, {"source": 2, "target": 0}])"};
+    std::ostringstream output;
+    georoute::QueryStreamOptions options;
+    options.output_format = georoute::RouteOutputFormat::ndjson;
+    georoute::run_query_stream(engine, input, georoute::QueryFileFormat::json, output, options);
+
+    const auto rows = lines(output.str());
+    REQUIRE(rows.size() == 2);
+    const auto first = nlohmann::json::parse(rows[0]);
+    REQUIRE(first.at("reachable") == true);
+    REQUIRE(first.at("travel_time") == 2.0);
+    REQUIRE_FALSE(first.contains("path"));
+    REQUIRE(nlohmann::json::parse(rows[1]).at("travel_time").is_null());
+
+    std::istringstream out_of_range{"0,1\n0,4\n"};
+    std::ostringstream discarded;
+    REQUIRE_THROWS_AS(
+        georoute::run_query_stream(engine, out_of_range, georoute::QueryFileFormat::csv, discarded, options),
+        std::out_of_range);
+    std::istringstream bad_update{"0,1\n0,7,2.0\n"};
+    REQUIRE_THROWS_AS(georoute::run_query_stream(engine, bad_update, georoute::QueryFileFormat::csv, discarded, options),
+                      std::out_of_range);
+}
@@ -0,0 +1,96 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory_resource>
+#include <vector>
+
+#include "georoute/engine.hpp"
+#include "georoute/graph.hpp"
+#include "georoute/request_arena.hpp"
+#include "georoute/router.hpp"
+#include "georoute/segment_tree.hpp"
+
+TEST_CASE("RequestArena reuses its buffer across scopes", "[request_arena]") {
+    georoute::RequestArena arena{1024};
+    const void* first = nullptr;
+    {
+        georoute::RequestArena::Scope scope{arena};
+        std::pmr::vector<int> values{scope.resource()};
+        values.reserve(16);
+        first = values.data();
+    }
+    {
+        georoute::RequestArena::Scope scope{arena};
+        std::pmr::vector<int> values{scope.resource()};
+        values.reserve(16);
+        REQUIRE(values.data() == first);
+    }
+    REQUIRE(arena.capacity() == 1024);
+    REQUIRE(arena.overflow_allocations() == 0);
+}
+
+TEST_CASE("RequestArena grows after a request overflows", "[request_arena]") {
+    georoute::RequestArena arena{256};
+    {
+        georoute::RequestArena::Scope scope{arena};
+        std::pmr::vector<char> values{scope.resource()};
+        values.resize(1000);
+    }
+    REQUIRE(arena.overflow_allocations() > 0);
+    REQUIRE(arena.capacity() >= 1000);
+
+    const auto overflowed = arena.overflow_allocations();
+    {
+        georoute::RequestArena::Scope scope{arena};
+        std::pmr::vector<char> values{scope.resource()};
+        values.resize(1000);
+    }
+    REQUIRE(arena.overflow_allocations() == overflowed);
+}
+
+TEST_CASE("RequestArena does not grow past max_capacity", "[request_arena]") {
+    georoute::RequestArena arena{256, 4096};
+    {
+        georoute::RequestArena::Scope scope{arena};
+        std::pmr::vector<char> values{scope.resource()};
+        values.resize(64 * 1024);
+    }
+    REQUIRE(arena.capacity() == 4096);
+
+    // Oversized requests still work; they keep spilling to the heap.
+    const auto overflowed = arena.overflow_allocations();
+    {
+        georoute::RequestArena::Scope scope{arena};
+        std::pmr::vector<char> values{scope.resource()};
+        values.resize(64 * 1024);
+        REQUIRE(values.back() == 0);
+    }
+    REQUIRE(arena.overflow_allocations() > overflowed);
+    REQUIRE(arena.capacity() == 4096);
+
+    // Requests under the cap fit the retained buffer.
+    const auto settled = arena.overflow_allocations();
+    {
+        georoute::RequestArena::Scope scope{arena};
+        std::pmr::vector<char> values{scope.resource()};
+        values.resize(1000);
+    }
+    REQUIRE(arena.overflow_allocations() == settled);
+}
+
+TEST_CASE("GeoRouteEngine allocates the path from the caller's resource", "[request_arena]") {
+    georoute::Graph graph{3};
+    graph.add_edge(0, 1, 1.0F);
+    graph.add_edge(1, 2, 1.0F);
+    georoute::SegmentTree tree{graph.edge_count()};
+    georoute::GeoRouteEngine engine{georoute::Router{std::move(graph), std::move(tree)}};
+
+    georoute::RequestArena arena;
+    georoute::RequestArena::Scope scope{arena};
+    const auto response = engine.route(0, 2, {}, scope.resource());
+    REQUIRE(response.result.nodes == std::pmr::vector<georoute::node_id>{0, 1, 2});
+    REQUIRE(response.result.nodes.get_allocator().resource() == scope.resource());
+
+    const auto at_epoch = engine.route_at_epoch(engine.current_epoch(), 0, 2, {}, scope.resource());
+    REQUIRE(at_epoch.result.nodes.get_allocator().resource() == scope.resource());
+    REQUIRE(arena.overflow_allocations() == 0);
+}
@@ -0,0 +1,190 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory_resource>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "georoute/engine.hpp"
+#include "georoute/route_coalescer.hpp"
+
+#include "test_graphs.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto no_deadline = Clock::time_point::max();
+
+// Spins until predicate holds, for state changed on other threads.
+template <typename Predicate>
+bool eventually(Predicate predicate) {
+    const auto deadline = Clock::now() + std::chrono::seconds{5};
+    while (!predicate()) {
+        if (Clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    return true;
+}
+
+georoute::RouteResponse make_response(georoute::RouteStatus status = georoute::RouteStatus::complete) {
+    georoute::RouteResponse response;
+    response.result.nodes = {4, 5, 6};
+    response.result.total_travel_time = 3.5F;
+    response.result.reachable = status == georoute::RouteStatus::complete;
+    response.status = status;
+    response.expanded_nodes = 17;
+    response.congestion_epoch = 9;
+    return response;
+}
+
+}  // namespace
+
+TEST_CASE("RouteCoalescer shares one search among identical callers", "[route_coalescer]") {
+    georoute::RouteCoalescer coalescer;
+    const georoute::RouteFlightKey key{&coalescer, 9, 4, 6, 0};
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::atomic<int> searches{0};
+
+    auto leader = std::async(std::launch::async, [&] {
+        return coalescer.run(key, no_deadline, std::pmr::get_default_resource(), [&] {
+            ++searches;
+            released.wait();
+            return make_response();
+        });
+    });
+    REQUIRE(eventually([&] { return coalescer.in_flight() == 1; }));
+
+    constexpr int follower_count = 4;
+    std::pmr::monotonic_buffer_resource arena;
+    std::vector<std::future<georoute::RouteResponse>> followers;
+    for (int i = 0; i < follower_count; ++i) {
+        followers.push_back(std::async(std::launch::async, [&] {
+            return coalescer.run(key, no_deadline, &arena, [&] {
+                ++searches;
+                return make_response();
+            });
+        }));
+    }
+    REQUIRE(eventually([&] { return coalescer.waiting() == follower_count; }));
+    release.set_value();
+
+    REQUIRE_FALSE(leader.get().coalesced);
+    for (auto& follower : followers) {
+        const auto response = follower.get();
+        REQUIRE(response.coalesced);
+        REQUIRE(response.result.nodes == std::pmr::vector<georoute::node_id>{4, 5, 6});
+        REQUIRE(response.result.nodes.get_allocator().resource() == &arena);
+        REQUIRE(response.result.total_travel_time == 3.5F);
+        REQUIRE(response.expanded_nodes == 17);
+        REQUIRE(response.congestion_epoch == 9);
+    }
+    REQUIRE(searches == 1);
+    REQUIRE(coalescer.in_flight() == 0);
+    REQUIRE(coalescer.waiting() == 0);
+}
+
+TEST_CASE("RouteCoalescer followers search themselves when the leader cannot share", "[route_coalescer]") {
+    georoute::RouteCoalescer coalescer;
+    const georoute::RouteFlightKey key{&coalescer, 1, 2, 3, 0};
+
+    const auto run_with_leader = [&](auto leader_compute) {
+        std::promise<void> release;
+        auto released = release.get_future().share();
+        auto leader = std::async(std::launch::async, [&] {
+            return coalescer.run(key, no_deadline, std::pmr::get_default_resource(), [&] {
+                released.wait();
+                return leader_compute();
+            });
+        });
+        REQUIRE(eventually([&] { return coalescer.in_flight() == 1; }));
+        std::atomic<int> own_searches{0};
+        auto follower = std::async(std::launch::async, [&] {
+            return coalescer.run(key, no_deadline, std::pmr::get_default_resource(), [&] {
+                ++own_searches;
+                return make_response();
+            });
+        });
+        REQUIRE(eventually([&] { return coalescer.waiting() == 1; }));
+        release.set_value();
+        const auto response = follower.get();
+        REQUIRE_FALSE(response.coalesced);
+        REQUIRE(own_searches == 1);
+        return leader;
+    };
+
+    auto budget_cut = run_with_leader([] { return make_response(georoute::RouteStatus::deadline_exceeded); });
+    REQUIRE(budget_cut.get().status == georoute::RouteStatus::deadline_exceeded);
+
+    auto failed = run_with_leader([]() -> georoute::RouteResponse { throw std::runtime_error{"search failed"}; });
+    REQUIRE_THROWS_AS(failed.get(), std::runtime_error);
+    REQUIRE(coalescer.in_flight() == 0);
+}
+
+TEST_CASE("RouteCoalescer followers stop waiting at their deadline", "[route_coalescer]") {
+    georoute::RouteCoalescer coalescer;
+    const georoute::RouteFlightKey key{&coalescer, 1, 2, 3, 0};
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    auto leader = std::async(std::launch::async, [&] {
+        return coalescer.run(key, no_deadline, std::pmr::get_default_resource(), [&] {
+            released.wait();
+            return make_response();
+        });
+    });
+    REQUIRE(eventually([&] { return coalescer.in_flight() == 1; }));
+
+    const auto deadline = Clock::now() + std::chrono::milliseconds{20};
+    const auto response = coalescer.run(key, deadline, std::pmr::get_default_resource(), [] {
+        return make_response(georoute::RouteStatus::deadline_exceeded);
+    });
+    REQUIRE(Clock::now() >= deadline);
+    REQUIRE_FALSE(response.coalesced);
+    REQUIRE(response.status == georoute::RouteStatus::deadline_exceeded);
+
+    release.set_value();
+    REQUIRE_FALSE(leader.get().coalesced);
+
+    // Different node caps are different searches.
+    const georoute::RouteFlightKey capped{&coalescer, 1, 2, 3, 100};
+    REQUIRE_FALSE(key == capped);
+}
+
+TEST_CASE("GeoRouteEngine counts coalesced queries separately", "[route_coalescer]") {
+    auto engine = build_line_engine(20000);
+    REQUIRE(engine.route_coalescing());
+
+    constexpr int threads = 8;
+    constexpr int per_thread = 20;
+    std::vector<std::thread> callers;
+    std::atomic<int> wrong{0};
+    for (int t = 0; t < threads; ++t) {
+        callers.emplace_back([&] {
+            for (int i = 0; i < per_thread; ++i) {
+                const auto response = engine.route(0, 19999);
+                if (!response.result.reachable || response.result.nodes.size() != 20000) {
+                    ++wrong;
+                }
+            }
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+    REQUIRE(wrong == 0);
+    auto stats = engine.get_stats();
+    REQUIRE(stats.total_queries + stats.total_coalesced_queries == threads * per_thread);
+
+    engine.reset_stats();
+    engine.set_route_coalescing(false);
+    REQUIRE(engine.route(0, 19999).result.reachable);
+    stats = engine.get_stats();
+    REQUIRE(stats.total_queries == 1);
+    REQUIRE(stats.total_coalesced_queries == 0);
+}
@@ -0,0 +1,62 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+
+#include "georoute/route_request.hpp"
+
+TEST_CASE("parse_route_request reads source, target and options", "[route_request]") {
+    const auto request = georoute::parse_route_request(
+        R"({"source": 3, "target": 7, "epoch": 12, "timeout_ms": 50, "max_settled_nodes": 1000})");
+    REQUIRE(request.source == 3);
+    REQUIRE(request.target == 7);
+    REQUIRE(request.epoch == 12);
+    REQUIRE(request.timeout_ms == 50);
+    REQUIRE(request.max_settled_nodes == 1000);
+
+    const auto minimal = georoute::parse_route_request(R"({"target": 1, "source": 0})");
+    REQUIRE(minimal.source == 0);
+    REQUIRE(minimal.target == 1);
+    REQUIRE_FALSE(minimal.epoch.has_value());
+    REQUIRE_FALSE(minimal.timeout_ms.has_value());
+    REQUIRE_FALSE(minimal.max_settled_nodes.has_value());
+    REQUIRE(minimal.path_encoding == georoute::PathEncoding::array);
+
+    const auto encoded = georoute::parse_route_request(R"({"source": 0, "target": 1, "path_encoding": "varint"})");
+    REQUIRE(encoded.path_encoding == georoute::PathEncoding::varint);
+}
+
+TEST_CASE("parse_route_request skips unknown and nested fields", "[route_request]") {
+    const auto request = georoute::parse_route_request(
+        R"({"client": {"source": 99, "tags": [1, 2]}, "source": 1, "note": "x", "target": 2})");
+    REQUIRE(request.source == 1);
+    REQUIRE(request.target == 2);
+
+    // Negative values are only checked in the known top-level fields.
+    const auto negative = georoute::parse_route_request(
+        R"({"source": 0, "target": 3, "offset": -7, "meta": {"x": -1, "source": -2}, "tags": [-1]})");
+    REQUIRE(negative.source == 0);
+    REQUIRE(negative.target == 3);
+
+    // A negative timeout keeps the server default, as before requests were streamed.
+    const auto timeout = georoute::parse_route_request(R"({"source": 1, "target": 2, "timeout_ms": -5})");
+    REQUIRE(timeout.timeout_ms == -5);
+    REQUIRE(georoute::make_request_budget(std::chrono::milliseconds{0}, 0, timeout.timeout_ms, std::nullopt).deadline ==
+            std::chrono::steady_clock::time_point::max());
+}
+
+TEST_CASE("parse_route_request rejects malformed bodies", "[route_request]") {
+    REQUIRE_THROWS_AS(georoute::parse_route_request("{\"source\": 1,"), std::invalid_argument);
+    REQUIRE_THROWS_AS(georoute::parse_route_request("[1, 2]"), std::invalid_argument);
+    REQUIRE_THROWS_AS(georoute::parse_route_request(R"({"source": 1})"), std::invalid_argument);
+    REQUIRE_THROWS_AS(georoute::parse_route_request(R"({"source": -1, "target": 2})"), std::invalid_argument);
+    REQUIRE_THROWS_AS(georoute::parse_route_request(R"({"source": "1", "target": 2})"), std::invalid_argument);
+    REQUIRE_THROWS_AS(georoute::parse_route_request(R"({"source": 1.5, "target": 2})"), std::invalid_argument);
+    REQUIRE_THROWS_AS(georoute::parse_route_request(R"({"source": 1, "target": 2, "max_settled_nodes": -5})"),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(georoute::parse_route_request(R"({"source": 1, "target": 2, "path_encoding": "gzip"})"),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(georoute::parse_route_request(R"({"source": 1, "target": 2, "path_encoding": 1})"),
+                      std::invalid_argument);
+}
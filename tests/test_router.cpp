@@ -3,9 +3,12 @@
 
 #include <nlohmann/json.hpp>
 
+#include <limits>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
+#include "georoute/dijkstra.hpp"
 #include "georoute/router.hpp"
 
 namespace {
@@ -30,7 +33,7 @@ TEST_CASE("Router computes routes with congestion applied", "[router]") {
     const auto baseline = router.compute_route(0, 3);
     REQUIRE(baseline.result.reachable);
     REQUIRE(baseline.result.total_travel_time == Catch::Approx(2.0F));
-    REQUIRE(baseline.result.nodes == std::vector<georoute::node_id>{0, 1, 3});
+    REQUIRE(baseline.result.nodes == std::pmr::vector<georoute::node_id>{0, 1, 3});
     REQUIRE(baseline.stats.expanded_nodes > 0);
 
     router.apply_congestion_update(0, 1, 2.5F);
@@ -38,7 +41,7 @@ TEST_CASE("Router computes routes with congestion applied", "[router]") {
     const auto congested = router.compute_route(0, 3);
     REQUIRE(congested.result.reachable);
     REQUIRE(congested.result.total_travel_time == Catch::Approx(3.0F));
-    REQUIRE(congested.result.nodes == std::vector<georoute::node_id>{0, 2, 3});
+    REQUIRE(congested.result.nodes == std::pmr::vector<georoute::node_id>{0, 2, 3});
     REQUIRE(congested.stats.expanded_nodes > 0);
 }
 
@@ -58,8 +61,139 @@ TEST_CASE("Router loads from JSON configuration", "[router]") {
 
     REQUIRE(route.result.reachable);
     REQUIRE(route.result.total_travel_time == Catch::Approx(2.0F));
-    REQUIRE(route.result.nodes == std::vector<georoute::node_id>{0, 1, 3});
+    REQUIRE(route.result.nodes == std::pmr::vector<georoute::node_id>{0, 1, 3});
     REQUIRE(route.stats.expanded_nodes > 0);
 }
 
+TEST_CASE("Router applies scattered edge updates", "[router]") {
+    auto router = build_sample_router();
+
+    const std::vector<georoute::EdgeFactorUpdate> updates{{0, 2.5F}, {1, 2.5F}};
+    router.apply_edge_updates(updates);
+
+    REQUIRE(router.congestion_factor(0) == Catch::Approx(2.5F));
+    REQUIRE(router.congestion_factor(2) == Catch::Approx(1.0F));
+    const auto congested = router.compute_route(0, 3);
+    REQUIRE(congested.result.total_travel_time == Catch::Approx(3.0F));
+    REQUIRE(congested.result.nodes == std::pmr::vector<georoute::node_id>{0, 2, 3});
+
+    const std::vector<georoute::EdgeFactorUpdate> invalid{{2, 2.0F}, {4, 2.0F}};
+    REQUIRE_THROWS_AS(router.apply_edge_updates(invalid), std::out_of_range);
+    REQUIRE(router.congestion_factor(2) == Catch::Approx(1.0F));
+
+    const std::vector<georoute::EdgeFactorUpdate> negative{{2, 2.0F}, {3, -1.0F}};
+    REQUIRE_THROWS_AS(router.apply_edge_updates(negative), std::invalid_argument);
+    REQUIRE_THROWS_AS(router.apply_congestion_update(0, 1, std::numeric_limits<float>::infinity()),
+                      std::invalid_argument);
+    REQUIRE(router.congestion_factor(2) == Catch::Approx(1.0F));
+}
+
+TEST_CASE("Router loads blocked congestion index from JSON", "[router]") {
+    const auto json = R"({
+        "nodes": 4,
+        "congestion_index": "blocked",
+        "edges": [
+            { "from": 0, "to": 1, "base_travel_time": 1.0 },
+            { "from": 1, "to": 3, "base_travel_time": 1.0 },
+            { "from": 0, "to": 2, "base_travel_time": 2.0 },
+            { "from": 2, "to": 3, "base_travel_time": 1.0 }
+        ]
+    })"_json;
+
+    auto router = georoute::Router::from_json(json);
+    router.apply_congestion_update(0, 1, 2.5F);
+    const auto route = router.compute_route(0, 3);
+
+    REQUIRE(route.result.total_travel_time == Catch::Approx(3.0F));
+    REQUIRE(route.result.nodes == std::pmr::vector<georoute::node_id>{0, 2, 3});
+}
+
+TEST_CASE("Router settings fall back to the given defaults", "[router]") {
+    const auto json = R"({
+        "nodes": 2,
+        "snapshot_history": 8,
+        "edges": [{ "from": 0, "to": 1, "base_travel_time": 1.0 }]
+    })"_json;
+
+    REQUIRE(georoute::Router::from_json(json).settings().congestion_index == "segment_tree");
+    const auto router = georoute::Router::from_json(json, georoute::RouterSettings{"blocked", 256});
+    const auto settings = router.settings();
+    REQUIRE(settings.congestion_index == "blocked");
+    REQUIRE(settings.snapshot_history == 8);
+}
 
+TEST_CASE("Router cost table tracks segment tree factors", "[router]") {
+    georoute::Graph graph{4};
+    graph.add_edge(0, 1, 1.0F);  // edge 0
+    graph.add_edge(1, 3, 1.0F);  // edge 1
+    graph.add_edge(0, 2, 2.0F);  // edge 2
+    graph.add_edge(2, 3, 1.0F);  // edge 3
+
+    georoute::SegmentTree tree{graph.edge_count()};
+    georoute::Router router{graph, georoute::SegmentTree{graph.edge_count()}};
+
+    const std::vector<std::pair<std::size_t, std::size_t>> ranges{{0, 1}, {1, 3}, {2, 2}, {0, 3}};
+    const std::vector<float> factors{2.5F, 0.8F, 1.7F, 1.1F};
+    for (std::size_t i = 0; i < ranges.size(); ++i) {
+        tree.range_multiply(ranges[i].first, ranges[i].second, factors[i]);
+        router.apply_congestion_update(ranges[i].first, ranges[i].second, factors[i]);
+
+        const auto expected = georoute::DijkstraRouter{graph, tree}.shortest_path(0, 3);
+        const auto actual = router.compute_route(0, 3);
+        REQUIRE(actual.result.total_travel_time == Catch::Approx(expected.result.total_travel_time));
+        REQUIRE(actual.result.nodes == expected.result.nodes);
+    }
+}
+
+TEST_CASE("Router rejects mismatched segment tree size", "[router]") {
+    georoute::Graph graph{2};
+    graph.add_edge(0, 1, 1.0F);
+
+    REQUIRE_THROWS_AS((georoute::Router{std::move(graph), georoute::SegmentTree{3}}), std::invalid_argument);
+}
+
+TEST_CASE("Router publishes one epoch per congestion write", "[router]") {
+    auto router = build_sample_router();
+    REQUIRE(router.current_epoch() == 0);
+    REQUIRE(router.compute_route(0, 3).congestion_epoch == 0);
+
+    REQUIRE(router.apply_congestion_update(0, 1, 2.5F) == 1);
+
+    const std::vector<georoute::CongestionUpdate> batch{{2, 2, 1.5F}, {3, 3, 1.5F}};
+    const auto published = router.apply_congestion_updates(batch);
+    REQUIRE(published.epoch == 2);
+    REQUIRE(router.current_epoch() == 2);
+
+    const auto route = router.compute_route(0, 3);
+    REQUIRE(route.congestion_epoch == 2);
+    REQUIRE(route.result.total_travel_time == Catch::Approx(4.5F));
+}
+
+TEST_CASE("Router snapshot is unaffected by later writes", "[router]") {
+    auto router = build_sample_router();
+    const auto pinned = router.snapshot();
+
+    router.apply_congestion_update(0, 3, 4.0F);
+
+    REQUIRE(pinned->epoch() == 0);
+    REQUIRE(pinned->cost(0) == Catch::Approx(1.0F));
+    REQUIRE(router.snapshot()->cost(0) == Catch::Approx(4.0F));
+
+    const auto past = router.compute_route_at(0, 0, 3);
+    REQUIRE(past.congestion_epoch == 0);
+    REQUIRE(past.result.total_travel_time == Catch::Approx(2.0F));
+    REQUIRE(router.compute_route(0, 3).result.total_travel_time == Catch::Approx(8.0F));
+}
+
+TEST_CASE("Router drops epochs beyond the snapshot history", "[router]") {
+    auto router = build_sample_router();
+    router.set_snapshot_history(2);
+
+    router.apply_congestion_update(0, 0, 2.0F);
+    router.apply_congestion_update(1, 1, 2.0F);
+
+    REQUIRE_THROWS_AS(router.compute_route_at(0, 0, 3), std::out_of_range);
+    REQUIRE_THROWS_AS(router.compute_route_at(3, 0, 3), std::out_of_range);
+    REQUIRE(router.compute_route_at(1, 0, 3).result.total_travel_time == Catch::Approx(3.0F));
+    REQUIRE(router.compute_route_at(2, 0, 3).result.total_travel_time == Catch::Approx(3.0F));
+}
@@ -2,6 +2,7 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <stdexcept>
+#include <vector>
 
 #include "georoute/segment_tree.hpp"
 
@@ -93,4 +94,29 @@ TEST_CASE("SegmentTree repeated updates on same range", "[segment_tree]") {
     REQUIRE(tree.point_query(4) == Catch::Approx(1.0F)); // Outside range
 }
 
+TEST_CASE("SegmentTree batch applies disjoint ranges in one pass", "[segment_tree]") {
+    georoute::SegmentTree tree{10};
+    const std::vector<georoute::CongestionUpdate> ranges{
+        {0, 1, 2.0F},
+        {3, 6, 1.5F},
+        {9, 9, 0.5F},
+    };
+    tree.range_multiply_batch(ranges);
+
+    REQUIRE(tree.point_query(0) == Catch::Approx(2.0F));
+    REQUIRE(tree.point_query(1) == Catch::Approx(2.0F));
+    REQUIRE(tree.point_query(2) == Catch::Approx(1.0F));
+    REQUIRE(tree.point_query(3) == Catch::Approx(1.5F));
+    REQUIRE(tree.point_query(6) == Catch::Approx(1.5F));
+    REQUIRE(tree.point_query(7) == Catch::Approx(1.0F));
+    REQUIRE(tree.point_query(9) == Catch::Approx(0.5F));
+}
 
+TEST_CASE("SegmentTree batch rejects overlapping ranges", "[segment_tree]") {
+    georoute::SegmentTree tree{10};
+    const std::vector<georoute::CongestionUpdate> overlapping{{0, 4, 2.0F}, {4, 6, 1.5F}};
+    const std::vector<georoute::CongestionUpdate> out_of_range{{8, 10, 2.0F}};
+
+    REQUIRE_THROWS_AS(tree.range_multiply_batch(overlapping), std::invalid_argument);
+    REQUIRE_THROWS_AS(tree.range_multiply_batch(out_of_range), std::out_of_range);
+}
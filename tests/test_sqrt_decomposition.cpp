@@ -0,0 +1,76 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <random>
+#include <stdexcept>
+
+#include "georoute/segment_tree.hpp"
+#include "georoute/sqrt_decomposition.hpp"
+
+TEST_CASE("SqrtDecomposition single element update", "[sqrt_decomposition]") {
+    georoute::SqrtDecomposition blocks{5};
+    blocks.range_multiply(2, 2, 1.5F);
+
+    REQUIRE(blocks.point_query(0) == Catch::Approx(1.0F));
+    REQUIRE(blocks.point_query(2) == Catch::Approx(1.5F));
+    REQUIRE(blocks.point_query(4) == Catch::Approx(1.0F));
+}
+
+TEST_CASE("SqrtDecomposition updates spanning several blocks", "[sqrt_decomposition]") {
+    georoute::SqrtDecomposition blocks{100};
+    const auto block = blocks.block_size();
+    REQUIRE(block < 100);
+
+    blocks.range_multiply(3, 3 * block + 1, 2.0F);   // partial, full blocks, partial
+    blocks.range_multiply(block, 2 * block - 1, 0.5F);  // exactly one aligned block
+
+    REQUIRE(blocks.point_query(2) == Catch::Approx(1.0F));
+    REQUIRE(blocks.point_query(3) == Catch::Approx(2.0F));
+    REQUIRE(blocks.point_query(block) == Catch::Approx(1.0F));
+    REQUIRE(blocks.point_query(2 * block) == Catch::Approx(2.0F));
+    REQUIRE(blocks.point_query(3 * block + 1) == Catch::Approx(2.0F));
+    REQUIRE(blocks.point_query(3 * block + 2) == Catch::Approx(1.0F));
+}
+
+TEST_CASE("SqrtDecomposition entire range update", "[sqrt_decomposition]") {
+    georoute::SqrtDecomposition blocks{37};
+    blocks.range_multiply(0, 36, 1.2F);
+    blocks.range_multiply(1, 35, 0.8F);
+
+    REQUIRE(blocks.point_query(0) == Catch::Approx(1.2F));
+    REQUIRE(blocks.point_query(1) == Catch::Approx(0.96F));
+    REQUIRE(blocks.point_query(35) == Catch::Approx(0.96F));
+    REQUIRE(blocks.point_query(36) == Catch::Approx(1.2F));
+}
+
+TEST_CASE("SqrtDecomposition invalid operations throw", "[sqrt_decomposition]") {
+    georoute::SqrtDecomposition blocks{3};
+
+    REQUIRE_THROWS_AS(blocks.range_multiply(2, 1, 1.0F), std::invalid_argument);
+    REQUIRE_THROWS_AS(blocks.range_multiply(0, 3, 1.0F), std::out_of_range);
+    REQUIRE_THROWS_AS(blocks.point_query(3), std::out_of_range);
+}
+
+TEST_CASE("SqrtDecomposition matches SegmentTree on random updates", "[sqrt_decomposition]") {
+    constexpr std::size_t size = 1000;
+    georoute::SegmentTree tree{size};
+    georoute::SqrtDecomposition blocks{size};
+
+    std::mt19937 rng{7};
+    std::uniform_int_distribution<std::size_t> index_dist(0, size - 1);
+    std::uniform_real_distribution<float> factor_dist(0.8F, 1.3F);
+    for (int i = 0; i < 200; ++i) {
+        auto l = index_dist(rng);
+        auto r = index_dist(rng);
+        if (l > r) {
+            std::swap(l, r);
+        }
+        const auto factor = factor_dist(rng);
+        tree.range_multiply(l, r, factor);
+        blocks.range_multiply(l, r, factor);
+    }
+
+    for (std::size_t i = 0; i < size; ++i) {
+        REQUIRE(blocks.point_query(i) == Catch::Approx(tree.point_query(i)).epsilon(1e-4));
+    }
+}